@@ -0,0 +1,202 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "Box2D.h"
+#include "../../Source/Common/b2Timer.h"
+#include "../TestBed/Framework/ThreadPool.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// This measures how the time step scales with the number of threads of the
+// reference thread pool. The pyramid is a single large island, so its contacts
+// are spread over the threads by color. The stacks are many small islands that
+// are solved on different threads. The scenes are as large as the broad-phase
+// allows, raise b2_maxProxies and b2_maxPairs in b2Settings.h for piles of
+// thousands of boxes.
+//
+// usage: benchmark [max threads] [steps]
+//
+// The checksum of the final transforms must be the same for every run with
+// the same thread count. With two or more threads it doesn't depend on the
+// thread count either.
+
+enum Scene
+{
+	e_pyramid,
+	e_stacks,
+	e_sceneCount
+};
+
+static const char* s_sceneNames[e_sceneCount] = {"pyramid", "stacks"};
+
+static b2World* CreateScene(Scene scene)
+{
+	// Fill the broad-phase, keeping a proxy for the ground. A box of a pile
+	// overlaps about four others.
+	int32 boxCount = b2Min(b2_maxProxies - 1, b2_maxPairs / 4);
+
+	int32 rowCount = 0;
+	while ((rowCount + 1) * (rowCount + 2) / 2 <= boxCount)
+	{
+		++rowCount;
+	}
+
+	const int32 stackHeight = 5;
+	int32 stackCount = boxCount / stackHeight;
+
+	float32 halfWidth = scene == e_pyramid ? 1.0f * rowCount : 1.5f * stackCount;
+	halfWidth += 10.0f;
+
+	b2AABB worldAABB;
+	worldAABB.lowerBound.Set(-halfWidth, -20.0f);
+	worldAABB.upperBound.Set(halfWidth, 2.0f * rowCount + 20.0f);
+
+	// The bodies must stay awake to be measured.
+	b2Vec2 gravity(0.0f, -10.0f);
+	bool doSleep = false;
+	b2World* world = new b2World(worldAABB, gravity, doSleep);
+
+	{
+		b2BodyDef bd;
+		bd.position.Set(0.0f, -10.0f);
+		b2Body* ground = world->CreateBody(&bd);
+
+		b2PolygonDef sd;
+		sd.SetAsBox(halfWidth - 5.0f, 10.0f);
+		ground->CreateFixture(&sd);
+	}
+
+	b2PolygonDef sd;
+	sd.SetAsBox(0.5f, 0.5f);
+	sd.density = 5.0f;
+	sd.friction = 0.6f;
+
+	if (scene == e_pyramid)
+	{
+		for (int32 i = 0; i < rowCount; ++i)
+		{
+			for (int32 j = i; j < rowCount; ++j)
+			{
+				b2BodyDef bd;
+				bd.position.Set(-0.5625f * rowCount + 0.5625f * i + 1.125f * (j - i), 0.5f + 1.0f * i);
+				b2Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&sd);
+				body->SetMassFromShapes();
+			}
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < stackCount; ++i)
+		{
+			for (int32 j = 0; j < stackHeight; ++j)
+			{
+				b2BodyDef bd;
+				bd.position.Set(-1.5f * stackCount + 3.0f * i, 0.5f + 1.0f * j);
+				b2Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&sd);
+				body->SetMassFromShapes();
+			}
+		}
+	}
+
+	return world;
+}
+
+// FNV-1a over the bits of the body transforms.
+static uint32 Checksum(b2World* world)
+{
+	uint32 hash = 2166136261u;
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		const b2XForm& xf = b->GetXForm();
+		const uint8* bytes = (const uint8*)&xf;
+		for (int32 i = 0; i < int32(sizeof(b2XForm)); ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 16777619u;
+		}
+	}
+
+	return hash;
+}
+
+int main(int argc, char** argv)
+{
+	int32 maxThreadCount = argc > 1 ? atoi(argv[1]) : 16;
+	int32 stepCount = argc > 2 ? atoi(argv[2]) : 300;
+	maxThreadCount = b2Max(maxThreadCount, 1);
+
+	// Let the piles settle before measuring.
+	const int32 settleCount = 60;
+
+	float32 timeStep = 1.0f / 60.0f;
+	int32 velocityIterations = 10;
+	int32 positionIterations = 8;
+
+	printf("processors = %d, steps = %d\n", ThreadPool::GetProcessorCount(), stepCount);
+	printf("%-8s %8s %8s %8s %8s %10s\n", "scene", "bodies", "islands", "threads", "ms/step", "speedup");
+
+	for (int32 s = 0; s < e_sceneCount; ++s)
+	{
+		float32 baseTime = 0.0f;
+
+		int32 threadCount = 1;
+		while (threadCount <= maxThreadCount)
+		{
+			ThreadPool* pool = NULL;
+			b2World* world = CreateScene(Scene(s));
+			if (threadCount > 1)
+			{
+				pool = new ThreadPool(threadCount);
+				world->SetTaskScheduler(pool);
+			}
+
+			for (int32 i = 0; i < settleCount; ++i)
+			{
+				world->Step(timeStep, velocityIterations, positionIterations);
+			}
+
+			b2Timer timer;
+			for (int32 i = 0; i < stepCount; ++i)
+			{
+				world->Step(timeStep, velocityIterations, positionIterations);
+			}
+			float32 time = timer.GetMilliseconds() / b2Max(stepCount, 1);
+
+			if (threadCount == 1)
+			{
+				baseTime = time;
+			}
+
+			float32 speedup = time > 0.0f ? baseTime / time : 0.0f;
+			printf("%-8s %8d %8d %8d %8.3f %9.2fx  checksum = %08x\n", s_sceneNames[s], world->GetBodyCount(),
+				world->GetIslandCount(), threadCount, time, speedup, Checksum(world));
+
+			delete world;
+			delete pool;
+
+			// 1, 2, 4, 8, 12, 16, ...
+			threadCount = threadCount < 8 ? 2 * threadCount : threadCount + 4;
+		}
+	}
+
+	return 0;
+}
@@ -367,13 +367,27 @@ int main(int argc, char** argv)
 		glui->add_spinner("Pos Iters", GLUI_SPINNER_INT, &settings.positionIterations);
 	positionIterationSpinner->set_int_limits(0, 100);
 
+	GLUI_Spinner* subStepSpinner =
+		glui->add_spinner("Sub-Steps", GLUI_SPINNER_INT, &settings.subSteps);
+	subStepSpinner->set_int_limits(0, 16);
+
+	GLUI_Spinner* velocityToleranceSpinner =
+		glui->add_spinner("Vel Tol", GLUI_SPINNER_FLOAT, &settings.velocityTolerance);
+	velocityToleranceSpinner->set_float_limits(0.0f, 0.1f);
+
 	GLUI_Spinner* hertzSpinner =
 		glui->add_spinner("Hertz", GLUI_SPINNER_FLOAT, &settingsHz);
 
 	hertzSpinner->set_float_limits(5.0f, 200.0f);
 
 	glui->add_checkbox("Warm Starting", &settings.enableWarmStarting);
+	glui->add_checkbox("Wide Solver", &settings.enableWideSolver);
 	glui->add_checkbox("Time of Impact", &settings.enableContinuous);
+	glui->add_checkbox("Threads", &settings.enableThreads);
+
+	GLUI_Spinner* threadCountSpinner =
+		glui->add_spinner("Thread Count", GLUI_SPINNER_INT, &settings.threadCount);
+	threadCountSpinner->set_int_limits(1, 16);
 
 	//glui->add_separator();
 
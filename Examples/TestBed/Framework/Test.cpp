@@ -56,6 +56,7 @@ Test::Test()
 	gravity.Set(0.0f, -10.0f);
 	bool doSleep = false;
 	m_world = new b2World(m_worldAABB, gravity, doSleep);
+	m_threadPool = NULL;
 	m_bomb = NULL;
 	m_textLine = 30;
 	m_mouseJoint = NULL;
@@ -78,36 +79,64 @@ Test::~Test()
 	// By deleting the world, we delete the bomb, mouse joint, etc.
 	delete m_world;
 	m_world = NULL;
+
+	delete m_threadPool;
+	m_threadPool = NULL;
 }
 
-void Test::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
+void Test::PreSolveManifolds(b2Contact* contact, const b2Manifold* oldManifolds, int32 oldManifoldCount)
 {
-	const b2Manifold* manifold = contact->GetManifold();
+	b2Fixture* fixtureA = contact->GetFixtureA();
+	b2Fixture* fixtureB = contact->GetFixtureB();
 
-	if (manifold->m_pointCount == 0)
+	int32 manifoldCount = contact->GetManifoldCount();
+	for (int32 k = 0; k < manifoldCount; ++k)
 	{
-		return;
-	}
+		const b2Manifold* manifold = contact->GetManifold() + k;
 
-	b2Fixture* fixtureA = contact->GetFixtureA();
-	b2Fixture* fixtureB = contact->GetFixtureB();
+		if (manifold->m_pointCount == 0)
+		{
+			continue;
+		}
 
-	b2PointState state1[b2_maxManifoldPoints], state2[b2_maxManifoldPoints];
-	b2GetPointStates(state1, state2, oldManifold, manifold);
+		// A chain segment may be at another index in the old manifolds,
+		// so a point persists if any old manifold has it.
+		b2PointState state[b2_maxManifoldPoints];
+		for (int32 i = 0; i < b2_maxManifoldPoints; ++i)
+		{
+			state[i] = b2_addState;
+		}
 
-	b2WorldManifold worldManifold;
-	contact->GetWorldManifold(&worldManifold);
+		for (int32 j = 0; j < oldManifoldCount; ++j)
+		{
+			b2PointState state1[b2_maxManifoldPoints], state2[b2_maxManifoldPoints];
+			b2GetPointStates(state1, state2, oldManifolds + j, manifold);
 
-	for (int32 i = 0; i < manifold->m_pointCount && m_pointCount < k_maxContactPoints; ++i)
-	{
-		ContactPoint* cp = m_points + m_pointCount;
-		cp->fixtureA = fixtureA;
-		cp->fixtureB = fixtureB;
-		cp->position = worldManifold.m_points[i];
-		cp->normal = worldManifold.m_normal;
-		cp->state = state2[i];
-		++m_pointCount;
+			for (int32 i = 0; i < manifold->m_pointCount; ++i)
+			{
+				if (state2[i] == b2_persistState)
+				{
+					state[i] = b2_persistState;
+				}
+			}
+		}
+
+		b2WorldManifold worldManifold;
+		contact->GetWorldManifold(&worldManifold, k);
+
+		for (int32 i = 0; i < manifold->m_pointCount && m_pointCount < k_maxContactPoints; ++i)
+		{
+			ContactPoint* cp = m_points + m_pointCount;
+			cp->fixtureA = fixtureA;
+			cp->fixtureB = fixtureB;
+			cp->position = worldManifold.m_points[i];
+			cp->normal = worldManifold.m_normal;
+			cp->state = state[i];
+			++m_pointCount;
+		}
 	}
+
+	PreSolve(contact, oldManifolds);
 }
 
 void Test::DrawTitle(int x, int y, const char *string)
@@ -298,8 +327,28 @@ void Test::Step(Settings* settings)
 	m_debugDraw.SetFlags(flags);
 
 	m_world->SetWarmStarting(settings->enableWarmStarting > 0);
+	m_world->SetWideContactSolver(settings->enableWideSolver > 0);
+	m_world->SetSubStepCount(settings->subSteps);
+	m_world->SetVelocityTolerance(settings->velocityTolerance, b2_minVelocityIterations);
 	m_world->SetContinuousPhysics(settings->enableContinuous > 0);
 
+	// The thread pool is rebuilt when the thread count changes. A single
+	// thread runs without a scheduler.
+	int32 threadCount = settings->enableThreads ? settings->threadCount : 1;
+	int32 poolThreadCount = m_threadPool ? m_threadPool->GetThreadCount() : 1;
+	if (threadCount != poolThreadCount)
+	{
+		m_world->SetTaskScheduler(NULL);
+		delete m_threadPool;
+		m_threadPool = NULL;
+
+		if (threadCount > 1)
+		{
+			m_threadPool = new ThreadPool(threadCount);
+			m_world->SetTaskScheduler(m_threadPool);
+		}
+	}
+
 	m_pointCount = 0;
 
 	m_world->Step(timeStep, settings->velocityIterations, settings->positionIterations);
@@ -330,6 +379,28 @@ void Test::Step(Settings* settings)
 
 		m_debugDraw.DrawString(5, m_textLine, "heap bytes = %d", b2_byteCount);
 		m_textLine += 15;
+
+		const b2TOIStats& toiStats = m_world->GetTOIStats();
+		m_debugDraw.DrawString(5, m_textLine, "toi candidates/events/dropped = %d/%d/%d",
+			toiStats.candidateCount, toiStats.eventCount, toiStats.droppedCount);
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "toi calls/iters/root iters = %d/%d/%d",
+			toiStats.callCount, toiStats.iterationCount, toiStats.rootIterationCount);
+		m_textLine += 15;
+
+		const b2SolverStats& solverStats = m_world->GetSolverStats();
+		float32 averageIterations = 0.0f;
+		if (solverStats.islandCount > 0)
+		{
+			averageIterations = float32(solverStats.velocityIterationCount) / float32(solverStats.islandCount);
+		}
+		m_debugDraw.DrawString(5, m_textLine, "islands/vel iters avg/max = %d/%.1f/%d",
+			solverStats.islandCount, averageIterations, solverStats.maxVelocityIterationCount);
+		m_textLine += 15;
+
+		m_debugDraw.DrawString(5, m_textLine, "islands awake/total = %d/%d",
+			m_world->GetAwakeIslandCount(), m_world->GetIslandCount());
+		m_textLine += 15;
 	}
 
 	if (m_mouseJoint)
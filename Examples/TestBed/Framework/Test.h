@@ -21,6 +21,7 @@
 
 #include "Box2D.h"
 #include "Render.h"
+#include "ThreadPool.h"
 
 #include <stdlib.h>
 
@@ -56,6 +57,8 @@ struct Settings
 		hz(60.0f),
 		velocityIterations(10),
 		positionIterations(8),
+		subSteps(0),
+		velocityTolerance(0.0f),
 		drawStats(0),
 		drawShapes(1),
 		drawJoints(1),
@@ -70,7 +73,10 @@ struct Settings
 		drawFrictionForces(0),
 		drawCOMs(0),
 		enableWarmStarting(1),
+		enableWideSolver(0),
 		enableContinuous(1),
+		enableThreads(0),
+		threadCount(4),
 		pause(0),
 		singleStep(0)
 		{}
@@ -78,6 +84,8 @@ struct Settings
 	float32 hz;
 	int32 velocityIterations;
 	int32 positionIterations;
+	int32 subSteps;
+	float32 velocityTolerance;
 	int32 drawShapes;
 	int32 drawJoints;
 	int32 drawControllers;
@@ -92,7 +100,10 @@ struct Settings
 	int32 drawCOMs;
 	int32 drawStats;
 	int32 enableWarmStarting;
+	int32 enableWideSolver;
 	int32 enableContinuous;
+	int32 enableThreads;
+	int32 threadCount;
 	int32 pause;
 	int32 singleStep;
 };
@@ -151,7 +162,7 @@ public:
 	virtual void MouseUp(const b2Vec2& p);
 	void MouseMove(const b2Vec2& p);
 	void LaunchBomb();
-	void LaunchBomb(const b2Vec2& position, const b2Vec2& velocity);
+	virtual void LaunchBomb(const b2Vec2& position, const b2Vec2& velocity);
 	
 	void SpawnBomb(const b2Vec2& worldPt);
 	void CompleteBombSpawn(const b2Vec2& p);
@@ -163,7 +174,7 @@ public:
 	// Callbacks for derived classes.
 	virtual void BeginContact(b2Contact* contact) { B2_NOT_USED(contact); }
 	virtual void EndContact(b2Contact* contact) { B2_NOT_USED(contact); }
-	virtual void PreSolve(b2Contact* contact, const b2Manifold* oldManifold);
+	virtual void PreSolveManifolds(b2Contact* contact, const b2Manifold* oldManifolds, int32 oldManifoldCount);
 	virtual void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
 	{
 		B2_NOT_USED(contact);
@@ -183,6 +194,7 @@ protected:
 	DebugDraw m_debugDraw;
 	int32 m_textLine;
 	b2World* m_world;
+	ThreadPool* m_threadPool;
 	b2Body* m_bomb;
 	b2MouseJoint* m_mouseJoint;
 	b2Vec2 m_bombSpawnPoint;
@@ -0,0 +1,300 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ThreadPool.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// The workers wait on the start semaphore, which is posted once per worker for
+// every task. Each worker posts the done semaphore when it runs out of items.
+struct ThreadPoolPlatform
+{
+	struct ThreadStart
+	{
+		ThreadPool* pool;
+		int32 threadIndex;
+	};
+
+#ifdef _WIN32
+	static DWORD WINAPI ThreadMain(LPVOID data)
+	{
+		ThreadStart* start = (ThreadStart*)data;
+		start->pool->WorkerMain(start->threadIndex);
+		return 0;
+	}
+
+	void Create(ThreadPool* pool, int32 workerCount)
+	{
+		InitializeCriticalSection(&mutex);
+		startSemaphore = CreateSemaphore(NULL, 0, workerCount, NULL);
+		doneSemaphore = CreateSemaphore(NULL, 0, workerCount, NULL);
+
+		threads = (HANDLE*)b2Alloc(workerCount * sizeof(HANDLE));
+		starts = (ThreadStart*)b2Alloc(workerCount * sizeof(ThreadStart));
+		for (int32 i = 0; i < workerCount; ++i)
+		{
+			starts[i].pool = pool;
+			starts[i].threadIndex = i + 1;
+			threads[i] = CreateThread(NULL, 0, ThreadMain, starts + i, 0, NULL);
+		}
+	}
+
+	void Destroy(int32 workerCount)
+	{
+		WaitForMultipleObjects(workerCount, threads, TRUE, INFINITE);
+		for (int32 i = 0; i < workerCount; ++i)
+		{
+			CloseHandle(threads[i]);
+		}
+
+		b2Free(starts);
+		b2Free(threads);
+		CloseHandle(doneSemaphore);
+		CloseHandle(startSemaphore);
+		DeleteCriticalSection(&mutex);
+	}
+
+	void Lock() { EnterCriticalSection(&mutex); }
+	void Unlock() { LeaveCriticalSection(&mutex); }
+
+	void PostStart(int32 count) { ReleaseSemaphore(startSemaphore, count, NULL); }
+	void WaitStart() { WaitForSingleObject(startSemaphore, INFINITE); }
+	void PostDone() { ReleaseSemaphore(doneSemaphore, 1, NULL); }
+	void WaitDone() { WaitForSingleObject(doneSemaphore, INFINITE); }
+
+	CRITICAL_SECTION mutex;
+	HANDLE startSemaphore;
+	HANDLE doneSemaphore;
+	HANDLE* threads;
+#else
+	static void* ThreadMain(void* data)
+	{
+		ThreadStart* start = (ThreadStart*)data;
+		start->pool->WorkerMain(start->threadIndex);
+		return NULL;
+	}
+
+	void Create(ThreadPool* pool, int32 workerCount)
+	{
+		pthread_mutex_init(&mutex, NULL);
+		pthread_cond_init(&startCondition, NULL);
+		pthread_cond_init(&doneCondition, NULL);
+		startCount = 0;
+		doneCount = 0;
+
+		threads = (pthread_t*)b2Alloc(workerCount * sizeof(pthread_t));
+		starts = (ThreadStart*)b2Alloc(workerCount * sizeof(ThreadStart));
+		for (int32 i = 0; i < workerCount; ++i)
+		{
+			starts[i].pool = pool;
+			starts[i].threadIndex = i + 1;
+			pthread_create(threads + i, NULL, ThreadMain, starts + i);
+		}
+	}
+
+	void Destroy(int32 workerCount)
+	{
+		for (int32 i = 0; i < workerCount; ++i)
+		{
+			pthread_join(threads[i], NULL);
+		}
+
+		b2Free(starts);
+		b2Free(threads);
+		pthread_cond_destroy(&doneCondition);
+		pthread_cond_destroy(&startCondition);
+		pthread_mutex_destroy(&mutex);
+	}
+
+	void Lock() { pthread_mutex_lock(&mutex); }
+	void Unlock() { pthread_mutex_unlock(&mutex); }
+
+	// Unnamed POSIX semaphores are missing on some systems, so the
+	// semaphores are counters guarded by the mutex.
+	void PostStart(int32 count)
+	{
+		Lock();
+		startCount += count;
+		pthread_cond_broadcast(&startCondition);
+		Unlock();
+	}
+
+	void WaitStart()
+	{
+		Lock();
+		while (startCount == 0)
+		{
+			pthread_cond_wait(&startCondition, &mutex);
+		}
+		--startCount;
+		Unlock();
+	}
+
+	void PostDone()
+	{
+		Lock();
+		++doneCount;
+		pthread_cond_signal(&doneCondition);
+		Unlock();
+	}
+
+	void WaitDone()
+	{
+		Lock();
+		while (doneCount == 0)
+		{
+			pthread_cond_wait(&doneCondition, &mutex);
+		}
+		--doneCount;
+		Unlock();
+	}
+
+	pthread_mutex_t mutex;
+	pthread_cond_t startCondition;
+	pthread_cond_t doneCondition;
+	int32 startCount;
+	int32 doneCount;
+	pthread_t* threads;
+#endif
+
+	ThreadStart* starts;
+};
+
+ThreadPool::ThreadPool(int32 threadCount)
+{
+	b2Assert(threadCount > 0);
+
+	m_threadCount = threadCount;
+	m_task = NULL;
+	m_itemCount = 0;
+	m_nextItem = 0;
+	m_rangeSize = 1;
+	m_quit = false;
+
+	m_platform = (ThreadPoolPlatform*)b2Alloc(sizeof(ThreadPoolPlatform));
+	if (m_threadCount > 1)
+	{
+		m_platform->Create(this, m_threadCount - 1);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	if (m_threadCount > 1)
+	{
+		m_platform->Lock();
+		m_quit = true;
+		m_platform->Unlock();
+
+		m_platform->PostStart(m_threadCount - 1);
+		m_platform->Destroy(m_threadCount - 1);
+	}
+
+	b2Free(m_platform);
+}
+
+int32 ThreadPool::GetProcessorCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return b2Max(int32(info.dwNumberOfProcessors), 1);
+#else
+	return b2Max(int32(sysconf(_SC_NPROCESSORS_ONLN)), 1);
+#endif
+}
+
+void ThreadPool::Run(b2Task* task, int32 itemCount)
+{
+	if (itemCount == 0)
+	{
+		return;
+	}
+
+	if (m_threadCount == 1 || itemCount == 1)
+	{
+		task->Execute(0, itemCount, 0);
+		return;
+	}
+
+	// A few ranges per thread balance the load without taking the
+	// lock for every item.
+	m_platform->Lock();
+	m_task = task;
+	m_itemCount = itemCount;
+	m_nextItem = 0;
+	m_rangeSize = b2Max(itemCount / (4 * m_threadCount), 1);
+	m_platform->Unlock();
+
+	m_platform->PostStart(m_threadCount - 1);
+
+	Execute(0);
+
+	for (int32 i = 1; i < m_threadCount; ++i)
+	{
+		m_platform->WaitDone();
+	}
+
+	m_task = NULL;
+}
+
+void ThreadPool::WorkerMain(int32 threadIndex)
+{
+	for (;;)
+	{
+		m_platform->WaitStart();
+
+		m_platform->Lock();
+		bool quit = m_quit;
+		m_platform->Unlock();
+
+		if (quit)
+		{
+			return;
+		}
+
+		Execute(threadIndex);
+
+		m_platform->PostDone();
+	}
+}
+
+void ThreadPool::Execute(int32 threadIndex)
+{
+	for (;;)
+	{
+		m_platform->Lock();
+		int32 begin = m_nextItem;
+		int32 end = b2Min(begin + m_rangeSize, m_itemCount);
+		m_nextItem = end;
+		b2Task* task = m_task;
+		m_platform->Unlock();
+
+		if (begin >= end)
+		{
+			break;
+		}
+
+		task->Execute(begin, end, threadIndex);
+	}
+}
@@ -0,0 +1,60 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "Box2D.h"
+
+struct ThreadPoolPlatform;
+
+// This is a reference task scheduler. It keeps a fixed set of worker threads
+// that sleep between tasks. The items of a task are handed out in small ranges,
+// so a thread that finishes early takes more work. The calling thread works too
+// and has thread index 0.
+class ThreadPool : public b2TaskScheduler
+{
+public:
+	ThreadPool(int32 threadCount);
+	~ThreadPool();
+
+	int32 GetThreadCount() const { return m_threadCount; }
+
+	void Run(b2Task* task, int32 itemCount);
+
+	// The number of threads of the machine, at least one.
+	static int32 GetProcessorCount();
+
+private:
+	friend struct ThreadPoolPlatform;
+
+	void WorkerMain(int32 threadIndex);
+	void Execute(int32 threadIndex);
+
+	ThreadPoolPlatform* m_platform;
+	int32 m_threadCount;
+
+	// The current task. These are guarded by the mutex of the platform.
+	b2Task* m_task;
+	int32 m_itemCount;
+	int32 m_nextItem;
+	int32 m_rangeSize;
+	bool m_quit;
+};
+
+#endif
@@ -0,0 +1,189 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef BODY_POOL_H
+#define BODY_POOL_H
+
+// The projectiles are created inactive up front and reused. Firing activates
+// one, a projectile is put back into the pool after a few seconds. The shelf
+// can be deactivated, the boxes on it fall and the chain hanging from it
+// stops being simulated.
+class BodyPool : public Test
+{
+public:
+
+	enum
+	{
+		e_poolSize = 16,
+	};
+
+	BodyPool()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(50.0f, 10.0f, b2Vec2(0.0f, -10.0f), 0.0f);
+			ground->CreateFixture(&sd);
+		}
+
+		{
+			b2BodyDef bd;
+			bd.position.Set(10.0f, 12.0f);
+			m_shelf = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(5.0f, 0.25f);
+			m_shelf->CreateFixture(&sd);
+
+			sd.SetAsBox(0.5f, 0.5f);
+			sd.density = 1.0f;
+			sd.friction = 0.6f;
+
+			for (int32 i = 0; i < 5; ++i)
+			{
+				for (int32 j = 0; j < 5 - i; ++j)
+				{
+					b2BodyDef boxDef;
+					boxDef.position.Set(7.5f + 0.5f * i + 1.1f * j, 12.75f + 1.0f * i);
+					b2Body* body = m_world->CreateBody(&boxDef);
+					body->CreateFixture(&sd);
+					body->SetMassFromShapes();
+				}
+			}
+
+			sd.SetAsBox(0.1f, 0.5f);
+			sd.density = 5.0f;
+
+			b2Body* prevBody = m_shelf;
+			for (int32 i = 0; i < 8; ++i)
+			{
+				b2BodyDef linkDef;
+				linkDef.position.Set(14.5f, 11.25f - 1.0f * i);
+				b2Body* body = m_world->CreateBody(&linkDef);
+				body->CreateFixture(&sd);
+				body->SetMassFromShapes();
+
+				b2RevoluteJointDef jd;
+				jd.Initialize(prevBody, body, b2Vec2(14.5f, 11.75f - 1.0f * i));
+				m_world->CreateJoint(&jd);
+
+				prevBody = body;
+			}
+		}
+
+		{
+			b2BodyDef bd;
+			bd.isActive = false;
+			bd.isBullet = true;
+
+			b2CircleDef cd;
+			cd.radius = 0.25f;
+			cd.density = 20.0f;
+			cd.restitution = 0.05f;
+
+			for (int32 i = 0; i < e_poolSize; ++i)
+			{
+				bd.position.Set(-20.0f - 1.0f * i, 1.0f);
+				m_pool[i] = m_world->CreateBody(&bd);
+				m_pool[i]->CreateFixture(&cd);
+				m_pool[i]->SetMassFromShapes();
+				m_fireTimes[i] = 0;
+			}
+		}
+
+		m_stepCount = 0;
+	}
+
+	void Fire()
+	{
+		for (int32 i = 0; i < e_poolSize; ++i)
+		{
+			b2Body* body = m_pool[i];
+			if (body->IsActive())
+			{
+				continue;
+			}
+
+			body->SetXForm(b2Vec2(-30.0f, 14.0f), 0.0f);
+			body->SetActive(true);
+			body->WakeUp();
+			body->SetLinearVelocity(b2Vec2(50.0f, 0.0f));
+			body->SetAngularVelocity(0.0f);
+			m_fireTimes[i] = m_stepCount;
+			return;
+		}
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'f':
+			Fire();
+			break;
+
+		case 'a':
+			m_shelf->SetActive(!m_shelf->IsActive());
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		Test::Step(settings);
+
+		// Put the old projectiles back into the pool.
+		for (int32 i = 0; i < e_poolSize; ++i)
+		{
+			if (m_pool[i]->IsActive() && m_stepCount - m_fireTimes[i] > 300)
+			{
+				m_pool[i]->SetActive(false);
+			}
+		}
+
+		int32 activeCount = 0;
+		for (int32 i = 0; i < e_poolSize; ++i)
+		{
+			if (m_pool[i]->IsActive())
+			{
+				++activeCount;
+			}
+		}
+
+		++m_stepCount;
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (f) to fire a pooled projectile, (a) to toggle the shelf");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "projectiles in use = %d of %d, shelf active = %d", activeCount, e_poolSize, m_shelf->IsActive());
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new BodyPool;
+	}
+
+	b2Body* m_shelf;
+	b2Body* m_pool[e_poolSize];
+	int32 m_fireTimes[e_poolSize];
+	int32 m_stepCount;
+};
+
+#endif
@@ -0,0 +1,173 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef CAPSULES_H
+#define CAPSULES_H
+
+#include <time.h>
+
+// Drops a pile of capsules, or of 8 sided polygons with the same outline, onto
+// static boxes, edges, and capsules. Compare the step time of the two.
+class Capsules : public Test
+{
+public:
+
+	enum
+	{
+		e_columnCount = 10,
+		e_rowCount = 20,
+	};
+
+	Capsules()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(40.0f, 1.0f, b2Vec2(0.0f, -1.0f), 0.0f);
+			sd.friction = 0.6f;
+			ground->CreateFixture(&sd);
+
+			b2EdgeDef ed;
+			ed.friction = 0.6f;
+			ed.vertex1.Set(-20.0f, 10.0f);
+			ed.vertex2.Set(-10.0f, 0.0f);
+			ground->CreateFixture(&ed);
+			ed.vertex1.Set(10.0f, 0.0f);
+			ed.vertex2.Set(20.0f, 10.0f);
+			ground->CreateFixture(&ed);
+
+			b2CapsuleDef cd;
+			cd.localPoint1.Set(-3.0f, 4.0f);
+			cd.localPoint2.Set(3.0f, 6.0f);
+			cd.radius = 0.5f;
+			cd.friction = 0.6f;
+			ground->CreateFixture(&cd);
+		}
+
+		for (int32 i = 0; i < e_columnCount * e_rowCount; ++i)
+		{
+			m_bodies[i] = NULL;
+		}
+
+		m_useCapsules = true;
+		CreateBodies();
+	}
+
+	void CreateBodies()
+	{
+		for (int32 i = 0; i < e_columnCount * e_rowCount; ++i)
+		{
+			if (m_bodies[i])
+			{
+				m_world->DestroyBody(m_bodies[i]);
+				m_bodies[i] = NULL;
+			}
+		}
+
+		const float32 halfLength = 0.5f;
+		const float32 radius = 0.25f;
+
+		b2CapsuleDef cd;
+		cd.localPoint1.Set(-halfLength, 0.0f);
+		cd.localPoint2.Set(halfLength, 0.0f);
+		cd.radius = radius;
+		cd.density = 1.0f;
+		cd.friction = 0.6f;
+
+		// The same outline as a polygon, four vertices on each end.
+		b2PolygonDef pd;
+		pd.vertexCount = 8;
+		pd.density = 1.0f;
+		pd.friction = 0.6f;
+		for (int32 i = 0; i < 4; ++i)
+		{
+			float32 angle = b2_pi * (-0.5f + i / 3.0f);
+			b2Vec2 r(radius * cosf(angle), radius * sinf(angle));
+			pd.vertices[i] = cd.localPoint2 + r;
+			pd.vertices[i + 4] = cd.localPoint1 - r;
+		}
+
+		int32 index = 0;
+		for (int32 i = 0; i < e_columnCount; ++i)
+		{
+			for (int32 j = 0; j < e_rowCount; ++j)
+			{
+				b2BodyDef bd;
+				bd.position.Set(-9.0f + 2.0f * i + 0.5f * (j & 1), 10.0f + 1.0f * j);
+				bd.angle = RandomFloat(-b2_pi, b2_pi);
+				b2Body* body = m_world->CreateBody(&bd);
+
+				if (m_useCapsules)
+				{
+					body->CreateFixture(&cd);
+				}
+				else
+				{
+					body->CreateFixture(&pd);
+				}
+
+				body->SetMassFromShapes();
+				m_bodies[index++] = body;
+			}
+		}
+
+		m_stepTime = 0.0f;
+		m_stepSamples = 0;
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'c':
+			m_useCapsules = !m_useCapsules;
+			CreateBodies();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		clock_t start = clock();
+		Test::Step(settings);
+		m_stepTime += 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		++m_stepSamples;
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (c) to switch between capsules and polygons");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "%s: %d bodies, %d contacts",
+			m_useCapsules ? "capsules" : "polygons", e_columnCount * e_rowCount, m_world->GetContactCount());
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "average step = %.3f ms", (float) (m_stepTime / m_stepSamples));
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new Capsules;
+	}
+
+	b2Body* m_bodies[e_columnCount * e_rowCount];
+	bool m_useCapsules;
+	float32 m_stepTime;
+	int32 m_stepSamples;
+};
+
+#endif
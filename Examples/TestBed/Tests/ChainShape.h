@@ -0,0 +1,167 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef CHAIN_SHAPE_H
+#define CHAIN_SHAPE_H
+
+#include <time.h>
+
+// Compares a terrain made of one chain shape with the same terrain made
+// with b2CreateEdgeChain. The edge chain is limited by the proxy count,
+// so the chain terrain can be made much longer.
+class ChainShape : public Test
+{
+public:
+
+	enum
+	{
+		e_edgeVertexCount = 401,
+		e_chainVertexCount = 20001,
+	};
+
+	ChainShape()
+	{
+		m_terrain = NULL;
+		m_useChain = true;
+		CreateTerrain();
+
+		for (int32 i = 0; i < 40; ++i)
+		{
+			b2BodyDef bd;
+			bd.position.Set(-40.0f + 2.0f * i, 20.0f + RandomFloat(0.0f, 5.0f));
+			b2Body* body = m_world->CreateBody(&bd);
+
+			if (i & 1)
+			{
+				b2CircleDef sd;
+				sd.radius = 0.5f;
+				sd.density = 1.0f;
+				sd.friction = 0.6f;
+				body->CreateFixture(&sd);
+			}
+			else
+			{
+				b2PolygonDef sd;
+				sd.SetAsBox(0.5f, 0.5f);
+				sd.density = 1.0f;
+				sd.friction = 0.6f;
+				body->CreateFixture(&sd);
+			}
+
+			body->SetMassFromShapes();
+		}
+	}
+
+	static float32 TerrainHeight(float32 x)
+	{
+		return 2.0f * sinf(0.2f * x) + 0.5f * sinf(1.3f * x);
+	}
+
+	void CreateTerrain()
+	{
+		if (m_terrain)
+		{
+			m_world->DestroyBody(m_terrain);
+			m_terrain = NULL;
+		}
+
+		// The chain terrain is much longer than the world, segments out of the
+		// world are never touched but they are loaded.
+		int32 count = m_useChain ? e_chainVertexCount : e_edgeVertexCount;
+		float32 dx = 0.5f;
+		float32 x0 = -0.5f * dx * (e_edgeVertexCount - 1);
+
+		b2Vec2* vertices = new b2Vec2[count];
+		for (int32 i = 0; i < count; ++i)
+		{
+			float32 x = x0 + dx * i;
+			vertices[i].Set(x, TerrainHeight(x));
+		}
+
+		clock_t start = clock();
+
+		b2BodyDef bd;
+		m_terrain = m_world->CreateBody(&bd);
+
+		if (m_useChain)
+		{
+			b2ChainDef cd;
+			cd.vertices = vertices;
+			cd.vertexCount = count;
+			cd.friction = 0.6f;
+			m_terrain->CreateFixture(&cd);
+		}
+		else
+		{
+			b2EdgeChainDef ed;
+			ed.vertices = vertices;
+			ed.vertexCount = count;
+			ed.isLoop = false;
+			ed.friction = 0.6f;
+			b2CreateEdgeChain(m_terrain, &ed);
+		}
+
+		m_createTime = 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		m_segmentCount = count - 1;
+		m_stepTime = 0.0f;
+		m_stepSamples = 0;
+
+		delete [] vertices;
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'c':
+			m_useChain = !m_useChain;
+			CreateTerrain();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		clock_t start = clock();
+		Test::Step(settings);
+		m_stepTime += 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		++m_stepSamples;
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (c) to switch between a chain shape and an edge chain");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "%s: %d segments, created in %.2f ms",
+			m_useChain ? "chain shape" : "edge chain", m_segmentCount, (float) m_createTime);
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "average step = %.3f ms", (float) (m_stepTime / m_stepSamples));
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new ChainShape;
+	}
+
+	b2Body* m_terrain;
+	bool m_useChain;
+	int32 m_segmentCount;
+	float32 m_createTime;
+	float32 m_stepTime;
+	int32 m_stepSamples;
+};
+
+#endif
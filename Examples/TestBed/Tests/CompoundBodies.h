@@ -0,0 +1,222 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef COMPOUND_BODIES_H
+#define COMPOUND_BODIES_H
+
+#include <time.h>
+
+// Buildings made of many bricks on a single body fall onto stepped terrain.
+// Compound bodies keep the bricks in a fixture tree behind a single broad-phase
+// proxy. Switch to regular bodies to compare the proxy count and step time.
+class CompoundBodies : public Test
+{
+public:
+
+	enum
+	{
+		e_buildingCount = 3,
+		e_columnCount = 8,
+		e_rowCount = 15,
+		e_stepCount = 30,
+		e_maxDebris = 60,
+	};
+
+	CompoundBodies()
+	{
+		m_ground = NULL;
+		for (int32 i = 0; i < e_buildingCount; ++i)
+		{
+			m_buildings[i] = NULL;
+		}
+		m_debrisCount = 0;
+
+		m_useCompound = true;
+		CreateBodies();
+	}
+
+	void CreateBodies()
+	{
+		if (m_ground)
+		{
+			m_world->DestroyBody(m_ground);
+		}
+
+		for (int32 i = 0; i < e_buildingCount; ++i)
+		{
+			if (m_buildings[i])
+			{
+				m_world->DestroyBody(m_buildings[i]);
+			}
+		}
+
+		for (int32 i = 0; i < m_debrisCount; ++i)
+		{
+			m_world->DestroyBody(m_debris[i]);
+		}
+
+		{
+			b2BodyDef bd;
+			bd.isCompound = m_useCompound;
+			m_ground = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(40.0f, 1.0f, b2Vec2(0.0f, -1.0f), 0.0f);
+			sd.friction = 0.6f;
+			m_ground->CreateFixture(&sd);
+
+			// Steps on both sides.
+			for (int32 i = 0; i < e_stepCount; ++i)
+			{
+				float32 x = 20.0f + 0.5f * i;
+				float32 h = 0.1f * (i + 1);
+				sd.SetAsBox(0.25f, 0.5f * h, b2Vec2(x, 0.5f * h), 0.0f);
+				m_ground->CreateFixture(&sd);
+				sd.SetAsBox(0.25f, 0.5f * h, b2Vec2(-x, 0.5f * h), 0.0f);
+				m_ground->CreateFixture(&sd);
+			}
+		}
+
+		b2PolygonDef sd;
+		sd.density = 1.0f;
+		sd.friction = 0.6f;
+
+		for (int32 i = 0; i < e_buildingCount; ++i)
+		{
+			b2BodyDef bd;
+			bd.isCompound = m_useCompound;
+			bd.position.Set(-12.0f + 12.0f * i, 2.0f + 6.0f * i);
+			bd.angle = 0.2f * (i - 1);
+			m_buildings[i] = m_world->CreateBody(&bd);
+
+			for (int32 j = 0; j < e_rowCount; ++j)
+			{
+				float32 offset = 0.25f * (j & 1);
+				for (int32 k = 0; k < e_columnCount; ++k)
+				{
+					b2Vec2 center(-2.0f + 0.5f * k + offset, 0.25f + 0.5f * j);
+					sd.SetAsBox(0.24f, 0.24f, center, 0.0f);
+					m_buildings[i]->CreateFixture(&sd);
+				}
+			}
+
+			m_buildings[i]->SetMassFromShapes();
+		}
+
+		m_debrisCount = 0;
+		m_stepTime = 0.0f;
+		m_stepSamples = 0;
+	}
+
+	// Knock a random brick out of each building. The brick becomes a body of its own.
+	void Break()
+	{
+		for (int32 i = 0; i < e_buildingCount; ++i)
+		{
+			b2Body* building = m_buildings[i];
+			int32 count = 0;
+			for (b2Fixture* f = building->GetFixtureList(); f; f = f->GetNext())
+			{
+				++count;
+			}
+
+			if (count < 2 || m_debrisCount == e_maxDebris)
+			{
+				continue;
+			}
+
+			int32 index = rand() % count;
+			b2Fixture* fixture = building->GetFixtureList();
+			for (int32 j = 0; j < index; ++j)
+			{
+				fixture = fixture->GetNext();
+			}
+
+			b2PolygonShape* brick = (b2PolygonShape*)fixture->GetShape();
+			b2PolygonDef sd;
+			sd.vertexCount = brick->m_vertexCount;
+			for (int32 j = 0; j < brick->m_vertexCount; ++j)
+			{
+				sd.vertices[j] = brick->m_vertices[j];
+			}
+			sd.density = fixture->GetDensity();
+			sd.friction = fixture->GetFriction();
+
+			b2BodyDef bd;
+			bd.position = building->GetPosition();
+			bd.angle = building->GetAngle();
+			b2Body* debris = m_world->CreateBody(&bd);
+			debris->CreateFixture(&sd);
+			debris->SetMassFromShapes();
+			debris->SetLinearVelocity(building->GetLinearVelocityFromWorldPoint(debris->GetWorldCenter()));
+			debris->SetAngularVelocity(building->GetAngularVelocity());
+
+			building->DestroyFixture(fixture);
+			building->SetMassFromShapes();
+			building->WakeUp();
+			m_debris[m_debrisCount++] = debris;
+		}
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'c':
+			m_useCompound = !m_useCompound;
+			CreateBodies();
+			break;
+
+		case 'b':
+			Break();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		clock_t start = clock();
+		Test::Step(settings);
+		m_stepTime += 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		++m_stepSamples;
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (c) to switch between compound and regular bodies, (b) to break bricks off");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "%s: %d bricks, %d debris, %d proxies, %d pairs, %d contacts",
+			m_useCompound ? "compound" : "regular", e_buildingCount * e_columnCount * e_rowCount,
+			m_debrisCount, m_world->GetProxyCount(), m_world->GetPairCount(), m_world->GetContactCount());
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "average step = %.3f ms", (float) (m_stepTime / m_stepSamples));
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new CompoundBodies;
+	}
+
+	b2Body* m_ground;
+	b2Body* m_buildings[e_buildingCount];
+	b2Body* m_debris[e_maxDebris];
+	int32 m_debrisCount;
+	bool m_useCompound;
+	float32 m_stepTime;
+	int32 m_stepSamples;
+};
+
+#endif
@@ -0,0 +1,161 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <time.h>
+
+// A long heightfield terrain with float or 16 bit samples.
+class Heightfield : public Test
+{
+public:
+
+	enum
+	{
+		e_sampleCount = 20001,
+	};
+
+	Heightfield()
+	{
+		m_terrain = NULL;
+		m_quantized = false;
+		CreateTerrain();
+
+		for (int32 i = 0; i < 40; ++i)
+		{
+			b2BodyDef bd;
+			bd.position.Set(-40.0f + 2.0f * i, 20.0f + RandomFloat(0.0f, 5.0f));
+			b2Body* body = m_world->CreateBody(&bd);
+
+			if (i & 1)
+			{
+				b2CircleDef sd;
+				sd.radius = 0.5f;
+				sd.density = 1.0f;
+				sd.friction = 0.6f;
+				body->CreateFixture(&sd);
+			}
+			else
+			{
+				b2PolygonDef sd;
+				sd.SetAsBox(0.5f, 0.5f);
+				sd.density = 1.0f;
+				sd.friction = 0.6f;
+				body->CreateFixture(&sd);
+			}
+
+			body->SetMassFromShapes();
+		}
+	}
+
+	static float32 TerrainHeight(float32 x)
+	{
+		return 2.0f * sinf(0.2f * x) + 0.5f * sinf(1.3f * x);
+	}
+
+	void CreateTerrain()
+	{
+		if (m_terrain)
+		{
+			m_world->DestroyBody(m_terrain);
+			m_terrain = NULL;
+		}
+
+		// Heights are stored relative to the body, which sits below the lowest point.
+		float32 spacing = 0.5f;
+		float32 x0 = -100.0f;
+		float32 y0 = -5.0f;
+
+		float32* heights = new float32[e_sampleCount];
+		uint16* quantizedHeights = new uint16[e_sampleCount];
+		for (int32 i = 0; i < e_sampleCount; ++i)
+		{
+			heights[i] = TerrainHeight(x0 + spacing * i) - y0;
+			quantizedHeights[i] = (uint16)(1000.0f * heights[i] + 0.5f);
+		}
+
+		clock_t start = clock();
+
+		b2BodyDef bd;
+		bd.position.Set(x0, y0);
+		m_terrain = m_world->CreateBody(&bd);
+
+		b2HeightfieldDef hd;
+		if (m_quantized)
+		{
+			hd.quantizedHeights = quantizedHeights;
+			hd.heightScale = 0.001f;
+		}
+		else
+		{
+			hd.heights = heights;
+		}
+		hd.sampleCount = e_sampleCount;
+		hd.spacing = spacing;
+		hd.friction = 0.6f;
+		m_terrain->CreateFixture(&hd);
+
+		m_createTime = 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		m_stepTime = 0.0f;
+		m_stepSamples = 0;
+
+		delete [] heights;
+		delete [] quantizedHeights;
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'q':
+			m_quantized = !m_quantized;
+			CreateTerrain();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		clock_t start = clock();
+		Test::Step(settings);
+		m_stepTime += 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		++m_stepSamples;
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (q) to switch between float and 16 bit samples");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "%d samples, %d bytes per sample, created in %.2f ms",
+			e_sampleCount, m_quantized ? (int) sizeof(uint16) : (int) sizeof(float32), (float) m_createTime);
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "average step = %.3f ms", (float) (m_stepTime / m_stepSamples));
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new Heightfield;
+	}
+
+	b2Body* m_terrain;
+	bool m_quantized;
+	float32 m_createTime;
+	float32 m_stepTime;
+	int32 m_stepSamples;
+};
+
+#endif
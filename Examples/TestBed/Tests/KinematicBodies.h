@@ -0,0 +1,178 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef KINEMATIC_BODIES_H
+#define KINEMATIC_BODIES_H
+
+// A moving platform, an elevator and a spinning paddle. These are kinematic
+// bodies that move with the velocity set here and push the boxes as if they
+// had infinite mass. A stopped kinematic body falls asleep with the boxes on it.
+class KinematicBodies : public Test
+{
+public:
+
+	KinematicBodies()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(40.0f, 10.0f, b2Vec2(0.0f, -10.0f), 0.0f);
+			ground->CreateFixture(&sd);
+		}
+
+		b2BodyDef bd;
+		bd.isKinematic = true;
+
+		{
+			bd.position.Set(-10.0f, 8.0f);
+			m_platform = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(4.0f, 0.25f);
+			m_platform->CreateFixture(&sd);
+		}
+
+		{
+			bd.position.Set(-25.0f, 2.0f);
+			m_elevator = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(3.0f, 0.25f);
+			m_elevator->CreateFixture(&sd);
+		}
+
+		{
+			bd.position.Set(20.0f, 4.0f);
+			m_paddle = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(4.0f, 0.25f);
+			m_paddle->CreateFixture(&sd);
+		}
+
+		b2PolygonDef sd;
+		sd.SetAsBox(0.5f, 0.5f);
+		sd.density = 1.0f;
+		sd.friction = 0.8f;
+
+		for (int32 i = 0; i < 3; ++i)
+		{
+			b2BodyDef boxDef;
+			boxDef.position.Set(-11.5f + 1.5f * i, 8.75f);
+			b2Body* body = m_world->CreateBody(&boxDef);
+			body->CreateFixture(&sd);
+			body->SetMassFromShapes();
+		}
+
+		for (int32 i = 0; i < 4; ++i)
+		{
+			b2BodyDef boxDef;
+			boxDef.position.Set(-25.0f, 2.75f + 1.0f * i);
+			b2Body* body = m_world->CreateBody(&boxDef);
+			body->CreateFixture(&sd);
+			body->SetMassFromShapes();
+		}
+
+		for (int32 i = 0; i < 10; ++i)
+		{
+			b2BodyDef boxDef;
+			boxDef.position.Set(14.0f + 1.2f * (i % 5), 10.0f + 1.2f * (i / 5));
+			b2Body* body = m_world->CreateBody(&boxDef);
+			body->CreateFixture(&sd);
+			body->SetMassFromShapes();
+		}
+
+		m_moving = true;
+		Move();
+	}
+
+	// The velocities are set every step, so the platform and the elevator turn
+	// around at the ends of their paths.
+	void Move()
+	{
+		if (m_moving == false)
+		{
+			m_platform->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
+			m_elevator->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
+			m_paddle->SetAngularVelocity(0.0f);
+			return;
+		}
+
+		b2Vec2 v = m_platform->GetLinearVelocity();
+		float32 x = m_platform->GetPosition().x;
+		if (x < -10.0f || v.x == 0.0f)
+		{
+			v.x = 3.0f;
+		}
+		else if (x > 5.0f)
+		{
+			v.x = -3.0f;
+		}
+		m_platform->SetLinearVelocity(v);
+
+		v = m_elevator->GetLinearVelocity();
+		float32 y = m_elevator->GetPosition().y;
+		if (y < 2.0f || v.y == 0.0f)
+		{
+			v.y = 2.0f;
+		}
+		else if (y > 12.0f)
+		{
+			v.y = -2.0f;
+		}
+		m_elevator->SetLinearVelocity(v);
+
+		m_paddle->SetAngularVelocity(1.0f);
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 's':
+			m_moving = !m_moving;
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		Move();
+
+		Test::Step(settings);
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (s) to stop or start the kinematic bodies");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "awake bodies = %d of %d", m_world->GetAwakeBodyCount(), m_world->GetBodyCount() - 1);
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new KinematicBodies;
+	}
+
+	b2Body* m_platform;
+	b2Body* m_elevator;
+	b2Body* m_paddle;
+	bool m_moving;
+};
+
+#endif
@@ -52,7 +52,7 @@ public:
 		B2_NOT_USED(settings);
 
 		b2Manifold manifold;
-		b2CollidePolygons(&manifold, &m_polygonA, m_transformA, &m_polygonB, m_transformB);
+		b2CollidePolygons(&manifold, &m_polygonA, m_transformA, &m_polygonB, m_transformB, 0.0f);
 
 		b2WorldManifold worldManifold;
 		worldManifold.Initialize(&manifold, m_transformA, m_polygonA.m_radius, m_transformB, m_polygonB.m_radius);
@@ -0,0 +1,269 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+// The world state is saved before every step, like rollback netcode does.
+// Rewinding restores the state of one second ago. The replay check restores
+// the state before each step and takes the step again, the bodies must end
+// up exactly where the first step put them. The history is dropped when
+// bodies or joints are created or destroyed, such as by the mouse or a bomb.
+class Rollback : public Test
+{
+public:
+
+	enum
+	{
+		e_historySize = 60,
+		e_maxBodies = 128,
+	};
+
+	struct State
+	{
+		int8* data;
+		int32 capacity;
+		b2Body* bodyList;
+		b2Joint* jointList;
+		int32 bodyCount;
+		int32 jointCount;
+	};
+
+	Rollback()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(50.0f, 10.0f, b2Vec2(0.0f, -10.0f), 0.0f);
+			ground->CreateFixture(&sd);
+
+			b2Vec2 vertices[9];
+			for (int32 i = 0; i < 9; ++i)
+			{
+				float32 x = 15.0f + 2.0f * i;
+				vertices[i].Set(x, 0.1f * (i - 4) * (i - 4));
+			}
+
+			b2ChainDef cd;
+			cd.vertices = vertices;
+			cd.vertexCount = 9;
+			cd.friction = 0.6f;
+			ground->CreateFixture(&cd);
+		}
+
+		m_bodyCount = 0;
+
+		{
+			b2PolygonDef sd;
+			sd.SetAsBox(0.5f, 0.5f);
+			sd.density = 5.0f;
+			sd.friction = 0.6f;
+
+			for (int32 i = 0; i < 10; ++i)
+			{
+				for (int32 j = i; j < 10; ++j)
+				{
+					b2BodyDef bd;
+					bd.position.Set(-15.0f + 0.5625f * i + 1.125f * (j - i), 0.5f + 1.0f * i);
+					b2Body* body = m_world->CreateBody(&bd);
+					body->CreateFixture(&sd);
+					body->SetMassFromShapes();
+					m_bodies[m_bodyCount++] = body;
+				}
+			}
+		}
+
+		{
+			b2CircleDef cd;
+			cd.radius = 0.5f;
+			cd.density = 1.0f;
+			cd.friction = 0.3f;
+
+			for (int32 i = 0; i < 10; ++i)
+			{
+				b2BodyDef bd;
+				bd.position.Set(18.0f + 1.2f * i, 10.0f + 1.5f * i);
+				b2Body* body = m_world->CreateBody(&bd);
+				body->CreateFixture(&cd);
+				body->SetMassFromShapes();
+				m_bodies[m_bodyCount++] = body;
+			}
+		}
+
+		for (int32 i = 0; i < e_historySize; ++i)
+		{
+			m_states[i].data = NULL;
+			m_states[i].capacity = 0;
+		}
+
+		m_historyStart = 0;
+		m_historyCount = 0;
+		m_check = false;
+		m_checkCount = 0;
+		m_mismatchCount = 0;
+	}
+
+	~Rollback()
+	{
+		for (int32 i = 0; i < e_historySize; ++i)
+		{
+			delete [] m_states[i].data;
+		}
+	}
+
+	// Is the world made of the same objects as when the state was saved?
+	bool Matches(const State* state) const
+	{
+		return state->bodyList == m_world->GetBodyList() && state->bodyCount == m_world->GetBodyCount() &&
+			state->jointList == m_world->GetJointList() && state->jointCount == m_world->GetJointCount();
+	}
+
+	void Save(State* state)
+	{
+		int32 size = m_world->GetStateSize();
+		if (size > state->capacity)
+		{
+			delete [] state->data;
+			state->capacity = size + size / 2;
+			state->data = new int8[state->capacity];
+		}
+
+		m_world->SaveState(state->data);
+		state->bodyList = m_world->GetBodyList();
+		state->jointList = m_world->GetJointList();
+		state->bodyCount = m_world->GetBodyCount();
+		state->jointCount = m_world->GetJointCount();
+	}
+
+	void Rewind()
+	{
+		if (m_historyCount == 0)
+		{
+			return;
+		}
+
+		State* state = m_states + m_historyStart;
+		if (Matches(state))
+		{
+			m_world->RestoreState(state->data);
+		}
+
+		m_historyCount = 0;
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'z':
+			Rewind();
+			break;
+
+		case 'c':
+			m_check = !m_check;
+			m_checkCount = 0;
+			m_mismatchCount = 0;
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		if (m_historyCount > 0 && Matches(m_states + m_historyStart) == false)
+		{
+			m_historyCount = 0;
+		}
+
+		// Save the state before the step, dropping the oldest one when the history is full.
+		int32 index = (m_historyStart + m_historyCount) % e_historySize;
+		if (m_historyCount == e_historySize)
+		{
+			m_historyStart = (m_historyStart + 1) % e_historySize;
+		}
+		else
+		{
+			++m_historyCount;
+		}
+
+		State* state = m_states + index;
+		Save(state);
+
+		bool pause = settings->pause != 0;
+
+		Test::Step(settings);
+
+		if (m_check && pause == false && Matches(state))
+		{
+			b2XForm xfs[e_maxBodies];
+			for (int32 i = 0; i < m_bodyCount; ++i)
+			{
+				xfs[i] = m_bodies[i]->GetXForm();
+			}
+
+			// Take the step again from the saved state.
+			m_world->RestoreState(state->data);
+			m_pointCount = 0;
+			float32 timeStep = settings->hz > 0.0f ? 1.0f / settings->hz : float32(0.0f);
+			m_world->Step(timeStep, settings->velocityIterations, settings->positionIterations);
+
+			for (int32 i = 0; i < m_bodyCount; ++i)
+			{
+				b2XForm xf = m_bodies[i]->GetXForm();
+				if (xf.position.x != xfs[i].position.x || xf.position.y != xfs[i].position.y ||
+					xf.R.col1.x != xfs[i].R.col1.x || xf.R.col1.y != xfs[i].R.col1.y)
+				{
+					++m_mismatchCount;
+					break;
+				}
+			}
+
+			++m_checkCount;
+		}
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (z) to rewind up to one second, (c) to toggle the replay check");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "saved steps = %d, state size = %d bytes", m_historyCount, m_world->GetStateSize());
+		m_textLine += 15;
+
+		if (m_check)
+		{
+			m_debugDraw.DrawString(5, m_textLine, "replayed steps = %d, mismatches = %d", m_checkCount, m_mismatchCount);
+			m_textLine += 15;
+		}
+	}
+
+	static Test* Create()
+	{
+		return new Rollback;
+	}
+
+	b2Body* m_bodies[e_maxBodies];
+	int32 m_bodyCount;
+
+	State m_states[e_historySize];
+	int32 m_historyStart;
+	int32 m_historyCount;
+
+	bool m_check;
+	int32 m_checkCount;
+	int32 m_mismatchCount;
+};
+
+#endif
@@ -0,0 +1,193 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SLEEPING_PILE_H
+#define SLEEPING_PILE_H
+
+#include <stdio.h>
+
+// A wide pile of boxes that falls asleep as one island. A bullet fired into
+// one end only wakes the boxes it disturbs, the far end of the pile keeps
+// sleeping. The awake body count is sampled over time after each shot.
+class SleepingPile : public Test
+{
+public:
+
+	enum
+	{
+		e_columnCount = 40,
+		e_rowCount = 6,
+		e_sampleCount = 12,
+	};
+
+	SleepingPile()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(60.0f, 10.0f, b2Vec2(0.0f, -10.0f), 0.0f);
+			ground->CreateFixture(&sd);
+		}
+
+		{
+			b2PolygonDef sd;
+			sd.SetAsBox(0.5f, 0.5f);
+			sd.density = 1.0f;
+			sd.friction = 0.6f;
+
+			for (int32 i = 0; i < e_rowCount; ++i)
+			{
+				for (int32 j = 0; j < e_columnCount; ++j)
+				{
+					b2BodyDef bd;
+					bd.position.Set(-20.0f + 1.0f * j + 0.5f * (i & 1), 0.5f + 1.0f * i);
+					b2Body* body = m_world->CreateBody(&bd);
+					body->CreateFixture(&sd);
+					body->SetMassFromShapes();
+				}
+			}
+		}
+
+		m_bullet = NULL;
+		m_fired = false;
+		m_peakCount = 0;
+		m_awakeSteps = 0;
+		m_shotStep = 0;
+		m_settleStep = -1;
+		m_sampleCount = 0;
+	}
+
+	void Fire()
+	{
+		if (m_bullet)
+		{
+			m_world->DestroyBody(m_bullet);
+		}
+
+		b2BodyDef bd;
+		bd.position.Set(-40.0f, 1.5f);
+		bd.isBullet = true;
+		m_bullet = m_world->CreateBody(&bd);
+
+		b2CircleDef sd;
+		sd.radius = 0.25f;
+		sd.density = 20.0f;
+		m_bullet->CreateFixture(&sd);
+		m_bullet->SetMassFromShapes();
+		m_bullet->SetLinearVelocity(b2Vec2(200.0f, 0.0f));
+
+		m_fired = true;
+		m_peakCount = 0;
+		m_awakeSteps = 0;
+		m_shotStep = m_stepCount;
+		m_settleStep = -1;
+		m_sampleCount = 0;
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'f':
+			Fire();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		int32 stepCount = m_stepCount;
+		Test::Step(settings);
+
+		// The bullet is not part of the pile.
+		int32 awakeCount = m_world->GetAwakeBodyCount();
+		if (m_bullet && m_bullet->IsSleeping() == false)
+		{
+			--awakeCount;
+		}
+
+		// Sample twice a second after a shot until the pile settles.
+		if (m_fired && m_stepCount != stepCount && m_settleStep == -1)
+		{
+			m_peakCount = b2Max(m_peakCount, awakeCount);
+			m_awakeSteps += awakeCount;
+
+			int32 steps = m_stepCount - m_shotStep;
+			int32 interval = settings->hz > 0.0f ? b2Max(1, int32(0.5f * settings->hz)) : 30;
+			if (steps % interval == 0 && m_sampleCount < e_sampleCount)
+			{
+				m_samples[m_sampleCount++] = awakeCount;
+			}
+
+			if (awakeCount == 0 && m_peakCount > 0)
+			{
+				m_settleStep = m_stepCount;
+			}
+		}
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (f) to fire a bullet into the pile");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "awake bodies = %d of %d, awake islands = %d",
+			awakeCount, e_rowCount * e_columnCount, m_world->GetAwakeIslandCount());
+		m_textLine += 15;
+
+		if (m_fired == false)
+		{
+			return;
+		}
+
+		m_debugDraw.DrawString(5, m_textLine, "since the shot: peak awake = %d, awake body steps = %d",
+			m_peakCount, m_awakeSteps);
+		m_textLine += 15;
+
+		if (m_settleStep != -1)
+		{
+			m_debugDraw.DrawString(5, m_textLine, "asleep again after %d steps", m_settleStep - m_shotStep);
+			m_textLine += 15;
+		}
+
+		char buffer[e_sampleCount * 6 + 1];
+		int32 length = 0;
+		for (int32 i = 0; i < m_sampleCount; ++i)
+		{
+			length += sprintf(buffer + length, " %d", m_samples[i]);
+		}
+		buffer[length] = 0;
+
+		m_debugDraw.DrawString(5, m_textLine, "awake every 0.5 s:%s", buffer);
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new SleepingPile;
+	}
+
+	b2Body* m_bullet;
+	bool m_fired;
+	int32 m_peakCount;
+	int32 m_awakeSteps;
+	int32 m_shotStep;
+	int32 m_settleStep;
+	int32 m_samples[e_sampleCount];
+	int32 m_sampleCount;
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SPECULATIVE_CONTACTS_H
+#define SPECULATIVE_CONTACTS_H
+
+#include <time.h>
+
+// Fast bodies fired at a thin plank. Without speculative contacts the plank is
+// dynamic, so the bodies only get TOI against the static wall and many of them
+// pass through the plank. With speculative contacts the solver sees the plank
+// one step ahead and stops them.
+class SpeculativeContacts : public Test
+{
+public:
+
+	enum
+	{
+		e_bodyCount = 100,
+	};
+
+	SpeculativeContacts()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(50.0f, 10.0f, b2Vec2(0.0f, -10.0f), 0.0f);
+			ground->CreateFixture(&sd);
+
+			sd.SetAsBox(0.1f, 20.0f, b2Vec2(25.0f, 20.0f), 0.0f);
+			ground->CreateFixture(&sd);
+		}
+
+		{
+			b2BodyDef bd;
+			bd.position.Set(10.0f, 10.0f);
+			m_plank = m_world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(0.1f, 10.0f);
+			sd.density = 10.0f;
+			m_plank->CreateFixture(&sd);
+			m_plank->SetMassFromShapes();
+		}
+
+		for (int32 i = 0; i < e_bodyCount; ++i)
+		{
+			m_bodies[i] = NULL;
+		}
+
+		m_speculative = true;
+		Fire();
+	}
+
+	void Fire()
+	{
+		for (int32 i = 0; i < e_bodyCount; ++i)
+		{
+			if (m_bodies[i])
+			{
+				m_world->DestroyBody(m_bodies[i]);
+			}
+
+			b2BodyDef bd;
+			bd.position.Set(-40.0f + 2.0f * (i % 10), 1.0f + 1.5f * (i / 10));
+			m_bodies[i] = m_world->CreateBody(&bd);
+
+			if (i & 1)
+			{
+				b2CircleDef sd;
+				sd.radius = 0.25f;
+				sd.density = 1.0f;
+				m_bodies[i]->CreateFixture(&sd);
+			}
+			else
+			{
+				b2PolygonDef sd;
+				sd.SetAsBox(0.25f, 0.25f);
+				sd.density = 1.0f;
+				m_bodies[i]->CreateFixture(&sd);
+			}
+
+			m_bodies[i]->SetMassFromShapes();
+			m_bodies[i]->SetLinearVelocity(b2Vec2(RandomFloat(80.0f, 110.0f), 0.0f));
+		}
+
+		m_plank->SetXForm(b2Vec2(10.0f, 10.0f), 0.0f);
+		m_plank->SetLinearVelocity(b2Vec2(0.0f, 0.0f));
+		m_plank->SetAngularVelocity(0.0f);
+		m_plank->WakeUp();
+
+		m_stepTime = 0.0f;
+		m_stepSamples = 0;
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 's':
+			m_speculative = !m_speculative;
+			Fire();
+			break;
+
+		case 'f':
+			Fire();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		m_world->SetSpeculativeContacts(m_speculative);
+
+		clock_t start = clock();
+		Test::Step(settings);
+		m_stepTime += 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		++m_stepSamples;
+
+		// Count the bodies that got past the plank.
+		float32 plankX = m_plank->GetPosition().x;
+		int32 passed = 0;
+		for (int32 i = 0; i < e_bodyCount; ++i)
+		{
+			if (m_bodies[i]->GetPosition().x > plankX)
+			{
+				++passed;
+			}
+		}
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (s) to toggle speculative contacts, (f) to fire again");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "speculative contacts %s: %d of %d bodies passed the plank",
+			m_speculative ? "on" : "off", passed, e_bodyCount);
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "average step = %.3f ms", (float) (m_stepTime / m_stepSamples));
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new SpeculativeContacts;
+	}
+
+	b2Body* m_plank;
+	b2Body* m_bodies[e_bodyCount];
+	bool m_speculative;
+	float32 m_stepTime;
+	int32 m_stepSamples;
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef STATIC_MESH_H
+#define STATIC_MESH_H
+
+#include "TriangleMesh.h"
+
+#include <time.h>
+
+// Meshes a terrain outline with TriangleMesh and loads it as one static mesh
+// fixture, or as one polygon fixture per triangle for comparison. A few free
+// segments are added to the mesh as platforms.
+class StaticMesh : public Test
+{
+public:
+
+	enum
+	{
+		e_outlineCount = 122,
+		e_maxVertexCount = 2000,
+	};
+
+	StaticMesh()
+	{
+		m_terrain = NULL;
+		m_useMesh = true;
+		CreateTerrain();
+
+		for (int32 i = 0; i < 40; ++i)
+		{
+			b2BodyDef bd;
+			bd.position.Set(-30.0f + 1.5f * i, 25.0f + RandomFloat(0.0f, 5.0f));
+			b2Body* body = m_world->CreateBody(&bd);
+
+			if (i & 1)
+			{
+				b2CircleDef sd;
+				sd.radius = 0.5f;
+				sd.density = 1.0f;
+				sd.friction = 0.6f;
+				body->CreateFixture(&sd);
+			}
+			else
+			{
+				b2PolygonDef sd;
+				sd.SetAsBox(0.5f, 0.5f);
+				sd.density = 1.0f;
+				sd.friction = 0.6f;
+				body->CreateFixture(&sd);
+			}
+
+			body->SetMassFromShapes();
+		}
+	}
+
+	void CreateTerrain()
+	{
+		if (m_terrain)
+		{
+			m_world->DestroyBody(m_terrain);
+			m_terrain = NULL;
+		}
+
+		// A wavy terrain outline, closed along the bottom.
+		tmVertex outline[e_outlineCount];
+		int32 topCount = e_outlineCount - 2;
+		for (int32 i = 0; i < topCount; ++i)
+		{
+			float32 x = -40.0f + 80.0f * i / (topCount - 1);
+			outline[i].x = x;
+			outline[i].y = 2.0f * sinf(0.25f * x) + 0.5f * sinf(1.1f * x) + 5.0f;
+		}
+		outline[topCount].x = 40.0f;
+		outline[topCount].y = 0.0f;
+		outline[topCount + 1].x = -40.0f;
+		outline[topCount + 1].y = 0.0f;
+
+		TriangleMesh md(e_maxVertexCount, tmO_SEGMENTBOUNDARY | tmO_GRADING);
+		md.Mesh(outline, e_outlineCount);
+
+		int32 vertexCount = md.GetVertexCount();
+		tmVertex* meshVertices = md.GetVertices();
+		b2Vec2* vertices = new b2Vec2[vertexCount + 4];
+		for (int32 i = 0; i < vertexCount; ++i)
+		{
+			vertices[i].Set(meshVertices[i].x, meshVertices[i].y);
+		}
+
+		int32* triangles = new int32[3 * md.GetInsideTriangleCount()];
+		int32 triangleCount = md.GetInsideTriangleIndices(triangles);
+		md.FreeMemory();
+
+		// Two platforms as a segment soup.
+		vertices[vertexCount + 0].Set(-20.0f, 14.0f);
+		vertices[vertexCount + 1].Set(-5.0f, 12.0f);
+		vertices[vertexCount + 2].Set(5.0f, 12.0f);
+		vertices[vertexCount + 3].Set(20.0f, 14.0f);
+		int32 segments[4] = {vertexCount + 0, vertexCount + 1, vertexCount + 2, vertexCount + 3};
+
+		clock_t start = clock();
+
+		b2BodyDef bd;
+		m_terrain = m_world->CreateBody(&bd);
+
+		if (m_useMesh)
+		{
+			b2MeshDef meshDef;
+			meshDef.vertices = vertices;
+			meshDef.vertexCount = vertexCount + 4;
+			meshDef.triangles = triangles;
+			meshDef.triangleCount = triangleCount;
+			meshDef.segments = segments;
+			meshDef.segmentCount = 2;
+			meshDef.friction = 0.6f;
+			m_terrain->CreateFixture(&meshDef);
+		}
+		else
+		{
+			b2PolygonDef pd;
+			pd.vertexCount = 3;
+			pd.friction = 0.6f;
+			for (int32 i = 0; i < triangleCount; ++i)
+			{
+				pd.vertices[0] = vertices[triangles[3 * i + 0]];
+				pd.vertices[1] = vertices[triangles[3 * i + 1]];
+				pd.vertices[2] = vertices[triangles[3 * i + 2]];
+				if (b2Cross(pd.vertices[1] - pd.vertices[0], pd.vertices[2] - pd.vertices[0]) < 0.0f)
+				{
+					b2Vec2 tmp = pd.vertices[1];
+					pd.vertices[1] = pd.vertices[2];
+					pd.vertices[2] = tmp;
+				}
+				m_terrain->CreateFixture(&pd);
+			}
+
+			b2EdgeDef ed;
+			ed.friction = 0.6f;
+			ed.vertex1 = vertices[segments[0]];
+			ed.vertex2 = vertices[segments[1]];
+			m_terrain->CreateFixture(&ed);
+			ed.vertex1 = vertices[segments[2]];
+			ed.vertex2 = vertices[segments[3]];
+			m_terrain->CreateFixture(&ed);
+		}
+
+		m_createTime = 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		m_triangleCount = triangleCount;
+		m_stepTime = 0.0f;
+		m_stepSamples = 0;
+
+		delete [] vertices;
+		delete [] triangles;
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'm':
+			m_useMesh = !m_useMesh;
+			CreateTerrain();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		clock_t start = clock();
+		Test::Step(settings);
+		m_stepTime += 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		++m_stepSamples;
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (m) to switch between a mesh shape and polygon fixtures");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "%s: %d triangles, created in %.2f ms",
+			m_useMesh ? "mesh shape" : "polygons", m_triangleCount, (float) m_createTime);
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "average step = %.3f ms", (float) (m_stepTime / m_stepSamples));
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new StaticMesh;
+	}
+
+	b2Body* m_terrain;
+	bool m_useMesh;
+	int32 m_triangleCount;
+	float32 m_createTime;
+	float32 m_stepTime;
+	int32 m_stepSamples;
+};
+
+#endif
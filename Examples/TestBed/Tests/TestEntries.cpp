@@ -27,15 +27,19 @@
 
 #include "ApplyForce.h"
 #include "BipedTest.h"
+#include "BodyPool.h"
 #include "BreakableBody.h"
 #include "Bridge.h"
 #include "BroadPhaseTest.h"
 #include "Buoyancy.h"
 #include "Car.h"
+#include "Capsules.h"
 #include "CCDTest.h"
 #include "Chain.h"
+#include "ChainShape.h"
 #include "CollisionFiltering.h"
 #include "CollisionProcessing.h"
+#include "CompoundBodies.h"
 #include "CompoundShapes.h"
 #include "DistanceTest.h"
 #include "Dominos.h"
@@ -43,6 +47,8 @@
 #include "DynamicTreeTest.h"
 #include "ElasticBody.h"
 #include "Gears.h"
+#include "Heightfield.h"
+#include "KinematicBodies.h"
 #include "LineJoint.h"
 #include "PolyCollision.h"
 #include "PolyShapes.h"
@@ -52,12 +58,18 @@
 #include "PyramidStaticEdges.h"
 #include "RaycastTest.h"
 #include "Revolute.h"
+#include "Rollback.h"
 #include "SensorTest.h"
 #include "ShapeEditing.h"
+#include "SleepingPile.h"
 #include "SliderCrank.h"
+#include "SpeculativeContacts.h"
 #include "SphereStack.h"
 #include "StaticEdges.h"
+#include "StaticMesh.h"
 #include "TheoJansen.h"
+#include "ThreadDeterminism.h"
+#include "TileMap.h"
 #include "TimeOfImpact.h"
 #include "VaryingFriction.h"
 #include "VaryingRestitution.h"
@@ -68,6 +80,18 @@
 
 TestEntry g_testEntries[] =
 {
+	{"Thread Determinism", ThreadDeterminism::Create},
+	{"Rollback", Rollback::Create},
+	{"Body Pool", BodyPool::Create},
+	{"Kinematic Bodies", KinematicBodies::Create},
+	{"Sleeping Pile", SleepingPile::Create},
+	{"Speculative Contacts", SpeculativeContacts::Create},
+	{"Tile Map", TileMap::Create},
+	{"Compound Bodies", CompoundBodies::Create},
+	{"Capsules", Capsules::Create},
+	{"Static Mesh", StaticMesh::Create},
+	{"Heightfield", Heightfield::Create},
+	{"Chain Shape", ChainShape::Create},
 	{"Sensor Test", SensorTest::Create},
 	{"CCD Test", CCDTest::Create},
 	{"SphereStack", SphereStack::Create},
@@ -0,0 +1,208 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef THREAD_DETERMINISM_H
+#define THREAD_DETERMINISM_H
+
+// A second world is built like the drawn one and stepped with the same thread
+// pool. The threads take the work in a different order every step, yet the
+// bodies of both worlds must stay exactly in the same place. The pyramid is a
+// large island that is solved by color, the stacks are solved as separate
+// islands and the bullets take the time of impact path. Turn on the threads
+// in the settings. The mouse and bombs are disabled, they would only disturb
+// the drawn world.
+class ThreadDeterminism : public Test
+{
+public:
+
+	enum
+	{
+		e_maxBodies = 320,
+		e_pyramidRows = 20,
+		e_stackCount = 20,
+		e_stackHeight = 4,
+		e_bulletCount = 10,
+	};
+
+	ThreadDeterminism()
+	{
+		m_bodyCount = Build(m_world, m_bodies);
+
+		// The same world parameters as in Test.
+		b2Vec2 gravity(0.0f, -10.0f);
+		bool doSleep = false;
+		m_shadow = new b2World(m_worldAABB, gravity, doSleep);
+		Build(m_shadow, m_shadowBodies);
+		m_shadowThreadCount = 1;
+
+		m_checkCount = 0;
+		m_mismatchStep = -1;
+	}
+
+	~ThreadDeterminism()
+	{
+		delete m_shadow;
+	}
+
+	static int32 Build(b2World* world, b2Body** bodies)
+	{
+		int32 count = 0;
+
+		{
+			b2BodyDef bd;
+			b2Body* ground = world->CreateBody(&bd);
+
+			b2PolygonDef sd;
+			sd.SetAsBox(100.0f, 10.0f, b2Vec2(0.0f, -10.0f), 0.0f);
+			ground->CreateFixture(&sd);
+		}
+
+		b2PolygonDef sd;
+		sd.SetAsBox(0.5f, 0.5f);
+		sd.density = 5.0f;
+		sd.friction = 0.6f;
+
+		for (int32 i = 0; i < e_pyramidRows; ++i)
+		{
+			for (int32 j = i; j < e_pyramidRows; ++j)
+			{
+				b2BodyDef bd;
+				bd.position.Set(-60.0f + 0.5625f * i + 1.125f * (j - i), 0.5f + 1.0f * i);
+				b2Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&sd);
+				body->SetMassFromShapes();
+				bodies[count++] = body;
+			}
+		}
+
+		for (int32 i = 0; i < e_stackCount; ++i)
+		{
+			for (int32 j = 0; j < e_stackHeight; ++j)
+			{
+				b2BodyDef bd;
+				bd.position.Set(-20.0f + 4.0f * i, 0.5f + 1.0f * j);
+				b2Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&sd);
+				body->SetMassFromShapes();
+				bodies[count++] = body;
+			}
+		}
+
+		b2CircleDef cd;
+		cd.radius = 0.25f;
+		cd.density = 20.0f;
+		cd.restitution = 0.1f;
+
+		for (int32 i = 0; i < e_bulletCount; ++i)
+		{
+			b2BodyDef bd;
+			bd.position.Set(-18.0f + 8.0f * i, 60.0f);
+			bd.isBullet = true;
+			b2Body* body = world->CreateBody(&bd);
+			body->CreateFixture(&cd);
+			body->SetMassFromShapes();
+			body->SetLinearVelocity(b2Vec2(0.0f, -150.0f));
+			bodies[count++] = body;
+		}
+
+		b2Assert(count <= e_maxBodies);
+		return count;
+	}
+
+	void MouseDown(const b2Vec2& p)
+	{
+		B2_NOT_USED(p);
+	}
+
+	void LaunchBomb(const b2Vec2& position, const b2Vec2& velocity)
+	{
+		B2_NOT_USED(position);
+		B2_NOT_USED(velocity);
+	}
+
+	void Step(Settings* settings)
+	{
+		int32 stepCount = m_stepCount;
+
+		Test::Step(settings);
+
+		// Test::Step rebuilds the thread pool when the thread count changes. The
+		// new pool may have the address of the old one, so compare the counts.
+		int32 threadCount = m_threadPool ? m_threadPool->GetThreadCount() : 1;
+		if (threadCount != m_shadowThreadCount)
+		{
+			m_shadow->SetTaskScheduler(m_threadPool);
+			m_shadowThreadCount = threadCount;
+		}
+
+		if (m_stepCount != stepCount)
+		{
+			m_shadow->SetWarmStarting(settings->enableWarmStarting > 0);
+			m_shadow->SetWideContactSolver(settings->enableWideSolver > 0);
+			m_shadow->SetSubStepCount(settings->subSteps);
+			m_shadow->SetVelocityTolerance(settings->velocityTolerance, b2_minVelocityIterations);
+			m_shadow->SetContinuousPhysics(settings->enableContinuous > 0);
+
+			float32 timeStep = settings->hz > 0.0f ? 1.0f / settings->hz : float32(0.0f);
+			m_shadow->Step(timeStep, settings->velocityIterations, settings->positionIterations);
+
+			for (int32 i = 0; i < m_bodyCount && m_mismatchStep == -1; ++i)
+			{
+				b2XForm xf1 = m_bodies[i]->GetXForm();
+				b2XForm xf2 = m_shadowBodies[i]->GetXForm();
+				if (xf1.position.x != xf2.position.x || xf1.position.y != xf2.position.y ||
+					xf1.R.col1.x != xf2.R.col1.x || xf1.R.col1.y != xf2.R.col1.y)
+				{
+					m_mismatchStep = m_stepCount;
+				}
+			}
+
+			++m_checkCount;
+		}
+
+		m_debugDraw.DrawString(5, m_textLine, "threads = %d, checked steps = %d", threadCount, m_checkCount);
+		m_textLine += 15;
+
+		if (m_mismatchStep == -1)
+		{
+			m_debugDraw.DrawString(5, m_textLine, "the worlds match");
+		}
+		else
+		{
+			m_debugDraw.DrawString(5, m_textLine, "the worlds differ since step %d", m_mismatchStep);
+		}
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new ThreadDeterminism;
+	}
+
+	b2World* m_shadow;
+	int32 m_shadowThreadCount;
+
+	b2Body* m_bodies[e_maxBodies];
+	b2Body* m_shadowBodies[e_maxBodies];
+	int32 m_bodyCount;
+
+	int32 m_checkCount;
+	int32 m_mismatchStep;
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef TILE_MAP_H
+#define TILE_MAP_H
+
+#include <time.h>
+
+// Shapes on a tile map. The grid shape collides only the cells under each shape
+// and merges the faces of neighboring cells, so shapes slide without snagging.
+// Switch to one box per surface cell to compare the proxy count and the cost of
+// digging, which the grid does in place.
+class TileMap : public Test
+{
+public:
+
+	enum
+	{
+		e_columnCount = 80,
+		e_rowCount = 30,
+		e_bodyCount = 40,
+	};
+
+	TileMap()
+	{
+		for (int32 i = 0; i < e_columnCount; ++i)
+		{
+			int32 height = 3 + int32(2.0f + 2.0f * sinf(0.3f * i));
+			if (i == 0 || i == e_columnCount - 1)
+			{
+				height = 20;
+			}
+
+			for (int32 j = 0; j < e_rowCount; ++j)
+			{
+				m_cells[j][i] = j < height ? 1 : 0;
+			}
+		}
+
+		// Floating platforms.
+		for (int32 i = 10; i < 26; ++i)
+		{
+			m_cells[14][i] = 1;
+		}
+
+		for (int32 i = 50; i < 66; ++i)
+		{
+			m_cells[10][i] = 1;
+			m_cells[11][i] = 1;
+		}
+
+		m_ground = NULL;
+		m_useGrid = true;
+		CreateGround();
+
+		for (int32 i = 0; i < e_bodyCount; ++i)
+		{
+			b2BodyDef bd;
+			bd.position.Set(RandomFloat(-35.0f, 35.0f), RandomFloat(20.0f, 40.0f));
+			b2Body* body = m_world->CreateBody(&bd);
+
+			if (i & 1)
+			{
+				b2CircleDef sd;
+				sd.radius = 0.5f;
+				sd.density = 1.0f;
+				sd.friction = 0.3f;
+				body->CreateFixture(&sd);
+			}
+			else
+			{
+				b2PolygonDef sd;
+				sd.SetAsBox(0.5f, 0.5f);
+				sd.density = 1.0f;
+				sd.friction = 0.3f;
+				body->CreateFixture(&sd);
+			}
+
+			body->SetMassFromShapes();
+		}
+	}
+
+	bool IsSolid(int32 column, int32 row) const
+	{
+		if (column < 0 || e_columnCount <= column || row < 0 || e_rowCount <= row)
+		{
+			return false;
+		}
+
+		return m_cells[row][column] != 0;
+	}
+
+	void CreateGround()
+	{
+		clock_t start = clock();
+
+		if (m_ground)
+		{
+			m_world->DestroyBody(m_ground);
+		}
+
+		b2BodyDef bd;
+		bd.position.Set(-0.5f * e_columnCount, 0.0f);
+		m_ground = m_world->CreateBody(&bd);
+
+		if (m_useGrid)
+		{
+			b2GridDef gd;
+			gd.cells = &m_cells[0][0];
+			gd.columnCount = e_columnCount;
+			gd.rowCount = e_rowCount;
+			gd.cellSize = 1.0f;
+			gd.friction = 0.3f;
+			m_grid = (b2GridShape*)m_ground->CreateFixture(&gd)->GetShape();
+		}
+		else
+		{
+			// Cells that are surrounded by solid cells can't be touched.
+			for (int32 j = 0; j < e_rowCount; ++j)
+			{
+				for (int32 i = 0; i < e_columnCount; ++i)
+				{
+					if (IsSolid(i, j) == false ||
+						(IsSolid(i - 1, j) && IsSolid(i + 1, j) && IsSolid(i, j - 1) && IsSolid(i, j + 1)))
+					{
+						continue;
+					}
+
+					b2PolygonDef sd;
+					sd.SetAsBox(0.5f, 0.5f, b2Vec2(i + 0.5f, j + 0.5f), 0.0f);
+					sd.friction = 0.3f;
+					m_ground->CreateFixture(&sd);
+				}
+			}
+
+			m_grid = NULL;
+		}
+
+		m_editTime = 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		m_stepTime = 0.0f;
+		m_stepSamples = 0;
+	}
+
+	// Remove the top cell of a random column.
+	void Dig()
+	{
+		int32 column = 20 + rand() % 40;
+		int32 row = e_rowCount - 1;
+		while (row > 0 && m_cells[row][column] == 0)
+		{
+			--row;
+		}
+
+		if (row == 0)
+		{
+			return;
+		}
+
+		m_cells[row][column] = 0;
+
+		if (m_grid)
+		{
+			clock_t start = clock();
+			m_grid->SetCell(column, row, 0);
+			m_editTime = 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		}
+		else
+		{
+			CreateGround();
+		}
+
+		// Bodies sleeping on the cell won't notice it is gone.
+		for (b2Body* b = m_world->GetBodyList(); b; b = b->GetNext())
+		{
+			b->WakeUp();
+		}
+	}
+
+	void Keyboard(unsigned char key)
+	{
+		switch (key)
+		{
+		case 'g':
+			m_useGrid = !m_useGrid;
+			CreateGround();
+			break;
+
+		case 'd':
+			Dig();
+			break;
+		}
+	}
+
+	void Step(Settings* settings)
+	{
+		clock_t start = clock();
+		Test::Step(settings);
+		m_stepTime += 1000.0f * float32(clock() - start) / CLOCKS_PER_SEC;
+		++m_stepSamples;
+
+		m_debugDraw.DrawString(5, m_textLine, "Press (g) to switch between a grid and boxes, (d) to dig");
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "%s: %d proxies, %d contacts, last edit %.3f ms",
+			m_useGrid ? "grid" : "boxes", m_world->GetProxyCount(), m_world->GetContactCount(), (float) m_editTime);
+		m_textLine += 15;
+		m_debugDraw.DrawString(5, m_textLine, "average step = %.3f ms", (float) (m_stepTime / m_stepSamples));
+		m_textLine += 15;
+	}
+
+	static Test* Create()
+	{
+		return new TileMap;
+	}
+
+	uint8 m_cells[e_rowCount][e_columnCount];
+	b2Body* m_ground;
+	b2GridShape* m_grid;
+	bool m_useGrid;
+	float32 m_editTime;
+	float32 m_stepTime;
+	int32 m_stepSamples;
+};
+
+#endif
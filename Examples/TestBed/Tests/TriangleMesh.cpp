@@ -219,6 +219,25 @@ int32 TriangleMesh::PrintTriangles()
     return 0;
 }
 
+/*----------------------------------------------------------------------------*/
+// write three vertex indices (into GetVertices()) per inside triangle,
+// indices must hold 3*GetInsideTriangleCount() entries
+int32 TriangleMesh::GetInsideTriangleIndices(int32 *indices)
+{
+    int32 n = 0;
+    for ( int32 i=0; i<triangleCount; i++ )
+    {
+       if ( Triangles[i].inside )
+       {
+          indices[3*n+0] = (int32)(Triangles[i].v[0] - Vertices);
+          indices[3*n+1] = (int32)(Triangles[i].v[1] - Vertices);
+          indices[3*n+2] = (int32)(Triangles[i].v[2] - Vertices);
+          n++;
+       }
+    }
+    return n;
+}
+
 /*----------------------------------------------------------------------------*/
 void TriangleMesh::PrintData(FILE *f)
 {
@@ -132,6 +132,7 @@ class TriangleMesh
    void PrintData(FILE* f = stdout);
    void FreeMemory();
    int32 PrintTriangles();
+   int32 GetInsideTriangleIndices(int32 *indices);
 
   private:
 
@@ -36,6 +36,11 @@ For discussion please visit http://www.box2d.org/forum
 #include "../Source/Collision/Shapes/b2CircleShape.h"
 #include "../Source/Collision/Shapes/b2PolygonShape.h"
 #include "../Source/Collision/Shapes/b2EdgeShape.h"
+#include "../Source/Collision/Shapes/b2ChainShape.h"
+#include "../Source/Collision/Shapes/b2HeightfieldShape.h"
+#include "../Source/Collision/Shapes/b2MeshShape.h"
+#include "../Source/Collision/Shapes/b2CapsuleShape.h"
+#include "../Source/Collision/Shapes/b2GridShape.h"
 #include "../Source/Collision/b2BroadPhase.h"
 #include "../Source/Collision/b2Distance.h"
 #include "../Source/Collision/b2DynamicTree.h"
@@ -0,0 +1,221 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+#include "b2CapsuleShape.h"
+#include "b2CircleShape.h"
+#include "b2PolygonShape.h"
+
+b2CapsuleShape::b2CapsuleShape()
+{
+	m_type = b2_capsuleShape;
+	m_radius = 0.0f;
+	m_p1.SetZero();
+	m_p2.SetZero();
+}
+
+void b2CapsuleShape::Set(const b2Vec2& p1, const b2Vec2& p2, float32 radius)
+{
+	b2Assert(b2DistanceSquared(p1, p2) > b2_linearSlop * b2_linearSlop);
+	b2Assert(radius > 0.0f);
+
+	m_p1 = p1;
+	m_p2 = p2;
+	m_radius = radius;
+}
+
+bool b2CapsuleShape::TestPoint(const b2XForm& transform, const b2Vec2& p) const
+{
+	b2Vec2 pLocal = b2MulT(transform, p);
+	b2Vec2 d = m_p2 - m_p1;
+
+	// Find the closest point on the segment.
+	float32 t = b2Clamp(b2Dot(pLocal - m_p1, d) / b2Dot(d, d), 0.0f, 1.0f);
+	b2Vec2 closest = m_p1 + t * d;
+	return b2DistanceSquared(pLocal, closest) <= m_radius * m_radius;
+}
+
+// The ray either enters through the side that faces its origin or through
+// one of the end circles.
+b2SegmentCollide b2CapsuleShape::TestSegment(const b2XForm& transform,
+								float32* lambda,
+								b2Vec2* normal,
+								const b2Segment& segment,
+								float32 maxLambda) const
+{
+	b2Vec2 p1 = b2Mul(transform, m_p1);
+	b2Vec2 p2 = b2Mul(transform, m_p2);
+	b2Vec2 d = p2 - p1;
+	float32 length = d.Normalize();
+	float32 rr2 = m_radius * m_radius;
+
+	// Does the segment start inside the capsule?
+	b2Vec2 s = segment.p1 - p1;
+	float32 u = b2Clamp(b2Dot(s, d), 0.0f, length);
+	if (b2DistanceSquared(segment.p1, p1 + u * d) < rr2)
+	{
+		*lambda = 0;
+		return b2_startsInsideCollide;
+	}
+
+	b2Vec2 r = segment.p2 - segment.p1;
+	float32 rr = b2Dot(r, r);
+	if (rr < B2_FLT_EPSILON)
+	{
+		return b2_missCollide;
+	}
+
+	// Test the side that faces the segment start.
+	b2Vec2 n = b2Cross(d, 1.0f);
+	if (b2Dot(s, n) < 0.0f)
+	{
+		n = -n;
+	}
+
+	float32 denom = b2Dot(r, n);
+	if (denom < 0.0f)
+	{
+		float32 a = (m_radius - b2Dot(s, n)) / denom;
+		if (0.0f <= a && a <= maxLambda)
+		{
+			float32 along = b2Dot(s + a * r, d);
+			if (0.0f <= along && along <= length)
+			{
+				*lambda = a;
+				*normal = n;
+				return b2_hitCollide;
+			}
+		}
+	}
+
+	// Test the end circles, see b2CircleShape::TestSegment.
+	bool hit = false;
+	float32 bestLambda = maxLambda;
+	b2Vec2 bestNormal;
+	for (int32 i = 0; i < 2; ++i)
+	{
+		b2Vec2 sc = segment.p1 - (i == 0 ? p1 : p2);
+		float32 b = b2Dot(sc, sc) - rr2;
+		float32 c = b2Dot(sc, r);
+		float32 sigma = c * c - rr * b;
+		if (sigma < 0.0f)
+		{
+			continue;
+		}
+
+		float32 a = -(c + b2Sqrt(sigma));
+		if (0.0f <= a && a <= bestLambda * rr)
+		{
+			bestLambda = a / rr;
+			bestNormal = sc + bestLambda * r;
+			hit = true;
+		}
+	}
+
+	if (hit == false)
+	{
+		return b2_missCollide;
+	}
+
+	bestNormal.Normalize();
+	*lambda = bestLambda;
+	*normal = bestNormal;
+	return b2_hitCollide;
+}
+
+void b2CapsuleShape::ComputeAABB(b2AABB* aabb, const b2XForm& transform) const
+{
+	b2Vec2 p1 = b2Mul(transform, m_p1);
+	b2Vec2 p2 = b2Mul(transform, m_p2);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = b2Min(p1, p2) - r;
+	aabb->upperBound = b2Max(p1, p2) + r;
+}
+
+// The capsule is a rectangle plus two half circles. Each half circle has its
+// centroid 4r/(3pi) beyond the end of the rectangle.
+void b2CapsuleShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	float32 length = b2Distance(m_p1, m_p2);
+	float32 rr = m_radius * m_radius;
+
+	float32 boxMass = density * 2.0f * m_radius * length;
+	float32 circleMass = density * b2_pi * rr;
+
+	massData->mass = boxMass + circleMass;
+	massData->center = 0.5f * (m_p1 + m_p2);
+
+	// Inertia about the center. The half circles are moved to the centroid and then
+	// to the end of the rectangle: m * ((h + c)^2 - c^2) = m * (h^2 + 2 * h * c).
+	float32 h = 0.5f * length;
+	float32 lc = 4.0f * m_radius / (3.0f * b2_pi);
+	float32 boxI = boxMass * (4.0f * rr + length * length) / 12.0f;
+	float32 circleI = circleMass * (0.5f * rr + h * h + 2.0f * h * lc);
+
+	// Inertia about the local origin.
+	massData->I = boxI + circleI + massData->mass * b2Dot(massData->center, massData->center);
+}
+
+float32 b2CapsuleShape::ComputeSubmergedArea(	const b2Vec2& normal,
+												float32 offset,
+												const b2XForm& xf,
+												b2Vec2* c) const
+{
+	b2Vec2 d = m_p2 - m_p1;
+	d.Normalize();
+	b2Vec2 n = m_radius * b2Cross(d, 1.0f);
+
+	b2Vec2 vertices[4];
+	vertices[0] = m_p1 + n;
+	vertices[1] = m_p2 + n;
+	vertices[2] = m_p2 - n;
+	vertices[3] = m_p1 - n;
+
+	b2PolygonShape box;
+	box.Set(vertices, 4);
+
+	b2CircleShape circle1;
+	circle1.m_p = m_p1;
+	circle1.m_radius = m_radius;
+
+	b2CircleShape circle2;
+	circle2.m_p = m_p2;
+	circle2.m_radius = m_radius;
+
+	b2Vec2 boxCenter(0.0f, 0.0f);
+	b2Vec2 center1(0.0f, 0.0f);
+	b2Vec2 center2(0.0f, 0.0f);
+	float32 boxArea = box.ComputeSubmergedArea(normal, offset, xf, &boxCenter);
+	float32 area1 = 0.5f * circle1.ComputeSubmergedArea(normal, offset, xf, &center1);
+	float32 area2 = 0.5f * circle2.ComputeSubmergedArea(normal, offset, xf, &center2);
+
+	float32 area = boxArea + area1 + area2;
+	if (area < B2_FLT_EPSILON)
+	{
+		return 0.0f;
+	}
+
+	*c = (1.0f / area) * (boxArea * boxCenter + area1 * center1 + area2 * center2);
+	return area;
+}
+
+float32 b2CapsuleShape::ComputeSweepRadius(const b2Vec2& pivot) const
+{
+	float32 ds1 = b2DistanceSquared(m_p1, pivot);
+	float32 ds2 = b2DistanceSquared(m_p2, pivot);
+	return b2Sqrt(b2Max(ds1, ds2));
+}
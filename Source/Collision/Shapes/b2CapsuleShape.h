@@ -0,0 +1,97 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+#ifndef B2_CAPSULE_SHAPE_H
+#define B2_CAPSULE_SHAPE_H
+
+#include "b2Shape.h"
+
+/// A capsule is a line segment inflated by a radius, so it has rounded ends.
+/// Capsules are solid and have mass. Collision against circles, capsules,
+/// polygons, and edges is computed directly from the segment, which is cheaper
+/// and smoother than a polygon approximation of the rounded ends.
+/// Chains, heightfields, meshes, and grids collide it with each of their children.
+class b2CapsuleShape : public b2Shape
+{
+public:
+	b2CapsuleShape();
+
+	/// Initialize the capsule with the centers of the two end caps.
+	/// The centers must not be coincident.
+	void Set(const b2Vec2& p1, const b2Vec2& p2, float32 radius);
+
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2XForm& transform, const b2Vec2& p) const;
+
+	/// @see b2Shape::TestSegment
+	b2SegmentCollide TestSegment(	const b2XForm& transform,
+						float32* lambda,
+						b2Vec2* normal,
+						const b2Segment& segment,
+						float32 maxLambda) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2XForm& transform) const;
+
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// The rounded ends are approximated by half of each end circle, this is
+	/// exact when the capsule is completely wet or dry.
+	/// @see b2Shape::ComputeSubmergedArea
+	float32 ComputeSubmergedArea(	const b2Vec2& normal,
+									float32 offset,
+									const b2XForm& xf,
+									b2Vec2* c) const;
+
+	/// @see b2Shape::ComputeSweepRadius
+	float32 ComputeSweepRadius(const b2Vec2& pivot) const;
+
+	/// Get the supporting vertex index in the given direction.
+	int32 GetSupport(const b2Vec2& d) const;
+
+	/// Get the supporting vertex in the given direction.
+	const b2Vec2& GetSupportVertex(const b2Vec2& d) const;
+
+	/// Get the vertex count.
+	int32 GetVertexCount() const { return 2; }
+
+	/// Get a vertex by index. Used by b2Distance.
+	const b2Vec2& GetVertex(int32 index) const;
+
+	/// The centers of the end caps.
+	b2Vec2 m_p1;
+	b2Vec2 m_p2;
+};
+
+inline int32 b2CapsuleShape::GetSupport(const b2Vec2& d) const
+{
+	return b2Dot(m_p1, d) > b2Dot(m_p2, d) ? 0 : 1;
+}
+
+inline const b2Vec2& b2CapsuleShape::GetSupportVertex(const b2Vec2& d) const
+{
+	return b2Dot(m_p1, d) > b2Dot(m_p2, d) ? m_p1 : m_p2;
+}
+
+inline const b2Vec2& b2CapsuleShape::GetVertex(int32 index) const
+{
+	b2Assert(0 <= index && index < 2);
+	return (&m_p1)[index];
+}
+
+#endif
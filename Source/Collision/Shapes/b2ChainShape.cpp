@@ -0,0 +1,252 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2ChainShape.h"
+#include "b2EdgeShape.h"
+
+b2ChainShape::b2ChainShape()
+{
+	m_type = b2_chainShape;
+	m_radius = b2_polygonRadius;
+	m_vertices = NULL;
+	m_count = 0;
+	m_hasPrevVertex = false;
+	m_hasNextVertex = false;
+}
+
+b2ChainShape::~b2ChainShape()
+{
+	if (m_vertices)
+	{
+		b2Free(m_vertices);
+		m_vertices = NULL;
+	}
+}
+
+void b2ChainShape::Set(const b2Vec2* vertices, int32 count, bool isLoop)
+{
+	b2Assert(m_vertices == NULL);
+	b2Assert(count >= 2);
+	b2Assert(isLoop == false || count >= 3);
+
+	m_count = isLoop ? count + 1 : count;
+	m_vertices = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_vertices[i] = vertices[i];
+	}
+
+	if (isLoop)
+	{
+		m_vertices[count] = vertices[0];
+		m_prevVertex = m_vertices[m_count - 2];
+		m_nextVertex = m_vertices[1];
+		m_hasPrevVertex = true;
+		m_hasNextVertex = true;
+	}
+
+	// Build the segment tree.
+	int32 childCount = m_count - 1;
+	b2AABB* aabbs = (b2AABB*)b2Alloc(childCount * sizeof(b2AABB));
+	b2Vec2 r(m_radius, m_radius);
+	for (int32 i = 0; i < childCount; ++i)
+	{
+		b2Vec2 v1 = m_vertices[i];
+		b2Vec2 v2 = m_vertices[i + 1];
+		b2Assert(b2DistanceSquared(v1, v2) > b2_linearSlop * b2_linearSlop);
+		aabbs[i].lowerBound = b2Min(v1, v2) - r;
+		aabbs[i].upperBound = b2Max(v1, v2) + r;
+	}
+
+	m_tree.Build(aabbs, childCount);
+	b2Free(aabbs);
+}
+
+void b2ChainShape::SetPrevVertex(const b2Vec2& prevVertex)
+{
+	m_prevVertex = prevVertex;
+	m_hasPrevVertex = true;
+}
+
+void b2ChainShape::SetNextVertex(const b2Vec2& nextVertex)
+{
+	m_nextVertex = nextVertex;
+	m_hasNextVertex = true;
+}
+
+void b2ChainShape::GetChildEdge(b2EdgeShape* edge, int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+
+	edge->Set(m_vertices[index], m_vertices[index + 1]);
+	edge->m_radius = m_radius;
+
+	if (index > 0)
+	{
+		edge->m_vertex0 = m_vertices[index - 1];
+		edge->m_hasVertex0 = true;
+	}
+	else
+	{
+		edge->m_vertex0 = m_prevVertex;
+		edge->m_hasVertex0 = m_hasPrevVertex;
+	}
+
+	if (index < m_count - 2)
+	{
+		edge->m_vertex3 = m_vertices[index + 2];
+		edge->m_hasVertex3 = true;
+	}
+	else
+	{
+		edge->m_vertex3 = m_nextVertex;
+		edge->m_hasVertex3 = m_hasNextVertex;
+	}
+}
+
+bool b2ChainShape::TestPoint(const b2XForm& transform, const b2Vec2& p) const
+{
+	B2_NOT_USED(transform);
+	B2_NOT_USED(p);
+	return false;
+}
+
+// Ray cast the segments that the static tree reports. The ray is in the
+// local frame of the chain.
+struct b2ChainRayCastCallback
+{
+	void RayCastCallback(b2RayCastOutput* output, const b2RayCastInput& input, int32 index)
+	{
+		b2EdgeShape edge;
+		chain->GetChildEdge(&edge, index);
+
+		b2Segment segment;
+		segment.p1 = input.p1;
+		segment.p2 = input.p2;
+
+		float32 fraction;
+		b2Vec2 n;
+		if (edge.TestSegment(b2XForm_identity, &fraction, &n, segment, input.maxFraction) == b2_hitCollide)
+		{
+			output->hit = true;
+			output->fraction = fraction;
+			output->normal = n;
+
+			hit = true;
+			lambda = fraction;
+			normal = n;
+		}
+	}
+
+	const b2ChainShape* chain;
+	float32 lambda;
+	b2Vec2 normal;
+	bool hit;
+};
+
+b2SegmentCollide b2ChainShape::TestSegment(const b2XForm& transform,
+								float32* lambda,
+								b2Vec2* normal,
+								const b2Segment& segment,
+								float32 maxLambda) const
+{
+	b2RayCastInput input;
+	input.p1 = b2MulT(transform, segment.p1);
+	input.p2 = b2MulT(transform, segment.p2);
+	input.maxFraction = maxLambda;
+
+	if (b2DistanceSquared(input.p1, input.p2) == 0.0f)
+	{
+		return b2_missCollide;
+	}
+
+	b2ChainRayCastCallback callback;
+	callback.chain = this;
+	callback.hit = false;
+
+	m_tree.RayCast(&callback, input);
+
+	if (callback.hit == false)
+	{
+		return b2_missCollide;
+	}
+
+	*lambda = callback.lambda;
+	*normal = b2Mul(transform.R, callback.normal);
+	return b2_hitCollide;
+}
+
+void b2ChainShape::ComputeAABB(b2AABB* aabb, const b2XForm& transform) const
+{
+	const b2AABB& localAABB = m_tree.GetAABB();
+	b2Vec2 center = b2Mul(transform, localAABB.GetCenter());
+	b2Vec2 extents = b2Mul(b2Abs(transform.R), localAABB.GetExtents());
+	aabb->lowerBound = center - extents;
+	aabb->upperBound = center + extents;
+}
+
+void b2ChainShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
+
+float32 b2ChainShape::ComputeSubmergedArea(	const b2Vec2& normal,
+											float32 offset,
+											const b2XForm& xf,
+											b2Vec2* c) const
+{
+	float32 area = 0.0f;
+	b2Vec2 center(0.0f, 0.0f);
+
+	b2EdgeShape edge;
+	for (int32 i = 0; i < m_count - 1; ++i)
+	{
+		GetChildEdge(&edge, i);
+
+		b2Vec2 edgeCenter;
+		float32 edgeArea = edge.ComputeSubmergedArea(normal, offset, xf, &edgeCenter);
+		if (edgeArea != 0.0f)
+		{
+			area += edgeArea;
+			center += edgeArea * edgeCenter;
+		}
+	}
+
+	if (area != 0.0f)
+	{
+		center *= 1.0f / area;
+	}
+
+	*c = center;
+	return area;
+}
+
+float32 b2ChainShape::ComputeSweepRadius(const b2Vec2& pivot) const
+{
+	float32 maxDistanceSquared = 0.0f;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		maxDistanceSquared = b2Max(maxDistanceSquared, b2DistanceSquared(m_vertices[i], pivot));
+	}
+
+	return b2Sqrt(maxDistanceSquared);
+}
@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_CHAIN_SHAPE_H
+#define B2_CHAIN_SHAPE_H
+
+#include "b2Shape.h"
+#include "../b2StaticTree.h"
+
+class b2EdgeShape;
+
+/// A chain shape is a free form sequence of line segments that form
+/// a polyline or a loop. The whole chain uses a single broad-phase proxy
+/// and the segments are kept in a static tree, so only segments that
+/// overlap another shape are collided. Segments know their neighbors
+/// (ghost vertices), so shapes slide smoothly across internal vertices.
+/// Chains have no mass and are intended for static terrain.
+class b2ChainShape : public b2Shape
+{
+public:
+	b2ChainShape();
+	~b2ChainShape();
+
+	/// Copy the vertices and build the segment tree. Adjacent vertices
+	/// must not be coincident.
+	/// @param vertices the vertices of the chain.
+	/// @param count the vertex count, at least 2.
+	/// @param isLoop connect the last vertex to the first.
+	void Set(const b2Vec2* vertices, int32 count, bool isLoop);
+
+	/// Establish connectivity to a vertex that precedes the first vertex.
+	/// Don't call this for loops.
+	void SetPrevVertex(const b2Vec2& prevVertex);
+
+	/// Establish connectivity to a vertex that follows the last vertex.
+	/// Don't call this for loops.
+	void SetNextVertex(const b2Vec2& nextVertex);
+
+	/// Get the number of segments.
+	int32 GetChildCount() const;
+
+	/// Get a segment as an edge. The edge carries the ghost vertices of its neighbors.
+	void GetChildEdge(b2EdgeShape* edge, int32 index) const;
+
+	/// Query the segments that overlap an AABB in the local frame of the chain.
+	/// The callback receives the segment index.
+	template <typename T>
+	void QueryChildren(T* callback, const b2AABB& aabb) const;
+
+	/// Chains don't contain points.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2XForm& transform, const b2Vec2& p) const;
+
+	/// @see b2Shape::TestSegment
+	b2SegmentCollide TestSegment(	const b2XForm& transform,
+						float32* lambda,
+						b2Vec2* normal,
+						const b2Segment& segment,
+						float32 maxLambda) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2XForm& transform) const;
+
+	/// Chains have no mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// @warning This only gives a sensible answer for loops.
+	/// @see b2Shape::ComputeSubmergedArea
+	float32 ComputeSubmergedArea(	const b2Vec2& normal,
+									float32 offset,
+									const b2XForm& xf,
+									b2Vec2* c) const;
+
+	/// @see b2Shape::ComputeSweepRadius
+	float32 ComputeSweepRadius(const b2Vec2& pivot) const;
+
+	/// The vertices. Loops repeat the first vertex at the end.
+	b2Vec2* m_vertices;
+
+	/// The vertex count.
+	int32 m_count;
+
+	b2Vec2 m_prevVertex, m_nextVertex;
+	bool m_hasPrevVertex, m_hasNextVertex;
+
+	/// The segment tree.
+	b2StaticTree m_tree;
+};
+
+inline int32 b2ChainShape::GetChildCount() const
+{
+	return m_count - 1;
+}
+
+template <typename T>
+inline void b2ChainShape::QueryChildren(T* callback, const b2AABB& aabb) const
+{
+	m_tree.Query(callback, aabb);
+}
+
+#endif
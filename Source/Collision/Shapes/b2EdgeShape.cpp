@@ -24,6 +24,8 @@ b2EdgeShape::b2EdgeShape()
 	m_radius = b2_polygonRadius;
 	m_prevEdge = NULL;
 	m_nextEdge = NULL;
+	m_hasVertex0 = false;
+	m_hasVertex3 = false;
 }
 
 b2EdgeShape::~b2EdgeShape()
@@ -31,11 +33,13 @@ b2EdgeShape::~b2EdgeShape()
 	if (m_prevEdge)
 	{
 		m_prevEdge->m_nextEdge = NULL;
+		m_prevEdge->m_hasVertex3 = false;
 	}
 
 	if (m_nextEdge)
 	{
 		m_nextEdge->m_prevEdge = NULL;
+		m_nextEdge->m_hasVertex0 = false;
 	}
 }
 
@@ -123,6 +127,8 @@ void b2EdgeShape::SetPrevEdge(b2EdgeShape* edge, const b2Vec2& cornerDir, bool c
 	m_prevEdge = edge;
 	m_cornerDir1 = cornerDir;
 	m_cornerConvex1 = convex;
+	m_vertex0 = edge->m_v1;
+	m_hasVertex0 = true;
 }
 
 void b2EdgeShape::SetNextEdge(b2EdgeShape* edge, const b2Vec2& cornerDir, bool convex)
@@ -130,6 +136,8 @@ void b2EdgeShape::SetNextEdge(b2EdgeShape* edge, const b2Vec2& cornerDir, bool c
 	m_nextEdge = edge;
 	m_cornerDir2 = cornerDir;
 	m_cornerConvex2 = convex;
+	m_vertex3 = edge->m_v2;
+	m_hasVertex3 = true;
 }
 
 float32 b2EdgeShape::ComputeSubmergedArea(	const b2Vec2& normal,
@@ -121,6 +121,13 @@ public:
 	
 	b2EdgeShape* m_nextEdge;
 	b2EdgeShape* m_prevEdge;
+
+	// Optional adjacent (ghost) vertices. These are the far vertices of the
+	// neighboring edges and are used to prevent collisions with internal vertices.
+	b2Vec2 m_vertex0;
+	b2Vec2 m_vertex3;
+	bool m_hasVertex0;
+	bool m_hasVertex3;
 };
 
 inline float32 b2EdgeShape::GetLength() const
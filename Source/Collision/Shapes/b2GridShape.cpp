@@ -0,0 +1,407 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2GridShape.h"
+
+#include <string.h>
+
+// The unit steps of the face directions. The edge of a face runs along the
+// normal of the next direction, so the solid cell is on its left.
+static const int32 b2_gridSteps[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+b2GridShape::b2GridShape()
+{
+	m_type = b2_gridShape;
+	m_radius = b2_polygonRadius;
+	m_cells = NULL;
+	m_columnCount = 0;
+	m_rowCount = 0;
+	m_cellSize = 1.0f;
+}
+
+b2GridShape::~b2GridShape()
+{
+	if (m_cells)
+	{
+		b2Free(m_cells);
+		m_cells = NULL;
+	}
+}
+
+void b2GridShape::Set(const uint8* cells, int32 columnCount, int32 rowCount, float32 cellSize)
+{
+	b2Assert(m_cells == NULL);
+	b2Assert(columnCount > 0 && rowCount > 0);
+	b2Assert(cellSize > b2_linearSlop);
+
+	// Face keys hold the cell index and the direction.
+	b2Assert(columnCount * rowCount < (1 << 29));
+
+	m_columnCount = columnCount;
+	m_rowCount = rowCount;
+	m_cellSize = cellSize;
+
+	int32 count = columnCount * rowCount;
+	m_cells = (uint8*)b2Alloc(count * sizeof(uint8));
+	if (cells)
+	{
+		memcpy(m_cells, cells, count * sizeof(uint8));
+	}
+	else
+	{
+		memset(m_cells, 0, count * sizeof(uint8));
+	}
+}
+
+bool b2GridShape::GetCellRange(int32* lower, int32* upper, float32 x1, float32 x2, int32 count) const
+{
+	float32 size = m_cellSize * float32(count);
+	if (x2 < 0.0f || size < x1)
+	{
+		return false;
+	}
+
+	float32 inv = 1.0f / m_cellSize;
+	int32 i1 = int32(b2Max(x1, 0.0f) * inv);
+	int32 i2 = int32(b2Min(x2, size) * inv);
+
+	*lower = b2Min(i1, count - 1);
+	*upper = b2Min(i2, count - 1);
+	return true;
+}
+
+bool b2GridShape::GetLineRange(int32* lower, int32* upper, float32 x1, float32 x2, int32 count) const
+{
+	float32 size = m_cellSize * float32(count);
+	if (x2 < 0.0f || size < x1)
+	{
+		return false;
+	}
+
+	float32 inv = 1.0f / m_cellSize;
+	float32 f1 = b2Max(x1, 0.0f) * inv;
+	int32 i1 = int32(f1);
+	if (float32(i1) < f1)
+	{
+		++i1;
+	}
+
+	int32 i2 = int32(b2Min(x2, size) * inv);
+
+	*lower = i1;
+	*upper = b2Min(i2, count);
+	return *lower <= *upper;
+}
+
+void b2GridShape::GetFaceEdge(b2EdgeShape* edge, int32 column, int32 row, int32 direction, int32 count) const
+{
+	b2Assert(0 <= direction && direction < 4);
+	b2Assert(count > 0);
+
+	const int32* n = b2_gridSteps[direction];
+	const int32* t = b2_gridSteps[(direction + 1) & 3];
+
+	// The run extends along x for up and down faces and along y otherwise.
+	int32 runX = n[1] != 0 ? 1 : 0;
+	int32 runY = 1 - runX;
+	int32 lastColumn = column + (count - 1) * runX;
+	int32 lastRow = row + (count - 1) * runY;
+
+	// The cells at the start and the end of the edge.
+	bool forward = t[0] + t[1] > 0;
+	int32 column1 = forward ? column : lastColumn;
+	int32 row1 = forward ? row : lastRow;
+	int32 column2 = forward ? lastColumn : column;
+	int32 row2 = forward ? lastRow : row;
+
+	// The face corners, in half cells: cell center + normal -/+ tangent.
+	float32 h = 0.5f * m_cellSize;
+	b2Vec2 v1(h * float32(2 * column1 + 1 + n[0] - t[0]), h * float32(2 * row1 + 1 + n[1] - t[1]));
+	b2Vec2 v2(h * float32(2 * column2 + 1 + n[0] + t[0]), h * float32(2 * row2 + 1 + n[1] + t[1]));
+	edge->Set(v1, v2);
+	edge->m_radius = m_radius;
+
+	b2Vec2 dn(m_cellSize * float32(n[0]), m_cellSize * float32(n[1]));
+	b2Vec2 dt(m_cellSize * float32(t[0]), m_cellSize * float32(t[1]));
+
+	// The boundary either turns up a wall (concave), continues straight or
+	// turns around the corner of the cell (convex).
+	int32 column0 = column1 - t[0];
+	int32 row0 = row1 - t[1];
+	if (IsSolid(column0, row0) == false)
+	{
+		edge->m_vertex0 = v1 - dn;
+	}
+	else if (IsSolid(column0 + n[0], row0 + n[1]))
+	{
+		edge->m_vertex0 = v1 + dn;
+	}
+	else
+	{
+		edge->m_vertex0 = v1 - dt;
+	}
+
+	int32 column3 = column2 + t[0];
+	int32 row3 = row2 + t[1];
+	if (IsSolid(column3, row3) == false)
+	{
+		edge->m_vertex3 = v2 - dn;
+	}
+	else if (IsSolid(column3 + n[0], row3 + n[1]))
+	{
+		edge->m_vertex3 = v2 + dn;
+	}
+	else
+	{
+		edge->m_vertex3 = v2 + dt;
+	}
+
+	edge->m_hasVertex0 = true;
+	edge->m_hasVertex3 = true;
+}
+
+bool b2GridShape::TestPoint(const b2XForm& transform, const b2Vec2& p) const
+{
+	b2Vec2 pLocal = b2MulT(transform, p);
+
+	int32 column, row, upper;
+	if (GetCellRange(&column, &upper, pLocal.x, pLocal.x, m_columnCount) == false ||
+		GetCellRange(&row, &upper, pLocal.y, pLocal.y, m_rowCount) == false)
+	{
+		return false;
+	}
+
+	return IsSolid(column, row);
+}
+
+b2SegmentCollide b2GridShape::TestSegment(const b2XForm& transform,
+								float32* lambda,
+								b2Vec2* normal,
+								const b2Segment& segment,
+								float32 maxLambda) const
+{
+	b2Vec2 p1 = b2MulT(transform, segment.p1);
+	b2Vec2 d = b2MulT(transform.R, segment.p2 - segment.p1);
+
+	// Clip the segment to the bounds of the grid.
+	int32 counts[2] = {m_columnCount, m_rowCount};
+	float32 lower = 0.0f;
+	float32 upper = maxLambda;
+	int32 axis = -1;
+	for (int32 i = 0; i < 2; ++i)
+	{
+		float32 p = (&p1.x)[i];
+		float32 di = (&d.x)[i];
+		float32 size = m_cellSize * float32(counts[i]);
+
+		if (b2Abs(di) <= B2_FLT_EPSILON)
+		{
+			if (p < 0.0f || size < p)
+			{
+				return b2_missCollide;
+			}
+
+			continue;
+		}
+
+		float32 inv = 1.0f / di;
+		float32 t1 = -p * inv;
+		float32 t2 = (size - p) * inv;
+		if (t1 > t2)
+		{
+			float32 tmp = t1;
+			t1 = t2;
+			t2 = tmp;
+		}
+
+		if (t1 > lower)
+		{
+			lower = t1;
+			axis = i;
+		}
+
+		upper = b2Min(upper, t2);
+		if (lower > upper)
+		{
+			return b2_missCollide;
+		}
+	}
+
+	// Walk the crossed cells in order.
+	b2Vec2 p = p1 + lower * d;
+	int32 cell[2], step[2];
+	float32 tMax[2], tDelta[2];
+	for (int32 i = 0; i < 2; ++i)
+	{
+		int32 upperCell;
+		GetCellRange(cell + i, &upperCell, (&p.x)[i], (&p.x)[i], counts[i]);
+
+		float32 di = (&d.x)[i];
+		if (b2Abs(di) <= B2_FLT_EPSILON)
+		{
+			step[i] = 0;
+			tMax[i] = B2_FLT_MAX;
+			tDelta[i] = 0.0f;
+			continue;
+		}
+
+		step[i] = di > 0.0f ? 1 : -1;
+		float32 boundary = m_cellSize * float32(di > 0.0f ? cell[i] + 1 : cell[i]);
+		tMax[i] = (boundary - (&p1.x)[i]) / di;
+		tDelta[i] = m_cellSize / b2Abs(di);
+	}
+
+	// A segment that enters from outside the grid comes from empty space, one that
+	// starts in a solid cell only hits after leaving the solid cells.
+	bool empty = axis >= 0;
+	float32 t = lower;
+	for (;;)
+	{
+		if (IsSolid(cell[0], cell[1]) == false)
+		{
+			empty = true;
+		}
+		else if (empty)
+		{
+			b2Vec2 n(0.0f, 0.0f);
+			(&n.x)[axis] = -float32(step[axis]);
+
+			*lambda = t;
+			*normal = b2Mul(transform.R, n);
+			return b2_hitCollide;
+		}
+
+		axis = tMax[0] < tMax[1] ? 0 : 1;
+		t = tMax[axis];
+		cell[axis] += step[axis];
+		if (t > upper || cell[axis] < 0 || counts[axis] <= cell[axis])
+		{
+			break;
+		}
+
+		tMax[axis] += tDelta[axis];
+	}
+
+	return b2_missCollide;
+}
+
+void b2GridShape::ComputeAABB(b2AABB* aabb, const b2XForm& transform) const
+{
+	b2Vec2 r(m_radius, m_radius);
+	b2Vec2 lower = -r;
+	b2Vec2 upper = b2Vec2(m_cellSize * float32(m_columnCount), m_cellSize * float32(m_rowCount)) + r;
+
+	b2Vec2 center = b2Mul(transform, 0.5f * (lower + upper));
+	b2Vec2 extents = b2Mul(b2Abs(transform.R), 0.5f * (upper - lower));
+	aabb->lowerBound = center - extents;
+	aabb->upperBound = center + extents;
+}
+
+void b2GridShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
+
+// Sums the submerged area of the faces. The faces form closed loops around the solid cells.
+struct b2GridSubmergedAreaCallback
+{
+	void QueryCallback(const b2EdgeShape* edge, int32 key)
+	{
+		B2_NOT_USED(key);
+
+		b2Vec2 edgeCenter;
+		float32 edgeArea = edge->ComputeSubmergedArea(normal, offset, xf, &edgeCenter);
+		if (edgeArea != 0.0f)
+		{
+			area += edgeArea;
+			center += edgeArea * edgeCenter;
+		}
+	}
+
+	b2Vec2 normal;
+	float32 offset;
+	b2XForm xf;
+	float32 area;
+	b2Vec2 center;
+};
+
+float32 b2GridShape::ComputeSubmergedArea(	const b2Vec2& normal,
+											float32 offset,
+											const b2XForm& xf,
+											b2Vec2* c) const
+{
+	b2GridSubmergedAreaCallback callback;
+	callback.normal = normal;
+	callback.offset = offset;
+	callback.xf = xf;
+	callback.area = 0.0f;
+	callback.center.SetZero();
+
+	b2AABB aabb;
+	aabb.lowerBound.SetZero();
+	aabb.upperBound.Set(m_cellSize * float32(m_columnCount), m_cellSize * float32(m_rowCount));
+	QueryFaces(&callback, aabb);
+
+	if (callback.area != 0.0f)
+	{
+		callback.center *= 1.0f / callback.area;
+	}
+
+	*c = callback.center;
+	return callback.area;
+}
+
+float32 b2GridShape::ComputeSweepRadius(const b2Vec2& pivot) const
+{
+	b2Vec2 d1 = -pivot;
+	b2Vec2 d2 = b2Vec2(m_cellSize * float32(m_columnCount), m_cellSize * float32(m_rowCount)) - pivot;
+
+	float32 dx = b2Max(b2Abs(d1.x), b2Abs(d2.x));
+	float32 dy = b2Max(b2Abs(d1.y), b2Abs(d2.y));
+	return b2Sqrt(dx * dx + dy * dy);
+}
+
+int32 b2GridShape::GetStateSize() const
+{
+	if (m_cells == NULL)
+	{
+		return 0;
+	}
+
+	return m_columnCount * m_rowCount * sizeof(uint8);
+}
+
+void b2GridShape::SaveState(void* buffer) const
+{
+	if (m_cells)
+	{
+		memcpy(buffer, m_cells, m_columnCount * m_rowCount * sizeof(uint8));
+	}
+}
+
+void b2GridShape::RestoreState(const void* buffer)
+{
+	if (m_cells)
+	{
+		memcpy(m_cells, buffer, m_columnCount * m_rowCount * sizeof(uint8));
+	}
+}
@@ -0,0 +1,241 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_GRID_SHAPE_H
+#define B2_GRID_SHAPE_H
+
+#include "b2Shape.h"
+#include "b2EdgeShape.h"
+
+/// A grid is a tile map of square cells in the local frame. Cell (i, j) covers
+/// [i, i + 1] x [j, j + 1] in units of the cell size. Each cell holds a type byte
+/// and cells with a non-zero type are solid. Collision only scans the cells under
+/// the other shape and collides the exposed faces of the solid cells as edges.
+/// Collinear faces are merged and carry the ghost vertices of their neighbors,
+/// so shapes slide across cell boundaries without catching on internal corners.
+/// Cells may be changed at any time, nothing needs to be rebuilt.
+/// Grids have no mass and are intended for static terrain.
+class b2GridShape : public b2Shape
+{
+public:
+	/// The directions of the outward normal of a face.
+	enum
+	{
+		e_faceRight = 0,
+		e_faceUp,
+		e_faceLeft,
+		e_faceDown,
+	};
+
+	b2GridShape();
+	~b2GridShape();
+
+	/// Allocate the cells and copy their types.
+	/// @param cells the cell types row by row, starting with the bottom row. NULL leaves all cells empty.
+	/// @param columnCount the number of columns.
+	/// @param rowCount the number of rows.
+	/// @param cellSize the side length of a cell.
+	void Set(const uint8* cells, int32 columnCount, int32 rowCount, float32 cellSize);
+
+	/// Get the type of a cell, zero if the cell is empty.
+	uint8 GetCell(int32 column, int32 row) const;
+
+	/// Change the type of a cell. This is O(1). Contacts pick up the change on
+	/// the next step, but bodies sleeping on a cell that is cleared are not woken.
+	void SetCell(int32 column, int32 row, uint8 type);
+
+	/// Is the cell solid? Cells outside the grid are empty.
+	bool IsSolid(int32 column, int32 row) const;
+
+	/// Get a run of exposed faces as an edge. The run starts at the given cell and
+	/// extends along the face, to the right for up and down faces and upward for
+	/// left and right faces. The edge carries the ghost vertices of its neighbors.
+	/// @param direction the outward normal of the faces, e.g. e_faceUp.
+	/// @param count the number of cells in the run.
+	void GetFaceEdge(b2EdgeShape* edge, int32 column, int32 row, int32 direction, int32 count) const;
+
+	/// Query the exposed faces that overlap an AABB in the local frame of the grid.
+	/// Adjacent faces are merged within the AABB. The callback receives each run as
+	/// an edge and a key that identifies the run for warm starting.
+	template <typename T>
+	void QueryFaces(T* callback, const b2AABB& aabb) const;
+
+	/// A point is inside if its cell is solid.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2XForm& transform, const b2Vec2& p) const;
+
+	/// This walks the cells crossed by the segment.
+	/// @see b2Shape::TestSegment
+	b2SegmentCollide TestSegment(	const b2XForm& transform,
+						float32* lambda,
+						b2Vec2* normal,
+						const b2Segment& segment,
+						float32 maxLambda) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2XForm& transform) const;
+
+	/// Grids have no mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// @see b2Shape::ComputeSubmergedArea
+	float32 ComputeSubmergedArea(	const b2Vec2& normal,
+									float32 offset,
+									const b2XForm& xf,
+									b2Vec2* c) const;
+
+	/// @see b2Shape::ComputeSweepRadius
+	float32 ComputeSweepRadius(const b2Vec2& pivot) const;
+
+	/// The cells may change, so they are saved with the world state.
+	/// @see b2Shape::GetStateSize
+	int32 GetStateSize() const;
+	void SaveState(void* buffer) const;
+	void RestoreState(const void* buffer);
+
+	/// The cell types, row by row.
+	uint8* m_cells;
+
+	int32 m_columnCount;
+	int32 m_rowCount;
+	float32 m_cellSize;
+
+private:
+	bool GetCellRange(int32* lower, int32* upper, float32 x1, float32 x2, int32 count) const;
+	bool GetLineRange(int32* lower, int32* upper, float32 x1, float32 x2, int32 count) const;
+
+	// Get the solidity of the cell before (side 0) or after (side 1) a grid line.
+	// Axis 0 are the vertical lines x = line * cellSize, axis 1 the horizontal lines.
+	bool IsSideSolid(int32 axis, int32 line, int32 index, int32 side) const;
+
+	template <typename T>
+	void QueryLine(T* callback, int32 axis, int32 line, int32 lower, int32 upper) const;
+};
+
+inline uint8 b2GridShape::GetCell(int32 column, int32 row) const
+{
+	b2Assert(0 <= column && column < m_columnCount);
+	b2Assert(0 <= row && row < m_rowCount);
+	return m_cells[row * m_columnCount + column];
+}
+
+inline void b2GridShape::SetCell(int32 column, int32 row, uint8 type)
+{
+	b2Assert(0 <= column && column < m_columnCount);
+	b2Assert(0 <= row && row < m_rowCount);
+	m_cells[row * m_columnCount + column] = type;
+}
+
+inline bool b2GridShape::IsSolid(int32 column, int32 row) const
+{
+	if (column < 0 || m_columnCount <= column || row < 0 || m_rowCount <= row)
+	{
+		return false;
+	}
+
+	return m_cells[row * m_columnCount + column] != 0;
+}
+
+inline bool b2GridShape::IsSideSolid(int32 axis, int32 line, int32 index, int32 side) const
+{
+	int32 cell = line - 1 + side;
+	return axis == 0 ? IsSolid(cell, index) : IsSolid(index, cell);
+}
+
+template <typename T>
+inline void b2GridShape::QueryFaces(T* callback, const b2AABB& aabb) const
+{
+	float32 x1 = aabb.lowerBound.x - m_radius;
+	float32 x2 = aabb.upperBound.x + m_radius;
+	float32 y1 = aabb.lowerBound.y - m_radius;
+	float32 y2 = aabb.upperBound.y + m_radius;
+
+	int32 lowerColumn, upperColumn, lowerRow, upperRow;
+	if (GetCellRange(&lowerColumn, &upperColumn, x1, x2, m_columnCount) == false ||
+		GetCellRange(&lowerRow, &upperRow, y1, y2, m_rowCount) == false)
+	{
+		return;
+	}
+
+	int32 lower, upper;
+	if (GetLineRange(&lower, &upper, y1, y2, m_rowCount))
+	{
+		for (int32 line = lower; line <= upper; ++line)
+		{
+			QueryLine(callback, 1, line, lowerColumn, upperColumn);
+		}
+	}
+
+	if (GetLineRange(&lower, &upper, x1, x2, m_columnCount))
+	{
+		for (int32 line = lower; line <= upper; ++line)
+		{
+			QueryLine(callback, 0, line, lowerRow, upperRow);
+		}
+	}
+}
+
+template <typename T>
+inline void b2GridShape::QueryLine(T* callback, int32 axis, int32 line, int32 lower, int32 upper) const
+{
+	// A face is exposed where the cells on the two sides of the line differ. Runs
+	// of faces that point the same way are merged. The cell before the line owns
+	// the faces that point forward, the cell after the line owns the others.
+	b2EdgeShape edge;
+	int32 start[2] = {-1, -1};
+	for (int32 index = lower; index <= upper + 1; ++index)
+	{
+		bool solid0 = false, solid1 = false;
+		if (index <= upper)
+		{
+			solid0 = IsSideSolid(axis, line, index, 0);
+			solid1 = IsSideSolid(axis, line, index, 1);
+		}
+
+		for (int32 side = 0; side < 2; ++side)
+		{
+			bool exposed = side == 0 ? solid0 && solid1 == false : solid1 && solid0 == false;
+			if (exposed)
+			{
+				if (start[side] < 0)
+				{
+					start[side] = index;
+				}
+				continue;
+			}
+
+			if (start[side] < 0)
+			{
+				continue;
+			}
+
+			int32 cell = line - 1 + side;
+			int32 direction = axis + 2 * side;
+			int32 column = axis == 0 ? cell : start[side];
+			int32 row = axis == 0 ? start[side] : cell;
+			GetFaceEdge(&edge, column, row, direction, index - start[side]);
+
+			int32 key = ((row * m_columnCount + column) << 2) + direction;
+			callback->QueryCallback(&edge, key);
+			start[side] = -1;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,296 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2HeightfieldShape.h"
+#include "b2EdgeShape.h"
+
+b2HeightfieldShape::b2HeightfieldShape()
+{
+	m_type = b2_heightfieldShape;
+	m_radius = b2_polygonRadius;
+	m_heights = NULL;
+	m_quantizedHeights = NULL;
+	m_heightScale = 1.0f;
+	m_count = 0;
+	m_spacing = 1.0f;
+	m_minHeight = 0.0f;
+	m_maxHeight = 0.0f;
+}
+
+b2HeightfieldShape::~b2HeightfieldShape()
+{
+	if (m_heights)
+	{
+		b2Free(m_heights);
+		m_heights = NULL;
+	}
+
+	if (m_quantizedHeights)
+	{
+		b2Free(m_quantizedHeights);
+		m_quantizedHeights = NULL;
+	}
+}
+
+void b2HeightfieldShape::Allocate(int32 count, float32 spacing, bool quantized)
+{
+	b2Assert(m_heights == NULL && m_quantizedHeights == NULL);
+	b2Assert(count >= 2);
+	b2Assert(spacing > b2_linearSlop);
+
+	m_count = count;
+	m_spacing = spacing;
+
+	if (quantized)
+	{
+		m_quantizedHeights = (uint16*)b2Alloc(count * sizeof(uint16));
+	}
+	else
+	{
+		m_heights = (float32*)b2Alloc(count * sizeof(float32));
+	}
+}
+
+void b2HeightfieldShape::Set(const float32* heights, int32 count, float32 spacing)
+{
+	Allocate(count, spacing, false);
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_heights[i] = heights[i];
+	}
+
+	ComputeBounds();
+}
+
+void b2HeightfieldShape::Set(const uint16* heights, int32 count, float32 spacing, float32 heightScale)
+{
+	Allocate(count, spacing, true);
+	m_heightScale = heightScale;
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_quantizedHeights[i] = heights[i];
+	}
+
+	ComputeBounds();
+}
+
+void b2HeightfieldShape::ComputeBounds()
+{
+	m_minHeight = GetHeight(0);
+	m_maxHeight = m_minHeight;
+	for (int32 i = 1; i < m_count; ++i)
+	{
+		float32 h = GetHeight(i);
+		m_minHeight = b2Min(m_minHeight, h);
+		m_maxHeight = b2Max(m_maxHeight, h);
+	}
+}
+
+bool b2HeightfieldShape::GetColumnRange(int32* lower, int32* upper, float32 x1, float32 x2) const
+{
+	float32 width = m_spacing * float32(m_count - 1);
+	if (x2 < 0.0f || width < x1)
+	{
+		return false;
+	}
+
+	float32 inv = 1.0f / m_spacing;
+	float32 f1 = b2Max(x1, 0.0f) * inv;
+	float32 f2 = b2Min(x2, width) * inv;
+	int32 i1 = int32(f1);
+	int32 i2 = int32(f2);
+
+	*lower = b2Min(i1, m_count - 2);
+	*upper = b2Min(i2, m_count - 2);
+	return true;
+}
+
+void b2HeightfieldShape::GetChildEdge(b2EdgeShape* edge, int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+
+	// The edge runs from right to left so that its normal points up.
+	float32 x1 = m_spacing * float32(index);
+	float32 x2 = x1 + m_spacing;
+	edge->Set(b2Vec2(x2, GetHeight(index + 1)), b2Vec2(x1, GetHeight(index)));
+	edge->m_radius = m_radius;
+
+	if (index + 2 < m_count)
+	{
+		edge->m_vertex0.Set(x2 + m_spacing, GetHeight(index + 2));
+		edge->m_hasVertex0 = true;
+	}
+	else
+	{
+		edge->m_hasVertex0 = false;
+	}
+
+	if (index > 0)
+	{
+		edge->m_vertex3.Set(x1 - m_spacing, GetHeight(index - 1));
+		edge->m_hasVertex3 = true;
+	}
+	else
+	{
+		edge->m_hasVertex3 = false;
+	}
+}
+
+bool b2HeightfieldShape::TestPoint(const b2XForm& transform, const b2Vec2& p) const
+{
+	b2Vec2 pLocal = b2MulT(transform, p);
+
+	int32 lower, upper;
+	if (GetColumnRange(&lower, &upper, pLocal.x, pLocal.x) == false)
+	{
+		return false;
+	}
+
+	float32 x1 = m_spacing * float32(lower);
+	float32 u = (pLocal.x - x1) / m_spacing;
+	float32 h = (1.0f - u) * GetHeight(lower) + u * GetHeight(lower + 1);
+	return pLocal.y <= h;
+}
+
+b2SegmentCollide b2HeightfieldShape::TestSegment(const b2XForm& transform,
+								float32* lambda,
+								b2Vec2* normal,
+								const b2Segment& segment,
+								float32 maxLambda) const
+{
+	b2Segment localSegment;
+	localSegment.p1 = b2MulT(transform, segment.p1);
+	localSegment.p2 = b2MulT(transform, segment.p2);
+
+	b2Vec2 p1 = localSegment.p1;
+	b2Vec2 d = localSegment.p2 - p1;
+	b2Vec2 p2 = p1 + maxLambda * d;
+
+	int32 lower, upper;
+	if (GetColumnRange(&lower, &upper, b2Min(p1.x, p2.x), b2Max(p1.x, p2.x)) == false)
+	{
+		return b2_missCollide;
+	}
+
+	// Step through the columns in the order the segment crosses them.
+	int32 index = lower, step = 1;
+	if (d.x < 0.0f)
+	{
+		index = upper;
+		step = -1;
+	}
+
+	bool vertical = b2Abs(d.x) <= B2_FLT_EPSILON;
+	float32 slope = vertical ? float32(0.0f) : d.y / d.x;
+	float32 xMin = b2Min(p1.x, p2.x);
+	float32 xMax = b2Max(p1.x, p2.x);
+
+	b2EdgeShape edge;
+	for (int32 count = upper - lower + 1; count > 0; --count, index += step)
+	{
+		float32 h1 = GetHeight(index);
+		float32 h2 = GetHeight(index + 1);
+
+		if (vertical == false)
+		{
+			// Skip the column if the segment passes entirely above or below it.
+			float32 x1 = b2Max(m_spacing * float32(index), xMin);
+			float32 x2 = b2Min(m_spacing * float32(index + 1), xMax);
+			float32 y1 = p1.y + slope * (x1 - p1.x);
+			float32 y2 = p1.y + slope * (x2 - p1.x);
+			if (b2Min(y1, y2) > b2Max(h1, h2) || b2Max(y1, y2) < b2Min(h1, h2))
+			{
+				continue;
+			}
+		}
+
+		GetChildEdge(&edge, index);
+
+		b2Vec2 n;
+		if (edge.TestSegment(b2XForm_identity, lambda, &n, localSegment, maxLambda) == b2_hitCollide)
+		{
+			*normal = b2Mul(transform.R, n);
+			return b2_hitCollide;
+		}
+	}
+
+	return b2_missCollide;
+}
+
+void b2HeightfieldShape::ComputeAABB(b2AABB* aabb, const b2XForm& transform) const
+{
+	b2Vec2 r(m_radius, m_radius);
+	b2Vec2 lower = b2Vec2(0.0f, m_minHeight) - r;
+	b2Vec2 upper = b2Vec2(m_spacing * float32(m_count - 1), m_maxHeight) + r;
+
+	b2Vec2 center = b2Mul(transform, 0.5f * (lower + upper));
+	b2Vec2 extents = b2Mul(b2Abs(transform.R), 0.5f * (upper - lower));
+	aabb->lowerBound = center - extents;
+	aabb->upperBound = center + extents;
+}
+
+void b2HeightfieldShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
+
+float32 b2HeightfieldShape::ComputeSubmergedArea(	const b2Vec2& normal,
+													float32 offset,
+													const b2XForm& xf,
+													b2Vec2* c) const
+{
+	float32 area = 0.0f;
+	b2Vec2 center(0.0f, 0.0f);
+
+	b2EdgeShape edge;
+	for (int32 i = 0; i < m_count - 1; ++i)
+	{
+		GetChildEdge(&edge, i);
+
+		b2Vec2 edgeCenter;
+		float32 edgeArea = edge.ComputeSubmergedArea(normal, offset, xf, &edgeCenter);
+		if (edgeArea != 0.0f)
+		{
+			area += edgeArea;
+			center += edgeArea * edgeCenter;
+		}
+	}
+
+	if (area != 0.0f)
+	{
+		center *= 1.0f / area;
+	}
+
+	*c = center;
+	return area;
+}
+
+float32 b2HeightfieldShape::ComputeSweepRadius(const b2Vec2& pivot) const
+{
+	float32 width = m_spacing * float32(m_count - 1);
+	b2Vec2 d1 = b2Vec2(0.0f, m_minHeight) - pivot;
+	b2Vec2 d2 = b2Vec2(width, m_maxHeight) - pivot;
+
+	float32 dx = b2Max(b2Abs(d1.x), b2Abs(d2.x));
+	float32 dy = b2Max(b2Abs(d1.y), b2Abs(d2.y));
+	return b2Sqrt(dx * dx + dy * dy);
+}
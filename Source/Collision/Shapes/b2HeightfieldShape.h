@@ -0,0 +1,148 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_HEIGHTFIELD_SHAPE_H
+#define B2_HEIGHTFIELD_SHAPE_H
+
+#include "b2Shape.h"
+
+class b2EdgeShape;
+
+/// A heightfield is a terrain surface given by height samples at a regular
+/// spacing along the local x-axis. Sample i is at (i * spacing, height_i) and
+/// the ground is below the surface. The samples are stored as floats or,
+/// to save memory, as 16 bit integers that are scaled. Collision looks up
+/// the columns under the other shape directly, without a tree, and each
+/// column is collided as an edge with ghost vertices, so shapes slide smoothly.
+/// Heightfields have no mass and are intended for static terrain.
+class b2HeightfieldShape : public b2Shape
+{
+public:
+	b2HeightfieldShape();
+	~b2HeightfieldShape();
+
+	/// Copy float height samples.
+	/// @param heights the height samples.
+	/// @param count the sample count, at least 2.
+	/// @param spacing the distance between samples along x.
+	void Set(const float32* heights, int32 count, float32 spacing);
+
+	/// Copy 16 bit height samples. The height of a sample is heightScale * sample.
+	void Set(const uint16* heights, int32 count, float32 spacing, float32 heightScale);
+
+	/// Get the number of columns, one less than the sample count.
+	int32 GetChildCount() const;
+
+	/// Get the height of a sample.
+	float32 GetHeight(int32 index) const;
+
+	/// Get a column as an edge. The edge carries the ghost vertices of its neighbors
+	/// and its normal points up, out of the ground.
+	void GetChildEdge(b2EdgeShape* edge, int32 index) const;
+
+	/// Query the columns under an AABB in the local frame of the heightfield.
+	/// The callback receives the column index. This is O(1) in the sample count.
+	template <typename T>
+	void QueryChildren(T* callback, const b2AABB& aabb) const;
+
+	/// A point is inside if it is under the surface.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2XForm& transform, const b2Vec2& p) const;
+
+	/// This steps through the columns crossed by the segment.
+	/// @see b2Shape::TestSegment
+	b2SegmentCollide TestSegment(	const b2XForm& transform,
+						float32* lambda,
+						b2Vec2* normal,
+						const b2Segment& segment,
+						float32 maxLambda) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2XForm& transform) const;
+
+	/// Heightfields have no mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// @see b2Shape::ComputeSubmergedArea
+	float32 ComputeSubmergedArea(	const b2Vec2& normal,
+									float32 offset,
+									const b2XForm& xf,
+									b2Vec2* c) const;
+
+	/// @see b2Shape::ComputeSweepRadius
+	float32 ComputeSweepRadius(const b2Vec2& pivot) const;
+
+	/// Float samples, NULL if the samples are 16 bit.
+	float32* m_heights;
+
+	/// 16 bit samples, NULL if the samples are floats.
+	uint16* m_quantizedHeights;
+	float32 m_heightScale;
+
+	int32 m_count;
+	float32 m_spacing;
+	float32 m_minHeight, m_maxHeight;
+
+private:
+	void Allocate(int32 count, float32 spacing, bool quantized);
+	void ComputeBounds();
+	bool GetColumnRange(int32* lower, int32* upper, float32 x1, float32 x2) const;
+};
+
+inline int32 b2HeightfieldShape::GetChildCount() const
+{
+	return m_count - 1;
+}
+
+inline float32 b2HeightfieldShape::GetHeight(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	if (m_heights)
+	{
+		return m_heights[index];
+	}
+
+	return m_heightScale * float32(int32(m_quantizedHeights[index]));
+}
+
+template <typename T>
+inline void b2HeightfieldShape::QueryChildren(T* callback, const b2AABB& aabb) const
+{
+	int32 lower, upper;
+	if (GetColumnRange(&lower, &upper, aabb.lowerBound.x - m_radius, aabb.upperBound.x + m_radius) == false)
+	{
+		return;
+	}
+
+	float32 h1 = GetHeight(lower);
+	for (int32 i = lower; i <= upper; ++i)
+	{
+		float32 h2 = GetHeight(i + 1);
+
+		// Skip columns that are entirely above or below the AABB.
+		if (b2Min(h1, h2) - m_radius <= aabb.upperBound.y && aabb.lowerBound.y <= b2Max(h1, h2) + m_radius)
+		{
+			callback->QueryCallback(i);
+		}
+
+		h1 = h2;
+	}
+}
+
+#endif
@@ -0,0 +1,327 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2MeshShape.h"
+#include "b2EdgeShape.h"
+#include "b2PolygonShape.h"
+
+b2MeshShape::b2MeshShape()
+{
+	m_type = b2_meshShape;
+	m_radius = b2_polygonRadius;
+	m_vertices = NULL;
+	m_vertexCount = 0;
+	m_triangles = NULL;
+	m_triangleCount = 0;
+	m_segments = NULL;
+	m_segmentCount = 0;
+}
+
+b2MeshShape::~b2MeshShape()
+{
+	if (m_vertices)
+	{
+		b2Free(m_vertices);
+		m_vertices = NULL;
+	}
+
+	if (m_triangles)
+	{
+		b2Free(m_triangles);
+		m_triangles = NULL;
+	}
+
+	if (m_segments)
+	{
+		b2Free(m_segments);
+		m_segments = NULL;
+	}
+}
+
+void b2MeshShape::Set(const b2Vec2* vertices, int32 vertexCount,
+					  const int32* triangles, int32 triangleCount,
+					  const int32* segments, int32 segmentCount)
+{
+	b2Assert(m_vertices == NULL);
+	b2Assert(vertexCount >= 2);
+	b2Assert(triangleCount + segmentCount > 0);
+
+	m_vertexCount = vertexCount;
+	m_vertices = (b2Vec2*)b2Alloc(vertexCount * sizeof(b2Vec2));
+	for (int32 i = 0; i < vertexCount; ++i)
+	{
+		m_vertices[i] = vertices[i];
+	}
+
+	m_triangleCount = triangleCount;
+	if (triangleCount > 0)
+	{
+		m_triangles = (int32*)b2Alloc(3 * triangleCount * sizeof(int32));
+		for (int32 i = 0; i < triangleCount; ++i)
+		{
+			int32 i1 = triangles[3 * i + 0];
+			int32 i2 = triangles[3 * i + 1];
+			int32 i3 = triangles[3 * i + 2];
+			b2Assert(0 <= i1 && i1 < vertexCount);
+			b2Assert(0 <= i2 && i2 < vertexCount);
+			b2Assert(0 <= i3 && i3 < vertexCount);
+
+			// Polygons must be counter-clockwise.
+			float32 area = b2Cross(vertices[i2] - vertices[i1], vertices[i3] - vertices[i1]);
+			b2Assert(area != 0.0f);
+			if (area < 0.0f)
+			{
+				int32 tmp = i2;
+				i2 = i3;
+				i3 = tmp;
+			}
+
+			m_triangles[3 * i + 0] = i1;
+			m_triangles[3 * i + 1] = i2;
+			m_triangles[3 * i + 2] = i3;
+		}
+	}
+
+	m_segmentCount = segmentCount;
+	if (segmentCount > 0)
+	{
+		m_segments = (int32*)b2Alloc(2 * segmentCount * sizeof(int32));
+		for (int32 i = 0; i < 2 * segmentCount; ++i)
+		{
+			b2Assert(0 <= segments[i] && segments[i] < vertexCount);
+			m_segments[i] = segments[i];
+		}
+	}
+
+	// Build the tree.
+	int32 childCount = GetChildCount();
+	b2AABB* aabbs = (b2AABB*)b2Alloc(childCount * sizeof(b2AABB));
+	b2Vec2 r(m_radius, m_radius);
+	for (int32 i = 0; i < m_triangleCount; ++i)
+	{
+		b2Vec2 v1 = m_vertices[m_triangles[3 * i + 0]];
+		b2Vec2 v2 = m_vertices[m_triangles[3 * i + 1]];
+		b2Vec2 v3 = m_vertices[m_triangles[3 * i + 2]];
+		aabbs[i].lowerBound = b2Min(b2Min(v1, v2), v3) - r;
+		aabbs[i].upperBound = b2Max(b2Max(v1, v2), v3) + r;
+	}
+
+	for (int32 i = 0; i < m_segmentCount; ++i)
+	{
+		b2Vec2 v1 = m_vertices[m_segments[2 * i + 0]];
+		b2Vec2 v2 = m_vertices[m_segments[2 * i + 1]];
+		aabbs[m_triangleCount + i].lowerBound = b2Min(v1, v2) - r;
+		aabbs[m_triangleCount + i].upperBound = b2Max(v1, v2) + r;
+	}
+
+	m_tree.Build(aabbs, childCount);
+	b2Free(aabbs);
+}
+
+void b2MeshShape::GetChildTriangle(b2PolygonShape* polygon, int32 index) const
+{
+	b2Assert(0 <= index && index < m_triangleCount);
+
+	b2Vec2 vertices[3];
+	vertices[0] = m_vertices[m_triangles[3 * index + 0]];
+	vertices[1] = m_vertices[m_triangles[3 * index + 1]];
+	vertices[2] = m_vertices[m_triangles[3 * index + 2]];
+	polygon->Set(vertices, 3);
+	polygon->m_radius = m_radius;
+}
+
+void b2MeshShape::GetChildEdge(b2EdgeShape* edge, int32 index) const
+{
+	b2Assert(m_triangleCount <= index && index < m_triangleCount + m_segmentCount);
+
+	const int32* segment = m_segments + 2 * (index - m_triangleCount);
+	edge->Set(m_vertices[segment[0]], m_vertices[segment[1]]);
+	edge->m_radius = m_radius;
+}
+
+// Tests a point against the triangles reported by the tree.
+struct b2MeshPointCallback
+{
+	void QueryCallback(int32 index)
+	{
+		if (inside || mesh->IsTriangle(index) == false)
+		{
+			return;
+		}
+
+		b2PolygonShape triangle;
+		mesh->GetChildTriangle(&triangle, index);
+		inside = triangle.TestPoint(b2XForm_identity, p);
+	}
+
+	const b2MeshShape* mesh;
+	b2Vec2 p;
+	bool inside;
+};
+
+bool b2MeshShape::TestPoint(const b2XForm& transform, const b2Vec2& p) const
+{
+	b2MeshPointCallback callback;
+	callback.mesh = this;
+	callback.p = b2MulT(transform, p);
+	callback.inside = false;
+
+	b2AABB aabb;
+	aabb.lowerBound = callback.p;
+	aabb.upperBound = callback.p;
+	m_tree.Query(&callback, aabb);
+
+	return callback.inside;
+}
+
+// Ray cast the children that the static tree reports. The ray is in the
+// local frame of the mesh.
+struct b2MeshRayCastCallback
+{
+	void RayCastCallback(b2RayCastOutput* output, const b2RayCastInput& input, int32 index)
+	{
+		b2Segment segment;
+		segment.p1 = input.p1;
+		segment.p2 = input.p2;
+
+		float32 fraction;
+		b2Vec2 n;
+		b2SegmentCollide collide;
+		if (mesh->IsTriangle(index))
+		{
+			b2PolygonShape triangle;
+			mesh->GetChildTriangle(&triangle, index);
+			collide = triangle.TestSegment(b2XForm_identity, &fraction, &n, segment, input.maxFraction);
+		}
+		else
+		{
+			b2EdgeShape edge;
+			mesh->GetChildEdge(&edge, index);
+			collide = edge.TestSegment(b2XForm_identity, &fraction, &n, segment, input.maxFraction);
+		}
+
+		if (collide == b2_hitCollide)
+		{
+			output->hit = true;
+			output->fraction = fraction;
+			output->normal = n;
+
+			hit = true;
+			lambda = fraction;
+			normal = n;
+		}
+	}
+
+	const b2MeshShape* mesh;
+	float32 lambda;
+	b2Vec2 normal;
+	bool hit;
+};
+
+b2SegmentCollide b2MeshShape::TestSegment(const b2XForm& transform,
+								float32* lambda,
+								b2Vec2* normal,
+								const b2Segment& segment,
+								float32 maxLambda) const
+{
+	b2RayCastInput input;
+	input.p1 = b2MulT(transform, segment.p1);
+	input.p2 = b2MulT(transform, segment.p2);
+	input.maxFraction = maxLambda;
+
+	if (b2DistanceSquared(input.p1, input.p2) == 0.0f)
+	{
+		return b2_missCollide;
+	}
+
+	b2MeshRayCastCallback callback;
+	callback.mesh = this;
+	callback.hit = false;
+
+	m_tree.RayCast(&callback, input);
+
+	if (callback.hit == false)
+	{
+		return b2_missCollide;
+	}
+
+	*lambda = callback.lambda;
+	*normal = b2Mul(transform.R, callback.normal);
+	return b2_hitCollide;
+}
+
+void b2MeshShape::ComputeAABB(b2AABB* aabb, const b2XForm& transform) const
+{
+	const b2AABB& localAABB = m_tree.GetAABB();
+	b2Vec2 center = b2Mul(transform, localAABB.GetCenter());
+	b2Vec2 extents = b2Mul(b2Abs(transform.R), localAABB.GetExtents());
+	aabb->lowerBound = center - extents;
+	aabb->upperBound = center + extents;
+}
+
+void b2MeshShape::ComputeMass(b2MassData* massData, float32 density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
+
+float32 b2MeshShape::ComputeSubmergedArea(	const b2Vec2& normal,
+											float32 offset,
+											const b2XForm& xf,
+											b2Vec2* c) const
+{
+	float32 area = 0.0f;
+	b2Vec2 center(0.0f, 0.0f);
+
+	b2PolygonShape triangle;
+	for (int32 i = 0; i < m_triangleCount; ++i)
+	{
+		GetChildTriangle(&triangle, i);
+
+		b2Vec2 triangleCenter;
+		float32 triangleArea = triangle.ComputeSubmergedArea(normal, offset, xf, &triangleCenter);
+		if (triangleArea != 0.0f)
+		{
+			area += triangleArea;
+			center += triangleArea * triangleCenter;
+		}
+	}
+
+	if (area != 0.0f)
+	{
+		center *= 1.0f / area;
+	}
+
+	*c = center;
+	return area;
+}
+
+float32 b2MeshShape::ComputeSweepRadius(const b2Vec2& pivot) const
+{
+	// Use the bounds, the vertex array may hold vertices that are not referenced.
+	const b2AABB& localAABB = m_tree.GetAABB();
+	b2Vec2 d1 = localAABB.lowerBound - pivot;
+	b2Vec2 d2 = localAABB.upperBound - pivot;
+
+	float32 dx = b2Max(b2Abs(d1.x), b2Abs(d2.x));
+	float32 dy = b2Max(b2Abs(d1.y), b2Abs(d2.y));
+	return b2Sqrt(dx * dx + dy * dy);
+}
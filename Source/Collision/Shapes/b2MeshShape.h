@@ -0,0 +1,128 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_MESH_SHAPE_H
+#define B2_MESH_SHAPE_H
+
+#include "b2Shape.h"
+#include "../b2StaticTree.h"
+
+class b2EdgeShape;
+class b2PolygonShape;
+
+/// A mesh shape is a static soup of triangles and segments that share one
+/// vertex array. The whole mesh uses a single broad-phase proxy and the
+/// triangles and segments are kept in a static tree, so only the pieces that
+/// overlap another shape are collided. Children are numbered with the
+/// triangles first, followed by the segments.
+/// Meshes have no mass and are intended for static geometry.
+class b2MeshShape : public b2Shape
+{
+public:
+	b2MeshShape();
+	~b2MeshShape();
+
+	/// Copy the vertices and indices and build the tree. Triangles may have
+	/// either winding.
+	/// @param vertices the shared vertices.
+	/// @param vertexCount the vertex count.
+	/// @param triangles three vertex indices per triangle, may be NULL.
+	/// @param triangleCount the triangle count.
+	/// @param segments two vertex indices per segment, may be NULL.
+	/// @param segmentCount the segment count.
+	void Set(const b2Vec2* vertices, int32 vertexCount,
+			 const int32* triangles, int32 triangleCount,
+			 const int32* segments, int32 segmentCount);
+
+	/// Get the number of triangles and segments.
+	int32 GetChildCount() const;
+
+	/// Is this child a triangle? Otherwise it is a segment.
+	bool IsTriangle(int32 index) const;
+
+	/// Get a triangle child as a polygon.
+	void GetChildTriangle(b2PolygonShape* polygon, int32 index) const;
+
+	/// Get a segment child as an edge.
+	void GetChildEdge(b2EdgeShape* edge, int32 index) const;
+
+	/// Query the children that overlap an AABB in the local frame of the mesh.
+	/// The callback receives the child index.
+	template <typename T>
+	void QueryChildren(T* callback, const b2AABB& aabb) const;
+
+	/// A point is inside if it is inside a triangle.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2XForm& transform, const b2Vec2& p) const;
+
+	/// @see b2Shape::TestSegment
+	b2SegmentCollide TestSegment(	const b2XForm& transform,
+						float32* lambda,
+						b2Vec2* normal,
+						const b2Segment& segment,
+						float32 maxLambda) const;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2XForm& transform) const;
+
+	/// Meshes have no mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float32 density) const;
+
+	/// This sums the submerged area of the triangles.
+	/// @see b2Shape::ComputeSubmergedArea
+	float32 ComputeSubmergedArea(	const b2Vec2& normal,
+									float32 offset,
+									const b2XForm& xf,
+									b2Vec2* c) const;
+
+	/// @see b2Shape::ComputeSweepRadius
+	float32 ComputeSweepRadius(const b2Vec2& pivot) const;
+
+	b2Vec2* m_vertices;
+	int32 m_vertexCount;
+
+	/// Three indices per triangle, counter-clockwise.
+	int32* m_triangles;
+	int32 m_triangleCount;
+
+	/// Two indices per segment.
+	int32* m_segments;
+	int32 m_segmentCount;
+
+	/// The tree over the triangles and segments.
+	b2StaticTree m_tree;
+};
+
+inline int32 b2MeshShape::GetChildCount() const
+{
+	return m_triangleCount + m_segmentCount;
+}
+
+inline bool b2MeshShape::IsTriangle(int32 index) const
+{
+	return index < m_triangleCount;
+}
+
+template <typename T>
+inline void b2MeshShape::QueryChildren(T* callback, const b2AABB& aabb) const
+{
+	m_tree.Query(callback, aabb);
+}
+
+#endif
@@ -42,6 +42,11 @@ enum b2ShapeType
 	b2_circleShape,
 	b2_polygonShape,
 	b2_edgeShape,
+	b2_chainShape,
+	b2_heightfieldShape,
+	b2_meshShape,
+	b2_capsuleShape,
+	b2_gridShape,
 	b2_shapeTypeCount,
 };
 
@@ -114,6 +119,16 @@ public:
 	/// @return the distance of the furthest point from the pivot.
 	virtual float32 ComputeSweepRadius(const b2Vec2& pivot) const = 0;
 
+	/// Get the size of the shape data on the heap that may change after the shape
+	/// was created. This is saved with the world state, see b2World::SaveState.
+	virtual int32 GetStateSize() const { return 0; }
+
+	/// Save the shape data on the heap that may change.
+	virtual void SaveState(void* buffer) const { B2_NOT_USED(buffer); }
+
+	/// Restore the shape data saved by SaveState.
+	virtual void RestoreState(const void* buffer) { B2_NOT_USED(buffer); }
+
 	b2ShapeType m_type;
 	float32 m_radius;
 };
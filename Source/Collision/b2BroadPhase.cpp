@@ -89,6 +89,7 @@ b2BroadPhase::b2BroadPhase(const b2AABB& worldAABB, b2PairCallback* callback)
 	m_proxyPool[b2_maxProxies-1].overlapCount = b2_invalid;
 	m_proxyPool[b2_maxProxies-1].userData = NULL;
 	m_freeProxy = 0;
+	m_usedProxyCount = 0;
 
 	m_timeStamp = 1;
 	m_queryResultCount = 0;
@@ -244,6 +245,7 @@ uint16 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 	uint16 proxyId = m_freeProxy;
 	b2Proxy* proxy = m_proxyPool + proxyId;
 	m_freeProxy = proxy->GetNext();
+	m_usedProxyCount = b2Max(m_usedProxyCount, proxyId + 1);
 
 	proxy->overlapCount = 0;
 	proxy->userData = userData;
@@ -322,6 +324,170 @@ uint16 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 	return proxyId;
 }
 
+static bool b2BoundLess(const b2Bound& a, const b2Bound& b)
+{
+	return a.value < b.value;
+}
+
+void b2BroadPhase::CreateProxies(const b2AABB* aabbs, void** userData, int32 count, uint16* proxyIds)
+{
+	b2Assert(m_proxyCount + count <= b2_maxProxies);
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	int32 oldBoundCount = 2 * m_proxyCount;
+	int32 newBoundCount = 2 * count;
+	b2Bound* newBounds = (b2Bound*)b2Alloc(newBoundCount * sizeof(b2Bound));
+	bool* isNew = (bool*)b2Alloc(b2_maxProxies * sizeof(bool));
+	memset(isNew, 0, b2_maxProxies * sizeof(bool));
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		// You are creating a shape outside the world box.
+		b2Assert(InRange(aabbs[i]));
+
+		uint16 proxyId = m_freeProxy;
+		b2Proxy* proxy = m_proxyPool + proxyId;
+		m_freeProxy = proxy->GetNext();
+		m_usedProxyCount = b2Max(m_usedProxyCount, proxyId + 1);
+
+		proxy->overlapCount = 0;
+		proxy->userData = userData[i];
+		proxyIds[i] = proxyId;
+		isNew[proxyId] = true;
+	}
+
+	for (int32 axis = 0; axis < 2; ++axis)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			uint16 lowerValues[2], upperValues[2];
+			ComputeBounds(lowerValues, upperValues, aabbs[i]);
+
+			newBounds[2 * i].value = lowerValues[axis];
+			newBounds[2 * i].proxyId = proxyIds[i];
+			newBounds[2 * i + 1].value = upperValues[axis];
+			newBounds[2 * i + 1].proxyId = proxyIds[i];
+		}
+
+		std::sort(newBounds, newBounds + newBoundCount, b2BoundLess);
+
+		// Merge from the back, so that the old bounds are moved at most once.
+		b2Bound* bounds = m_bounds[axis];
+		int32 i = oldBoundCount - 1;
+		int32 j = newBoundCount - 1;
+		for (int32 index = oldBoundCount + newBoundCount - 1; j >= 0; --index)
+		{
+			if (i >= 0 && bounds[i].value > newBounds[j].value)
+			{
+				bounds[index] = bounds[i--];
+			}
+			else
+			{
+				bounds[index] = newBounds[j--];
+			}
+		}
+
+		// Fix the bound indices and the stabbing counts.
+		uint16 stabbingCount = 0;
+		for (int32 index = 0; index < oldBoundCount + newBoundCount; ++index)
+		{
+			b2Bound* bound = bounds + index;
+			b2Proxy* proxy = m_proxyPool + bound->proxyId;
+			if (bound->IsLower())
+			{
+				proxy->lowerBounds[axis] = (uint16)index;
+				++stabbingCount;
+			}
+			else
+			{
+				proxy->upperBounds[axis] = (uint16)index;
+				--stabbingCount;
+			}
+
+			bound->stabbingCount = stabbingCount;
+		}
+	}
+
+	m_proxyCount += count;
+
+	// Sweep along the x-axis and keep the old and the new proxies that
+	// overlap the sweep position. A pair needs at least one new proxy.
+	uint16* oldActive = (uint16*)b2Alloc(m_proxyCount * sizeof(uint16));
+	uint16* newActive = (uint16*)b2Alloc(m_proxyCount * sizeof(uint16));
+	uint16* activeIndex = (uint16*)b2Alloc(b2_maxProxies * sizeof(uint16));
+	int32 oldActiveCount = 0;
+	int32 newActiveCount = 0;
+
+	b2Bound* bounds = m_bounds[0];
+	for (int32 index = 0; index < 2 * m_proxyCount; ++index)
+	{
+		uint16 proxyId = bounds[index].proxyId;
+		b2Proxy* proxy = m_proxyPool + proxyId;
+
+		if (bounds[index].IsUpper())
+		{
+			// Remove the proxy from its active list.
+			uint16* active = isNew[proxyId] ? newActive : oldActive;
+			int32* activeCount = isNew[proxyId] ? &newActiveCount : &oldActiveCount;
+			uint16 last = active[--(*activeCount)];
+			active[activeIndex[proxyId]] = last;
+			activeIndex[last] = activeIndex[proxyId];
+			continue;
+		}
+
+		if (isNew[proxyId])
+		{
+			for (int32 k = 0; k < oldActiveCount; ++k)
+			{
+				b2Proxy* other = m_proxyPool + oldActive[k];
+				if (proxy->lowerBounds[1] < other->upperBounds[1] && other->lowerBounds[1] < proxy->upperBounds[1])
+				{
+					m_pairManager.AddBufferedPair(proxyId, oldActive[k]);
+				}
+			}
+		}
+
+		for (int32 k = 0; k < newActiveCount; ++k)
+		{
+			b2Proxy* other = m_proxyPool + newActive[k];
+			if (proxy->lowerBounds[1] < other->upperBounds[1] && other->lowerBounds[1] < proxy->upperBounds[1])
+			{
+				m_pairManager.AddBufferedPair(proxyId, newActive[k]);
+			}
+		}
+
+		if (isNew[proxyId])
+		{
+			activeIndex[proxyId] = (uint16)newActiveCount;
+			newActive[newActiveCount++] = proxyId;
+		}
+		else
+		{
+			activeIndex[proxyId] = (uint16)oldActiveCount;
+			oldActive[oldActiveCount++] = proxyId;
+		}
+	}
+
+	b2Assert(oldActiveCount == 0 && newActiveCount == 0);
+
+	m_pairManager.Commit();
+
+	b2Free(activeIndex);
+	b2Free(newActive);
+	b2Free(oldActive);
+	b2Free(isNew);
+	b2Free(newBounds);
+
+	if (s_validate)
+	{
+		Validate();
+	}
+}
+
 void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	b2Assert(0 < m_proxyCount && m_proxyCount <= b2_maxProxies);
@@ -636,6 +802,110 @@ int32 b2BroadPhase::Query(const b2AABB& aabb, void** userData, int32 maxCount)
 	return count;
 }
 
+// The counters of a saved broad-phase, followed by the used proxies, the used
+// bounds of both axes, the used pairs and the hash table.
+struct b2BroadPhaseState
+{
+	int32 proxyCount;
+	int32 usedProxyCount;
+	int32 pairCount;
+	int32 usedPairCount;
+	uint16 freeProxy;
+	uint16 freePair;
+	uint16 timeStamp;
+};
+
+int32 b2BroadPhase::GetStateSize() const
+{
+	int32 boundSize = 2 * m_proxyCount * sizeof(b2Bound);
+	return sizeof(b2BroadPhaseState) + m_usedProxyCount * sizeof(b2Proxy) + 2 * boundSize +
+		m_pairManager.m_usedPairCount * sizeof(b2Pair) + sizeof(m_pairManager.m_hashTable);
+}
+
+void b2BroadPhase::SaveState(void* buffer) const
+{
+	b2Assert(m_pairManager.m_pairBufferCount == 0);
+
+	b2BroadPhaseState state;
+	state.proxyCount = m_proxyCount;
+	state.usedProxyCount = m_usedProxyCount;
+	state.pairCount = m_pairManager.m_pairCount;
+	state.usedPairCount = m_pairManager.m_usedPairCount;
+	state.freeProxy = m_freeProxy;
+	state.freePair = m_pairManager.m_freePair;
+	state.timeStamp = m_timeStamp;
+
+	int32 proxySize = m_usedProxyCount * sizeof(b2Proxy);
+	int32 boundSize = 2 * m_proxyCount * sizeof(b2Bound);
+	int32 pairSize = m_pairManager.m_usedPairCount * sizeof(b2Pair);
+
+	int8* p = (int8*)buffer;
+	memcpy(p, &state, sizeof(state));
+	p += sizeof(state);
+	memcpy(p, m_proxyPool, proxySize);
+	p += proxySize;
+	memcpy(p, m_bounds[0], boundSize);
+	p += boundSize;
+	memcpy(p, m_bounds[1], boundSize);
+	p += boundSize;
+	memcpy(p, m_pairManager.m_pairs, pairSize);
+	p += pairSize;
+	memcpy(p, m_pairManager.m_hashTable, sizeof(m_pairManager.m_hashTable));
+}
+
+void b2BroadPhase::RestoreState(const void* buffer)
+{
+	b2Assert(m_pairManager.m_pairBufferCount == 0);
+
+	b2BroadPhaseState state;
+	const int8* p = (const int8*)buffer;
+	memcpy(&state, p, sizeof(state));
+	p += sizeof(state);
+
+	// Proxies and pairs that were first used after the save go back to their
+	// initial state, so that they are allocated in the same order again.
+	for (int32 i = state.usedProxyCount; i < m_usedProxyCount; ++i)
+	{
+		b2Proxy* proxy = m_proxyPool + i;
+		proxy->SetNext(i < b2_maxProxies - 1 ? uint16(i + 1) : b2_nullProxy);
+		proxy->timeStamp = 0;
+		proxy->overlapCount = b2_invalid;
+		proxy->userData = NULL;
+	}
+
+	for (int32 i = state.usedPairCount; i < m_pairManager.m_usedPairCount; ++i)
+	{
+		b2Pair* pair = m_pairManager.m_pairs + i;
+		pair->proxyId1 = b2_nullProxy;
+		pair->proxyId2 = b2_nullProxy;
+		pair->userData = NULL;
+		pair->status = 0;
+		pair->next = i < b2_maxPairs - 1 ? uint16(i + 1) : b2_nullPair;
+	}
+
+	m_proxyCount = state.proxyCount;
+	m_usedProxyCount = state.usedProxyCount;
+	m_pairManager.m_pairCount = state.pairCount;
+	m_pairManager.m_usedPairCount = state.usedPairCount;
+	m_freeProxy = state.freeProxy;
+	m_pairManager.m_freePair = state.freePair;
+	m_timeStamp = state.timeStamp;
+
+	int32 proxySize = m_usedProxyCount * sizeof(b2Proxy);
+	int32 boundSize = 2 * m_proxyCount * sizeof(b2Bound);
+	int32 pairSize = m_pairManager.m_usedPairCount * sizeof(b2Pair);
+
+	memcpy(m_proxyPool, p, proxySize);
+	p += proxySize;
+	memcpy(m_bounds[0], p, boundSize);
+	p += boundSize;
+	memcpy(m_bounds[1], p, boundSize);
+	p += boundSize;
+	memcpy(m_pairManager.m_pairs, p, pairSize);
+	p += pairSize;
+	memcpy(m_pairManager.m_hashTable, p, sizeof(m_pairManager.m_hashTable));
+}
+
 void b2BroadPhase::Validate()
 {
 	for (int32 axis = 0; axis < 2; ++axis)
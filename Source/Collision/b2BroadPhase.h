@@ -81,6 +81,11 @@ public:
 	uint16 CreateProxy(const b2AABB& aabb, void* userData);
 	void DestroyProxy(int32 proxyId);
 
+	// Create many proxies at once. The new bounds are sorted and merged into
+	// the bound arrays and the new pairs are found in one sweep, instead of
+	// a query and an insertion per proxy. The AABBs must be in range.
+	void CreateProxies(const b2AABB* aabbs, void** userData, int32 count, uint16* proxyIds);
+
 	// Call MoveProxy as many times as you like, then when you are done
 	// call Commit to finalized the proxy pairs (for your time step).
 	void MoveProxy(int32 proxyId, const b2AABB& aabb);
@@ -101,6 +106,12 @@ public:
 	// Proxies with a negative sortKey are discarded
 	int32 QuerySegment(const b2Segment& segment, void** userData, int32 maxCount, SortKeyFunc sortKey);
 
+	// Save the proxies, bounds and pairs, see b2World::SaveState. The pair buffer
+	// must be empty, as it is after a commit.
+	int32 GetStateSize() const;
+	void SaveState(void* buffer) const;
+	void RestoreState(const void* buffer);
+
 	void Validate();
 	void ValidatePairs();
 
@@ -124,6 +135,9 @@ public:
 	b2Proxy m_proxyPool[b2_maxProxies];
 	uint16 m_freeProxy;
 
+	// The proxies from this index on were never used and are still as initialized.
+	int32 m_usedProxyCount;
+
 	b2Bound m_bounds[2][2*b2_maxProxies];
 
 	uint16 m_queryResults[b2_maxProxies];
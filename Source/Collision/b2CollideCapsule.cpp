@@ -0,0 +1,462 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+#include "b2Collision.h"
+#include "Shapes/b2CapsuleShape.h"
+#include "Shapes/b2CircleShape.h"
+#include "Shapes/b2EdgeShape.h"
+#include "Shapes/b2PolygonShape.h"
+
+// Find the closest points between the segments p1-q1 and p2-q2, returned as
+// fractions along each segment. The segments must have non-zero length.
+// Real-Time Collision Detection by Christer Ericson, Section 5.1.9.
+static void b2ClosestPointsSegments(float32* s, float32* t,
+									const b2Vec2& p1, const b2Vec2& q1,
+									const b2Vec2& p2, const b2Vec2& q2)
+{
+	b2Vec2 d1 = q1 - p1;
+	b2Vec2 d2 = q2 - p2;
+	b2Vec2 r = p1 - p2;
+	float32 a = b2Dot(d1, d1);
+	float32 b = b2Dot(d1, d2);
+	float32 c = b2Dot(d1, r);
+	float32 e = b2Dot(d2, d2);
+	float32 f = b2Dot(d2, r);
+
+	// Closest point on the first line to the second line, zero for parallel lines.
+	float32 denom = a * e - b * b;
+	float32 sc = 0.0f;
+	if (denom > 0.0f)
+	{
+		sc = b2Clamp((b * f - c * e) / denom, 0.0f, 1.0f);
+	}
+
+	float32 tc = (b * sc + f) / e;
+	if (tc < 0.0f)
+	{
+		tc = 0.0f;
+		sc = b2Clamp(-c / a, 0.0f, 1.0f);
+	}
+	else if (tc > 1.0f)
+	{
+		tc = 1.0f;
+		sc = b2Clamp((b - c) / a, 0.0f, 1.0f);
+	}
+
+	*s = sc;
+	*t = tc;
+}
+
+void b2CollideCapsuleAndCircle(
+	b2Manifold* manifold,
+	const b2CapsuleShape* capsule, const b2XForm& xf1,
+	const b2CircleShape* circle, const b2XForm& xf2)
+{
+	manifold->m_pointCount = 0;
+
+	// Compute circle position in the frame of the capsule.
+	b2Vec2 c = b2Mul(xf2, circle->m_p);
+	b2Vec2 cLocal = b2MulT(xf1, c);
+
+	// Find the closest point on the capsule segment.
+	b2Vec2 p1 = capsule->m_p1;
+	b2Vec2 d = capsule->m_p2 - p1;
+	float32 t = b2Clamp(b2Dot(cLocal - p1, d) / b2Dot(d, d), 0.0f, 1.0f);
+	b2Vec2 closest = p1 + t * d;
+
+	float32 radius = capsule->m_radius + circle->m_radius;
+	if (b2DistanceSquared(cLocal, closest) > radius * radius)
+	{
+		return;
+	}
+
+	manifold->m_type = b2Manifold::e_circles;
+	manifold->m_localPoint = closest;
+	manifold->m_localPlaneNormal.SetZero();
+	manifold->m_pointCount = 1;
+
+	manifold->m_points[0].m_localPoint = circle->m_p;
+	manifold->m_points[0].m_id.key = 0;
+}
+
+// Collide the segment a1-a2 of shape A with a capsule. The segment is rounded
+// by radiusA. The ghost vertices are optional, they come from edge chains and
+// hand the vertex regions over to the neighboring edges.
+static void b2CollideSegmentAndCapsule(
+	b2Manifold* manifold,
+	const b2Vec2& a1, const b2Vec2& a2, float32 radiusA,
+	const b2Vec2* vertex0, const b2Vec2* vertex3, const b2XForm& xfA,
+	const b2CapsuleShape* capsule, const b2XForm& xfB)
+{
+	manifold->m_pointCount = 0;
+
+	// Compute the capsule segment in the frame of A.
+	b2Vec2 v1 = b2MulT(xfA, b2Mul(xfB, capsule->m_p1));
+	b2Vec2 v2 = b2MulT(xfA, b2Mul(xfB, capsule->m_p2));
+	float32 totalRadius = radiusA + capsule->m_radius;
+
+	float32 s, t;
+	b2ClosestPointsSegments(&s, &t, a1, a2, v1, v2);
+	b2Vec2 cA = a1 + s * (a2 - a1);
+	b2Vec2 cB = v1 + t * (v2 - v1);
+	float32 distSqr = b2DistanceSquared(cA, cB);
+	if (distSqr > totalRadius * totalRadius)
+	{
+		return;
+	}
+
+	if (s == 0.0f && vertex0 != NULL && b2Dot(a1 - *vertex0, a1 - cB) > 0.0f)
+	{
+		return;
+	}
+
+	if (s == 1.0f && vertex3 != NULL && b2Dot(*vertex3 - a2, cB - a2) > 0.0f)
+	{
+		return;
+	}
+
+	b2Vec2 tangent = a2 - a1;
+	float32 lengthA = tangent.Normalize();
+	b2Vec2 normal = b2Cross(tangent, 1.0f);
+	if (b2Dot(normal, 0.5f * (v1 + v2) - cA) < 0.0f)
+	{
+		normal = -normal;
+	}
+
+	// Nearly parallel segments that overlap get two points, so capsules can
+	// rest on their sides.
+	const float32 k_parallelTol = 0.05f;
+	b2Vec2 dB = v2 - v1;
+	float32 lengthB = dB.Length();
+	if (b2Abs(b2Cross(tangent, dB)) < k_parallelTol * lengthB)
+	{
+		// Clip the capsule segment to the extent of segment A.
+		float32 u1 = b2Dot(tangent, v1 - a1);
+		float32 u2 = b2Dot(tangent, v2 - a1);
+		float32 tLower = b2Clamp(-u1 / (u2 - u1), 0.0f, 1.0f);
+		float32 tUpper = b2Clamp((lengthA - u1) / (u2 - u1), 0.0f, 1.0f);
+		if (tUpper < tLower)
+		{
+			b2Swap(tLower, tUpper);
+		}
+
+		if ((tUpper - tLower) * lengthB > b2_linearSlop)
+		{
+			float32 fractions[2] = {tLower, tUpper};
+			int32 pointCount = 0;
+			for (int32 i = 0; i < 2; ++i)
+			{
+				b2Vec2 p = v1 + fractions[i] * dB;
+				float32 separation = b2Dot(normal, p - a1);
+				if (separation <= totalRadius)
+				{
+					b2ManifoldPoint* cp = manifold->m_points + pointCount;
+					cp->m_localPoint = capsule->m_p1 + fractions[i] * (capsule->m_p2 - capsule->m_p1);
+					cp->m_id.key = 0;
+					cp->m_id.features.incidentVertex = (uint8)i;
+					++pointCount;
+				}
+			}
+
+			if (pointCount > 0)
+			{
+				manifold->m_type = b2Manifold::e_faceA;
+				manifold->m_localPlaneNormal = normal;
+				manifold->m_localPoint = a1;
+				manifold->m_pointCount = pointCount;
+				return;
+			}
+		}
+	}
+
+	manifold->m_pointCount = 1;
+	manifold->m_points[0].m_localPoint = capsule->m_p1 + t * (capsule->m_p2 - capsule->m_p1);
+	manifold->m_points[0].m_id.key = 0;
+
+	if (distSqr > B2_FLT_EPSILON * B2_FLT_EPSILON)
+	{
+		manifold->m_type = b2Manifold::e_circles;
+		manifold->m_localPoint = cA;
+		manifold->m_localPlaneNormal.SetZero();
+	}
+	else
+	{
+		// The segments cross, push the capsule out along the normal of segment A.
+		manifold->m_type = b2Manifold::e_faceA;
+		manifold->m_localPoint = cA;
+		manifold->m_localPlaneNormal = normal;
+	}
+}
+
+void b2CollideCapsules(
+	b2Manifold* manifold,
+	const b2CapsuleShape* capsuleA, const b2XForm& xfA,
+	const b2CapsuleShape* capsuleB, const b2XForm& xfB)
+{
+	b2CollideSegmentAndCapsule(manifold,
+		capsuleA->m_p1, capsuleA->m_p2, capsuleA->m_radius, NULL, NULL, xfA,
+		capsuleB, xfB);
+}
+
+void b2CollideEdgeAndCapsule(
+	b2Manifold* manifold,
+	const b2EdgeShape* edge, const b2XForm& xfA,
+	const b2CapsuleShape* capsule, const b2XForm& xfB)
+{
+	const b2Vec2* vertex0 = edge->m_hasVertex0 ? &edge->m_vertex0 : NULL;
+	const b2Vec2* vertex3 = edge->m_hasVertex3 ? &edge->m_vertex3 : NULL;
+	b2CollideSegmentAndCapsule(manifold,
+		edge->m_v1, edge->m_v2, edge->m_radius, vertex0, vertex3, xfA,
+		capsule, xfB);
+}
+
+// This is b2CollidePolygons with the capsule as a two sided polygon. When the
+// cores are apart the segment distance decides if a polygon vertex touches
+// a rounded end, because a face normal would push the wrong way there.
+void b2CollidePolyAndCapsule(
+	b2Manifold* manifold,
+	const b2PolygonShape* polygon, const b2XForm& xfA,
+	const b2CapsuleShape* capsule, const b2XForm& xfB)
+{
+	manifold->m_pointCount = 0;
+	float32 totalRadius = polygon->m_radius + capsule->m_radius;
+
+	// Work in the frame of the polygon.
+	b2XForm xf(b2MulT(xfA.R, xfB.position - xfA.position), b2MulT(xfA.R, xfB.R));
+	b2Vec2 v1 = b2Mul(xf, capsule->m_p1);
+	b2Vec2 v2 = b2Mul(xf, capsule->m_p2);
+
+	int32 count = polygon->m_vertexCount;
+	const b2Vec2* vertices = polygon->m_vertices;
+	const b2Vec2* normals = polygon->m_normals;
+
+	// Find the polygon face of max separation.
+	int32 edgeA = 0;
+	float32 separationA = -B2_FLT_MAX;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 s = b2Min(b2Dot(normals[i], v1 - vertices[i]), b2Dot(normals[i], v2 - vertices[i]));
+		if (s > separationA)
+		{
+			separationA = s;
+			edgeA = i;
+		}
+	}
+
+	if (separationA > totalRadius)
+	{
+		return;
+	}
+
+	// Find the capsule side of max separation.
+	b2Vec2 normalB = b2Cross(v2 - v1, 1.0f);
+	normalB.Normalize();
+	float32 minDot = B2_FLT_MAX;
+	float32 maxDot = -B2_FLT_MAX;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 dot = b2Dot(normalB, vertices[i] - v1);
+		minDot = b2Min(minDot, dot);
+		maxDot = b2Max(maxDot, dot);
+	}
+
+	float32 separationB = minDot;
+	if (-maxDot > minDot)
+	{
+		separationB = -maxDot;
+		normalB = -normalB;
+	}
+
+	if (separationB > totalRadius)
+	{
+		return;
+	}
+
+	if (b2Max(separationA, separationB) > 0.0f)
+	{
+		// Find the closest polygon edge to the capsule segment.
+		int32 edge = 0;
+		float32 bestS = 0.0f, bestT = 0.0f;
+		float32 bestDistSqr = B2_FLT_MAX;
+		for (int32 i = 0; i < count; ++i)
+		{
+			int32 i2 = i + 1 < count ? i + 1 : 0;
+			float32 s, t;
+			b2ClosestPointsSegments(&s, &t, vertices[i], vertices[i2], v1, v2);
+			b2Vec2 pA = vertices[i] + s * (vertices[i2] - vertices[i]);
+			b2Vec2 pB = v1 + t * (v2 - v1);
+			float32 distSqr = b2DistanceSquared(pA, pB);
+			if (distSqr < bestDistSqr)
+			{
+				bestDistSqr = distSqr;
+				bestS = s;
+				bestT = t;
+				edge = i;
+			}
+		}
+
+		if (bestDistSqr > totalRadius * totalRadius)
+		{
+			return;
+		}
+
+		// A polygon vertex against a rounded end.
+		if ((bestS == 0.0f || bestS == 1.0f) && (bestT == 0.0f || bestT == 1.0f))
+		{
+			int32 vertex = edge;
+			if (bestS == 1.0f)
+			{
+				vertex = edge + 1 < count ? edge + 1 : 0;
+			}
+
+			uint8 end = bestT == 0.0f ? 0 : 1;
+
+			manifold->m_type = b2Manifold::e_circles;
+			manifold->m_localPoint = vertices[vertex];
+			manifold->m_localPlaneNormal.SetZero();
+			manifold->m_pointCount = 1;
+
+			b2ManifoldPoint* cp = manifold->m_points + 0;
+			cp->m_localPoint = capsule->GetVertex(end);
+			cp->m_id.features.referenceEdge = (uint8)vertex;
+			cp->m_id.features.incidentEdge = b2_nullFeature;
+			cp->m_id.features.incidentVertex = end;
+			cp->m_id.features.flip = 0;
+			return;
+		}
+	}
+
+	b2ClipVertex incidentEdge[2];
+	b2Vec2 frontNormal;
+	b2Vec2 refV1, refV2;
+	uint8 flip;
+	const float32 k_relativeTol = 0.98f;
+	const float32 k_absoluteTol = 0.001f;
+
+	if (separationB > k_relativeTol * separationA + k_absoluteTol)
+	{
+		// The capsule side is the reference face. Find the incident polygon edge.
+		int32 index = 0;
+		float32 minNormalDot = B2_FLT_MAX;
+		for (int32 i = 0; i < count; ++i)
+		{
+			float32 dot = b2Dot(normalB, normals[i]);
+			if (dot < minNormalDot)
+			{
+				minNormalDot = dot;
+				index = i;
+			}
+		}
+
+		int32 i1 = index;
+		int32 i2 = i1 + 1 < count ? i1 + 1 : 0;
+
+		incidentEdge[0].v = vertices[i1];
+		incidentEdge[0].id.features.referenceEdge = 0;
+		incidentEdge[0].id.features.incidentEdge = (uint8)i1;
+		incidentEdge[0].id.features.incidentVertex = 0;
+
+		incidentEdge[1].v = vertices[i2];
+		incidentEdge[1].id.features.referenceEdge = 0;
+		incidentEdge[1].id.features.incidentEdge = (uint8)i2;
+		incidentEdge[1].id.features.incidentVertex = 1;
+
+		frontNormal = normalB;
+		refV1 = v1;
+		refV2 = v2;
+		flip = 1;
+
+		manifold->m_type = b2Manifold::e_faceB;
+		manifold->m_localPlaneNormal = b2MulT(xf.R, normalB);
+		manifold->m_localPoint = capsule->m_p1;
+	}
+	else
+	{
+		// The polygon face is the reference face, the capsule segment is incident.
+		int32 i1 = edgeA;
+		int32 i2 = i1 + 1 < count ? i1 + 1 : 0;
+
+		incidentEdge[0].v = v1;
+		incidentEdge[0].id.features.referenceEdge = (uint8)edgeA;
+		incidentEdge[0].id.features.incidentEdge = 0;
+		incidentEdge[0].id.features.incidentVertex = 0;
+
+		incidentEdge[1].v = v2;
+		incidentEdge[1].id.features.referenceEdge = (uint8)edgeA;
+		incidentEdge[1].id.features.incidentEdge = 1;
+		incidentEdge[1].id.features.incidentVertex = 1;
+
+		frontNormal = normals[edgeA];
+		refV1 = vertices[i1];
+		refV2 = vertices[i2];
+		flip = 0;
+
+		manifold->m_type = b2Manifold::e_faceA;
+		manifold->m_localPlaneNormal = normals[edgeA];
+		manifold->m_localPoint = 0.5f * (refV1 + refV2);
+	}
+
+	b2Vec2 sideNormal = refV2 - refV1;
+	sideNormal.Normalize();
+
+	float32 sideOffset1 = -b2Dot(sideNormal, refV1);
+	float32 sideOffset2 = b2Dot(sideNormal, refV2);
+
+	// Clip incident edge against the sides of the reference face.
+	b2ClipVertex clipPoints1[2];
+	b2ClipVertex clipPoints2[2];
+	int32 np;
+
+	np = b2ClipSegmentToLine(clipPoints1, incidentEdge, -sideNormal, sideOffset1);
+
+	if (np < 2)
+	{
+		return;
+	}
+
+	np = b2ClipSegmentToLine(clipPoints2, clipPoints1, sideNormal, sideOffset2);
+
+	if (np < 2)
+	{
+		return;
+	}
+
+	int32 pointCount = 0;
+	for (int32 i = 0; i < b2_maxManifoldPoints; ++i)
+	{
+		float32 separation = b2Dot(frontNormal, clipPoints2[i].v - refV1);
+
+		if (separation <= totalRadius)
+		{
+			b2ManifoldPoint* cp = manifold->m_points + pointCount;
+			if (flip)
+			{
+				// Clip points of the polygon stay in the polygon frame.
+				cp->m_localPoint = clipPoints2[i].v;
+			}
+			else
+			{
+				cp->m_localPoint = b2MulT(xf, clipPoints2[i].v);
+			}
+			cp->m_id = clipPoints2[i].id;
+			cp->m_id.features.flip = flip;
+			++pointCount;
+		}
+	}
+
+	manifold->m_pointCount = pointCount;
+}
@@ -23,7 +23,8 @@
 void b2CollideCircles(
 	b2Manifold* manifold,
 	const b2CircleShape* circle1, const b2XForm& xf1,
-	const b2CircleShape* circle2, const b2XForm& xf2)
+	const b2CircleShape* circle2, const b2XForm& xf2,
+	float32 speculativeDistance)
 {
 	manifold->m_pointCount = 0;
 
@@ -32,7 +33,7 @@ void b2CollideCircles(
 
 	b2Vec2 d = p2 - p1;
 	float32 distSqr = b2Dot(d, d);
-	float32 radius = circle1->m_radius + circle2->m_radius;
+	float32 radius = circle1->m_radius + circle2->m_radius + speculativeDistance;
 	if (distSqr > radius * radius)
 	{
 		return;
@@ -50,7 +51,8 @@ void b2CollideCircles(
 void b2CollidePolygonAndCircle(
 	b2Manifold* manifold,
 	const b2PolygonShape* polygon, const b2XForm& xf1,
-	const b2CircleShape* circle, const b2XForm& xf2)
+	const b2CircleShape* circle, const b2XForm& xf2,
+	float32 speculativeDistance)
 {
 	manifold->m_pointCount = 0;
 
@@ -61,7 +63,7 @@ void b2CollidePolygonAndCircle(
 	// Find the min separating edge.
 	int32 normalIndex = 0;
 	float32 separation = -B2_FLT_MAX;
-	float32 radius = polygon->m_radius + circle->m_radius;
+	float32 radius = polygon->m_radius + circle->m_radius + speculativeDistance;
 	int32 vertexCount = polygon->m_vertexCount;
 	const b2Vec2* vertices = polygon->m_vertices;
 	const b2Vec2* normals = polygon->m_normals;
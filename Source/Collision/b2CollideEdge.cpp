@@ -21,8 +21,423 @@
 #include "Shapes/b2EdgeShape.h"
 #include "Shapes/b2PolygonShape.h"
 
+// Edge contacts can be generated from the edge face or from a polygon face.
+struct b2EdgeAxis
+{
+	enum Type
+	{
+		e_unknown,
+		e_edge,
+		e_polygon
+	};
+
+	Type type;
+	int32 index;
+	float32 separation;
+};
+
+// Polygon versus an edge that is part of a chain. The ghost vertices give the
+// normals of the neighboring edges. These are used to decide which side of the
+// edge the polygon is on and to limit the polygon normals that may be used as
+// the contact normal. This removes the collisions with internal vertices that
+// make shapes snag while sliding across a chain of edges.
+static void b2CollidePolyAndChainEdge(b2Manifold* manifold,
+									  const b2PolygonShape* polygon, const b2XForm& xfA,
+									  const b2EdgeShape* edge, const b2XForm& xfB)
+{
+	manifold->m_pointCount = 0;
+
+	// The polygon transform in the frame of the edge.
+	b2XForm xf;
+	xf.R = b2MulT(xfB.R, xfA.R);
+	xf.position = b2MulT(xfB, xfA.position);
+
+	b2Vec2 centroid = b2Mul(xf, polygon->m_centroid);
+
+	b2Vec2 v0 = edge->m_vertex0;
+	b2Vec2 v1 = edge->m_v1;
+	b2Vec2 v2 = edge->m_v2;
+	b2Vec2 v3 = edge->m_vertex3;
+	bool hasVertex0 = edge->m_hasVertex0;
+	bool hasVertex3 = edge->m_hasVertex3;
+
+	b2Vec2 normal0(0.0f, 0.0f), normal2(0.0f, 0.0f);
+	b2Vec2 normal1 = edge->m_normal;
+	float32 offset0 = 0.0f, offset2 = 0.0f;
+	float32 offset1 = b2Dot(normal1, centroid - v1);
+	bool convex1 = false, convex2 = false;
+
+	if (hasVertex0)
+	{
+		b2Vec2 edge0 = v1 - v0;
+		edge0.Normalize();
+		normal0 = b2Cross(edge0, 1.0f);
+		convex1 = b2Cross(edge0, edge->m_direction) >= 0.0f;
+		offset0 = b2Dot(normal0, centroid - v0);
+	}
+
+	if (hasVertex3)
+	{
+		b2Vec2 edge2 = v3 - v2;
+		edge2.Normalize();
+		normal2 = b2Cross(edge2, 1.0f);
+		convex2 = b2Cross(edge->m_direction, edge2) > 0.0f;
+		offset2 = b2Dot(normal2, centroid - v2);
+	}
+
+	// Determine the front side and the range of admissible normals.
+	bool front;
+	b2Vec2 normal, lowerLimit, upperLimit;
+	if (hasVertex0 && hasVertex3)
+	{
+		if (convex1 && convex2)
+		{
+			front = offset0 >= 0.0f || offset1 >= 0.0f || offset2 >= 0.0f;
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = normal0;
+				upperLimit = normal2;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = -normal1;
+				upperLimit = -normal1;
+			}
+		}
+		else if (convex1)
+		{
+			front = offset0 >= 0.0f || (offset1 >= 0.0f && offset2 >= 0.0f);
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = normal0;
+				upperLimit = normal1;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = -normal2;
+				upperLimit = -normal1;
+			}
+		}
+		else if (convex2)
+		{
+			front = offset2 >= 0.0f || (offset0 >= 0.0f && offset1 >= 0.0f);
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = normal1;
+				upperLimit = normal2;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = -normal1;
+				upperLimit = -normal0;
+			}
+		}
+		else
+		{
+			front = offset0 >= 0.0f && offset1 >= 0.0f && offset2 >= 0.0f;
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = normal1;
+				upperLimit = normal1;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = -normal2;
+				upperLimit = -normal0;
+			}
+		}
+	}
+	else if (hasVertex0)
+	{
+		if (convex1)
+		{
+			front = offset0 >= 0.0f || offset1 >= 0.0f;
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = normal0;
+				upperLimit = -normal1;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = normal1;
+				upperLimit = -normal1;
+			}
+		}
+		else
+		{
+			front = offset0 >= 0.0f && offset1 >= 0.0f;
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = normal1;
+				upperLimit = -normal1;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = normal1;
+				upperLimit = -normal0;
+			}
+		}
+	}
+	else
+	{
+		b2Assert(hasVertex3);
+		if (convex2)
+		{
+			front = offset1 >= 0.0f || offset2 >= 0.0f;
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = -normal1;
+				upperLimit = normal2;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = -normal1;
+				upperLimit = normal1;
+			}
+		}
+		else
+		{
+			front = offset1 >= 0.0f && offset2 >= 0.0f;
+			if (front)
+			{
+				normal = normal1;
+				lowerLimit = -normal1;
+				upperLimit = normal1;
+			}
+			else
+			{
+				normal = -normal1;
+				lowerLimit = -normal2;
+				upperLimit = normal1;
+			}
+		}
+	}
+
+	// Get the polygon in the frame of the edge.
+	int32 count = polygon->m_vertexCount;
+	b2Vec2 vertices[b2_maxPolygonVertices];
+	b2Vec2 normals[b2_maxPolygonVertices];
+	for (int32 i = 0; i < count; ++i)
+	{
+		vertices[i] = b2Mul(xf, polygon->m_vertices[i]);
+		normals[i] = b2Mul(xf.R, polygon->m_normals[i]);
+	}
+
+	float32 totalRadius = polygon->m_radius + edge->m_radius;
+
+	// Separation along the edge normal.
+	b2EdgeAxis edgeAxis;
+	edgeAxis.type = b2EdgeAxis::e_edge;
+	edgeAxis.index = front ? 0 : 1;
+	edgeAxis.separation = B2_FLT_MAX;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 s = b2Dot(normal, vertices[i] - v1);
+		if (s < edgeAxis.separation)
+		{
+			edgeAxis.separation = s;
+		}
+	}
+
+	if (edgeAxis.separation > totalRadius)
+	{
+		return;
+	}
+
+	// Separation along the polygon normals that are admissible.
+	b2EdgeAxis polygonAxis;
+	polygonAxis.type = b2EdgeAxis::e_unknown;
+	polygonAxis.index = -1;
+	polygonAxis.separation = -B2_FLT_MAX;
+
+	b2Vec2 perp(-normal.y, normal.x);
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 n = -normals[i];
+
+		float32 s1 = b2Dot(n, vertices[i] - v1);
+		float32 s2 = b2Dot(n, vertices[i] - v2);
+		float32 s = b2Min(s1, s2);
+
+		if (s > totalRadius)
+		{
+			// No collision.
+			return;
+		}
+
+		// Adjacency
+		if (b2Dot(n, perp) >= 0.0f)
+		{
+			if (b2Dot(n - upperLimit, normal) < -b2_angularSlop)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			if (b2Dot(n - lowerLimit, normal) < -b2_angularSlop)
+			{
+				continue;
+			}
+		}
+
+		if (s > polygonAxis.separation)
+		{
+			polygonAxis.type = b2EdgeAxis::e_polygon;
+			polygonAxis.index = i;
+			polygonAxis.separation = s;
+		}
+	}
+
+	// Favor the edge axis to keep the normal stable.
+	const float32 k_relativeTol = 0.98f;
+	const float32 k_absoluteTol = 0.001f;
 
-// This implements 2-sided edge vs circle collision.
+	b2EdgeAxis primaryAxis = edgeAxis;
+	if (polygonAxis.type != b2EdgeAxis::e_unknown &&
+		polygonAxis.separation > k_relativeTol * edgeAxis.separation + k_absoluteTol)
+	{
+		primaryAxis = polygonAxis;
+	}
+
+	b2ClipVertex incidentEdge[2];
+	b2Vec2 refV1, refV2, refNormal;
+	int32 refIndex;
+	if (primaryAxis.type == b2EdgeAxis::e_edge)
+	{
+		// Find the polygon normal that is most anti-parallel to the edge normal.
+		int32 bestIndex = 0;
+		float32 bestValue = b2Dot(normal, normals[0]);
+		for (int32 i = 1; i < count; ++i)
+		{
+			float32 value = b2Dot(normal, normals[i]);
+			if (value < bestValue)
+			{
+				bestValue = value;
+				bestIndex = i;
+			}
+		}
+
+		int32 i1 = bestIndex;
+		int32 i2 = i1 + 1 < count ? i1 + 1 : 0;
+
+		incidentEdge[0].v = vertices[i1];
+		incidentEdge[0].id.features.referenceEdge = 0;
+		incidentEdge[0].id.features.incidentEdge = (uint8)i1;
+		incidentEdge[0].id.features.incidentVertex = 0;
+		incidentEdge[0].id.features.flip = 1;
+
+		incidentEdge[1].v = vertices[i2];
+		incidentEdge[1].id.features.referenceEdge = 0;
+		incidentEdge[1].id.features.incidentEdge = (uint8)i2;
+		incidentEdge[1].id.features.incidentVertex = 1;
+		incidentEdge[1].id.features.flip = 1;
+
+		refIndex = 0;
+		if (front)
+		{
+			refV1 = v1;
+			refV2 = v2;
+			refNormal = normal1;
+		}
+		else
+		{
+			refV1 = v2;
+			refV2 = v1;
+			refNormal = -normal1;
+		}
+	}
+	else
+	{
+		refIndex = primaryAxis.index;
+		int32 i2 = refIndex + 1 < count ? refIndex + 1 : 0;
+
+		incidentEdge[0].v = v1;
+		incidentEdge[0].id.features.referenceEdge = (uint8)refIndex;
+		incidentEdge[0].id.features.incidentEdge = 0;
+		incidentEdge[0].id.features.incidentVertex = 0;
+		incidentEdge[0].id.features.flip = 0;
+
+		incidentEdge[1].v = v2;
+		incidentEdge[1].id.features.referenceEdge = (uint8)refIndex;
+		incidentEdge[1].id.features.incidentEdge = 0;
+		incidentEdge[1].id.features.incidentVertex = 1;
+		incidentEdge[1].id.features.flip = 0;
+
+		refV1 = vertices[refIndex];
+		refV2 = vertices[i2];
+		refNormal = normals[refIndex];
+	}
+
+	// Clip the incident edge to the side planes of the reference face.
+	b2Vec2 sideNormal(refNormal.y, -refNormal.x);
+
+	b2ClipVertex clipPoints1[2];
+	b2ClipVertex clipPoints2[2];
+	int32 np = b2ClipSegmentToLine(clipPoints1, incidentEdge, sideNormal, b2Dot(sideNormal, refV1));
+	if (np < b2_maxManifoldPoints)
+	{
+		return;
+	}
+
+	np = b2ClipSegmentToLine(clipPoints2, clipPoints1, -sideNormal, -b2Dot(sideNormal, refV2));
+	if (np < b2_maxManifoldPoints)
+	{
+		return;
+	}
+
+	if (primaryAxis.type == b2EdgeAxis::e_edge)
+	{
+		manifold->m_type = b2Manifold::e_faceB;
+		manifold->m_localPlaneNormal = refNormal;
+		manifold->m_localPoint = refV1;
+	}
+	else
+	{
+		manifold->m_type = b2Manifold::e_faceA;
+		manifold->m_localPlaneNormal = polygon->m_normals[refIndex];
+		manifold->m_localPoint = polygon->m_vertices[refIndex];
+	}
+
+	int32 pointCount = 0;
+	for (int32 i = 0; i < b2_maxManifoldPoints; ++i)
+	{
+		float32 separation = b2Dot(refNormal, clipPoints2[i].v - refV1);
+		if (separation <= totalRadius)
+		{
+			b2ManifoldPoint* cp = manifold->m_points + pointCount;
+			if (primaryAxis.type == b2EdgeAxis::e_edge)
+			{
+				cp->m_localPoint = b2MulT(xf, clipPoints2[i].v);
+			}
+			else
+			{
+				cp->m_localPoint = clipPoints2[i].v;
+			}
+			cp->m_id = clipPoints2[i].id;
+			++pointCount;
+		}
+	}
+
+	manifold->m_pointCount = pointCount;
+}
+
+// This implements 2-sided edge vs circle collision. If the edge is part of a chain,
+// vertex contacts are left to a neighboring edge when the circle is in its region.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							const b2EdgeShape* edge, 
 							const b2XForm& transformA,
@@ -48,6 +463,11 @@ void b2CollideEdgeAndCircle(b2Manifold* manifold,
 			return;
 		}
 
+		if (edge->m_hasVertex0 && b2Dot(v1 - edge->m_vertex0, v1 - cLocal) > 0.0f)
+		{
+			return;
+		}
+
 		manifold->m_pointCount = 1;
 		manifold->m_type = b2Manifold::e_faceA;
 		manifold->m_localPlaneNormal = cLocal - v1;
@@ -64,6 +484,11 @@ void b2CollideEdgeAndCircle(b2Manifold* manifold,
 			return;
 		}
 
+		if (edge->m_hasVertex3 && b2Dot(edge->m_vertex3 - v2, cLocal - v2) > 0.0f)
+		{
+			return;
+		}
+
 		manifold->m_pointCount = 1;
 		manifold->m_type = b2Manifold::e_faceA;
 		manifold->m_localPlaneNormal = cLocal - v2;
@@ -98,10 +523,16 @@ void b2CollidePolyAndEdge(b2Manifold* manifold,
 						  const b2EdgeShape* edge, 
 						  const b2XForm& transformB)
 {
+	if (edge->m_hasVertex0 || edge->m_hasVertex3)
+	{
+		b2CollidePolyAndChainEdge(manifold, polygon, transformA, edge, transformB);
+		return;
+	}
+
 	b2PolygonShape polygonB;
 	polygonB.SetAsEdge(edge->m_v1, edge->m_v2);
 
-	b2CollidePolygons(manifold, polygon, transformA, &polygonB, transformB);
+	b2CollidePolygons(manifold, polygon, transformA, &polygonB, transformB, 0.0f);
 }
 
 #else
@@ -192,10 +192,11 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 // The normal points from 1 to 2
 void b2CollidePolygons(b2Manifold* manifold,
 					  const b2PolygonShape* polyA, const b2XForm& xfA,
-					  const b2PolygonShape* polyB, const b2XForm& xfB)
+					  const b2PolygonShape* polyB, const b2XForm& xfB,
+					  float32 speculativeDistance)
 {
 	manifold->m_pointCount = 0;
-	float32 totalRadius = polyA->m_radius + polyB->m_radius;
+	float32 totalRadius = polyA->m_radius + polyB->m_radius + speculativeDistance;
 
 	int32 edgeA = 0;
 	float32 separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
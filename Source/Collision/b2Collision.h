@@ -30,6 +30,7 @@ class b2Shape;
 class b2CircleShape;
 class b2PolygonShape;
 class b2EdgeShape;
+class b2CapsuleShape;
 
 const uint8 b2_nullFeature = UCHAR_MAX;
 
@@ -201,19 +202,25 @@ struct b2AABB
 };
 
 /// Compute the collision manifold between two circles.
+/// @param speculativeDistance also report shapes that are separated by up to this distance.
 void b2CollideCircles(b2Manifold* manifold,
 					  const b2CircleShape* circle1, const b2XForm& xf1,
-					  const b2CircleShape* circle2, const b2XForm& xf2);
+					  const b2CircleShape* circle2, const b2XForm& xf2,
+					  float32 speculativeDistance);
 
 /// Compute the collision manifold between a polygon and a circle.
+/// @param speculativeDistance also report shapes that are separated by up to this distance.
 void b2CollidePolygonAndCircle(b2Manifold* manifold,
 							   const b2PolygonShape* polygon, const b2XForm& xf1,
-							   const b2CircleShape* circle, const b2XForm& xf2);
+							   const b2CircleShape* circle, const b2XForm& xf2,
+							   float32 speculativeDistance);
 
 /// Compute the collision manifold between two polygons.
+/// @param speculativeDistance also report points that are separated by up to this distance.
 void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygon1, const b2XForm& xf1,
-					   const b2PolygonShape* polygon2, const b2XForm& xf2);
+					   const b2PolygonShape* polygon2, const b2XForm& xf2,
+					   float32 speculativeDistance);
 
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
@@ -225,6 +232,26 @@ void b2CollidePolyAndEdge(b2Manifold* manifold,
 						  const b2PolygonShape* poly, const b2XForm& xf1,
 						  const b2EdgeShape* edge, const b2XForm& xf2);
 
+/// Compute the collision manifold between a capsule and a circle.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsule, const b2XForm& xf1,
+							   const b2CircleShape* circle, const b2XForm& xf2);
+
+/// Compute the collision manifold between two capsules.
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2XForm& xfA,
+					   const b2CapsuleShape* capsuleB, const b2XForm& xfB);
+
+/// Compute the collision manifold between a polygon and a capsule.
+void b2CollidePolyAndCapsule(b2Manifold* manifold,
+							 const b2PolygonShape* polygon, const b2XForm& xfA,
+							 const b2CapsuleShape* capsule, const b2XForm& xfB);
+
+/// Compute the collision manifold between an edge and a capsule.
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							 const b2EdgeShape* edge, const b2XForm& xfA,
+							 const b2CapsuleShape* capsule, const b2XForm& xfB);
+
 /// Clipping for contact manifolds.
 int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float32 offset);
@@ -255,4 +282,13 @@ inline bool b2TestOverlap(const b2AABB& a, const b2AABB& b)
 	return true;
 }
 
+/// Compute the AABB of a box after it is moved by a transform.
+inline void b2TransformAABB(b2AABB* aabb, const b2AABB& box, const b2XForm& xf)
+{
+	b2Vec2 center = b2Mul(xf, box.GetCenter());
+	b2Vec2 extents = b2Mul(b2Abs(xf.R), box.GetExtents());
+	aabb->lowerBound = center - extents;
+	aabb->upperBound = center + extents;
+}
+
 #endif
@@ -20,6 +20,7 @@
 #include "Shapes/b2CircleShape.h"
 #include "Shapes/b2PolygonShape.h"
 #include "Shapes/b2EdgeShape.h"
+#include "Shapes/b2CapsuleShape.h"
 
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
 
@@ -568,3 +569,51 @@ b2Distance(	b2DistanceOutput* output,
 		   const b2PolygonShape* shapeA,
 		   const b2PolygonShape* shapeB);
 
+template void 
+b2Distance(	b2DistanceOutput* output,
+		   b2SimplexCache* cache,
+		   const b2DistanceInput* input,
+		   const b2CapsuleShape* shapeA,
+		   const b2CircleShape* shapeB);
+
+template void 
+b2Distance(	b2DistanceOutput* output,
+		   b2SimplexCache* cache,
+		   const b2DistanceInput* input,
+		   const b2CapsuleShape* shapeA,
+		   const b2EdgeShape* shapeB);
+
+template void 
+b2Distance(	b2DistanceOutput* output,
+		   b2SimplexCache* cache,
+		   const b2DistanceInput* input,
+		   const b2CapsuleShape* shapeA,
+		   const b2PolygonShape* shapeB);
+
+template void 
+b2Distance(	b2DistanceOutput* output,
+		   b2SimplexCache* cache,
+		   const b2DistanceInput* input,
+		   const b2CapsuleShape* shapeA,
+		   const b2CapsuleShape* shapeB);
+
+template void 
+b2Distance(	b2DistanceOutput* output,
+		   b2SimplexCache* cache,
+		   const b2DistanceInput* input,
+		   const b2CircleShape* shapeA,
+		   const b2CapsuleShape* shapeB);
+
+template void 
+b2Distance(	b2DistanceOutput* output,
+		   b2SimplexCache* cache,
+		   const b2DistanceInput* input,
+		   const b2EdgeShape* shapeA,
+		   const b2CapsuleShape* shapeB);
+
+template void 
+b2Distance(	b2DistanceOutput* output,
+		   b2SimplexCache* cache,
+		   const b2DistanceInput* input,
+		   const b2PolygonShape* shapeA,
+		   const b2CapsuleShape* shapeB);
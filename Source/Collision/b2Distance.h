@@ -52,7 +52,7 @@ struct b2DistanceOutput
 };
 
 /// Compute the closest points between two shapes. Supports any combination of:
-/// b2CircleShape, b2PolygonShape, b2EdgeShape. The simplex cache is input/output.
+/// b2CircleShape, b2PolygonShape, b2EdgeShape, b2CapsuleShape. The simplex cache is input/output.
 /// On the first call set b2SimplexCache.count to zero.
 template <typename TA, typename TB>
 void b2Distance(b2DistanceOutput* output,
@@ -116,7 +116,7 @@ struct b2DistanceOutput
 };
 
 /// Compute the closest points between two shapes. Supports any combination of:
-/// b2CircleShape, b2PolygonShape, b2EdgeShape. The simplex cache is input/output.
+/// b2CircleShape, b2PolygonShape, b2EdgeShape, b2CapsuleShape. The simplex cache is input/output.
 /// On the first call set b2SimplexCache.count to zero.
 template <typename TA, typename TB>
 void b2Distance(b2DistanceOutput* output,
@@ -180,7 +180,7 @@ struct b2DistanceOutput
 };
 
 /// Compute the closest points between two shapes. Supports any combination of:
-/// b2CircleShape, b2PolygonShape, b2EdgeShape. The simplex cache is input/output.
+/// b2CircleShape, b2PolygonShape, b2EdgeShape, b2CapsuleShape. The simplex cache is input/output.
 /// On the first call set b2SimplexCache.count to zero.
 template <typename TA, typename TB>
 void b2Distance(b2DistanceOutput* output,
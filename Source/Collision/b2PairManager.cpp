@@ -71,6 +71,7 @@ b2PairManager::b2PairManager()
 		m_hashTable[i] = b2_nullPair;
 	}
 	m_freePair = 0;
+	m_usedPairCount = 0;
 	for (int32 i = 0; i < b2_maxPairs; ++i)
 	{
 		m_pairs[i].proxyId1 = b2_nullProxy;
@@ -136,6 +137,7 @@ b2Pair* b2PairManager::AddPair(int32 proxyId1, int32 proxyId2)
 	uint16 pairIndex = m_freePair;
 	pair = m_pairs + pairIndex;
 	m_freePair = pair->next;
+	m_usedPairCount = b2Max(m_usedPairCount, pairIndex + 1);
 
 	pair->proxyId1 = (uint16)proxyId1;
 	pair->proxyId2 = (uint16)proxyId2;
@@ -110,6 +110,9 @@ public:
 	b2PairCallback *m_callback;
 	b2Pair m_pairs[b2_maxPairs];
 	uint16 m_freePair;
+
+	// The pairs from this index on were never used and are still as initialized.
+	int32 m_usedPairCount;
 	int32 m_pairCount;
 
 	b2BufferedPair m_pairBuffer[b2_maxPairs];
@@ -0,0 +1,157 @@
+/*
+* Copyright (c) 2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2StaticTree.h"
+
+// Partially sort the items so that the item at index k has its center in the
+// sorted position along the axis. Items before k are not greater and items
+// after k are not less.
+static void b2SelectMedian(int32* items, const b2Vec2* centers, int32 count, int32 k, int32 axis)
+{
+	int32 left = 0;
+	int32 right = count - 1;
+
+	while (left < right)
+	{
+		float32 pivot = (&centers[items[(left + right) >> 1]].x)[axis];
+
+		int32 i = left;
+		int32 j = right;
+		while (i <= j)
+		{
+			while ((&centers[items[i]].x)[axis] < pivot)
+			{
+				++i;
+			}
+
+			while (pivot < (&centers[items[j]].x)[axis])
+			{
+				--j;
+			}
+
+			if (i <= j)
+			{
+				int32 tmp = items[i];
+				items[i] = items[j];
+				items[j] = tmp;
+				++i;
+				--j;
+			}
+		}
+
+		if (k <= j)
+		{
+			right = j;
+		}
+		else if (k >= i)
+		{
+			left = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+b2StaticTree::b2StaticTree()
+{
+	m_nodes = NULL;
+	m_nodeCount = 0;
+}
+
+b2StaticTree::~b2StaticTree()
+{
+	Clear();
+}
+
+void b2StaticTree::Clear()
+{
+	if (m_nodes)
+	{
+		b2Free(m_nodes);
+		m_nodes = NULL;
+	}
+
+	m_nodeCount = 0;
+}
+
+void b2StaticTree::Build(const b2AABB* aabbs, int32 count)
+{
+	Clear();
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	// A binary tree with n leaves has 2n - 1 nodes.
+	m_nodes = (b2StaticTreeNode*)b2Alloc((2 * count - 1) * sizeof(b2StaticTreeNode));
+
+	int32* items = (int32*)b2Alloc(count * sizeof(int32));
+	b2Vec2* centers = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	for (int32 i = 0; i < count; ++i)
+	{
+		items[i] = i;
+		centers[i] = aabbs[i].GetCenter();
+	}
+
+	BuildRecursive(items, aabbs, centers, count);
+	b2Assert(m_nodeCount == 2 * count - 1);
+
+	b2Free(centers);
+	b2Free(items);
+}
+
+int32 b2StaticTree::BuildRecursive(int32* items, const b2AABB* aabbs, const b2Vec2* centers, int32 count)
+{
+	int32 nodeId = m_nodeCount++;
+	b2StaticTreeNode* node = m_nodes + nodeId;
+
+	if (count == 1)
+	{
+		node->aabb = aabbs[items[0]];
+		node->child2 = -1;
+		node->item = items[0];
+		return nodeId;
+	}
+
+	// Split along the longest axis of the item centers.
+	b2Vec2 lower = centers[items[0]];
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		lower = b2Min(lower, centers[items[i]]);
+		upper = b2Max(upper, centers[items[i]]);
+	}
+
+	b2Vec2 d = upper - lower;
+	int32 axis = d.x >= d.y ? 0 : 1;
+
+	int32 half = count >> 1;
+	b2SelectMedian(items, centers, count, half, axis);
+
+	node->item = -1;
+	BuildRecursive(items, aabbs, centers, half);
+	int32 child2 = BuildRecursive(items + half, aabbs, centers, count - half);
+
+	node->child2 = child2;
+	node->aabb.Combine(m_nodes[nodeId + 1].aabb, m_nodes[child2].aabb);
+
+	return nodeId;
+}
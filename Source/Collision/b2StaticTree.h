@@ -0,0 +1,229 @@
+/*
+* Copyright (c) 2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_STATIC_TREE_H
+#define B2_STATIC_TREE_H
+
+#include "b2Collision.h"
+
+/// A node in the static tree. Nodes are stored in depth first order, so the
+/// first child of an internal node immediately follows its parent.
+/// 16 + 4 + 4 = 24 bytes.
+struct b2StaticTreeNode
+{
+	bool IsLeaf() const
+	{
+		return item != -1;
+	}
+
+	b2AABB aabb;
+	int32 child2;	///< the second child of an internal node
+	int32 item;		///< the item index of a leaf, -1 for internal nodes
+};
+
+/// A static tree is a bounding volume hierarchy that is built once over a fixed
+/// set of items, such as the segments of a chain. It is built top-down by
+/// splitting at the median of the longest axis, so the height is always
+/// O(log n) regardless of the order of the input. Unlike b2DynamicTree it does
+/// not support insertion or removal, but it has no limit on the item count.
+class b2StaticTree
+{
+public:
+
+	/// Construct an empty tree.
+	b2StaticTree();
+
+	/// Destroy the tree, freeing the nodes.
+	~b2StaticTree();
+
+	/// Build the tree from the item bounds. Items are reported back by their
+	/// index into this array. This replaces any existing tree.
+	void Build(const b2AABB* aabbs, int32 count);
+
+	/// Free the nodes.
+	void Clear();
+
+	/// Get the bounds of all the items. The tree must not be empty.
+	const b2AABB& GetAABB() const;
+
+	/// Get the number of nodes.
+	int32 GetNodeCount() const;
+
+	/// Query an AABB for overlapping items. The callback class
+	/// is called with the index of each item that overlaps the supplied AABB.
+	template <typename T>
+	void Query(T* callback, const b2AABB& aabb) const;
+
+	/// Ray-cast against the items in the tree. The callback performs the exact
+	/// ray-cast against the item and reports a hit through the output.
+	/// @param input the ray-cast input data. The ray extends from p1 to p1 + maxFraction * (p2 - p1).
+	/// @param callback a callback class that is called for each item that may be hit by the ray.
+	template <typename T>
+	void RayCast(T* callback, const b2RayCastInput& input) const;
+
+private:
+
+	int32 BuildRecursive(int32* items, const b2AABB* aabbs, const b2Vec2* centers, int32 count);
+
+	b2StaticTreeNode* m_nodes;
+	int32 m_nodeCount;
+};
+
+inline const b2AABB& b2StaticTree::GetAABB() const
+{
+	b2Assert(m_nodeCount > 0);
+	return m_nodes[0].aabb;
+}
+
+inline int32 b2StaticTree::GetNodeCount() const
+{
+	return m_nodeCount;
+}
+
+template <typename T>
+inline void b2StaticTree::Query(T* callback, const b2AABB& aabb) const
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	// The tree height is bounded by the log of the item count.
+	const int32 k_stackSize = 64;
+	int32 stack[k_stackSize];
+
+	int32 count = 0;
+	stack[count++] = 0;
+
+	while (count > 0)
+	{
+		int32 nodeId = stack[--count];
+		const b2StaticTreeNode* node = m_nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, aabb) == false)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf())
+		{
+			callback->QueryCallback(node->item);
+		}
+		else
+		{
+			b2Assert(count + 1 < k_stackSize);
+			stack[count++] = node->child2;
+			stack[count++] = nodeId + 1;
+		}
+	}
+}
+
+template <typename T>
+inline void b2StaticTree::RayCast(T* callback, const b2RayCastInput& input) const
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	b2Vec2 p1 = input.p1;
+	b2Vec2 p2 = input.p2;
+	b2Vec2 r = p2 - p1;
+	b2Assert(r.LengthSquared() > 0.0f);
+	r.Normalize();
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2Cross(1.0f, r);
+	b2Vec2 abs_v = b2Abs(v);
+
+	float32 maxFraction = input.maxFraction;
+
+	// Build a bounding box for the segment.
+	b2AABB segmentAABB;
+	{
+		b2Vec2 t = p1 + maxFraction * (p2 - p1);
+		segmentAABB.lowerBound = b2Min(p1, t);
+		segmentAABB.upperBound = b2Max(p1, t);
+	}
+
+	const int32 k_stackSize = 64;
+	int32 stack[k_stackSize];
+
+	int32 count = 0;
+	stack[count++] = 0;
+
+	while (count > 0)
+	{
+		int32 nodeId = stack[--count];
+		const b2StaticTreeNode* node = m_nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, segmentAABB) == false)
+		{
+			continue;
+		}
+
+		// Separating axis for segment (Gino, p80).
+		// |dot(v, p1 - c)| > dot(|v|, h)
+		b2Vec2 c = node->aabb.GetCenter();
+		b2Vec2 h = node->aabb.GetExtents();
+		float32 separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+		if (separation > 0.0f)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf())
+		{
+			b2RayCastInput subInput;
+			subInput.p1 = input.p1;
+			subInput.p2 = input.p2;
+			subInput.maxFraction = maxFraction;
+
+			b2RayCastOutput output;
+			output.hit = false;
+
+			callback->RayCastCallback(&output, subInput, node->item);
+
+			if (output.hit)
+			{
+				// Early exit.
+				if (output.fraction == 0.0f)
+				{
+					return;
+				}
+
+				maxFraction = output.fraction;
+
+				// Update segment bounding box.
+				{
+					b2Vec2 t = p1 + maxFraction * (p2 - p1);
+					segmentAABB.lowerBound = b2Min(p1, t);
+					segmentAABB.upperBound = b2Max(p1, t);
+				}
+			}
+		}
+		else
+		{
+			b2Assert(count + 1 < k_stackSize);
+			stack[count++] = node->child2;
+			stack[count++] = nodeId + 1;
+		}
+	}
+}
+
+#endif
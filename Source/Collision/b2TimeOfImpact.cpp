@@ -22,6 +22,7 @@
 #include "Shapes/b2CircleShape.h"
 #include "Shapes/b2PolygonShape.h"
 #include "Shapes/b2EdgeShape.h"
+#include "Shapes/b2CapsuleShape.h"
 
 #include <stdio.h>
 
@@ -290,6 +291,8 @@ float32 b2TimeOfImpact(const b2TOIInput* input, const TA* shapeA, const TB* shap
 
 	const int32 k_maxIterations = 1000;	// TODO_ERIN b2Settings
 	int32 iter = 0;
+	int32 rootIterations = 0;
+	int32 maxRootIterations = 0;
 	float32 target = 0.0f;
 
 	// Prepare input for distance query.
@@ -441,7 +444,8 @@ float32 b2TimeOfImpact(const b2TOIInput* input, const TA* shapeA, const TB* shap
 				b2Assert(rootIterCount < 50);
 			}
 
-			b2_maxToiRootIters = b2Max(b2_maxToiRootIters, rootIterCount);
+			rootIterations += rootIterCount;
+			maxRootIterations = b2Max(maxRootIterations, rootIterCount);
 		}
 
 		// Ensure significant advancement.
@@ -460,7 +464,20 @@ float32 b2TimeOfImpact(const b2TOIInput* input, const TA* shapeA, const TB* shap
 		}
 	}
 
-	b2_maxToiIters = b2Max(b2_maxToiIters, iter);
+	if (input->counters)
+	{
+		b2TOICounters* counters = input->counters;
+		++counters->callCount;
+		counters->iterationCount += iter;
+		counters->rootIterationCount += rootIterations;
+		counters->maxIterations = b2Max(counters->maxIterations, iter);
+		counters->maxRootIterations = b2Max(counters->maxRootIterations, maxRootIterations);
+	}
+	else
+	{
+		b2_maxToiIters = b2Max(b2_maxToiIters, iter);
+		b2_maxToiRootIters = b2Max(b2_maxToiRootIters, maxRootIterations);
+	}
 
 	return alpha;
 }
@@ -494,3 +511,23 @@ b2TimeOfImpact(const b2TOIInput* input,	const b2PolygonShape* shapeA, const b2Ed
 template float32
 b2TimeOfImpact(const b2TOIInput* input,	const b2PolygonShape* shapeA, const b2PolygonShape* shapeB);
 
+template float32
+b2TimeOfImpact(const b2TOIInput* input,	const b2CapsuleShape* shapeA, const b2CircleShape* shapeB);
+
+template float32
+b2TimeOfImpact(const b2TOIInput* input,	const b2CapsuleShape* shapeA, const b2EdgeShape* shapeB);
+
+template float32
+b2TimeOfImpact(const b2TOIInput* input,	const b2CapsuleShape* shapeA, const b2PolygonShape* shapeB);
+
+template float32
+b2TimeOfImpact(const b2TOIInput* input,	const b2CapsuleShape* shapeA, const b2CapsuleShape* shapeB);
+
+template float32
+b2TimeOfImpact(const b2TOIInput* input,	const b2CircleShape* shapeA, const b2CapsuleShape* shapeB);
+
+template float32
+b2TimeOfImpact(const b2TOIInput* input,	const b2EdgeShape* shapeA, const b2CapsuleShape* shapeB);
+
+template float32
+b2TimeOfImpact(const b2TOIInput* input,	const b2PolygonShape* shapeA, const b2CapsuleShape* shapeB);
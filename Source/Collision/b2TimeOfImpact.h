@@ -22,14 +22,50 @@
 #include "../Common/b2Math.h"
 #include <limits.h>
 
+/// Work counters of b2TimeOfImpact, for profiling.
+struct b2TOICounters
+{
+	/// Set all counters to zero.
+	void SetZero()
+	{
+		callCount = 0;
+		iterationCount = 0;
+		rootIterationCount = 0;
+		maxIterations = 0;
+		maxRootIterations = 0;
+	}
+
+	/// Add the counters of another thread.
+	void Add(const b2TOICounters& counters)
+	{
+		callCount += counters.callCount;
+		iterationCount += counters.iterationCount;
+		rootIterationCount += counters.rootIterationCount;
+		maxIterations = b2Max(maxIterations, counters.maxIterations);
+		maxRootIterations = b2Max(maxRootIterations, counters.maxRootIterations);
+	}
+
+	int32 callCount;			///< calls of b2TimeOfImpact
+	int32 iterationCount;		///< conservative advancement iterations
+	int32 rootIterationCount;	///< root finder iterations
+	int32 maxIterations;		///< most advancement iterations of a call
+	int32 maxRootIterations;	///< most root finder iterations of an advancement
+};
+
 /// Inpute parameters for b2TimeOfImpact
 struct b2TOIInput
 {
+	b2TOIInput() : counters(NULL) {}
+
 	b2Sweep sweepA;
 	b2Sweep sweepB;
 	float32 sweepRadiusA;
 	float32 sweepRadiusB;
 	float32 tolerance;
+
+	/// If not NULL, the work of the call is added to these counters. Otherwise
+	/// only the global maxima are updated, which is not thread safe.
+	b2TOICounters* counters;
 };
 
 /// Compute the time when two shapes begin to touch or touch at a closer distance.
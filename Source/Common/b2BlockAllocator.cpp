@@ -22,6 +22,7 @@
 #include <climits>
 
 #include <cstring>
+#include <algorithm>
 
 int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] = 
 {
@@ -205,3 +206,242 @@ void b2BlockAllocator::Clear()
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 }
+
+void b2BlockAllocator::Reset()
+{
+	memset(m_freeLists, 0, sizeof(m_freeLists));
+
+	// Go backwards so the first chunks are allocated first.
+	for (int32 i = m_chunkCount - 1; i >= 0; --i)
+	{
+		b2Chunk* chunk = m_chunks + i;
+		int32 blockSize = chunk->blockSize;
+		int32 index = s_blockSizeLookup[blockSize];
+		int32 blockCount = b2_chunkSize / blockSize;
+		for (int32 j = 0; j < blockCount - 1; ++j)
+		{
+			b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * j);
+			b2Block* next = (b2Block*)((int8*)chunk->blocks + blockSize * (j + 1));
+			block->next = next;
+		}
+		b2Block* last = (b2Block*)((int8*)chunk->blocks + blockSize * (blockCount - 1));
+		last->next = m_freeLists[index];
+
+		m_freeLists[index] = chunk->blocks;
+	}
+}
+
+// The state holds the number of chunks, the number of free blocks of each size,
+// the free blocks in list order, a mask of the free blocks of each chunk and
+// the content of the used blocks. Free blocks only hold their link.
+const int32 b2_freeMaskSize = b2_chunkSize / (8 * 16);
+
+struct b2ChunkAddressLess
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		return chunks[a].blocks < chunks[b].blocks;
+	}
+
+	const b2Chunk* chunks;
+};
+
+int32 b2BlockAllocator::GetFreeCount(int32 index) const
+{
+	int32 count = 0;
+	for (b2Block* block = m_freeLists[index]; block; block = block->next)
+	{
+		++count;
+	}
+	return count;
+}
+
+int32 b2BlockAllocator::GetStateSize() const
+{
+	int32 size = (1 + b2_blockSizes) * sizeof(int32) + m_chunkCount * b2_freeMaskSize;
+
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		int32 blockSize = m_chunks[i].blockSize;
+		size += (b2_chunkSize / blockSize) * blockSize;
+	}
+
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		int32 freeCount = GetFreeCount(i);
+		size += freeCount * sizeof(b2Block*);
+		size -= freeCount * s_blockSizes[i];
+	}
+
+	return size;
+}
+
+void b2BlockAllocator::SaveState(void* buffer) const
+{
+	int8* p = (int8*)buffer;
+	memcpy(p, &m_chunkCount, sizeof(int32));
+	p += sizeof(int32);
+
+	int32 freeCounts[b2_blockSizes];
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		freeCounts[i] = GetFreeCount(i);
+	}
+	memcpy(p, freeCounts, sizeof(freeCounts));
+	p += sizeof(freeCounts);
+
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			memcpy(p, &block, sizeof(b2Block*));
+			p += sizeof(b2Block*);
+		}
+	}
+
+	// Find the chunk of each free block by a binary search over the chunks
+	// sorted by address.
+	uint8* masks = (uint8*)p;
+	memset(masks, 0, m_chunkCount * b2_freeMaskSize);
+	p += m_chunkCount * b2_freeMaskSize;
+
+	int32* order = (int32*)b2Alloc(m_chunkCount * sizeof(int32));
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		order[i] = i;
+	}
+	b2ChunkAddressLess less;
+	less.chunks = m_chunks;
+	std::sort(order, order + m_chunkCount, less);
+
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		for (b2Block* block = m_freeLists[i]; block; block = block->next)
+		{
+			int32 low = 0;
+			int32 high = m_chunkCount - 1;
+			while (low < high)
+			{
+				int32 mid = (low + high + 1) / 2;
+				if ((int8*)m_chunks[order[mid]].blocks <= (int8*)block)
+				{
+					low = mid;
+				}
+				else
+				{
+					high = mid - 1;
+				}
+			}
+
+			int32 chunkIndex = order[low];
+			b2Assert(m_chunks[chunkIndex].blockSize == s_blockSizes[i]);
+			int32 blockIndex = (int32)((int8*)block - (int8*)m_chunks[chunkIndex].blocks) / s_blockSizes[i];
+			masks[chunkIndex * b2_freeMaskSize + (blockIndex >> 3)] |= uint8(1 << (blockIndex & 7));
+		}
+	}
+
+	b2Free(order);
+
+	// Copy the runs of used blocks.
+	for (int32 i = 0; i < m_chunkCount; ++i)
+	{
+		const b2Chunk* chunk = m_chunks + i;
+		const uint8* mask = masks + i * b2_freeMaskSize;
+		int32 blockSize = chunk->blockSize;
+		int32 blockCount = b2_chunkSize / blockSize;
+		int32 j = 0;
+		while (j < blockCount)
+		{
+			if (mask[j >> 3] & (1 << (j & 7)))
+			{
+				++j;
+				continue;
+			}
+
+			int32 first = j;
+			while (j < blockCount && (mask[j >> 3] & (1 << (j & 7))) == 0)
+			{
+				++j;
+			}
+
+			int32 size = (j - first) * blockSize;
+			memcpy(p, (int8*)chunk->blocks + first * blockSize, size);
+			p += size;
+		}
+	}
+}
+
+void b2BlockAllocator::RestoreState(const void* buffer)
+{
+	const int8* p = (const int8*)buffer;
+	int32 chunkCount;
+	memcpy(&chunkCount, p, sizeof(int32));
+	p += sizeof(int32);
+
+	int32 freeCounts[b2_blockSizes];
+	memcpy(freeCounts, p, sizeof(freeCounts));
+	p += sizeof(freeCounts);
+
+	// Chunks are only added, so the saved chunks are still the first ones.
+	b2Assert(chunkCount <= m_chunkCount);
+
+	for (int32 i = 0; i < b2_blockSizes; ++i)
+	{
+		b2Block** link = m_freeLists + i;
+		for (int32 j = 0; j < freeCounts[i]; ++j)
+		{
+			b2Block* block;
+			memcpy(&block, p, sizeof(b2Block*));
+			p += sizeof(b2Block*);
+			*link = block;
+			link = &block->next;
+		}
+		*link = NULL;
+	}
+
+	const uint8* masks = (const uint8*)p;
+	p += chunkCount * b2_freeMaskSize;
+
+	for (int32 i = 0; i < chunkCount; ++i)
+	{
+		b2Chunk* chunk = m_chunks + i;
+		const uint8* mask = masks + i * b2_freeMaskSize;
+		int32 blockSize = chunk->blockSize;
+		int32 blockCount = b2_chunkSize / blockSize;
+		int32 j = 0;
+		while (j < blockCount)
+		{
+			if (mask[j >> 3] & (1 << (j & 7)))
+			{
+				++j;
+				continue;
+			}
+
+			int32 first = j;
+			while (j < blockCount && (mask[j >> 3] & (1 << (j & 7))) == 0)
+			{
+				++j;
+			}
+
+			int32 size = (j - first) * blockSize;
+			memcpy((int8*)chunk->blocks + first * blockSize, p, size);
+			p += size;
+		}
+	}
+
+	// Free the blocks of the newer chunks, otherwise every restore would
+	// lose them.
+	for (int32 i = chunkCount; i < m_chunkCount; ++i)
+	{
+		b2Chunk* chunk = m_chunks + i;
+		int32 blockSize = chunk->blockSize;
+		int32 index = s_blockSizeLookup[blockSize];
+		int32 blockCount = b2_chunkSize / blockSize;
+		for (int32 j = 0; j < blockCount; ++j)
+		{
+			b2Block* block = (b2Block*)((int8*)chunk->blocks + blockSize * j);
+			block->next = m_freeLists[index];
+			m_freeLists[index] = block;
+		}
+	}
+}
@@ -43,8 +43,21 @@ public:
 
 	void Clear();
 
+	// Make all blocks free again while keeping the chunks. The blocks
+	// must no longer be in use.
+	void Reset();
+
+	// Save the content of the used blocks and the free lists. Restoring brings
+	// back the blocks as they were saved, the chunks are kept and the blocks of
+	// chunks that were added since are free.
+	int32 GetStateSize() const;
+	void SaveState(void* buffer) const;
+	void RestoreState(const void* buffer);
+
 private:
 
+	int32 GetFreeCount(int32 index) const;
+
 	b2Chunk* m_chunks;
 	int32 m_chunkCount;
 	int32 m_chunkSpace;
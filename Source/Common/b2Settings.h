@@ -106,12 +106,6 @@ typedef float float32;
 
 // Dynamics
 
-/// Maximum number of contacts to be handled to solve a TOI island.
-#define b2_maxTOIContactsPerIsland	32
-
-/// Maximum number of joints to be handled to solve a TOI island.
-#define b2_maxTOIJointsPerIsland	32
-
 /// A velocity threshold for elastic collisions. Any collision with a relative linear
 /// velocity below this threshold will be treated as inelastic.
 #define b2_velocityThreshold		1.0f
@@ -139,6 +133,31 @@ typedef float float32;
 /// to overshoot.
 #define b2_contactBaumgarte			0.2f
 
+/// Islands with at least this many contacts are solved one at a time, with the
+/// contacts of each color spread over the threads of the task scheduler.
+#define b2_largeIslandContactCount	256
+
+/// The velocity iterations of an island stop once an iteration changes no body
+/// velocity by more than this. The unit is m/s for linear and rad/s for angular
+/// velocities. Zero always runs all iterations.
+#define b2_velocityTolerance		0.0f
+
+/// The number of velocity iterations an island runs before it may stop early.
+#define b2_minVelocityIterations	1
+
+// Soft step
+
+/// The stiffness of soft contacts in the soft step. This is limited to a quarter
+/// of the sub-step rate.
+#define b2_contactHertz				30.0f
+
+/// The damping ratio of soft contacts. Soft contacts are over damped so they
+/// don't bounce.
+#define b2_contactDampingRatio		10.0f
+
+/// The maximum velocity used by soft contacts to push overlapping shapes apart.
+#define b2_contactPushVelocity		3.0f
+
 // Sleep
 
 /// The time that a body must be still before it will go to sleep.
@@ -150,6 +169,10 @@ typedef float float32;
 /// A body cannot sleep if its angular velocity is above this tolerance.
 #define b2_angularSleepTolerance	(2.0f / 180.0f * b2_pi)
 
+/// A sleeping body that touches an awake island wakes when the solver pushes it
+/// harder than its resting load by more than this velocity change.
+#define b2_wakeVelocityTolerance	0.1f
+
 // Memory Allocation
 
 /// The current number of bytes allocated through b2Alloc.
@@ -0,0 +1,130 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2ChainAndCapsuleContact.h"
+#include "../b2Body.h"
+#include "../b2Fixture.h"
+#include "../../Collision/Shapes/b2ChainShape.h"
+#include "../../Collision/Shapes/b2CapsuleShape.h"
+#include "../../Collision/Shapes/b2EdgeShape.h"
+#include "../../Collision/b2TimeOfImpact.h"
+#include "../../Common/b2BlockAllocator.h"
+
+#include <new>
+
+// Collides the capsule with each chain segment reported by the segment tree.
+struct b2ChainAndCapsuleCallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		chain->GetChildEdge(&edge, index);
+
+		b2Manifold manifold;
+		b2CollideEdgeAndCapsule(&manifold, &edge, xfA, capsule, xfB);
+
+		if (manifold.m_pointCount > 0)
+		{
+			contact->AddChild(index, manifold);
+		}
+	}
+
+	b2ChainAndCapsuleContact* contact;
+	const b2ChainShape* chain;
+	const b2CapsuleShape* capsule;
+	b2XForm xfA;
+	b2XForm xfB;
+};
+
+// Finds the earliest time of impact of the capsule with the chain segments.
+struct b2ChainAndCapsuleTOICallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		chain->GetChildEdge(&edge, index);
+
+		input.sweepRadiusA = edge.ComputeSweepRadius(input.sweepA.localCenter);
+		toi = b2Min(toi, b2TimeOfImpact(&input, &edge, capsule));
+	}
+
+	b2TOIInput input;
+	const b2ChainShape* chain;
+	const b2CapsuleShape* capsule;
+	float32 toi;
+};
+
+b2Contact* b2ChainAndCapsuleContact::Create(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2ChainAndCapsuleContact));
+	return new (mem) b2ChainAndCapsuleContact(fixtureA, fixtureB);
+}
+
+void b2ChainAndCapsuleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2ChainAndCapsuleContact*)contact)->~b2ChainAndCapsuleContact();
+	allocator->Free(contact, sizeof(b2ChainAndCapsuleContact));
+}
+
+b2ChainAndCapsuleContact::b2ChainAndCapsuleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+: b2CompositeContact(fixtureA, fixtureB)
+{
+	b2Assert(m_fixtureA->GetType() == b2_chainShape);
+	b2Assert(m_fixtureB->GetType() == b2_capsuleShape);
+}
+
+void b2ChainAndCapsuleContact::Evaluate()
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2ChainAndCapsuleCallback callback;
+	callback.contact = this;
+	callback.chain = (b2ChainShape*)m_fixtureA->GetShape();
+	callback.capsule = (b2CapsuleShape*)m_fixtureB->GetShape();
+	callback.xfA = bodyA->GetXForm();
+	callback.xfB = bodyB->GetXForm();
+
+	// Bound the capsule in the frame of the chain.
+	b2XForm xf(b2MulT(callback.xfA, callback.xfB.position), b2MulT(callback.xfA.R, callback.xfB.R));
+	b2AABB aabb;
+	callback.capsule->ComputeAABB(&aabb, xf);
+
+	BeginChildren();
+	callback.chain->QueryChildren(&callback, aabb);
+	EndChildren();
+}
+
+float32 b2ChainAndCapsuleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
+{
+	b2ChainAndCapsuleTOICallback callback;
+	callback.input.sweepA = sweepA;
+	callback.input.sweepB = sweepB;
+	callback.input.sweepRadiusB = m_fixtureB->ComputeSweepRadius(sweepB.localCenter);
+	callback.input.tolerance = b2_linearSlop;
+	callback.input.counters = counters;
+	callback.chain = (const b2ChainShape*)m_fixtureA->GetShape();
+	callback.capsule = (const b2CapsuleShape*)m_fixtureB->GetShape();
+	callback.toi = 1.0f;
+
+	b2AABB aabb;
+	ComputeSweptAABB(&aabb, callback.capsule, sweepB, callback.input.sweepRadiusB, sweepA);
+	callback.chain->QueryChildren(&callback, aabb);
+
+	return callback.toi;
+}
@@ -0,0 +1,43 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef CHAIN_AND_CAPSULE_CONTACT_H
+#define CHAIN_AND_CAPSULE_CONTACT_H
+
+#include "b2CompositeContact.h"
+
+class b2BlockAllocator;
+
+class b2ChainAndCapsuleContact : public b2CompositeContact
+{
+public:
+	static b2Contact* Create(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator);
+	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
+
+	b2ChainAndCapsuleContact(b2Fixture* fixtureA, b2Fixture* fixtureB);
+	~b2ChainAndCapsuleContact() {}
+
+	void Evaluate();
+
+	float32 ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const;
+
+private:
+	friend struct b2ChainAndCapsuleCallback;
+};
+
+#endif
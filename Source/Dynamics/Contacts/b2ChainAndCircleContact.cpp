@@ -0,0 +1,132 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2ChainAndCircleContact.h"
+#include "../b2Body.h"
+#include "../b2Fixture.h"
+#include "../../Collision/Shapes/b2ChainShape.h"
+#include "../../Collision/Shapes/b2CircleShape.h"
+#include "../../Collision/Shapes/b2EdgeShape.h"
+#include "../../Collision/b2TimeOfImpact.h"
+#include "../../Common/b2BlockAllocator.h"
+
+#include <new>
+
+// Collides the circle with each chain segment reported by the segment tree.
+struct b2ChainAndCircleCallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		chain->GetChildEdge(&edge, index);
+
+		b2Manifold manifold;
+		b2CollideEdgeAndCircle(&manifold, &edge, xfA, circle, xfB);
+
+		if (manifold.m_pointCount > 0)
+		{
+			contact->AddChild(index, manifold);
+		}
+	}
+
+	b2ChainAndCircleContact* contact;
+	const b2ChainShape* chain;
+	const b2CircleShape* circle;
+	b2XForm xfA;
+	b2XForm xfB;
+};
+
+// Finds the earliest time of impact of the circle with the chain segments.
+struct b2ChainAndCircleTOICallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		chain->GetChildEdge(&edge, index);
+
+		input.sweepRadiusA = edge.ComputeSweepRadius(input.sweepA.localCenter);
+		toi = b2Min(toi, b2TimeOfImpact(&input, &edge, circle));
+	}
+
+	b2TOIInput input;
+	const b2ChainShape* chain;
+	const b2CircleShape* circle;
+	float32 toi;
+};
+
+b2Contact* b2ChainAndCircleContact::Create(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2ChainAndCircleContact));
+	return new (mem) b2ChainAndCircleContact(fixtureA, fixtureB);
+}
+
+void b2ChainAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2ChainAndCircleContact*)contact)->~b2ChainAndCircleContact();
+	allocator->Free(contact, sizeof(b2ChainAndCircleContact));
+}
+
+b2ChainAndCircleContact::b2ChainAndCircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+: b2CompositeContact(fixtureA, fixtureB)
+{
+	b2Assert(m_fixtureA->GetType() == b2_chainShape);
+	b2Assert(m_fixtureB->GetType() == b2_circleShape);
+}
+
+void b2ChainAndCircleContact::Evaluate()
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2ChainAndCircleCallback callback;
+	callback.contact = this;
+	callback.chain = (b2ChainShape*)m_fixtureA->GetShape();
+	callback.circle = (b2CircleShape*)m_fixtureB->GetShape();
+	callback.xfA = bodyA->GetXForm();
+	callback.xfB = bodyB->GetXForm();
+
+	// Bound the circle in the frame of the chain.
+	b2Vec2 center = b2MulT(callback.xfA, b2Mul(callback.xfB, callback.circle->m_p));
+	b2Vec2 r(callback.circle->m_radius, callback.circle->m_radius);
+	b2AABB aabb;
+	aabb.lowerBound = center - r;
+	aabb.upperBound = center + r;
+
+	BeginChildren();
+	callback.chain->QueryChildren(&callback, aabb);
+	EndChildren();
+}
+
+float32 b2ChainAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
+{
+	b2ChainAndCircleTOICallback callback;
+	callback.input.sweepA = sweepA;
+	callback.input.sweepB = sweepB;
+	callback.input.sweepRadiusB = m_fixtureB->ComputeSweepRadius(sweepB.localCenter);
+	callback.input.tolerance = b2_linearSlop;
+	callback.input.counters = counters;
+	callback.chain = (const b2ChainShape*)m_fixtureA->GetShape();
+	callback.circle = (const b2CircleShape*)m_fixtureB->GetShape();
+	callback.toi = 1.0f;
+
+	b2AABB aabb;
+	ComputeSweptAABB(&aabb, callback.circle, sweepB, callback.input.sweepRadiusB, sweepA);
+	callback.chain->QueryChildren(&callback, aabb);
+
+	return callback.toi;
+}
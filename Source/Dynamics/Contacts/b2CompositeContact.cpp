@@ -0,0 +1,196 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2CompositeContact.h"
+
+#include <string.h>
+
+b2CompositeContact::b2CompositeContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+: b2Contact(fixtureA, fixtureB)
+{
+	for (int32 i = 0; i < 2; ++i)
+	{
+		m_childManifolds[i] = NULL;
+		m_childIndices[i] = NULL;
+		m_childCapacity[i] = 0;
+		m_childCount[i] = 0;
+	}
+
+	m_current = 0;
+}
+
+b2CompositeContact::~b2CompositeContact()
+{
+	for (int32 i = 0; i < 2; ++i)
+	{
+		if (m_childManifolds[i])
+		{
+			b2Free(m_childManifolds[i]);
+			b2Free(m_childIndices[i]);
+		}
+	}
+}
+
+void b2CompositeContact::BeginChildren()
+{
+	m_current ^= 1;
+	m_childCount[m_current] = 0;
+}
+
+void b2CompositeContact::AddChild(int32 childIndex, const b2Manifold& manifold)
+{
+	b2Assert(manifold.m_pointCount > 0);
+
+	int32 k = m_current;
+	int32 count = m_childCount[k];
+
+	if (count == m_childCapacity[k])
+	{
+		// Grow the buffer.
+		int32 capacity = b2Max(4, 2 * m_childCapacity[k]);
+		b2Manifold* manifolds = (b2Manifold*)b2Alloc(capacity * sizeof(b2Manifold));
+		int32* indices = (int32*)b2Alloc(capacity * sizeof(int32));
+
+		if (m_childManifolds[k])
+		{
+			memcpy(manifolds, m_childManifolds[k], count * sizeof(b2Manifold));
+			memcpy(indices, m_childIndices[k], count * sizeof(int32));
+			b2Free(m_childManifolds[k]);
+			b2Free(m_childIndices[k]);
+		}
+
+		m_childManifolds[k] = manifolds;
+		m_childIndices[k] = indices;
+		m_childCapacity[k] = capacity;
+	}
+
+	b2Manifold* newManifold = m_childManifolds[k] + count;
+	*newManifold = manifold;
+	m_childIndices[k][count] = childIndex;
+	m_childCount[k] = count + 1;
+
+	// Warm start from the same child in the previous update.
+	int32 old = k ^ 1;
+	for (int32 i = 0; i < m_childCount[old]; ++i)
+	{
+		if (m_childIndices[old][i] == childIndex)
+		{
+			WarmStart(newManifold, m_childManifolds[old] + i);
+			return;
+		}
+	}
+
+	for (int32 i = 0; i < newManifold->m_pointCount; ++i)
+	{
+		newManifold->m_points[i].m_normalImpulse = 0.0f;
+		newManifold->m_points[i].m_tangentImpulse = 0.0f;
+	}
+}
+
+void b2CompositeContact::EndChildren()
+{
+	int32 k = m_current;
+	if (m_childCount[k] > 0)
+	{
+		m_manifolds = m_childManifolds[k];
+		m_manifoldCount = m_childCount[k];
+	}
+	else
+	{
+		m_manifold.m_pointCount = 0;
+		m_manifolds = &m_manifold;
+		m_manifoldCount = 1;
+	}
+}
+
+int32 b2CompositeContact::GetStateSize() const
+{
+	return m_childCount[m_current] * (sizeof(b2Manifold) + sizeof(int32));
+}
+
+void b2CompositeContact::SaveState(void* buffer) const
+{
+	int32 k = m_current;
+	int32 count = m_childCount[k];
+	if (count == 0)
+	{
+		return;
+	}
+
+	int8* p = (int8*)buffer;
+	memcpy(p, m_childManifolds[k], count * sizeof(b2Manifold));
+	p += count * sizeof(b2Manifold);
+	memcpy(p, m_childIndices[k], count * sizeof(int32));
+}
+
+void b2CompositeContact::RestoreState(const void* buffer)
+{
+	// The buffers of the previous update are not needed, the next update
+	// only warm starts from the current one.
+	for (int32 i = 0; i < 2; ++i)
+	{
+		m_childManifolds[i] = NULL;
+		m_childIndices[i] = NULL;
+		m_childCapacity[i] = 0;
+	}
+
+	int32 k = m_current;
+	int32 count = m_childCount[k];
+	m_childCount[k ^ 1] = 0;
+
+	if (count == 0)
+	{
+		return;
+	}
+
+	const int8* p = (const int8*)buffer;
+	m_childManifolds[k] = (b2Manifold*)b2Alloc(count * sizeof(b2Manifold));
+	m_childIndices[k] = (int32*)b2Alloc(count * sizeof(int32));
+	m_childCapacity[k] = count;
+	memcpy((void*)m_childManifolds[k], p, count * sizeof(b2Manifold));
+	p += count * sizeof(b2Manifold);
+	memcpy(m_childIndices[k], p, count * sizeof(int32));
+
+	// EndChildren pointed the contact at the current manifolds.
+	m_manifolds = m_childManifolds[k];
+}
+
+void b2CompositeContact::ComputeSweptAABB(b2AABB* aabb, const b2Shape* shape, const b2Sweep& sweep,
+										  float32 sweepRadius, const b2Sweep& compositeSweep)
+{
+	b2XForm xf1, xf2, compositeXF1, compositeXF2;
+	sweep.GetTransform(&xf1, 0.0f);
+	sweep.GetTransform(&xf2, 1.0f);
+	compositeSweep.GetTransform(&compositeXF1, 0.0f);
+	compositeSweep.GetTransform(&compositeXF2, 1.0f);
+
+	b2XForm localXF1(b2MulT(compositeXF1, xf1.position), b2MulT(compositeXF1.R, xf1.R));
+	b2XForm localXF2(b2MulT(compositeXF2, xf2.position), b2MulT(compositeXF2.R, xf2.R));
+
+	b2AABB aabb1, aabb2;
+	shape->ComputeAABB(&aabb1, localXF1);
+	shape->ComputeAABB(&aabb2, localXF2);
+	aabb->Combine(aabb1, aabb2);
+
+	// The end points miss the bulge of the rotation in between.
+	float32 angle = b2Abs((sweep.a - sweep.a0) - (compositeSweep.a - compositeSweep.a0));
+	float32 margin = sweepRadius * b2Min(angle, b2_pi);
+	b2Vec2 r(margin, margin);
+	aabb->lowerBound -= r;
+	aabb->upperBound += r;
+}
@@ -0,0 +1,62 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef COMPOSITE_CONTACT_H
+#define COMPOSITE_CONTACT_H
+
+#include "b2Contact.h"
+
+/// A contact between a convex shape and a shape made of many child segments,
+/// such as a chain. Only the children that overlap the convex shape are
+/// collided and every touching child gets its own manifold. The manifolds
+/// of the previous update are kept so that impulses are matched per child
+/// for warm starting.
+class b2CompositeContact : public b2Contact
+{
+protected:
+	b2CompositeContact(b2Fixture* fixtureA, b2Fixture* fixtureB);
+	~b2CompositeContact();
+
+	/// Start collecting the manifolds of the touching children.
+	void BeginChildren();
+
+	/// Add the manifold of a touching child.
+	void AddChild(int32 childIndex, const b2Manifold& manifold);
+
+	/// Make the collected manifolds the manifolds of this contact.
+	void EndChildren();
+
+	/// Save and restore the current child manifolds.
+	int32 GetStateSize() const;
+	void SaveState(void* buffer) const;
+	void RestoreState(const void* buffer);
+
+	/// Compute the AABB of a convex shape over its sweep, in the frame of the
+	/// composite shape. This is used to find the children for TOI.
+	static void ComputeSweptAABB(b2AABB* aabb, const b2Shape* shape, const b2Sweep& sweep,
+								 float32 sweepRadius, const b2Sweep& compositeSweep);
+
+	// Double buffered child manifolds, the other buffer holds the previous update.
+	b2Manifold* m_childManifolds[2];
+	int32* m_childIndices[2];
+	int32 m_childCapacity[2];
+	int32 m_childCount[2];
+	int32 m_current;
+};
+
+#endif
@@ -22,6 +22,22 @@
 #include "b2PolyContact.h"
 #include "b2EdgeAndCircleContact.h"
 #include "b2PolyAndEdgeContact.h"
+#include "b2ChainAndCircleContact.h"
+#include "b2PolyAndChainContact.h"
+#include "b2HeightfieldAndCircleContact.h"
+#include "b2PolyAndHeightfieldContact.h"
+#include "b2MeshAndCircleContact.h"
+#include "b2PolyAndMeshContact.h"
+#include "b2CapsuleAndCircleContact.h"
+#include "b2CapsuleContact.h"
+#include "b2PolyAndCapsuleContact.h"
+#include "b2EdgeAndCapsuleContact.h"
+#include "b2ChainAndCapsuleContact.h"
+#include "b2HeightfieldAndCapsuleContact.h"
+#include "b2MeshAndCapsuleContact.h"
+#include "b2GridAndCircleContact.h"
+#include "b2PolyAndGridContact.h"
+#include "b2GridAndCapsuleContact.h"
 #include "b2ContactSolver.h"
 #include "../../Collision/b2Collision.h"
 #include "../../Collision/Shapes/b2Shape.h"
@@ -41,6 +57,27 @@ void b2Contact::InitializeRegisters()
 	
 	AddType(b2EdgeAndCircleContact::Create, b2EdgeAndCircleContact::Destroy, b2_edgeShape, b2_circleShape);
 	AddType(b2PolyAndEdgeContact::Create, b2PolyAndEdgeContact::Destroy, b2_polygonShape, b2_edgeShape);
+
+	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2_chainShape, b2_circleShape);
+	AddType(b2PolyAndChainContact::Create, b2PolyAndChainContact::Destroy, b2_polygonShape, b2_chainShape);
+
+	AddType(b2HeightfieldAndCircleContact::Create, b2HeightfieldAndCircleContact::Destroy, b2_heightfieldShape, b2_circleShape);
+	AddType(b2PolyAndHeightfieldContact::Create, b2PolyAndHeightfieldContact::Destroy, b2_polygonShape, b2_heightfieldShape);
+
+	AddType(b2MeshAndCircleContact::Create, b2MeshAndCircleContact::Destroy, b2_meshShape, b2_circleShape);
+	AddType(b2PolyAndMeshContact::Create, b2PolyAndMeshContact::Destroy, b2_polygonShape, b2_meshShape);
+
+	AddType(b2CapsuleAndCircleContact::Create, b2CapsuleAndCircleContact::Destroy, b2_capsuleShape, b2_circleShape);
+	AddType(b2CapsuleContact::Create, b2CapsuleContact::Destroy, b2_capsuleShape, b2_capsuleShape);
+	AddType(b2PolyAndCapsuleContact::Create, b2PolyAndCapsuleContact::Destroy, b2_polygonShape, b2_capsuleShape);
+	AddType(b2EdgeAndCapsuleContact::Create, b2EdgeAndCapsuleContact::Destroy, b2_edgeShape, b2_capsuleShape);
+	AddType(b2ChainAndCapsuleContact::Create, b2ChainAndCapsuleContact::Destroy, b2_chainShape, b2_capsuleShape);
+	AddType(b2HeightfieldAndCapsuleContact::Create, b2HeightfieldAndCapsuleContact::Destroy, b2_heightfieldShape, b2_capsuleShape);
+	AddType(b2MeshAndCapsuleContact::Create, b2MeshAndCapsuleContact::Destroy, b2_meshShape, b2_capsuleShape);
+
+	AddType(b2GridAndCircleContact::Create, b2GridAndCircleContact::Destroy, b2_gridShape, b2_circleShape);
+	AddType(b2PolyAndGridContact::Create, b2PolyAndGridContact::Destroy, b2_polygonShape, b2_gridShape);
+	AddType(b2GridAndCapsuleContact::Create, b2GridAndCapsuleContact::Destroy, b2_gridShape, b2_capsuleShape);
 }
 
 void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
@@ -101,12 +138,6 @@ void b2Contact::Destroy(b2Contact* contact, b2ShapeType typeA, b2ShapeType typeB
 {
 	b2Assert(s_initialized == true);
 
-	if (contact->m_manifold.m_pointCount > 0)
-	{
-		contact->GetFixtureA()->GetBody()->WakeUp();
-		contact->GetFixtureB()->GetBody()->WakeUp();
-	}
-
 	b2Assert(b2_unknownShape < typeA && typeB < b2_shapeTypeCount);
 	b2Assert(b2_unknownShape < typeA && typeB < b2_shapeTypeCount);
 
@@ -114,6 +145,29 @@ void b2Contact::Destroy(b2Contact* contact, b2ShapeType typeA, b2ShapeType typeB
 	destroyFcn(contact, allocator);
 }
 
+void b2Contact::WarmStart(b2Manifold* manifold, const b2Manifold* oldManifold)
+{
+	for (int32 i = 0; i < manifold->m_pointCount; ++i)
+	{
+		b2ManifoldPoint* mp2 = manifold->m_points + i;
+		mp2->m_normalImpulse = 0.0f;
+		mp2->m_tangentImpulse = 0.0f;
+		b2ContactID id2 = mp2->m_id;
+
+		for (int32 j = 0; j < oldManifold->m_pointCount; ++j)
+		{
+			const b2ManifoldPoint* mp1 = oldManifold->m_points + j;
+
+			if (mp1->m_id.key == id2.key)
+			{
+				mp2->m_normalImpulse = mp1->m_normalImpulse;
+				mp2->m_tangentImpulse = mp1->m_tangentImpulse;
+				break;
+			}
+		}
+	}
+}
+
 b2Contact::b2Contact(b2Fixture* fA, b2Fixture* fB)
 {
 	m_flags = 0;
@@ -127,6 +181,14 @@ b2Contact::b2Contact(b2Fixture* fA, b2Fixture* fB)
 	m_fixtureB = fB;
 
 	m_manifold.m_pointCount = 0;
+	m_manifolds = &m_manifold;
+	m_manifoldCount = 1;
+
+	m_speculativeDistance = 0.0f;
+
+	m_toiIndex = -1;
+	m_activeIndex = -1;
+	m_islandEpoch = 0;
 
 	m_prev = NULL;
 	m_next = NULL;
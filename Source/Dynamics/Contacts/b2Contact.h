@@ -31,6 +31,7 @@ class b2World;
 class b2BlockAllocator;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2TOICounters;
 
 typedef b2Contact* b2ContactCreateFcn(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator);
 typedef void b2ContactDestroyFcn(b2Contact* contact, b2BlockAllocator* allocator);
@@ -62,11 +63,17 @@ class b2Contact
 {
 public:
 
-	/// Get the contact manifold.
+	/// Get the contact manifold. Contacts with a chain have one manifold per
+	/// touching segment, stored contiguously.
+	/// @see GetManifoldCount
 	b2Manifold* GetManifold();
 
+	/// Get the number of manifolds. This is one for contacts between convex shapes.
+	int32 GetManifoldCount() const;
+
 	/// Get the world manifold.
-	void GetWorldManifold(b2WorldManifold* worldManifold) const;
+	/// @param index the manifold index, less than GetManifoldCount().
+	void GetWorldManifold(b2WorldManifold* worldManifold, int32 index = 0) const;
 
 	/// Is this contact solid?
 	/// @return true if this contact should generate a response.
@@ -108,7 +115,10 @@ public:
 protected:
 	friend class b2ContactManager;
 	friend class b2World;
+	friend class b2Island;
+	friend class b2IslandManager;
 	friend class b2ContactSolver;
+	friend class b2TOIQueue;
 
 	// m_flags
 	enum
@@ -118,9 +128,8 @@ protected:
 		e_nonSolidFlag	= 0x0001,
 		// Do not use TOI solve.
 		e_slowFlag		= 0x0002,
-		// Used when crawling contact graph when forming islands.
-		e_islandFlag	= 0x0004,
-		// Used in SolveTOI to indicate the cached toi value is still valid.
+		// Used in SolveTOI to indicate the cached toi value is still valid
+		// and the contact is in the TOI queue.
 		e_toiFlag		= 0x0008,
         // TODO: Doc
 		e_touchFlag		= 0x0010,
@@ -133,6 +142,11 @@ protected:
 		// Meaning it should be deferred instead of destroyed.
 		// This is essntially a poor mans recursive lock.
 		e_lockedFlag	= 0x0080,
+		// This contact type can report speculative points.
+		e_speculativeFlag	= 0x0100,
+		// The solver pushed a sleeping body of this contact harder than
+		// when it fell asleep, so it should wake.
+		e_wakeFlag		= 0x0200,
 	};
 
 	static void AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destroyFcn,
@@ -142,13 +156,26 @@ protected:
     static void Destroy(b2Contact* contact, b2ShapeType typeA, b2ShapeType typeB, b2BlockAllocator* allocator);
 	static void Destroy(b2Contact* contact, b2BlockAllocator* allocator);
 
-	b2Contact() : m_fixtureA(NULL), m_fixtureB(NULL) {}
+	/// Copy the impulses of matching points from the old manifold for warm starting.
+	static void WarmStart(b2Manifold* manifold, const b2Manifold* oldManifold);
+
+	b2Contact() : m_fixtureA(NULL), m_fixtureB(NULL), m_manifolds(&m_manifold), m_manifoldCount(1) {}
 	b2Contact(b2Fixture* fixtureA, b2Fixture* fixtureB);
 	virtual ~b2Contact() {}
 
 	virtual void Evaluate() = 0;
 
-	virtual float32 ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB) const = 0;
+	virtual float32 ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const = 0;
+
+	// Contacts that keep manifolds on the heap save them with the world state,
+	// see b2World::SaveState. The heap memory is freed before a restore, so the
+	// restored contact must allocate it again.
+	virtual int32 GetStateSize() const { return 0; }
+	virtual void SaveState(void* buffer) const { B2_NOT_USED(buffer); }
+	virtual void RestoreState(const void* buffer) { B2_NOT_USED(buffer); }
+
+	// The total number of points in all manifolds.
+	int32 GetPointCount() const;
 
 	static b2ContactRegister s_registers[b2_shapeTypeCount][b2_shapeTypeCount];
 	static bool s_initialized;
@@ -168,24 +195,62 @@ protected:
 
 	b2Manifold m_manifold;
 
+	// Convex contacts point this at m_manifold. Contacts with a chain point this
+	// at the manifolds of the touching segments.
+	b2Manifold* m_manifolds;
+	int32 m_manifoldCount;
+
 	float32 m_toi;
+
+	// The index in the TOI queue, or -1.
+	int32 m_toiIndex;
+
+	// The index in the active contact array of the contact manager, or -1.
+	int32 m_activeIndex;
+
+	// The island search that last reached this contact.
+	uint32 m_islandEpoch;
+
+	// Points separated by up to this distance are reported and solved
+	// speculatively. Computed by the contact manager before Evaluate.
+	float32 m_speculativeDistance;
+
+	// The island indices of the bodies, bound when the island is built.
+	int32 m_indexA, m_indexB;
     
     void* m_userData;
 };
 
 inline b2Manifold* b2Contact::GetManifold()
 {
-	return &m_manifold;
+	return m_manifolds;
 }
 
-inline void b2Contact::GetWorldManifold(b2WorldManifold* worldManifold) const
+inline int32 b2Contact::GetManifoldCount() const
 {
+	return m_manifoldCount;
+}
+
+inline int32 b2Contact::GetPointCount() const
+{
+	int32 pointCount = 0;
+	for (int32 i = 0; i < m_manifoldCount; ++i)
+	{
+		pointCount += m_manifolds[i].m_pointCount;
+	}
+	return pointCount;
+}
+
+inline void b2Contact::GetWorldManifold(b2WorldManifold* worldManifold, int32 index) const
+{
+	b2Assert(0 <= index && index < m_manifoldCount);
+
 	const b2Body* bodyA = m_fixtureA->GetBody();
 	const b2Body* bodyB = m_fixtureB->GetBody();
 	const b2Shape* shapeA = m_fixtureA->GetShape();
 	const b2Shape* shapeB = m_fixtureB->GetShape();
 
-	worldManifold->Initialize(&m_manifold, bodyA->GetXForm(), shapeA->m_radius, bodyB->GetXForm(), shapeB->m_radius);
+	worldManifold->Initialize(m_manifolds + index, bodyA->GetXForm(), shapeA->m_radius, bodyB->GetXForm(), shapeB->m_radius);
 }
 
 inline bool b2Contact::IsSolid() const
@@ -17,23 +17,78 @@
 */
 
 #include "b2ContactSolver.h"
+#include "b2WideContactSolver.h"
 #include "b2Contact.h"
 #include "../b2Body.h"
 #include "../b2Fixture.h"
 #include "../b2World.h"
 #include "../../Common/b2StackAllocator.h"
 
+#include <new>
+
 #define B2_DEBUG_SOLVER 0
 
-b2ContactSolver::b2ContactSolver(const b2TimeStep& step, b2Contact** contacts, int32 contactCount, b2StackAllocator* allocator)
+// The separation of a manifold point, negative when the shapes overlap.
+static float32 b2ComputeSeparation(const b2Manifold* manifold, int32 index,
+								   const b2XForm& xfA, const b2XForm& xfB, float32 radius)
+{
+	switch (manifold->m_type)
+	{
+	case b2Manifold::e_circles:
+		{
+			b2Vec2 pointA = b2Mul(xfA, manifold->m_localPoint);
+			b2Vec2 pointB = b2Mul(xfB, manifold->m_points[0].m_localPoint);
+			return b2Distance(pointA, pointB) - radius;
+		}
+
+	case b2Manifold::e_faceA:
+		{
+			b2Vec2 normal = b2Mul(xfA.R, manifold->m_localPlaneNormal);
+			b2Vec2 planePoint = b2Mul(xfA, manifold->m_localPoint);
+			b2Vec2 clipPoint = b2Mul(xfB, manifold->m_points[index].m_localPoint);
+			return b2Dot(clipPoint - planePoint, normal) - radius;
+		}
+
+	case b2Manifold::e_faceB:
+		{
+			b2Vec2 normal = b2Mul(xfB.R, manifold->m_localPlaneNormal);
+			b2Vec2 planePoint = b2Mul(xfB, manifold->m_localPoint);
+			b2Vec2 clipPoint = b2Mul(xfA, manifold->m_points[index].m_localPoint);
+			return b2Dot(clipPoint - planePoint, normal) - radius;
+		}
+	}
+
+	return 0.0f;
+}
+
+b2ContactSolver::b2ContactSolver(const b2SolverData& data, b2Contact** contacts, int32 contactCount, b2StackAllocator* allocator)
 {
-	m_step = step;
+	m_step = data.step;
+	m_positions = data.positions;
+	m_velocities = data.velocities;
 	m_allocator = allocator;
+	m_taskScheduler = data.taskScheduler;
+	m_wideSolver = NULL;
+
+	// Contacts with a chain may carry several manifolds and some of them may
+	// have been disabled by the user, so count the constraints first.
+	m_constraintCount = 0;
+	for (int32 i = 0; i < contactCount; ++i)
+	{
+		b2Contact* contact = contacts[i];
+		for (int32 j = 0; j < contact->m_manifoldCount; ++j)
+		{
+			if (contact->m_manifolds[j].m_pointCount > 0)
+			{
+				++m_constraintCount;
+			}
+		}
+	}
 
-	m_constraintCount = contactCount;
 	m_constraints = (b2ContactConstraint*)m_allocator->Allocate(m_constraintCount * sizeof(b2ContactConstraint));
 
-	for (int32 i = 0; i < m_constraintCount; ++i)
+	int32 constraintIndex = 0;
+	for (int32 i = 0; i < contactCount; ++i)
 	{
 		b2Contact* contact = contacts[i];
 
@@ -45,119 +100,172 @@ b2ContactSolver::b2ContactSolver(const b2TimeStep& step, b2Contact** contacts, i
 		float32 radiusB = shapeB->m_radius;
 		b2Body* bodyA = fixtureA->GetBody();
 		b2Body* bodyB = fixtureB->GetBody();
-		b2Manifold* manifold = contact->GetManifold();
+		int32 indexA = contact->m_indexA;
+		int32 indexB = contact->m_indexB;
 
 		float32 friction = b2MixFriction(fixtureA->GetFriction(), fixtureB->GetFriction());
 		float32 restitution = b2MixRestitution(fixtureA->GetRestitution(), fixtureB->GetRestitution());
 
-		b2Vec2 vA = bodyA->m_linearVelocity;
-		b2Vec2 vB = bodyB->m_linearVelocity;
-		float32 wA = bodyA->m_angularVelocity;
-		float32 wB = bodyB->m_angularVelocity;
+		b2Vec2 cA = m_positions[indexA].x;
+		b2Vec2 cB = m_positions[indexB].x;
+		b2Vec2 vA = m_velocities[indexA].v;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float32 wA = m_velocities[indexA].w;
+		float32 wB = m_velocities[indexB].w;
 
-		b2Assert(manifold->m_pointCount > 0);
+		// A sleeping body at the border of an island is held in place like a static body.
+		float32 invMassA = bodyA->m_invMass;
+		float32 invIA = bodyA->m_invI;
+		if (bodyA->IsSleeping())
+		{
+			invMassA = 0.0f;
+			invIA = 0.0f;
+		}
 
-		b2WorldManifold worldManifold;
-		worldManifold.Initialize(manifold, bodyA->m_xf, radiusA, bodyB->m_xf, radiusB);
+		float32 invMassB = bodyB->m_invMass;
+		float32 invIB = bodyB->m_invI;
+		if (bodyB->IsSleeping())
+		{
+			invMassB = 0.0f;
+			invIB = 0.0f;
+		}
 
-		b2ContactConstraint* cc = m_constraints + i;
-		cc->bodyA = bodyA;
-		cc->bodyB = bodyB;
-		cc->manifold = manifold;
-		cc->normal = worldManifold.m_normal;
-		cc->pointCount = manifold->m_pointCount;
-		cc->friction = friction;
-		cc->restitution = restitution;
+		for (int32 manifoldIndex = 0; manifoldIndex < contact->m_manifoldCount; ++manifoldIndex)
+		{
+			b2Manifold* manifold = contact->m_manifolds + manifoldIndex;
+			if (manifold->m_pointCount == 0)
+			{
+				continue;
+			}
 
-		cc->localPlaneNormal = manifold->m_localPlaneNormal;
-		cc->localPoint = manifold->m_localPoint;
-		cc->radius = radiusA + radiusB;
-		cc->type = manifold->m_type;
+			b2WorldManifold worldManifold;
+			worldManifold.Initialize(manifold, bodyA->m_xf, radiusA, bodyB->m_xf, radiusB);
+
+			b2ContactConstraint* cc = m_constraints + constraintIndex;
+			++constraintIndex;
+			cc->localCenterA = bodyA->m_sweep.localCenter;
+			cc->localCenterB = bodyB->m_sweep.localCenter;
+			cc->invMassA = invMassA;
+			cc->invIA = invIA;
+			cc->invMassB = invMassB;
+			cc->invIB = invIB;
+			cc->massA = bodyA->m_mass;
+			cc->massB = bodyB->m_mass;
+			cc->indexA = indexA;
+			cc->indexB = indexB;
+			cc->manifold = manifold;
+			cc->contact = contact;
+			cc->normal = worldManifold.m_normal;
+			cc->pointCount = manifold->m_pointCount;
+			cc->friction = friction;
+			cc->restitution = restitution;
+
+			cc->localPlaneNormal = manifold->m_localPlaneNormal;
+			cc->localPoint = manifold->m_localPoint;
+			cc->radius = radiusA + radiusB;
+			cc->type = manifold->m_type;
+			cc->positionA = m_positions[indexA];
+			cc->positionB = m_positions[indexB];
+
+			for (int32 j = 0; j < cc->pointCount; ++j)
+			{
+				b2ManifoldPoint* cp = manifold->m_points + j;
+				b2ContactConstraintPoint* ccp = cc->points + j;
 
-		for (int32 j = 0; j < cc->pointCount; ++j)
-		{
-			b2ManifoldPoint* cp = manifold->m_points + j;
-			b2ContactConstraintPoint* ccp = cc->points + j;
+				ccp->normalImpulse = cp->m_normalImpulse;
+				ccp->tangentImpulse = cp->m_tangentImpulse;
 
-			ccp->normalImpulse = cp->m_normalImpulse;
-			ccp->tangentImpulse = cp->m_tangentImpulse;
+				ccp->localPoint = cp->m_localPoint;
 
-			ccp->localPoint = cp->m_localPoint;
+				ccp->rA = worldManifold.m_points[j] - cA;
+				ccp->rB = worldManifold.m_points[j] - cB;
 
-			ccp->rA = worldManifold.m_points[j] - bodyA->m_sweep.c;
-			ccp->rB = worldManifold.m_points[j] - bodyB->m_sweep.c;
+				float32 rnA = b2Cross(ccp->rA, cc->normal);
+				float32 rnB = b2Cross(ccp->rB, cc->normal);
+				rnA *= rnA;
+				rnB *= rnB;
 
-			float32 rnA = b2Cross(ccp->rA, cc->normal);
-			float32 rnB = b2Cross(ccp->rB, cc->normal);
-			rnA *= rnA;
-			rnB *= rnB;
+				float32 kNormal = invMassA + invMassB + invIA * rnA + invIB * rnB;
 
-			float32 kNormal = bodyA->m_invMass + bodyB->m_invMass + bodyA->m_invI * rnA + bodyB->m_invI * rnB;
+				b2Assert(kNormal > B2_FLT_EPSILON);
+				ccp->normalMass = 1.0f / kNormal;
 
-			b2Assert(kNormal > B2_FLT_EPSILON);
-			ccp->normalMass = 1.0f / kNormal;
+				float32 kEqualized = bodyA->m_mass * invMassA + bodyB->m_mass * invMassB;
+				kEqualized += bodyA->m_mass * invIA * rnA + bodyB->m_mass * invIB * rnB;
 
-			float32 kEqualized = bodyA->m_mass * bodyA->m_invMass + bodyB->m_mass * bodyB->m_invMass;
-			kEqualized += bodyA->m_mass * bodyA->m_invI * rnA + bodyB->m_mass * bodyB->m_invI * rnB;
+				b2Assert(kEqualized > B2_FLT_EPSILON);
+				ccp->equalizedMass = 1.0f / kEqualized;
 
-			b2Assert(kEqualized > B2_FLT_EPSILON);
-			ccp->equalizedMass = 1.0f / kEqualized;
+				b2Vec2 tangent = b2Cross(cc->normal, 1.0f);
 
-			b2Vec2 tangent = b2Cross(cc->normal, 1.0f);
+				float32 rtA = b2Cross(ccp->rA, tangent);
+				float32 rtB = b2Cross(ccp->rB, tangent);
+				rtA *= rtA;
+				rtB *= rtB;
 
-			float32 rtA = b2Cross(ccp->rA, tangent);
-			float32 rtB = b2Cross(ccp->rB, tangent);
-			rtA *= rtA;
-			rtB *= rtB;
+				float32 kTangent = invMassA + invMassB + invIA * rtA + invIB * rtB;
 
-			float32 kTangent = bodyA->m_invMass + bodyB->m_invMass + bodyA->m_invI * rtA + bodyB->m_invI * rtB;
+				b2Assert(kTangent > B2_FLT_EPSILON);
+				ccp->tangentMass = 1.0f /  kTangent;
 
-			b2Assert(kTangent > B2_FLT_EPSILON);
-			ccp->tangentMass = 1.0f /  kTangent;
+				// Setup a velocity bias for restitution.
+				ccp->velocityBias = 0.0f;
+				float32 vRel = b2Dot(cc->normal, vB + b2Cross(wB, ccp->rB) - vA - b2Cross(wA, ccp->rA));
+				if (vRel < -b2_velocityThreshold)
+				{
+					ccp->velocityBias = -cc->restitution * vRel;
+				}
 
-			// Setup a velocity bias for restitution.
-			ccp->velocityBias = 0.0f;
-			float32 vRel = b2Dot(cc->normal, vB + b2Cross(wB, ccp->rB) - vA - b2Cross(wA, ccp->rA));
-			if (vRel < -b2_velocityThreshold)
-			{
-				ccp->velocityBias = -cc->restitution * vRel;
-			}
-		}
+				// The soft step tracks the separation from the motion of the anchors.
+				if (m_step.subStepCount > 0)
+				{
+					float32 separation = b2ComputeSeparation(manifold, j, bodyA->m_xf, bodyB->m_xf, cc->radius);
+					ccp->adjustedSeparation = separation - b2Dot(ccp->rB - ccp->rA, cc->normal);
+					ccp->relativeVelocity = vRel;
+					ccp->maxNormalImpulse = 0.0f;
+				}
 
-		// If we have two points, then prepare the block solver.
-		if (cc->pointCount == 2)
-		{
-			b2ContactConstraintPoint* ccp1 = cc->points + 0;
-			b2ContactConstraintPoint* ccp2 = cc->points + 1;
-			
-			float32 invMassA = bodyA->m_invMass;
-			float32 invIA = bodyA->m_invI;
-			float32 invMassB = bodyB->m_invMass;
-			float32 invIB = bodyB->m_invI;
-
-			float32 rn1A = b2Cross(ccp1->rA, cc->normal);
-			float32 rn1B = b2Cross(ccp1->rB, cc->normal);
-			float32 rn2A = b2Cross(ccp2->rA, cc->normal);
-			float32 rn2B = b2Cross(ccp2->rB, cc->normal);
-
-			float32 k11 = invMassA + invMassB + invIA * rn1A * rn1A + invIB * rn1B * rn1B;
-			float32 k22 = invMassA + invMassB + invIA * rn2A * rn2A + invIB * rn2B * rn2B;
-			float32 k12 = invMassA + invMassB + invIA * rn1A * rn2A + invIB * rn1B * rn2B;
-
-			// Ensure a reasonable condition number.
-			const float32 k_maxConditionNumber = 100.0f;
-			if (k11 * k11 < k_maxConditionNumber * (k11 * k22 - k12 * k12))
-			{
-				// K is safe to invert.
-				cc->K.col1.Set(k11, k12);
-				cc->K.col2.Set(k12, k22);
-				cc->normalMass = cc->K.GetInverse();
+				// A speculative point may approach by its gap within the step.
+				if (contact->m_speculativeDistance > 0.0f)
+				{
+					float32 separation = b2ComputeSeparation(manifold, j, bodyA->m_xf, bodyB->m_xf, cc->radius);
+					if (separation > 0.0f)
+					{
+						ccp->velocityBias = -separation * m_step.inv_dt;
+					}
+				}
 			}
-			else
+
+			// If we have two points, then prepare the block solver.
+			if (cc->pointCount == 2)
 			{
-				// The constraints are redundant, just use one.
-				// TODO_ERIN use deepest?
-				cc->pointCount = 1;
+				b2ContactConstraintPoint* ccp1 = cc->points + 0;
+				b2ContactConstraintPoint* ccp2 = cc->points + 1;
+
+				float32 rn1A = b2Cross(ccp1->rA, cc->normal);
+				float32 rn1B = b2Cross(ccp1->rB, cc->normal);
+				float32 rn2A = b2Cross(ccp2->rA, cc->normal);
+				float32 rn2B = b2Cross(ccp2->rB, cc->normal);
+
+				float32 k11 = invMassA + invMassB + invIA * rn1A * rn1A + invIB * rn1B * rn1B;
+				float32 k22 = invMassA + invMassB + invIA * rn2A * rn2A + invIB * rn2B * rn2B;
+				float32 k12 = invMassA + invMassB + invIA * rn1A * rn2A + invIB * rn1B * rn2B;
+
+				// Ensure a reasonable condition number.
+				const float32 k_maxConditionNumber = 100.0f;
+				if (k11 * k11 < k_maxConditionNumber * (k11 * k22 - k12 * k12))
+				{
+					// K is safe to invert.
+					cc->K.col1.Set(k11, k12);
+					cc->K.col2.Set(k12, k22);
+					cc->normalMass = cc->K.GetInverse();
+				}
+				else
+				{
+					// The constraints are redundant, just use one.
+					// TODO_ERIN use deepest?
+					cc->pointCount = 1;
+				}
 			}
 		}
 	}
@@ -165,6 +273,12 @@ b2ContactSolver::b2ContactSolver(const b2TimeStep& step, b2Contact** contacts, i
 
 b2ContactSolver::~b2ContactSolver()
 {
+	if (m_wideSolver)
+	{
+		m_wideSolver->~b2WideContactSolver();
+		m_allocator->Free(m_wideSolver);
+	}
+
 	m_allocator->Free(m_constraints);
 }
 
@@ -175,27 +289,27 @@ void b2ContactSolver::InitVelocityConstraints(const b2TimeStep& step)
 	{
 		b2ContactConstraint* c = m_constraints + i;
 
-		b2Body* bodyA = c->bodyA;
-		b2Body* bodyB = c->bodyB;
-		float32 invMassA = bodyA->m_invMass;
-		float32 invIA = bodyA->m_invI;
-		float32 invMassB = bodyB->m_invMass;
-		float32 invIB = bodyB->m_invI;
+		float32 invMassA = c->invMassA;
+		float32 invIA = c->invIA;
+		float32 invMassB = c->invMassB;
+		float32 invIB = c->invIB;
 		b2Vec2 normal = c->normal;
 		b2Vec2 tangent = b2Cross(normal, 1.0f);
 
 		if (step.warmStarting)
 		{
+			b2Velocity* velocityA = m_velocities + c->indexA;
+			b2Velocity* velocityB = m_velocities + c->indexB;
 			for (int32 j = 0; j < c->pointCount; ++j)
 			{
 				b2ContactConstraintPoint* ccp = c->points + j;
 				ccp->normalImpulse *= step.dtRatio;
 				ccp->tangentImpulse *= step.dtRatio;
 				b2Vec2 P = ccp->normalImpulse * normal + ccp->tangentImpulse * tangent;
-				bodyA->m_angularVelocity -= invIA * b2Cross(ccp->rA, P);
-				bodyA->m_linearVelocity -= invMassA * P;
-				bodyB->m_angularVelocity += invIB * b2Cross(ccp->rB, P);
-				bodyB->m_linearVelocity += invMassB * P;
+				velocityA->w -= invIA * b2Cross(ccp->rA, P);
+				velocityA->v -= invMassA * P;
+				velocityB->w += invIB * b2Cross(ccp->rB, P);
+				velocityB->v += invMassB * P;
 			}
 		}
 		else
@@ -208,23 +322,43 @@ void b2ContactSolver::InitVelocityConstraints(const b2TimeStep& step)
 			}
 		}
 	}
+
+	// Pack the warm started constraints into lanes. The colors of the wide
+	// solver also let the threads solve the constraints of a color at once.
+	if ((step.wideContactSolver || m_taskScheduler) && m_constraintCount > 0)
+	{
+		void* mem = m_allocator->Allocate(sizeof(b2WideContactSolver));
+		m_wideSolver = new (mem) b2WideContactSolver(m_constraints, m_constraintCount, m_positions, m_velocities,
+													 m_allocator, m_taskScheduler);
+	}
 }
 
-void b2ContactSolver::SolveVelocityConstraints()
+float32 b2ContactSolver::SolveVelocityConstraints()
 {
-	for (int32 i = 0; i < m_constraintCount; ++i)
+	// The wide solver leaves the constraints it couldn't color to this loop.
+	int32 count = m_constraintCount;
+	const int32* indices = NULL;
+	float32 maxChange = 0.0f;
+	if (m_wideSolver)
 	{
-		b2ContactConstraint* c = m_constraints + i;
-		b2Body* bodyA = c->bodyA;
-		b2Body* bodyB = c->bodyB;
-		float32 wA = bodyA->m_angularVelocity;
-		float32 wB = bodyB->m_angularVelocity;
-		b2Vec2 vA = bodyA->m_linearVelocity;
-		b2Vec2 vB = bodyB->m_linearVelocity;
-		float32 invMassA = bodyA->m_invMass;
-		float32 invIA = bodyA->m_invI;
-		float32 invMassB = bodyB->m_invMass;
-		float32 invIB = bodyB->m_invI;
+		maxChange = m_wideSolver->SolveVelocityConstraints();
+		count = m_wideSolver->m_overflowCount;
+		indices = m_wideSolver->m_overflow;
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2ContactConstraint* c = m_constraints + (indices ? indices[i] : i);
+		b2Velocity* velocityA = m_velocities + c->indexA;
+		b2Velocity* velocityB = m_velocities + c->indexB;
+		float32 wA = velocityA->w;
+		float32 wB = velocityB->w;
+		b2Vec2 vA = velocityA->v;
+		b2Vec2 vB = velocityB->v;
+		float32 invMassA = c->invMassA;
+		float32 invIA = c->invIA;
+		float32 invMassB = c->invMassB;
+		float32 invIB = c->invIB;
 		b2Vec2 normal = c->normal;
 		b2Vec2 tangent = b2Cross(normal, 1.0f);
 		float32 friction = c->friction;
@@ -502,20 +636,52 @@ void b2ContactSolver::SolveVelocityConstraints()
 			}
 		}
 
-		bodyA->m_linearVelocity = vA;
-		bodyA->m_angularVelocity = wA;
-		bodyB->m_linearVelocity = vB;
-		bodyB->m_angularVelocity = wB;
+		maxChange = b2Max(maxChange, b2VelocityChange(*velocityA, vA, wA));
+		maxChange = b2Max(maxChange, b2VelocityChange(*velocityB, vB, wB));
+
+		velocityA->v = vA;
+		velocityA->w = wA;
+		velocityB->v = vB;
+		velocityB->w = wB;
 	}
+
+	return maxChange;
 }
 
 void b2ContactSolver::FinalizeVelocityConstraints()
 {
+	if (m_wideSolver)
+	{
+		m_wideSolver->StoreImpulses();
+	}
+
 	for (int32 i = 0; i < m_constraintCount; ++i)
 	{
 		b2ContactConstraint* c = m_constraints + i;
 		b2Manifold* m = c->manifold;
 
+		// A sleeping body at the border of the island holds the resting load it
+		// fell asleep with. The manifold keeps that load while the body sleeps,
+		// so a push that grows slowly still wakes the body once it is larger.
+		b2Body* bodyA = c->contact->m_fixtureA->GetBody();
+		b2Body* bodyB = c->contact->m_fixtureB->GetBody();
+		b2Body* border = bodyA->IsSleeping() ? bodyA : bodyB;
+		if (border->IsSleeping() && border->IsStatic() == false)
+		{
+			float32 change = 0.0f;
+			for (int32 j = 0; j < c->pointCount; ++j)
+			{
+				change += c->points[j].normalImpulse - m->m_points[j].m_normalImpulse;
+			}
+
+			if (change * border->m_invMass > b2_wakeVelocityTolerance)
+			{
+				c->contact->m_flags |= b2Contact::e_wakeFlag;
+			}
+
+			continue;
+		}
+
 		for (int32 j = 0; j < c->pointCount; ++j)
 		{
 			m->m_points[j].m_normalImpulse = c->points[j].normalImpulse;
@@ -524,6 +690,307 @@ void b2ContactSolver::FinalizeVelocityConstraints()
 	}
 }
 
+// Soft constraints as in "Solver2D" by Erin Catto. The constraint is a spring with
+// the given frequency and damping ratio that is stepped implicitly with step h.
+static b2Softness b2MakeSoftness(float32 hertz, float32 dampingRatio, float32 h)
+{
+	float32 omega = 2.0f * b2_pi * hertz;
+	float32 a1 = 2.0f * dampingRatio + h * omega;
+	float32 a2 = h * omega * a1;
+	float32 a3 = 1.0f / (1.0f + a2);
+
+	b2Softness softness;
+	softness.biasRate = omega / a1;
+	softness.massScale = a2 * a3;
+	softness.impulseScale = a3;
+	return softness;
+}
+
+void b2ContactSolver::PrepareSoftConstraints(const b2TimeStep& step, float32 h)
+{
+	// Stiff contacts need small sub-steps.
+	float32 contactHertz = b2Min(b2_contactHertz, 0.25f / h);
+	m_softness = b2MakeSoftness(contactHertz, b2_contactDampingRatio, h);
+	m_staticSoftness = b2MakeSoftness(2.0f * contactHertz, b2_contactDampingRatio, h);
+
+	for (int32 i = 0; i < m_constraintCount; ++i)
+	{
+		b2ContactConstraint* c = m_constraints + i;
+		for (int32 j = 0; j < c->pointCount; ++j)
+		{
+			b2ContactConstraintPoint* ccp = c->points + j;
+			if (step.warmStarting)
+			{
+				ccp->normalImpulse *= step.dtRatio;
+				ccp->tangentImpulse *= step.dtRatio;
+			}
+			else
+			{
+				ccp->normalImpulse = 0.0f;
+				ccp->tangentImpulse = 0.0f;
+			}
+		}
+	}
+}
+
+void b2ContactSolver::WarmStartSoftConstraints()
+{
+	for (int32 i = 0; i < m_constraintCount; ++i)
+	{
+		b2ContactConstraint* c = m_constraints + i;
+		b2Velocity* velocityA = m_velocities + c->indexA;
+		b2Velocity* velocityB = m_velocities + c->indexB;
+		b2Vec2 normal = c->normal;
+		b2Vec2 tangent = b2Cross(normal, 1.0f);
+
+		for (int32 j = 0; j < c->pointCount; ++j)
+		{
+			b2ContactConstraintPoint* ccp = c->points + j;
+			b2Vec2 P = ccp->normalImpulse * normal + ccp->tangentImpulse * tangent;
+			velocityA->w -= c->invIA * b2Cross(ccp->rA, P);
+			velocityA->v -= c->invMassA * P;
+			velocityB->w += c->invIB * b2Cross(ccp->rB, P);
+			velocityB->v += c->invMassB * P;
+		}
+	}
+}
+
+void b2ContactSolver::SolveSoftConstraints(float32 inv_h, bool useBias)
+{
+	for (int32 i = 0; i < m_constraintCount; ++i)
+	{
+		b2ContactConstraint* c = m_constraints + i;
+		b2Velocity* velocityA = m_velocities + c->indexA;
+		b2Velocity* velocityB = m_velocities + c->indexB;
+		float32 wA = velocityA->w;
+		float32 wB = velocityB->w;
+		b2Vec2 vA = velocityA->v;
+		b2Vec2 vB = velocityB->v;
+		float32 invMassA = c->invMassA;
+		float32 invIA = c->invIA;
+		float32 invMassB = c->invMassB;
+		float32 invIB = c->invIB;
+		b2Vec2 normal = c->normal;
+		b2Vec2 tangent = b2Cross(normal, 1.0f);
+		float32 friction = c->friction;
+
+		// Contacts with a static body are stiffer.
+		b2Softness softness = (invMassA == 0.0f || invMassB == 0.0f) ? m_staticSoftness : m_softness;
+
+		// The motion of the bodies since the start of the step.
+		const b2Position& positionA = m_positions[c->indexA];
+		const b2Position& positionB = m_positions[c->indexB];
+		b2Vec2 dcA = positionA.x - c->positionA.x;
+		b2Vec2 dcB = positionB.x - c->positionB.x;
+		b2Mat22 qA(positionA.a - c->positionA.a);
+		b2Mat22 qB(positionB.a - c->positionB.a);
+
+		// Solve normal constraints
+		b2Vec2 velocityBias, massScale, impulseScale;
+		float32* biases = &velocityBias.x;
+		float32* massScales = &massScale.x;
+		float32* impulseScales = &impulseScale.x;
+		for (int32 j = 0; j < c->pointCount; ++j)
+		{
+			b2ContactConstraintPoint* ccp = c->points + j;
+
+			// The current separation of the anchors.
+			b2Vec2 d = dcB - dcA + b2Mul(qB, ccp->rB) - b2Mul(qA, ccp->rA);
+			float32 s = b2Dot(d, normal) + ccp->adjustedSeparation;
+
+			biases[j] = 0.0f;
+			massScales[j] = 1.0f;
+			impulseScales[j] = 0.0f;
+			if (s > 0.0f)
+			{
+				// Speculative, approach by the gap within the sub-step.
+				biases[j] = s * inv_h;
+			}
+			else if (useBias)
+			{
+				// Keep a slop of overlap so the contact persists.
+				biases[j] = b2Max(softness.biasRate * b2Min(s + b2_linearSlop, 0.0f), -b2_contactPushVelocity);
+				massScales[j] = softness.massScale;
+				impulseScales[j] = softness.impulseScale;
+			}
+		}
+
+		if (c->pointCount == 1)
+		{
+			b2ContactConstraintPoint* ccp = c->points + 0;
+
+			// Relative velocity at contact
+			b2Vec2 dv = vB + b2Cross(wB, ccp->rB) - vA - b2Cross(wA, ccp->rA);
+
+			// Compute normal impulse
+			float32 vn = b2Dot(dv, normal);
+			float32 lambda = -ccp->normalMass * massScale.x * (vn + velocityBias.x) - impulseScale.x * ccp->normalImpulse;
+
+			// b2Clamp the accumulated impulse
+			float32 newImpulse = b2Max(ccp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - ccp->normalImpulse;
+			ccp->normalImpulse = newImpulse;
+			ccp->maxNormalImpulse = b2Max(ccp->maxNormalImpulse, lambda);
+
+			// Apply contact impulse
+			b2Vec2 P = lambda * normal;
+			vA -= invMassA * P;
+			wA -= invIA * b2Cross(ccp->rA, P);
+
+			vB += invMassB * P;
+			wB += invIB * b2Cross(ccp->rB, P);
+		}
+		else
+		{
+			// The block solver with soft rows. Row i of the mini LCP is scaled by the
+			// mass scale of its point, so for accumulated impulse a and new impulse x:
+			//
+			// K * (x - a) = -massScale * (vn + bias) - impulseScale * K * a
+			//
+			// This gives K * x + r = 0 with r = massScale * (vn + bias) + (impulseScale - 1) * K * a
+			// and the cases are enumerated as in SolveVelocityConstraints.
+			b2ContactConstraintPoint* cp1 = c->points + 0;
+			b2ContactConstraintPoint* cp2 = c->points + 1;
+
+			b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
+
+			// Relative velocity at contact
+			b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+			b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+
+			// Compute normal velocity
+			float32 vn1 = b2Dot(dv1, normal);
+			float32 vn2 = b2Dot(dv2, normal);
+
+			b2Vec2 Ka = b2Mul(c->K, a);
+			b2Vec2 r;
+			r.x = massScale.x * (vn1 + velocityBias.x) + (impulseScale.x - 1.0f) * Ka.x;
+			r.y = massScale.y * (vn2 + velocityBias.y) + (impulseScale.y - 1.0f) * Ka.y;
+
+			// Case 1: both points push.
+			b2Vec2 x = -b2Mul(c->normalMass, r);
+			if (x.x < 0.0f || x.y < 0.0f)
+			{
+				// Case 2: the first point pushes and the second separates.
+				x.x = -cp1->normalMass * r.x;
+				x.y = 0.0f;
+				if (x.x < 0.0f || c->K.col1.y * x.x + r.y < 0.0f)
+				{
+					// Case 3: the second point pushes and the first separates.
+					x.x = 0.0f;
+					x.y = -cp2->normalMass * r.y;
+					if (x.y < 0.0f || c->K.col2.x * x.y + r.x < 0.0f)
+					{
+						// Case 4: both separate. This is also the fallback if the
+						// problem has no solution.
+						x.SetZero();
+					}
+				}
+			}
+
+			// Resubstitute for the incremental impulse
+			b2Vec2 d = x - a;
+			cp1->normalImpulse = x.x;
+			cp2->normalImpulse = x.y;
+			cp1->maxNormalImpulse = b2Max(cp1->maxNormalImpulse, d.x);
+			cp2->maxNormalImpulse = b2Max(cp2->maxNormalImpulse, d.y);
+
+			// Apply incremental impulse
+			b2Vec2 P1 = d.x * normal;
+			b2Vec2 P2 = d.y * normal;
+			vA -= invMassA * (P1 + P2);
+			wA -= invIA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+
+			vB += invMassB * (P1 + P2);
+			wB += invIB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+		}
+
+		// Solve tangent constraints
+		for (int32 j = 0; j < c->pointCount; ++j)
+		{
+			b2ContactConstraintPoint* ccp = c->points + j;
+
+			// Relative velocity at contact
+			b2Vec2 dv = vB + b2Cross(wB, ccp->rB) - vA - b2Cross(wA, ccp->rA);
+
+			// Compute tangent force
+			float32 vt = b2Dot(dv, tangent);
+			float32 lambda = ccp->tangentMass * (-vt);
+
+			// b2Clamp the accumulated force
+			float32 maxFriction = friction * ccp->normalImpulse;
+			float32 newImpulse = b2Clamp(ccp->tangentImpulse + lambda, -maxFriction, maxFriction);
+			lambda = newImpulse - ccp->tangentImpulse;
+			ccp->tangentImpulse = newImpulse;
+
+			// Apply contact impulse
+			b2Vec2 P = lambda * tangent;
+
+			vA -= invMassA * P;
+			wA -= invIA * b2Cross(ccp->rA, P);
+
+			vB += invMassB * P;
+			wB += invIB * b2Cross(ccp->rB, P);
+		}
+
+		velocityA->v = vA;
+		velocityA->w = wA;
+		velocityB->v = vB;
+		velocityB->w = wB;
+	}
+}
+
+void b2ContactSolver::ApplyRestitution()
+{
+	for (int32 i = 0; i < m_constraintCount; ++i)
+	{
+		b2ContactConstraint* c = m_constraints + i;
+		if (c->restitution == 0.0f)
+		{
+			continue;
+		}
+
+		b2Velocity* velocityA = m_velocities + c->indexA;
+		b2Velocity* velocityB = m_velocities + c->indexB;
+		float32 wA = velocityA->w;
+		float32 wB = velocityB->w;
+		b2Vec2 vA = velocityA->v;
+		b2Vec2 vB = velocityB->v;
+		b2Vec2 normal = c->normal;
+
+		for (int32 j = 0; j < c->pointCount; ++j)
+		{
+			b2ContactConstraintPoint* ccp = c->points + j;
+
+			// Only points that approached fast and were pushed bounce.
+			if (ccp->relativeVelocity > -b2_velocityThreshold || ccp->maxNormalImpulse == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, ccp->rB) - vA - b2Cross(wA, ccp->rA);
+			float32 vn = b2Dot(dv, normal);
+			float32 lambda = -ccp->normalMass * (vn + c->restitution * ccp->relativeVelocity);
+
+			float32 newImpulse = b2Max(ccp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - ccp->normalImpulse;
+			ccp->normalImpulse = newImpulse;
+
+			b2Vec2 P = lambda * normal;
+			vA -= c->invMassA * P;
+			wA -= c->invIA * b2Cross(ccp->rA, P);
+
+			vB += c->invMassB * P;
+			wB += c->invIB * b2Cross(ccp->rB, P);
+		}
+
+		velocityA->v = vA;
+		velocityA->w = wA;
+		velocityB->v = vB;
+		velocityB->w = wB;
+	}
+}
+
 #if 0
 // Sequential solver.
 bool b2ContactSolver::SolvePositionConstraints(float32 baumgarte)
@@ -587,7 +1054,7 @@ bool b2ContactSolver::SolvePositionConstraints(float32 baumgarte)
 
 struct b2PositionSolverManifold
 {
-	void Initialize(b2ContactConstraint* cc)
+	void Initialize(b2ContactConstraint* cc, const b2XForm& xfA, const b2XForm& xfB)
 	{
 		b2Assert(cc->pointCount > 0);
 
@@ -595,8 +1062,8 @@ struct b2PositionSolverManifold
 		{
 		case b2Manifold::e_circles:
 			{
-				b2Vec2 pointA = cc->bodyA->GetWorldPoint(cc->localPoint);
-				b2Vec2 pointB = cc->bodyB->GetWorldPoint(cc->points[0].localPoint);
+				b2Vec2 pointA = b2Mul(xfA, cc->localPoint);
+				b2Vec2 pointB = b2Mul(xfB, cc->points[0].localPoint);
 				if (b2DistanceSquared(pointA, pointB) > B2_FLT_EPSILON * B2_FLT_EPSILON)
 				{
 					m_normal = pointB - pointA;
@@ -614,12 +1081,12 @@ struct b2PositionSolverManifold
 
 		case b2Manifold::e_faceA:
 			{
-				m_normal = cc->bodyA->GetWorldVector(cc->localPlaneNormal);
-				b2Vec2 planePoint = cc->bodyA->GetWorldPoint(cc->localPoint);
+				m_normal = b2Mul(xfA.R, cc->localPlaneNormal);
+				b2Vec2 planePoint = b2Mul(xfA, cc->localPoint);
 
 				for (int32 i = 0; i < cc->pointCount; ++i)
 				{
-					b2Vec2 clipPoint = cc->bodyB->GetWorldPoint(cc->points[i].localPoint);
+					b2Vec2 clipPoint = b2Mul(xfB, cc->points[i].localPoint);
 					m_separations[i] = b2Dot(clipPoint - planePoint, m_normal) - cc->radius;
 					m_points[i] = clipPoint;
 				}
@@ -628,12 +1095,12 @@ struct b2PositionSolverManifold
 
 		case b2Manifold::e_faceB:
 			{
-				m_normal = cc->bodyB->GetWorldVector(cc->localPlaneNormal);
-				b2Vec2 planePoint = cc->bodyB->GetWorldPoint(cc->localPoint);
+				m_normal = b2Mul(xfB.R, cc->localPlaneNormal);
+				b2Vec2 planePoint = b2Mul(xfB, cc->localPoint);
 
 				for (int32 i = 0; i < cc->pointCount; ++i)
 				{
-					b2Vec2 clipPoint = cc->bodyA->GetWorldPoint(cc->points[i].localPoint);
+					b2Vec2 clipPoint = b2Mul(xfA, cc->points[i].localPoint);
 					m_separations[i] = b2Dot(clipPoint - planePoint, m_normal) - cc->radius;
 					m_points[i] = clipPoint;
 				}
@@ -655,19 +1122,35 @@ bool b2ContactSolver::SolvePositionConstraints(float32 baumgarte)
 {
 	float32 minSeparation = 0.0f;
 
-	for (int32 i = 0; i < m_constraintCount; ++i)
+	// The wide solver leaves the constraints it couldn't color to this loop.
+	int32 count = m_constraintCount;
+	const int32* indices = NULL;
+	if (m_wideSolver)
 	{
-		b2ContactConstraint* c = m_constraints + i;
-		b2Body* bodyA = c->bodyA;
-		b2Body* bodyB = c->bodyB;
+		minSeparation = m_wideSolver->SolvePositionConstraints(baumgarte);
+		count = m_wideSolver->m_overflowCount;
+		indices = m_wideSolver->m_overflow;
+	}
 
-		float32 invMassA = bodyA->m_mass * bodyA->m_invMass;
-		float32 invIA = bodyA->m_mass * bodyA->m_invI;
-		float32 invMassB = bodyB->m_mass * bodyB->m_invMass;
-		float32 invIB = bodyB->m_mass * bodyB->m_invI;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2ContactConstraint* c = m_constraints + (indices ? indices[i] : i);
+		b2Position* positionA = m_positions + c->indexA;
+		b2Position* positionB = m_positions + c->indexB;
+
+		float32 invMassA = c->massA * c->invMassA;
+		float32 invIA = c->massA * c->invIA;
+		float32 invMassB = c->massB * c->invMassB;
+		float32 invIB = c->massB * c->invIB;
+
+		b2XForm xfA, xfB;
+		xfA.R.Set(positionA->a);
+		xfA.position = positionA->x - b2Mul(xfA.R, c->localCenterA);
+		xfB.R.Set(positionB->a);
+		xfB.position = positionB->x - b2Mul(xfB.R, c->localCenterB);
 
 		b2PositionSolverManifold psm;
-		psm.Initialize(c);
+		psm.Initialize(c, xfA, xfB);
 		b2Vec2 normal = psm.m_normal;
 
 		// Solve normal constraints
@@ -678,8 +1161,8 @@ bool b2ContactSolver::SolvePositionConstraints(float32 baumgarte)
 			b2Vec2 point = psm.m_points[j];
 			float32 separation = psm.m_separations[j];
 
-			b2Vec2 rA = point - bodyA->m_sweep.c;
-			b2Vec2 rB = point - bodyB->m_sweep.c;
+			b2Vec2 rA = point - positionA->x;
+			b2Vec2 rB = point - positionB->x;
 
 			// Track max constraint error.
 			minSeparation = b2Min(minSeparation, separation);
@@ -692,13 +1175,11 @@ bool b2ContactSolver::SolvePositionConstraints(float32 baumgarte)
 
 			b2Vec2 P = impulse * normal;
 
-			bodyA->m_sweep.c -= invMassA * P;
-			bodyA->m_sweep.a -= invIA * b2Cross(rA, P);
-			bodyA->SynchronizeTransform();
+			positionA->x -= invMassA * P;
+			positionA->a -= invIA * b2Cross(rA, P);
 
-			bodyB->m_sweep.c += invMassB * P;
-			bodyB->m_sweep.a += invIB * b2Cross(rB, P);
-			bodyB->SynchronizeTransform();
+			positionB->x += invMassB * P;
+			positionB->a += invIB * b2Cross(rB, P);
 		}
 	}
 
@@ -707,4 +1188,4 @@ bool b2ContactSolver::SolvePositionConstraints(float32 baumgarte)
 	return minSeparation >= -1.5f * b2_linearSlop;
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -27,6 +27,7 @@ class b2Contact;
 class b2Body;
 class b2Island;
 class b2StackAllocator;
+class b2WideContactSolver;
 
 struct b2ContactConstraintPoint
 {
@@ -39,6 +40,11 @@ struct b2ContactConstraintPoint
 	float32 tangentMass;
 	float32 equalizedMass;
 	float32 velocityBias;
+
+	// Soft step.
+	float32 adjustedSeparation;
+	float32 relativeVelocity;
+	float32 maxNormalImpulse;
 };
 
 struct b2ContactConstraint
@@ -49,32 +55,73 @@ struct b2ContactConstraint
 	b2Vec2 normal;
 	b2Mat22 normalMass;
 	b2Mat22 K;
-	b2Body* bodyA;
-	b2Body* bodyB;
+	b2Vec2 localCenterA, localCenterB;
+	float32 invMassA, invIA;
+	float32 invMassB, invIB;
+	float32 massA, massB;
+	int32 indexA, indexB;
 	b2Manifold::Type type;
 	float32 radius;
 	float32 friction;
 	float32 restitution;
 	int32 pointCount;
 	b2Manifold* manifold;
+	b2Contact* contact;
+
+	// The body positions at the start of the step, used by the soft step.
+	b2Position positionA, positionB;
+};
+
+/// A soft constraint is a mass-spring-damper that is stepped implicitly.
+struct b2Softness
+{
+	float32 biasRate;
+	float32 massScale;
+	float32 impulseScale;
 };
 
 class b2ContactSolver
 {
 public:
-	b2ContactSolver(const b2TimeStep& step, b2Contact** contacts, int32 contactCount, b2StackAllocator* allocator);
+	b2ContactSolver(const b2SolverData& data, b2Contact** contacts, int32 contactCount, b2StackAllocator* allocator);
 	~b2ContactSolver();
 
 	void InitVelocityConstraints(const b2TimeStep& step);
-	void SolveVelocityConstraints();
+	/// This returns the largest velocity change, see b2VelocityChange.
+	float32 SolveVelocityConstraints();
 	void FinalizeVelocityConstraints();
 
 	bool SolvePositionConstraints(float32 baumgarte);
 
+	/// Compute the softness and scale the accumulated impulses for a soft step.
+	void PrepareSoftConstraints(const b2TimeStep& step, float32 h);
+
+	/// Apply the accumulated impulses. This is done at the start of every sub-step.
+	void WarmStartSoftConstraints();
+
+	/// Solve the soft constraints once. The separation is tracked from the motion
+	/// of the bodies, so no collision is needed between sub-steps.
+	/// @param useBias push overlapping shapes apart, false for relaxation.
+	void SolveSoftConstraints(float32 inv_h, bool useBias);
+
+	/// Apply restitution after the last sub-step.
+	void ApplyRestitution();
+
 	b2TimeStep m_step;
+	b2Position* m_positions;
+	b2Velocity* m_velocities;
 	b2StackAllocator* m_allocator;
+	b2TaskScheduler* m_taskScheduler;
 	b2ContactConstraint* m_constraints;
 	int m_constraintCount;
+
+	// This is NULL unless the step uses the wide solver or the island is
+	// spread over threads.
+	b2WideContactSolver* m_wideSolver;
+
+	// Soft step.
+	b2Softness m_softness;
+	b2Softness m_staticSoftness;
 };
 
 #endif
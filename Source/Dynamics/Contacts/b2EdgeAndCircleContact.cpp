@@ -60,7 +60,7 @@ void b2EdgeAndCircleContact::Evaluate()
 							(b2CircleShape*)m_fixtureB->GetShape(), bodyB->GetXForm());
 }
 
-float32 b2EdgeAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB) const
+float32 b2EdgeAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
 {
 	b2TOIInput input;
 	input.sweepA = sweepA;
@@ -68,6 +68,7 @@ float32 b2EdgeAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep&
 	input.sweepRadiusA = m_fixtureA->ComputeSweepRadius(sweepA.localCenter);
 	input.sweepRadiusB = m_fixtureB->ComputeSweepRadius(sweepB.localCenter);
 	input.tolerance = b2_linearSlop;
+	input.counters = counters;
 
 	return b2TimeOfImpact(&input, (const b2EdgeShape*)m_fixtureA->GetShape(), (const b2CircleShape*)m_fixtureB->GetShape());
 }
@@ -37,7 +37,7 @@ public:
 
 	void Evaluate();
 
-	float32 ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB) const;
+	float32 ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const;
 };
 
 #endif
@@ -0,0 +1,127 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2GridAndCircleContact.h"
+#include "../b2Body.h"
+#include "../b2Fixture.h"
+#include "../../Collision/Shapes/b2GridShape.h"
+#include "../../Collision/Shapes/b2CircleShape.h"
+#include "../../Collision/b2TimeOfImpact.h"
+#include "../../Common/b2BlockAllocator.h"
+
+#include <new>
+
+// Collides the circle with each exposed grid face under the other shape.
+struct b2GridAndCircleCallback
+{
+	void QueryCallback(const b2EdgeShape* edge, int32 key)
+	{
+		b2Manifold manifold;
+		b2CollideEdgeAndCircle(&manifold, edge, xfA, circle, xfB);
+
+		if (manifold.m_pointCount > 0)
+		{
+			contact->AddChild(key, manifold);
+		}
+	}
+
+	b2GridAndCircleContact* contact;
+	const b2GridShape* grid;
+	const b2CircleShape* circle;
+	b2XForm xfA;
+	b2XForm xfB;
+};
+
+// Finds the earliest time of impact of the circle with the grid faces.
+struct b2GridAndCircleTOICallback
+{
+	void QueryCallback(const b2EdgeShape* edge, int32 key)
+	{
+		B2_NOT_USED(key);
+
+		input.sweepRadiusA = edge->ComputeSweepRadius(input.sweepA.localCenter);
+		toi = b2Min(toi, b2TimeOfImpact(&input, edge, circle));
+	}
+
+	b2TOIInput input;
+	const b2GridShape* grid;
+	const b2CircleShape* circle;
+	float32 toi;
+};
+
+b2Contact* b2GridAndCircleContact::Create(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2GridAndCircleContact));
+	return new (mem) b2GridAndCircleContact(fixtureA, fixtureB);
+}
+
+void b2GridAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2GridAndCircleContact*)contact)->~b2GridAndCircleContact();
+	allocator->Free(contact, sizeof(b2GridAndCircleContact));
+}
+
+b2GridAndCircleContact::b2GridAndCircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+: b2CompositeContact(fixtureA, fixtureB)
+{
+	b2Assert(m_fixtureA->GetType() == b2_gridShape);
+	b2Assert(m_fixtureB->GetType() == b2_circleShape);
+}
+
+void b2GridAndCircleContact::Evaluate()
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2GridAndCircleCallback callback;
+	callback.contact = this;
+	callback.grid = (b2GridShape*)m_fixtureA->GetShape();
+	callback.circle = (b2CircleShape*)m_fixtureB->GetShape();
+	callback.xfA = bodyA->GetXForm();
+	callback.xfB = bodyB->GetXForm();
+
+	// Bound the circle in the frame of the grid.
+	b2Vec2 center = b2MulT(callback.xfA, b2Mul(callback.xfB, callback.circle->m_p));
+	b2Vec2 r(callback.circle->m_radius, callback.circle->m_radius);
+	b2AABB aabb;
+	aabb.lowerBound = center - r;
+	aabb.upperBound = center + r;
+
+	BeginChildren();
+	callback.grid->QueryFaces(&callback, aabb);
+	EndChildren();
+}
+
+float32 b2GridAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
+{
+	b2GridAndCircleTOICallback callback;
+	callback.input.sweepA = sweepA;
+	callback.input.sweepB = sweepB;
+	callback.input.sweepRadiusB = m_fixtureB->ComputeSweepRadius(sweepB.localCenter);
+	callback.input.tolerance = b2_linearSlop;
+	callback.input.counters = counters;
+	callback.grid = (const b2GridShape*)m_fixtureA->GetShape();
+	callback.circle = (const b2CircleShape*)m_fixtureB->GetShape();
+	callback.toi = 1.0f;
+
+	b2AABB aabb;
+	ComputeSweptAABB(&aabb, callback.circle, sweepB, callback.input.sweepRadiusB, sweepA);
+	callback.grid->QueryFaces(&callback, aabb);
+
+	return callback.toi;
+}
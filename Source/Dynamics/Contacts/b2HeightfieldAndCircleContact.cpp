@@ -0,0 +1,132 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2HeightfieldAndCircleContact.h"
+#include "../b2Body.h"
+#include "../b2Fixture.h"
+#include "../../Collision/Shapes/b2HeightfieldShape.h"
+#include "../../Collision/Shapes/b2CircleShape.h"
+#include "../../Collision/Shapes/b2EdgeShape.h"
+#include "../../Collision/b2TimeOfImpact.h"
+#include "../../Common/b2BlockAllocator.h"
+
+#include <new>
+
+// Collides the circle with each heightfield column under the other shape.
+struct b2HeightfieldAndCircleCallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		heightfield->GetChildEdge(&edge, index);
+
+		b2Manifold manifold;
+		b2CollideEdgeAndCircle(&manifold, &edge, xfA, circle, xfB);
+
+		if (manifold.m_pointCount > 0)
+		{
+			contact->AddChild(index, manifold);
+		}
+	}
+
+	b2HeightfieldAndCircleContact* contact;
+	const b2HeightfieldShape* heightfield;
+	const b2CircleShape* circle;
+	b2XForm xfA;
+	b2XForm xfB;
+};
+
+// Finds the earliest time of impact of the circle with the heightfield columns.
+struct b2HeightfieldAndCircleTOICallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		heightfield->GetChildEdge(&edge, index);
+
+		input.sweepRadiusA = edge.ComputeSweepRadius(input.sweepA.localCenter);
+		toi = b2Min(toi, b2TimeOfImpact(&input, &edge, circle));
+	}
+
+	b2TOIInput input;
+	const b2HeightfieldShape* heightfield;
+	const b2CircleShape* circle;
+	float32 toi;
+};
+
+b2Contact* b2HeightfieldAndCircleContact::Create(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2HeightfieldAndCircleContact));
+	return new (mem) b2HeightfieldAndCircleContact(fixtureA, fixtureB);
+}
+
+void b2HeightfieldAndCircleContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2HeightfieldAndCircleContact*)contact)->~b2HeightfieldAndCircleContact();
+	allocator->Free(contact, sizeof(b2HeightfieldAndCircleContact));
+}
+
+b2HeightfieldAndCircleContact::b2HeightfieldAndCircleContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+: b2CompositeContact(fixtureA, fixtureB)
+{
+	b2Assert(m_fixtureA->GetType() == b2_heightfieldShape);
+	b2Assert(m_fixtureB->GetType() == b2_circleShape);
+}
+
+void b2HeightfieldAndCircleContact::Evaluate()
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2HeightfieldAndCircleCallback callback;
+	callback.contact = this;
+	callback.heightfield = (b2HeightfieldShape*)m_fixtureA->GetShape();
+	callback.circle = (b2CircleShape*)m_fixtureB->GetShape();
+	callback.xfA = bodyA->GetXForm();
+	callback.xfB = bodyB->GetXForm();
+
+	// Bound the circle in the frame of the heightfield.
+	b2Vec2 center = b2MulT(callback.xfA, b2Mul(callback.xfB, callback.circle->m_p));
+	b2Vec2 r(callback.circle->m_radius, callback.circle->m_radius);
+	b2AABB aabb;
+	aabb.lowerBound = center - r;
+	aabb.upperBound = center + r;
+
+	BeginChildren();
+	callback.heightfield->QueryChildren(&callback, aabb);
+	EndChildren();
+}
+
+float32 b2HeightfieldAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
+{
+	b2HeightfieldAndCircleTOICallback callback;
+	callback.input.sweepA = sweepA;
+	callback.input.sweepB = sweepB;
+	callback.input.sweepRadiusB = m_fixtureB->ComputeSweepRadius(sweepB.localCenter);
+	callback.input.tolerance = b2_linearSlop;
+	callback.input.counters = counters;
+	callback.heightfield = (const b2HeightfieldShape*)m_fixtureA->GetShape();
+	callback.circle = (const b2CircleShape*)m_fixtureB->GetShape();
+	callback.toi = 1.0f;
+
+	b2AABB aabb;
+	ComputeSweptAABB(&aabb, callback.circle, sweepB, callback.input.sweepRadiusB, sweepA);
+	callback.heightfield->QueryChildren(&callback, aabb);
+
+	return callback.toi;
+}
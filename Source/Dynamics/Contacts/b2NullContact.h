@@ -27,10 +27,11 @@ class b2NullContact : public b2Contact
 public:
 	b2NullContact() {}
 	void Evaluate() {}
-	float32 ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB) const
+	float32 ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
 	{
 		B2_NOT_USED(sweepA);
 		B2_NOT_USED(sweepB);
+		B2_NOT_USED(counters);
 		return 1.0f;
 	}
 };
@@ -43,6 +43,8 @@ b2PolyAndCircleContact::b2PolyAndCircleContact(b2Fixture* fixtureA, b2Fixture* f
 {
 	b2Assert(m_fixtureA->GetType() == b2_polygonShape);
 	b2Assert(m_fixtureB->GetType() == b2_circleShape);
+
+	m_flags |= e_speculativeFlag;
 }
 
 void b2PolyAndCircleContact::Evaluate()
@@ -52,10 +54,11 @@ void b2PolyAndCircleContact::Evaluate()
 
 	b2CollidePolygonAndCircle(	&m_manifold,
 								(b2PolygonShape*)m_fixtureA->GetShape(), bodyA->GetXForm(),
-								(b2CircleShape*)m_fixtureB->GetShape(), bodyB->GetXForm());
+								(b2CircleShape*)m_fixtureB->GetShape(), bodyB->GetXForm(),
+								m_speculativeDistance);
 }
 
-float32 b2PolyAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB) const
+float32 b2PolyAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
 {
 	b2TOIInput input;
 	input.sweepA = sweepA;
@@ -63,6 +66,7 @@ float32 b2PolyAndCircleContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep&
 	input.sweepRadiusA = m_fixtureA->ComputeSweepRadius(sweepA.localCenter);
 	input.sweepRadiusB = m_fixtureB->ComputeSweepRadius(sweepB.localCenter);
 	input.tolerance = b2_linearSlop;
+	input.counters = counters;
 
 	return b2TimeOfImpact(&input, (const b2PolygonShape*)m_fixtureA->GetShape(), (const b2CircleShape*)m_fixtureB->GetShape());
 }
@@ -57,7 +57,7 @@ void b2PolyAndEdgeContact::Evaluate()
 							(b2EdgeShape*)m_fixtureB->GetShape(), bodyB->GetXForm());
 }
 
-float32 b2PolyAndEdgeContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB) const
+float32 b2PolyAndEdgeContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
 {
 	b2TOIInput input;
 	input.sweepA = sweepA;
@@ -65,6 +65,7 @@ float32 b2PolyAndEdgeContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& s
 	input.sweepRadiusA = m_fixtureA->ComputeSweepRadius(sweepA.localCenter);
 	input.sweepRadiusB = m_fixtureB->ComputeSweepRadius(sweepB.localCenter);
 	input.tolerance = b2_linearSlop;
+	input.counters = counters;
 
 	return b2TimeOfImpact(&input, (const b2PolygonShape*)m_fixtureA->GetShape(), (const b2EdgeShape*)m_fixtureB->GetShape());
 }
@@ -0,0 +1,125 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2PolyAndGridContact.h"
+#include "../b2Body.h"
+#include "../b2Fixture.h"
+#include "../../Collision/Shapes/b2GridShape.h"
+#include "../../Collision/Shapes/b2PolygonShape.h"
+#include "../../Collision/b2TimeOfImpact.h"
+#include "../../Common/b2BlockAllocator.h"
+
+#include <new>
+
+// Collides the polygon with each exposed grid face under the other shape.
+struct b2PolyAndGridCallback
+{
+	void QueryCallback(const b2EdgeShape* edge, int32 key)
+	{
+		b2Manifold manifold;
+		b2CollidePolyAndEdge(&manifold, polygon, xfA, edge, xfB);
+
+		if (manifold.m_pointCount > 0)
+		{
+			contact->AddChild(key, manifold);
+		}
+	}
+
+	b2PolyAndGridContact* contact;
+	const b2PolygonShape* polygon;
+	const b2GridShape* grid;
+	b2XForm xfA;
+	b2XForm xfB;
+};
+
+// Finds the earliest time of impact of the polygon with the grid faces.
+struct b2PolyAndGridTOICallback
+{
+	void QueryCallback(const b2EdgeShape* edge, int32 key)
+	{
+		B2_NOT_USED(key);
+
+		input.sweepRadiusB = edge->ComputeSweepRadius(input.sweepB.localCenter);
+		toi = b2Min(toi, b2TimeOfImpact(&input, polygon, edge));
+	}
+
+	b2TOIInput input;
+	const b2PolygonShape* polygon;
+	const b2GridShape* grid;
+	float32 toi;
+};
+
+b2Contact* b2PolyAndGridContact::Create(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2PolyAndGridContact));
+	return new (mem) b2PolyAndGridContact(fixtureA, fixtureB);
+}
+
+void b2PolyAndGridContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2PolyAndGridContact*)contact)->~b2PolyAndGridContact();
+	allocator->Free(contact, sizeof(b2PolyAndGridContact));
+}
+
+b2PolyAndGridContact::b2PolyAndGridContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+: b2CompositeContact(fixtureA, fixtureB)
+{
+	b2Assert(m_fixtureA->GetType() == b2_polygonShape);
+	b2Assert(m_fixtureB->GetType() == b2_gridShape);
+}
+
+void b2PolyAndGridContact::Evaluate()
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2PolyAndGridCallback callback;
+	callback.contact = this;
+	callback.polygon = (b2PolygonShape*)m_fixtureA->GetShape();
+	callback.grid = (b2GridShape*)m_fixtureB->GetShape();
+	callback.xfA = bodyA->GetXForm();
+	callback.xfB = bodyB->GetXForm();
+
+	// Bound the polygon in the frame of the grid.
+	b2XForm xf(b2MulT(callback.xfB, callback.xfA.position), b2MulT(callback.xfB.R, callback.xfA.R));
+	b2AABB aabb;
+	callback.polygon->ComputeAABB(&aabb, xf);
+
+	BeginChildren();
+	callback.grid->QueryFaces(&callback, aabb);
+	EndChildren();
+}
+
+float32 b2PolyAndGridContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
+{
+	b2PolyAndGridTOICallback callback;
+	callback.input.sweepA = sweepA;
+	callback.input.sweepB = sweepB;
+	callback.input.sweepRadiusA = m_fixtureA->ComputeSweepRadius(sweepA.localCenter);
+	callback.input.tolerance = b2_linearSlop;
+	callback.input.counters = counters;
+	callback.polygon = (const b2PolygonShape*)m_fixtureA->GetShape();
+	callback.grid = (const b2GridShape*)m_fixtureB->GetShape();
+	callback.toi = 1.0f;
+
+	b2AABB aabb;
+	ComputeSweptAABB(&aabb, callback.polygon, sweepA, callback.input.sweepRadiusA, sweepB);
+	callback.grid->QueryFaces(&callback, aabb);
+
+	return callback.toi;
+}
@@ -0,0 +1,130 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2PolyAndHeightfieldContact.h"
+#include "../b2Body.h"
+#include "../b2Fixture.h"
+#include "../../Collision/Shapes/b2HeightfieldShape.h"
+#include "../../Collision/Shapes/b2EdgeShape.h"
+#include "../../Collision/Shapes/b2PolygonShape.h"
+#include "../../Collision/b2TimeOfImpact.h"
+#include "../../Common/b2BlockAllocator.h"
+
+#include <new>
+
+// Collides the polygon with each heightfield column under the other shape.
+struct b2PolyAndHeightfieldCallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		heightfield->GetChildEdge(&edge, index);
+
+		b2Manifold manifold;
+		b2CollidePolyAndEdge(&manifold, polygon, xfA, &edge, xfB);
+
+		if (manifold.m_pointCount > 0)
+		{
+			contact->AddChild(index, manifold);
+		}
+	}
+
+	b2PolyAndHeightfieldContact* contact;
+	const b2PolygonShape* polygon;
+	const b2HeightfieldShape* heightfield;
+	b2XForm xfA;
+	b2XForm xfB;
+};
+
+// Finds the earliest time of impact of the polygon with the heightfield columns.
+struct b2PolyAndHeightfieldTOICallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2EdgeShape edge;
+		heightfield->GetChildEdge(&edge, index);
+
+		input.sweepRadiusB = edge.ComputeSweepRadius(input.sweepB.localCenter);
+		toi = b2Min(toi, b2TimeOfImpact(&input, polygon, &edge));
+	}
+
+	b2TOIInput input;
+	const b2PolygonShape* polygon;
+	const b2HeightfieldShape* heightfield;
+	float32 toi;
+};
+
+b2Contact* b2PolyAndHeightfieldContact::Create(b2Fixture* fixtureA, b2Fixture* fixtureB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2PolyAndHeightfieldContact));
+	return new (mem) b2PolyAndHeightfieldContact(fixtureA, fixtureB);
+}
+
+void b2PolyAndHeightfieldContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2PolyAndHeightfieldContact*)contact)->~b2PolyAndHeightfieldContact();
+	allocator->Free(contact, sizeof(b2PolyAndHeightfieldContact));
+}
+
+b2PolyAndHeightfieldContact::b2PolyAndHeightfieldContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+: b2CompositeContact(fixtureA, fixtureB)
+{
+	b2Assert(m_fixtureA->GetType() == b2_polygonShape);
+	b2Assert(m_fixtureB->GetType() == b2_heightfieldShape);
+}
+
+void b2PolyAndHeightfieldContact::Evaluate()
+{
+	b2Body* bodyA = m_fixtureA->GetBody();
+	b2Body* bodyB = m_fixtureB->GetBody();
+
+	b2PolyAndHeightfieldCallback callback;
+	callback.contact = this;
+	callback.polygon = (b2PolygonShape*)m_fixtureA->GetShape();
+	callback.heightfield = (b2HeightfieldShape*)m_fixtureB->GetShape();
+	callback.xfA = bodyA->GetXForm();
+	callback.xfB = bodyB->GetXForm();
+
+	// Bound the polygon in the frame of the heightfield.
+	b2XForm xf(b2MulT(callback.xfB, callback.xfA.position), b2MulT(callback.xfB.R, callback.xfA.R));
+	b2AABB aabb;
+	callback.polygon->ComputeAABB(&aabb, xf);
+
+	BeginChildren();
+	callback.heightfield->QueryChildren(&callback, aabb);
+	EndChildren();
+}
+
+float32 b2PolyAndHeightfieldContact::ComputeTOI(const b2Sweep& sweepA, const b2Sweep& sweepB, b2TOICounters* counters) const
+{
+	b2PolyAndHeightfieldTOICallback callback;
+	callback.input.sweepA = sweepA;
+	callback.input.sweepB = sweepB;
+	callback.input.sweepRadiusA = m_fixtureA->ComputeSweepRadius(sweepA.localCenter);
+	callback.input.tolerance = b2_linearSlop;
+	callback.input.counters = counters;
+	callback.polygon = (const b2PolygonShape*)m_fixtureA->GetShape();
+	callback.heightfield = (const b2HeightfieldShape*)m_fixtureB->GetShape();
+	callback.toi = 1.0f;
+
+	b2AABB aabb;
+	ComputeSweptAABB(&aabb, callback.polygon, sweepA, callback.input.sweepRadiusA, sweepB);
+	callback.heightfield->QueryChildren(&callback, aabb);
+
+	return callback.toi;
+}
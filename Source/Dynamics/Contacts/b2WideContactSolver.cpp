@@ -0,0 +1,963 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "b2WideContactSolver.h"
+#include "../../Common/b2StackAllocator.h"
+
+#include <new>
+
+// The number of lanes. Constraints are solved one at a time when neither
+// SSE2 nor AVX is available or with fixed point math.
+#if defined(TARGET_FLOAT32_IS_FIXED)
+#define B2_SIMD_WIDTH 1
+#elif defined(__AVX__)
+#define B2_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define B2_SIMD_WIDTH 4
+#else
+#define B2_SIMD_WIDTH 1
+#endif
+
+#if B2_SIMD_WIDTH == 8
+
+#include <immintrin.h>
+
+typedef __m256 b2FloatW;
+typedef __m256 b2MaskW;
+
+inline b2FloatW b2ZeroW() { return _mm256_setzero_ps(); }
+inline b2FloatW b2SplatW(float32 a) { return _mm256_set1_ps(a); }
+inline b2FloatW b2LoadW(const float32* p) { return _mm256_loadu_ps(p); }
+inline void b2StoreW(float32* p, b2FloatW a) { _mm256_storeu_ps(p, a); }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return _mm256_add_ps(a, b); }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return _mm256_sub_ps(a, b); }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return _mm256_mul_ps(a, b); }
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b) { return _mm256_div_ps(a, b); }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return _mm256_min_ps(a, b); }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return _mm256_max_ps(a, b); }
+inline b2FloatW b2SqrtW(b2FloatW a) { return _mm256_sqrt_ps(a); }
+inline b2MaskW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline b2MaskW b2GreaterW(b2FloatW a, b2FloatW b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline b2MaskW b2AndW(b2MaskW a, b2MaskW b) { return _mm256_and_ps(a, b); }
+
+// Select b where the mask is set and a elsewhere.
+inline b2FloatW b2BlendW(b2FloatW a, b2FloatW b, b2MaskW mask) { return _mm256_blendv_ps(a, b, mask); }
+
+#elif B2_SIMD_WIDTH == 4
+
+#include <emmintrin.h>
+
+typedef __m128 b2FloatW;
+typedef __m128 b2MaskW;
+
+inline b2FloatW b2ZeroW() { return _mm_setzero_ps(); }
+inline b2FloatW b2SplatW(float32 a) { return _mm_set1_ps(a); }
+inline b2FloatW b2LoadW(const float32* p) { return _mm_loadu_ps(p); }
+inline void b2StoreW(float32* p, b2FloatW a) { _mm_storeu_ps(p, a); }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return _mm_add_ps(a, b); }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return _mm_sub_ps(a, b); }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return _mm_mul_ps(a, b); }
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b) { return _mm_div_ps(a, b); }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return _mm_min_ps(a, b); }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return _mm_max_ps(a, b); }
+inline b2FloatW b2SqrtW(b2FloatW a) { return _mm_sqrt_ps(a); }
+inline b2MaskW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return _mm_cmpge_ps(a, b); }
+inline b2MaskW b2GreaterW(b2FloatW a, b2FloatW b) { return _mm_cmpgt_ps(a, b); }
+inline b2MaskW b2AndW(b2MaskW a, b2MaskW b) { return _mm_and_ps(a, b); }
+
+// Select b where the mask is set and a elsewhere.
+inline b2FloatW b2BlendW(b2FloatW a, b2FloatW b, b2MaskW mask) { return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b)); }
+
+#else
+
+typedef float32 b2FloatW;
+typedef bool b2MaskW;
+
+inline b2FloatW b2ZeroW() { return 0.0f; }
+inline b2FloatW b2SplatW(float32 a) { return a; }
+inline b2FloatW b2LoadW(const float32* p) { return *p; }
+inline void b2StoreW(float32* p, b2FloatW a) { *p = a; }
+inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return a + b; }
+inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return a - b; }
+inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return a * b; }
+inline b2FloatW b2DivW(b2FloatW a, b2FloatW b) { return a / b; }
+inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return b2Min(a, b); }
+inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return b2Max(a, b); }
+inline b2FloatW b2SqrtW(b2FloatW a) { return b2Sqrt(a); }
+inline b2MaskW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return a >= b; }
+inline b2MaskW b2GreaterW(b2FloatW a, b2FloatW b) { return a > b; }
+inline b2MaskW b2AndW(b2MaskW a, b2MaskW b) { return a && b; }
+
+// Select b where the mask is set and a elsewhere.
+inline b2FloatW b2BlendW(b2FloatW a, b2FloatW b, b2MaskW mask) { return mask ? b : a; }
+
+#endif
+
+// Cross product of two vectors given by their components.
+inline b2FloatW b2CrossW(b2FloatW ax, b2FloatW ay, b2FloatW bx, b2FloatW by)
+{
+	return b2SubW(b2MulW(ax, by), b2MulW(ay, bx));
+}
+
+// The velocities of the bodies of a block, one body per lane.
+struct b2VelocityW
+{
+	b2FloatW vx, vy, w;
+};
+
+// The positions of the bodies of a block, one body per lane.
+struct b2PositionW
+{
+	b2FloatW cx, cy, a;
+};
+
+// The relative velocity at a contact point: vB + cross(wB, rB) - vA - cross(wA, rA).
+inline void b2RelativeVelocityW(b2FloatW* dvx, b2FloatW* dvy, const b2VelocityW& A, const b2VelocityW& B,
+								b2FloatW rAx, b2FloatW rAy, b2FloatW rBx, b2FloatW rBy)
+{
+	*dvx = b2AddW(b2SubW(b2SubW(B.vx, b2MulW(B.w, rBy)), A.vx), b2MulW(A.w, rAy));
+	*dvy = b2SubW(b2SubW(b2AddW(B.vy, b2MulW(B.w, rBx)), A.vy), b2MulW(A.w, rAx));
+}
+
+// Apply the impulse P at r to a body. Body A gets the negative impulse.
+inline void b2ApplyImpulseW(b2VelocityW* body, b2FloatW invMass, b2FloatW invI,
+							b2FloatW rx, b2FloatW ry, b2FloatW Px, b2FloatW Py)
+{
+	body->vx = b2AddW(body->vx, b2MulW(invMass, Px));
+	body->vy = b2AddW(body->vy, b2MulW(invMass, Py));
+	body->w = b2AddW(body->w, b2MulW(invI, b2CrossW(rx, ry, Px, Py)));
+}
+
+inline void b2ApplyImpulseW(b2PositionW* body, b2FloatW invMass, b2FloatW invI,
+							b2FloatW rx, b2FloatW ry, b2FloatW Px, b2FloatW Py)
+{
+	body->cx = b2AddW(body->cx, b2MulW(invMass, Px));
+	body->cy = b2AddW(body->cy, b2MulW(invMass, Py));
+	body->a = b2AddW(body->a, b2MulW(invI, b2CrossW(rx, ry, Px, Py)));
+}
+
+// The lanes of a manifold point.
+struct b2WidePoint
+{
+	float32 rAx[B2_SIMD_WIDTH], rAy[B2_SIMD_WIDTH];
+	float32 rBx[B2_SIMD_WIDTH], rBy[B2_SIMD_WIDTH];
+	float32 normalImpulse[B2_SIMD_WIDTH];
+	float32 tangentImpulse[B2_SIMD_WIDTH];
+	float32 normalMass[B2_SIMD_WIDTH];
+	float32 tangentMass[B2_SIMD_WIDTH];
+	float32 equalizedMass[B2_SIMD_WIDTH];
+	float32 velocityBias[B2_SIMD_WIDTH];
+	float32 localPointX[B2_SIMD_WIDTH], localPointY[B2_SIMD_WIDTH];
+};
+
+// Constraints of one color that are solved together. All constraints of
+// a block have the same point count and circle manifolds are kept apart
+// from face manifolds. Unused lanes are zero and have no effect.
+struct b2WideContactBlock
+{
+	b2WidePoint points[b2_maxManifoldPoints];
+	float32 normalX[B2_SIMD_WIDTH], normalY[B2_SIMD_WIDTH];
+	float32 friction[B2_SIMD_WIDTH];
+	float32 invMassA[B2_SIMD_WIDTH], invIA[B2_SIMD_WIDTH];
+	float32 invMassB[B2_SIMD_WIDTH], invIB[B2_SIMD_WIDTH];
+
+	// Block solver.
+	float32 K11[B2_SIMD_WIDTH], K12[B2_SIMD_WIDTH], K22[B2_SIMD_WIDTH];
+	float32 normalMass11[B2_SIMD_WIDTH], normalMass12[B2_SIMD_WIDTH];
+	float32 normalMass21[B2_SIMD_WIDTH], normalMass22[B2_SIMD_WIDTH];
+
+	// Position solver.
+	float32 localCenterAX[B2_SIMD_WIDTH], localCenterAY[B2_SIMD_WIDTH];
+	float32 localCenterBX[B2_SIMD_WIDTH], localCenterBY[B2_SIMD_WIDTH];
+	float32 localNormalX[B2_SIMD_WIDTH], localNormalY[B2_SIMD_WIDTH];
+	float32 localPointX[B2_SIMD_WIDTH], localPointY[B2_SIMD_WIDTH];
+	float32 radius[B2_SIMD_WIDTH];
+	float32 faceB[B2_SIMD_WIDTH];
+	float32 positionMassA[B2_SIMD_WIDTH], positionIA[B2_SIMD_WIDTH];
+	float32 positionMassB[B2_SIMD_WIDTH], positionIB[B2_SIMD_WIDTH];
+
+	b2ContactConstraint* constraints[B2_SIMD_WIDTH];
+	int32 indexA[B2_SIMD_WIDTH];
+	int32 indexB[B2_SIMD_WIDTH];
+	int32 count;
+	int32 pointCount;
+	bool circles;
+};
+
+// Blocks of a color are grouped by circles, one point faces and two point faces.
+const int32 b2_wideGroupCount = 3;
+
+static int32 b2GetWideGroup(const b2ContactConstraint* c)
+{
+	if (c->type == b2Manifold::e_circles)
+	{
+		return 0;
+	}
+
+	return c->pointCount;
+}
+
+static void b2PackLane(b2WideContactBlock* block, int32 lane, b2ContactConstraint* c)
+{
+	int32 k = lane;
+	block->constraints[k] = c;
+	block->indexA[k] = c->indexA;
+	block->indexB[k] = c->indexB;
+	block->normalX[k] = c->normal.x;
+	block->normalY[k] = c->normal.y;
+	block->friction[k] = c->friction;
+	block->invMassA[k] = c->invMassA;
+	block->invIA[k] = c->invIA;
+	block->invMassB[k] = c->invMassB;
+	block->invIB[k] = c->invIB;
+
+	for (int32 j = 0; j < c->pointCount; ++j)
+	{
+		const b2ContactConstraintPoint* ccp = c->points + j;
+		b2WidePoint* p = block->points + j;
+		p->rAx[k] = ccp->rA.x;
+		p->rAy[k] = ccp->rA.y;
+		p->rBx[k] = ccp->rB.x;
+		p->rBy[k] = ccp->rB.y;
+		p->normalImpulse[k] = ccp->normalImpulse;
+		p->tangentImpulse[k] = ccp->tangentImpulse;
+		p->normalMass[k] = ccp->normalMass;
+		p->tangentMass[k] = ccp->tangentMass;
+		p->equalizedMass[k] = ccp->equalizedMass;
+		p->velocityBias[k] = ccp->velocityBias;
+		p->localPointX[k] = ccp->localPoint.x;
+		p->localPointY[k] = ccp->localPoint.y;
+	}
+
+	if (c->pointCount == 2)
+	{
+		block->K11[k] = c->K.col1.x;
+		block->K12[k] = c->K.col2.x;
+		block->K22[k] = c->K.col2.y;
+		block->normalMass11[k] = c->normalMass.col1.x;
+		block->normalMass12[k] = c->normalMass.col2.x;
+		block->normalMass21[k] = c->normalMass.col1.y;
+		block->normalMass22[k] = c->normalMass.col2.y;
+	}
+
+	block->localCenterAX[k] = c->localCenterA.x;
+	block->localCenterAY[k] = c->localCenterA.y;
+	block->localCenterBX[k] = c->localCenterB.x;
+	block->localCenterBY[k] = c->localCenterB.y;
+	block->localNormalX[k] = c->localPlaneNormal.x;
+	block->localNormalY[k] = c->localPlaneNormal.y;
+	block->localPointX[k] = c->localPoint.x;
+	block->localPointY[k] = c->localPoint.y;
+	block->radius[k] = c->radius;
+	block->faceB[k] = c->type == b2Manifold::e_faceB ? 1.0f : 0.0f;
+	block->positionMassA[k] = c->massA * c->invMassA;
+	block->positionIA[k] = c->massA * c->invIA;
+	block->positionMassB[k] = c->massB * c->invMassB;
+	block->positionIB[k] = c->massB * c->invIB;
+}
+
+b2WideContactSolver::b2WideContactSolver(b2ContactConstraint* constraints, int32 constraintCount,
+										 b2Position* positions, b2Velocity* velocities, b2StackAllocator* allocator,
+										 b2TaskScheduler* taskScheduler)
+{
+	m_positions = positions;
+	m_velocities = velocities;
+	m_allocator = allocator;
+	m_taskScheduler = taskScheduler;
+
+	int32 bodyCount = 0;
+	for (int32 i = 0; i < constraintCount; ++i)
+	{
+		bodyCount = b2Max(bodyCount, b2Max(constraints[i].indexA, constraints[i].indexB) + 1);
+	}
+
+	// The colors of the constraints. This array holds the overflow list later.
+	int32* colors = (int32*)m_allocator->Allocate(constraintCount * sizeof(int32));
+
+	// Greedy coloring. Each body keeps the set of colors it is used by.
+	// Bodies without mass are never written, so they may appear in
+	// several constraints of a color.
+	uint32* bodyColors = (uint32*)m_allocator->Allocate(bodyCount * sizeof(uint32));
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		bodyColors[i] = 0;
+	}
+
+	int32 groupCounts[b2_wideColorCount][b2_wideGroupCount];
+	for (int32 i = 0; i < b2_wideColorCount; ++i)
+	{
+		for (int32 j = 0; j < b2_wideGroupCount; ++j)
+		{
+			groupCounts[i][j] = 0;
+		}
+	}
+
+	m_colorCount = 0;
+	m_overflowCount = 0;
+	for (int32 i = 0; i < constraintCount; ++i)
+	{
+		const b2ContactConstraint* c = constraints + i;
+		bool staticA = c->invMassA == 0.0f && c->invIA == 0.0f;
+		bool staticB = c->invMassB == 0.0f && c->invIB == 0.0f;
+
+		uint32 used = 0;
+		if (staticA == false)
+		{
+			used |= bodyColors[c->indexA];
+		}
+		if (staticB == false)
+		{
+			used |= bodyColors[c->indexB];
+		}
+
+		int32 color = 0;
+		while (color < b2_wideColorCount && (used & (1u << color)) != 0)
+		{
+			++color;
+		}
+
+		if (color == b2_wideColorCount)
+		{
+			colors[i] = -1;
+			++m_overflowCount;
+			continue;
+		}
+
+		if (staticA == false)
+		{
+			bodyColors[c->indexA] |= 1u << color;
+		}
+		if (staticB == false)
+		{
+			bodyColors[c->indexB] |= 1u << color;
+		}
+
+		colors[i] = color;
+		++groupCounts[color][b2GetWideGroup(c)];
+		m_colorCount = b2Max(m_colorCount, color + 1);
+	}
+
+	m_allocator->Free(bodyColors);
+
+	// Lay out the blocks by color and group.
+	int32 groupBlocks[b2_wideColorCount][b2_wideGroupCount];
+	int32 groupLanes[b2_wideColorCount][b2_wideGroupCount];
+	m_blockCount = 0;
+	for (int32 i = 0; i < m_colorCount; ++i)
+	{
+		m_colorBlocks[i] = m_blockCount;
+		for (int32 j = 0; j < b2_wideGroupCount; ++j)
+		{
+			groupBlocks[i][j] = m_blockCount;
+			groupLanes[i][j] = 0;
+			m_blockCount += (groupCounts[i][j] + B2_SIMD_WIDTH - 1) / B2_SIMD_WIDTH;
+		}
+	}
+	m_colorBlocks[m_colorCount] = m_blockCount;
+
+	m_blocks = (b2WideContactBlock*)m_allocator->Allocate(m_blockCount * sizeof(b2WideContactBlock));
+	for (int32 i = 0; i < m_blockCount; ++i)
+	{
+		new (m_blocks + i) b2WideContactBlock();
+	}
+
+	// Pack the lanes and collect the overflow.
+	m_overflow = colors;
+	int32 overflowCount = 0;
+	for (int32 i = 0; i < constraintCount; ++i)
+	{
+		int32 color = colors[i];
+		if (color < 0)
+		{
+			m_overflow[overflowCount++] = i;
+			continue;
+		}
+
+		b2ContactConstraint* c = constraints + i;
+		int32 group = b2GetWideGroup(c);
+		b2WideContactBlock* block = m_blocks + groupBlocks[color][group];
+		int32 lane = groupLanes[color][group];
+
+		b2PackLane(block, lane, c);
+		block->count = lane + 1;
+		block->pointCount = c->pointCount;
+		block->circles = group == 0;
+
+		if (lane + 1 == B2_SIMD_WIDTH)
+		{
+			++groupBlocks[color][group];
+			groupLanes[color][group] = 0;
+		}
+		else
+		{
+			groupLanes[color][group] = lane + 1;
+		}
+	}
+
+	b2Assert(overflowCount == m_overflowCount);
+}
+
+b2WideContactSolver::~b2WideContactSolver()
+{
+	m_allocator->Free(m_blocks);
+	m_allocator->Free(m_overflow);
+}
+
+// Solves the blocks of one color on the threads of the task scheduler.
+class b2WideVelocityTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		float32 change = solver->SolveVelocityBlocks(blockStart + begin, blockStart + end);
+		maxChanges[threadIndex] = b2Max(maxChanges[threadIndex], change);
+	}
+
+	b2WideContactSolver* solver;
+	int32 blockStart;
+	float32* maxChanges;
+};
+
+class b2WidePositionTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		float32 separation = solver->SolvePositionBlocks(blockStart + begin, blockStart + end, baumgarte);
+		minSeparations[threadIndex] = b2Min(minSeparations[threadIndex], separation);
+	}
+
+	b2WideContactSolver* solver;
+	int32 blockStart;
+	float32 baumgarte;
+	float32* minSeparations;
+};
+
+float32 b2WideContactSolver::SolveVelocityConstraints()
+{
+	if (m_taskScheduler == NULL)
+	{
+		return SolveVelocityBlocks(0, m_blockCount);
+	}
+
+	// Each thread tracks its own largest velocity change.
+	int32 threadCount = m_taskScheduler->GetThreadCount();
+	float32* maxChanges = (float32*)m_allocator->Allocate(threadCount * sizeof(float32));
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		maxChanges[i] = 0.0f;
+	}
+
+	// The blocks of a color don't share dynamic bodies.
+	b2WideVelocityTask task;
+	task.solver = this;
+	task.maxChanges = maxChanges;
+	for (int32 i = 0; i < m_colorCount; ++i)
+	{
+		task.blockStart = m_colorBlocks[i];
+		m_taskScheduler->Run(&task, m_colorBlocks[i + 1] - m_colorBlocks[i]);
+	}
+
+	float32 maxChange = 0.0f;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		maxChange = b2Max(maxChange, maxChanges[i]);
+	}
+
+	m_allocator->Free(maxChanges);
+	return maxChange;
+}
+
+float32 b2WideContactSolver::SolveVelocityBlocks(int32 begin, int32 end)
+{
+	float32 buffer[6][B2_SIMD_WIDTH];
+	float32 maxChange = 0.0f;
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2WideContactBlock* block = m_blocks + i;
+		int32 count = block->count;
+
+		// Gather the velocities.
+		for (int32 k = 0; k < B2_SIMD_WIDTH; ++k)
+		{
+			if (k < count)
+			{
+				const b2Velocity& velocityA = m_velocities[block->indexA[k]];
+				const b2Velocity& velocityB = m_velocities[block->indexB[k]];
+				buffer[0][k] = velocityA.v.x;
+				buffer[1][k] = velocityA.v.y;
+				buffer[2][k] = velocityA.w;
+				buffer[3][k] = velocityB.v.x;
+				buffer[4][k] = velocityB.v.y;
+				buffer[5][k] = velocityB.w;
+			}
+			else
+			{
+				for (int32 j = 0; j < 6; ++j)
+				{
+					buffer[j][k] = 0.0f;
+				}
+			}
+		}
+
+		b2VelocityW A, B;
+		A.vx = b2LoadW(buffer[0]);
+		A.vy = b2LoadW(buffer[1]);
+		A.w = b2LoadW(buffer[2]);
+		B.vx = b2LoadW(buffer[3]);
+		B.vy = b2LoadW(buffer[4]);
+		B.w = b2LoadW(buffer[5]);
+
+		b2FloatW invMassA = b2LoadW(block->invMassA);
+		b2FloatW invIA = b2LoadW(block->invIA);
+		b2FloatW invMassB = b2LoadW(block->invMassB);
+		b2FloatW invIB = b2LoadW(block->invIB);
+		b2FloatW negInvMassA = b2SubW(b2ZeroW(), invMassA);
+		b2FloatW negInvIA = b2SubW(b2ZeroW(), invIA);
+		b2FloatW normalX = b2LoadW(block->normalX);
+		b2FloatW normalY = b2LoadW(block->normalY);
+		b2FloatW tangentX = normalY;
+		b2FloatW tangentY = b2SubW(b2ZeroW(), normalX);
+		b2FloatW friction = b2LoadW(block->friction);
+
+		// Solve tangent constraints.
+		for (int32 j = 0; j < block->pointCount; ++j)
+		{
+			b2WidePoint* p = block->points + j;
+			b2FloatW rAx = b2LoadW(p->rAx);
+			b2FloatW rAy = b2LoadW(p->rAy);
+			b2FloatW rBx = b2LoadW(p->rBx);
+			b2FloatW rBy = b2LoadW(p->rBy);
+
+			b2FloatW dvx, dvy;
+			b2RelativeVelocityW(&dvx, &dvy, A, B, rAx, rAy, rBx, rBy);
+
+			b2FloatW vt = b2AddW(b2MulW(dvx, tangentX), b2MulW(dvy, tangentY));
+			b2FloatW lambda = b2MulW(b2LoadW(p->tangentMass), b2SubW(b2ZeroW(), vt));
+
+			b2FloatW oldImpulse = b2LoadW(p->tangentImpulse);
+			b2FloatW maxFriction = b2MulW(friction, b2LoadW(p->normalImpulse));
+			b2FloatW newImpulse = b2AddW(oldImpulse, lambda);
+			newImpulse = b2MaxW(b2SubW(b2ZeroW(), maxFriction), b2MinW(newImpulse, maxFriction));
+			lambda = b2SubW(newImpulse, oldImpulse);
+			b2StoreW(p->tangentImpulse, newImpulse);
+
+			b2FloatW Px = b2MulW(lambda, tangentX);
+			b2FloatW Py = b2MulW(lambda, tangentY);
+			b2ApplyImpulseW(&A, negInvMassA, negInvIA, rAx, rAy, Px, Py);
+			b2ApplyImpulseW(&B, invMassB, invIB, rBx, rBy, Px, Py);
+		}
+
+		// Solve normal constraints.
+		if (block->pointCount == 1)
+		{
+			b2WidePoint* p = block->points + 0;
+			b2FloatW rAx = b2LoadW(p->rAx);
+			b2FloatW rAy = b2LoadW(p->rAy);
+			b2FloatW rBx = b2LoadW(p->rBx);
+			b2FloatW rBy = b2LoadW(p->rBy);
+
+			b2FloatW dvx, dvy;
+			b2RelativeVelocityW(&dvx, &dvy, A, B, rAx, rAy, rBx, rBy);
+
+			b2FloatW vn = b2AddW(b2MulW(dvx, normalX), b2MulW(dvy, normalY));
+			b2FloatW lambda = b2MulW(b2SubW(b2ZeroW(), b2LoadW(p->normalMass)), b2SubW(vn, b2LoadW(p->velocityBias)));
+
+			b2FloatW oldImpulse = b2LoadW(p->normalImpulse);
+			b2FloatW newImpulse = b2MaxW(b2AddW(oldImpulse, lambda), b2ZeroW());
+			lambda = b2SubW(newImpulse, oldImpulse);
+			b2StoreW(p->normalImpulse, newImpulse);
+
+			b2FloatW Px = b2MulW(lambda, normalX);
+			b2FloatW Py = b2MulW(lambda, normalY);
+			b2ApplyImpulseW(&A, negInvMassA, negInvIA, rAx, rAy, Px, Py);
+			b2ApplyImpulseW(&B, invMassB, invIB, rBx, rBy, Px, Py);
+		}
+		else
+		{
+			// The block solver of b2ContactSolver. All four cases are evaluated
+			// and the first valid one is selected per lane.
+			b2WidePoint* p1 = block->points + 0;
+			b2WidePoint* p2 = block->points + 1;
+			b2FloatW r1Ax = b2LoadW(p1->rAx);
+			b2FloatW r1Ay = b2LoadW(p1->rAy);
+			b2FloatW r1Bx = b2LoadW(p1->rBx);
+			b2FloatW r1By = b2LoadW(p1->rBy);
+			b2FloatW r2Ax = b2LoadW(p2->rAx);
+			b2FloatW r2Ay = b2LoadW(p2->rAy);
+			b2FloatW r2Bx = b2LoadW(p2->rBx);
+			b2FloatW r2By = b2LoadW(p2->rBy);
+
+			b2FloatW ax = b2LoadW(p1->normalImpulse);
+			b2FloatW ay = b2LoadW(p2->normalImpulse);
+
+			b2FloatW dv1x, dv1y, dv2x, dv2y;
+			b2RelativeVelocityW(&dv1x, &dv1y, A, B, r1Ax, r1Ay, r1Bx, r1By);
+			b2RelativeVelocityW(&dv2x, &dv2y, A, B, r2Ax, r2Ay, r2Bx, r2By);
+
+			b2FloatW vn1 = b2AddW(b2MulW(dv1x, normalX), b2MulW(dv1y, normalY));
+			b2FloatW vn2 = b2AddW(b2MulW(dv2x, normalX), b2MulW(dv2y, normalY));
+
+			// b = vn - velocityBias - K * a
+			b2FloatW K11 = b2LoadW(block->K11);
+			b2FloatW K12 = b2LoadW(block->K12);
+			b2FloatW K22 = b2LoadW(block->K22);
+			b2FloatW bx = b2SubW(b2SubW(vn1, b2LoadW(p1->velocityBias)), b2AddW(b2MulW(K11, ax), b2MulW(K12, ay)));
+			b2FloatW by = b2SubW(b2SubW(vn2, b2LoadW(p2->velocityBias)), b2AddW(b2MulW(K12, ax), b2MulW(K22, ay)));
+
+			// Case 1: vn = 0
+			b2FloatW x1 = b2SubW(b2ZeroW(), b2AddW(b2MulW(b2LoadW(block->normalMass11), bx), b2MulW(b2LoadW(block->normalMass12), by)));
+			b2FloatW x2 = b2SubW(b2ZeroW(), b2AddW(b2MulW(b2LoadW(block->normalMass21), bx), b2MulW(b2LoadW(block->normalMass22), by)));
+			b2MaskW case1 = b2AndW(b2GreaterEqualW(x1, b2ZeroW()), b2GreaterEqualW(x2, b2ZeroW()));
+
+			// Case 2: vn1 = 0 and x2 = 0
+			b2FloatW c2x1 = b2SubW(b2ZeroW(), b2MulW(b2LoadW(p1->normalMass), bx));
+			b2FloatW c2vn2 = b2AddW(b2MulW(K12, c2x1), by);
+			b2MaskW case2 = b2AndW(b2GreaterEqualW(c2x1, b2ZeroW()), b2GreaterEqualW(c2vn2, b2ZeroW()));
+
+			// Case 3: vn2 = 0 and x1 = 0
+			b2FloatW c3x2 = b2SubW(b2ZeroW(), b2MulW(b2LoadW(p2->normalMass), by));
+			b2FloatW c3vn1 = b2AddW(b2MulW(K12, c3x2), bx);
+			b2MaskW case3 = b2AndW(b2GreaterEqualW(c3x2, b2ZeroW()), b2GreaterEqualW(c3vn1, b2ZeroW()));
+
+			// Case 4: x1 = 0 and x2 = 0
+			b2MaskW case4 = b2AndW(b2GreaterEqualW(bx, b2ZeroW()), b2GreaterEqualW(by, b2ZeroW()));
+
+			// Keep the old impulse when there is no solution.
+			b2FloatW xx = b2BlendW(ax, b2ZeroW(), case4);
+			b2FloatW xy = b2BlendW(ay, b2ZeroW(), case4);
+			xx = b2BlendW(xx, b2ZeroW(), case3);
+			xy = b2BlendW(xy, c3x2, case3);
+			xx = b2BlendW(xx, c2x1, case2);
+			xy = b2BlendW(xy, b2ZeroW(), case2);
+			xx = b2BlendW(xx, x1, case1);
+			xy = b2BlendW(xy, x2, case1);
+
+			// Apply the incremental impulse.
+			b2FloatW dx = b2SubW(xx, ax);
+			b2FloatW dy = b2SubW(xy, ay);
+			b2StoreW(p1->normalImpulse, xx);
+			b2StoreW(p2->normalImpulse, xy);
+
+			b2FloatW P1x = b2MulW(dx, normalX);
+			b2FloatW P1y = b2MulW(dx, normalY);
+			b2FloatW P2x = b2MulW(dy, normalX);
+			b2FloatW P2y = b2MulW(dy, normalY);
+			b2FloatW Px = b2AddW(P1x, P2x);
+			b2FloatW Py = b2AddW(P1y, P2y);
+
+			A.vx = b2SubW(A.vx, b2MulW(invMassA, Px));
+			A.vy = b2SubW(A.vy, b2MulW(invMassA, Py));
+			A.w = b2SubW(A.w, b2MulW(invIA, b2AddW(b2CrossW(r1Ax, r1Ay, P1x, P1y), b2CrossW(r2Ax, r2Ay, P2x, P2y))));
+
+			B.vx = b2AddW(B.vx, b2MulW(invMassB, Px));
+			B.vy = b2AddW(B.vy, b2MulW(invMassB, Py));
+			B.w = b2AddW(B.w, b2MulW(invIB, b2AddW(b2CrossW(r1Bx, r1By, P1x, P1y), b2CrossW(r2Bx, r2By, P2x, P2y))));
+		}
+
+		// Scatter the velocities.
+		b2StoreW(buffer[0], A.vx);
+		b2StoreW(buffer[1], A.vy);
+		b2StoreW(buffer[2], A.w);
+		b2StoreW(buffer[3], B.vx);
+		b2StoreW(buffer[4], B.vy);
+		b2StoreW(buffer[5], B.w);
+
+		// Bodies without mass are unchanged and may be shared by other
+		// blocks of the color, so they are not written.
+		for (int32 k = 0; k < count; ++k)
+		{
+			if (block->invMassA[k] != 0.0f || block->invIA[k] != 0.0f)
+			{
+				b2Velocity& velocityA = m_velocities[block->indexA[k]];
+				b2Vec2 vA(buffer[0][k], buffer[1][k]);
+				maxChange = b2Max(maxChange, b2VelocityChange(velocityA, vA, buffer[2][k]));
+				velocityA.v = vA;
+				velocityA.w = buffer[2][k];
+			}
+
+			if (block->invMassB[k] != 0.0f || block->invIB[k] != 0.0f)
+			{
+				b2Velocity& velocityB = m_velocities[block->indexB[k]];
+				b2Vec2 vB(buffer[3][k], buffer[4][k]);
+				maxChange = b2Max(maxChange, b2VelocityChange(velocityB, vB, buffer[5][k]));
+				velocityB.v = vB;
+				velocityB.w = buffer[5][k];
+			}
+		}
+	}
+
+	return maxChange;
+}
+
+void b2WideContactSolver::StoreImpulses()
+{
+	for (int32 i = 0; i < m_blockCount; ++i)
+	{
+		b2WideContactBlock* block = m_blocks + i;
+		for (int32 k = 0; k < block->count; ++k)
+		{
+			b2ContactConstraint* c = block->constraints[k];
+			for (int32 j = 0; j < c->pointCount; ++j)
+			{
+				c->points[j].normalImpulse = block->points[j].normalImpulse[k];
+				c->points[j].tangentImpulse = block->points[j].tangentImpulse[k];
+			}
+		}
+	}
+}
+
+float32 b2WideContactSolver::SolvePositionConstraints(float32 baumgarte)
+{
+	if (m_taskScheduler == NULL)
+	{
+		return SolvePositionBlocks(0, m_blockCount, baumgarte);
+	}
+
+	// Each thread tracks its own minimum separation.
+	int32 threadCount = m_taskScheduler->GetThreadCount();
+	float32* minSeparations = (float32*)m_allocator->Allocate(threadCount * sizeof(float32));
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		minSeparations[i] = 0.0f;
+	}
+
+	b2WidePositionTask task;
+	task.solver = this;
+	task.baumgarte = baumgarte;
+	task.minSeparations = minSeparations;
+	for (int32 i = 0; i < m_colorCount; ++i)
+	{
+		task.blockStart = m_colorBlocks[i];
+		m_taskScheduler->Run(&task, m_colorBlocks[i + 1] - m_colorBlocks[i]);
+	}
+
+	float32 minSeparation = 0.0f;
+	for (int32 i = 0; i < threadCount; ++i)
+	{
+		minSeparation = b2Min(minSeparation, minSeparations[i]);
+	}
+
+	m_allocator->Free(minSeparations);
+	return minSeparation;
+}
+
+float32 b2WideContactSolver::SolvePositionBlocks(int32 begin, int32 end, float32 baumgarte)
+{
+	float32 buffer[10][B2_SIMD_WIDTH];
+
+	b2FloatW minSeparation = b2ZeroW();
+	b2FloatW baumgarteW = b2SplatW(baumgarte);
+	b2FloatW slop = b2SplatW(b2_linearSlop);
+	b2FloatW maxCorrection = b2SplatW(b2_maxLinearCorrection);
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2WideContactBlock* block = m_blocks + i;
+		int32 count = block->count;
+
+		// Gather the positions. The rotations are computed here because
+		// there are no wide sine and cosine.
+		for (int32 k = 0; k < B2_SIMD_WIDTH; ++k)
+		{
+			if (k < count)
+			{
+				const b2Position& positionA = m_positions[block->indexA[k]];
+				const b2Position& positionB = m_positions[block->indexB[k]];
+				buffer[0][k] = positionA.x.x;
+				buffer[1][k] = positionA.x.y;
+				buffer[2][k] = positionA.a;
+				buffer[3][k] = cosf(positionA.a);
+				buffer[4][k] = sinf(positionA.a);
+				buffer[5][k] = positionB.x.x;
+				buffer[6][k] = positionB.x.y;
+				buffer[7][k] = positionB.a;
+				buffer[8][k] = cosf(positionB.a);
+				buffer[9][k] = sinf(positionB.a);
+			}
+			else
+			{
+				for (int32 j = 0; j < 10; ++j)
+				{
+					buffer[j][k] = 0.0f;
+				}
+			}
+		}
+
+		b2PositionW A, B;
+		A.cx = b2LoadW(buffer[0]);
+		A.cy = b2LoadW(buffer[1]);
+		A.a = b2LoadW(buffer[2]);
+		B.cx = b2LoadW(buffer[5]);
+		B.cy = b2LoadW(buffer[6]);
+		B.a = b2LoadW(buffer[7]);
+
+		// xf.position = c - R * localCenter
+		b2FloatW cosA = b2LoadW(buffer[3]);
+		b2FloatW sinA = b2LoadW(buffer[4]);
+		b2FloatW cosB = b2LoadW(buffer[8]);
+		b2FloatW sinB = b2LoadW(buffer[9]);
+		b2FloatW lcAx = b2LoadW(block->localCenterAX);
+		b2FloatW lcAy = b2LoadW(block->localCenterAY);
+		b2FloatW lcBx = b2LoadW(block->localCenterBX);
+		b2FloatW lcBy = b2LoadW(block->localCenterBY);
+		b2FloatW xfAx = b2SubW(A.cx, b2SubW(b2MulW(cosA, lcAx), b2MulW(sinA, lcAy)));
+		b2FloatW xfAy = b2SubW(A.cy, b2AddW(b2MulW(sinA, lcAx), b2MulW(cosA, lcAy)));
+		b2FloatW xfBx = b2SubW(B.cx, b2SubW(b2MulW(cosB, lcBx), b2MulW(sinB, lcBy)));
+		b2FloatW xfBy = b2SubW(B.cy, b2AddW(b2MulW(sinB, lcBx), b2MulW(cosB, lcBy)));
+
+		b2FloatW localPointX = b2LoadW(block->localPointX);
+		b2FloatW localPointY = b2LoadW(block->localPointY);
+		b2FloatW radius = b2LoadW(block->radius);
+
+		// The position solver manifold of b2ContactSolver.
+		b2FloatW normalX, normalY;
+		b2FloatW pointX[b2_maxManifoldPoints], pointY[b2_maxManifoldPoints];
+		b2FloatW separation[b2_maxManifoldPoints];
+
+		if (block->circles)
+		{
+			b2WidePoint* p = block->points + 0;
+			b2FloatW lpx = b2LoadW(p->localPointX);
+			b2FloatW lpy = b2LoadW(p->localPointY);
+			b2FloatW pAx = b2AddW(xfAx, b2SubW(b2MulW(cosA, localPointX), b2MulW(sinA, localPointY)));
+			b2FloatW pAy = b2AddW(xfAy, b2AddW(b2MulW(sinA, localPointX), b2MulW(cosA, localPointY)));
+			b2FloatW pBx = b2AddW(xfBx, b2SubW(b2MulW(cosB, lpx), b2MulW(sinB, lpy)));
+			b2FloatW pBy = b2AddW(xfBy, b2AddW(b2MulW(sinB, lpx), b2MulW(cosB, lpy)));
+
+			b2FloatW dx = b2SubW(pBx, pAx);
+			b2FloatW dy = b2SubW(pBy, pAy);
+			b2FloatW distanceSquared = b2AddW(b2MulW(dx, dx), b2MulW(dy, dy));
+			b2FloatW epsilonSquared = b2SplatW(B2_FLT_EPSILON * B2_FLT_EPSILON);
+			b2MaskW apart = b2GreaterW(distanceSquared, epsilonSquared);
+			b2FloatW invLength = b2DivW(b2SplatW(1.0f), b2SqrtW(b2MaxW(distanceSquared, epsilonSquared)));
+			normalX = b2BlendW(b2SplatW(1.0f), b2MulW(dx, invLength), apart);
+			normalY = b2BlendW(b2ZeroW(), b2MulW(dy, invLength), apart);
+
+			b2FloatW half = b2SplatW(0.5f);
+			pointX[0] = b2MulW(half, b2AddW(pAx, pBx));
+			pointY[0] = b2MulW(half, b2AddW(pAy, pBy));
+			separation[0] = b2SubW(b2AddW(b2MulW(dx, normalX), b2MulW(dy, normalY)), radius);
+		}
+		else
+		{
+			// The reference face belongs to A or B.
+			b2MaskW faceB = b2GreaterW(b2LoadW(block->faceB), b2ZeroW());
+			b2FloatW refCos = b2BlendW(cosA, cosB, faceB);
+			b2FloatW refSin = b2BlendW(sinA, sinB, faceB);
+			b2FloatW refX = b2BlendW(xfAx, xfBx, faceB);
+			b2FloatW refY = b2BlendW(xfAy, xfBy, faceB);
+			b2FloatW incCos = b2BlendW(cosB, cosA, faceB);
+			b2FloatW incSin = b2BlendW(sinB, sinA, faceB);
+			b2FloatW incX = b2BlendW(xfBx, xfAx, faceB);
+			b2FloatW incY = b2BlendW(xfBy, xfAy, faceB);
+
+			b2FloatW lnx = b2LoadW(block->localNormalX);
+			b2FloatW lny = b2LoadW(block->localNormalY);
+			normalX = b2SubW(b2MulW(refCos, lnx), b2MulW(refSin, lny));
+			normalY = b2AddW(b2MulW(refSin, lnx), b2MulW(refCos, lny));
+			b2FloatW planeX = b2AddW(refX, b2SubW(b2MulW(refCos, localPointX), b2MulW(refSin, localPointY)));
+			b2FloatW planeY = b2AddW(refY, b2AddW(b2MulW(refSin, localPointX), b2MulW(refCos, localPointY)));
+
+			for (int32 j = 0; j < block->pointCount; ++j)
+			{
+				b2WidePoint* p = block->points + j;
+				b2FloatW lpx = b2LoadW(p->localPointX);
+				b2FloatW lpy = b2LoadW(p->localPointY);
+				pointX[j] = b2AddW(incX, b2SubW(b2MulW(incCos, lpx), b2MulW(incSin, lpy)));
+				pointY[j] = b2AddW(incY, b2AddW(b2MulW(incSin, lpx), b2MulW(incCos, lpy)));
+				b2FloatW dx = b2SubW(pointX[j], planeX);
+				b2FloatW dy = b2SubW(pointY[j], planeY);
+				separation[j] = b2SubW(b2AddW(b2MulW(dx, normalX), b2MulW(dy, normalY)), radius);
+			}
+
+			// Ensure the normal points from A to B.
+			normalX = b2BlendW(normalX, b2SubW(b2ZeroW(), normalX), faceB);
+			normalY = b2BlendW(normalY, b2SubW(b2ZeroW(), normalY), faceB);
+		}
+
+		b2FloatW invMassA = b2LoadW(block->positionMassA);
+		b2FloatW invIA = b2LoadW(block->positionIA);
+		b2FloatW invMassB = b2LoadW(block->positionMassB);
+		b2FloatW invIB = b2LoadW(block->positionIB);
+		b2FloatW negInvMassA = b2SubW(b2ZeroW(), invMassA);
+		b2FloatW negInvIA = b2SubW(b2ZeroW(), invIA);
+
+		for (int32 j = 0; j < block->pointCount; ++j)
+		{
+			b2FloatW rAx = b2SubW(pointX[j], A.cx);
+			b2FloatW rAy = b2SubW(pointY[j], A.cy);
+			b2FloatW rBx = b2SubW(pointX[j], B.cx);
+			b2FloatW rBy = b2SubW(pointY[j], B.cy);
+
+			// Track max constraint error.
+			minSeparation = b2MinW(minSeparation, separation[j]);
+
+			// Prevent large corrections and allow slop.
+			b2FloatW C = b2AddW(separation[j], slop);
+			C = b2MaxW(b2SubW(b2ZeroW(), maxCorrection), b2MinW(C, b2ZeroW()));
+			C = b2MulW(baumgarteW, C);
+
+			// Compute normal impulse
+			b2FloatW impulse = b2MulW(b2SubW(b2ZeroW(), b2LoadW(block->points[j].equalizedMass)), C);
+
+			b2FloatW Px = b2MulW(impulse, normalX);
+			b2FloatW Py = b2MulW(impulse, normalY);
+			b2ApplyImpulseW(&A, negInvMassA, negInvIA, rAx, rAy, Px, Py);
+			b2ApplyImpulseW(&B, invMassB, invIB, rBx, rBy, Px, Py);
+		}
+
+		// Scatter the positions.
+		b2StoreW(buffer[0], A.cx);
+		b2StoreW(buffer[1], A.cy);
+		b2StoreW(buffer[2], A.a);
+		b2StoreW(buffer[5], B.cx);
+		b2StoreW(buffer[6], B.cy);
+		b2StoreW(buffer[7], B.a);
+
+		for (int32 k = 0; k < count; ++k)
+		{
+			if (block->invMassA[k] != 0.0f || block->invIA[k] != 0.0f)
+			{
+				b2Position& positionA = m_positions[block->indexA[k]];
+				positionA.x.Set(buffer[0][k], buffer[1][k]);
+				positionA.a = buffer[2][k];
+			}
+
+			if (block->invMassB[k] != 0.0f || block->invIB[k] != 0.0f)
+			{
+				b2Position& positionB = m_positions[block->indexB[k]];
+				positionB.x.Set(buffer[5][k], buffer[6][k]);
+				positionB.a = buffer[7][k];
+			}
+		}
+	}
+
+	float32 separations[B2_SIMD_WIDTH];
+	b2StoreW(separations, minSeparation);
+
+	float32 result = 0.0f;
+	for (int32 k = 0; k < B2_SIMD_WIDTH; ++k)
+	{
+		result = b2Min(result, separations[k]);
+	}
+
+	return result;
+}
@@ -0,0 +1,83 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B2_WIDE_CONTACT_SOLVER_H
+#define B2_WIDE_CONTACT_SOLVER_H
+
+#include "b2ContactSolver.h"
+
+struct b2WideContactBlock;
+
+/// The number of colors. Constraints that find no free color are solved
+/// by the scalar solver.
+const int32 b2_wideColorCount = 32;
+
+/// Solves contact constraints several at a time with SIMD instructions.
+/// The constraints are colored so that no two constraints of a color share
+/// a dynamic body. The constraints of a color are packed into blocks of
+/// lanes (4 with SSE2, 8 with AVX) and each block is solved at once,
+/// including the two point block solver. Constraints that don't get a color
+/// are left to the scalar solver. Without SIMD support a block holds a
+/// single constraint.
+/// With a task scheduler the blocks of a color are spread over the threads
+/// and the colors are solved one after the other. The result doesn't
+/// depend on the number of threads.
+class b2WideContactSolver
+{
+public:
+	b2WideContactSolver(b2ContactConstraint* constraints, int32 constraintCount,
+						b2Position* positions, b2Velocity* velocities, b2StackAllocator* allocator,
+						b2TaskScheduler* taskScheduler);
+	~b2WideContactSolver();
+
+	/// @return the largest velocity change of the colored constraints.
+	float32 SolveVelocityConstraints();
+
+	/// Copy the accumulated impulses back to the constraints.
+	void StoreImpulses();
+
+	/// @return the minimum separation of the colored constraints.
+	float32 SolvePositionConstraints(float32 baumgarte);
+
+	/// Solve the velocity constraints of the blocks in [begin, end).
+	/// @return the largest velocity change of the blocks.
+	float32 SolveVelocityBlocks(int32 begin, int32 end);
+
+	/// Solve the position constraints of the blocks in [begin, end).
+	/// @return the minimum separation of the blocks.
+	float32 SolvePositionBlocks(int32 begin, int32 end, float32 baumgarte);
+
+	b2Position* m_positions;
+	b2Velocity* m_velocities;
+	b2StackAllocator* m_allocator;
+	b2TaskScheduler* m_taskScheduler;
+
+	b2WideContactBlock* m_blocks;
+	int32 m_blockCount;
+	int32 m_colorCount;
+
+	// The blocks of color i are [m_colorBlocks[i], m_colorBlocks[i + 1]).
+	int32 m_colorBlocks[b2_wideColorCount + 1];
+
+	// The indices of the constraints that didn't get a color.
+	int32* m_overflow;
+	int32 m_overflowCount;
+};
+
+#endif
@@ -44,7 +44,7 @@ void b2BuoyancyController::Step(const b2TimeStep& step)
 	for(b2ControllerEdge *i=m_bodyList;i;i=i->nextBody)
 	{
 		b2Body* body = i->body;
-		if(body->IsSleeping())
+		if(body->IsSleeping() || body->IsActive() == false)
 		{
 			//Buoyancy force is just a function of position,
 			//so unlike most forces, it is safe to ignore sleeping bodes
@@ -28,7 +28,7 @@ void b2ConstantForceController::Step(const b2TimeStep& step)
 	B2_NOT_USED(step);
 	for(b2ControllerEdge *i=m_bodyList;i;i=i->nextBody){
 		b2Body* body = i->body;
-		if(body->IsSleeping())
+		if(body->IsSleeping() || body->IsActive() == false)
 			continue;
 		body->ApplyForce(F,body->GetWorldCenter());
 	}
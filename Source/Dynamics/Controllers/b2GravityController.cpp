@@ -30,8 +30,12 @@ void b2GravityController::Step(const b2TimeStep& step)
 	if(invSqr){
 		for(b2ControllerEdge *i=m_bodyList;i;i=i->nextBody){
 			b2Body* body1 = i->body;
+			if(body1->IsActive() == false)
+				continue;
 			for(b2ControllerEdge *j=m_bodyList;j!=i;j=j->nextBody){
 				b2Body* body2 = j->body;
+				if(body2->IsActive() == false)
+					continue;
 				b2Vec2 d = body2->GetWorldCenter() - body1->GetWorldCenter();
 				float32 r2 = d.LengthSquared();
 				if(r2 < B2_FLT_EPSILON)
@@ -44,8 +48,12 @@ void b2GravityController::Step(const b2TimeStep& step)
 	}else{
 		for(b2ControllerEdge *i=m_bodyList;i;i=i->nextBody){
 			b2Body* body1 = i->body;
+			if(body1->IsActive() == false)
+				continue;
 			for(b2ControllerEdge *j=m_bodyList;j!=i;j=j->nextBody){
 				b2Body* body2 = j->body;
+				if(body2->IsActive() == false)
+					continue;
 				b2Vec2 d = body2->GetWorldCenter() - body1->GetWorldCenter();
 				float32 r2 = d.LengthSquared();
 				if(r2 < B2_FLT_EPSILON)
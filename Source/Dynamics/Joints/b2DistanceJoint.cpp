@@ -60,15 +60,34 @@ b2DistanceJoint::b2DistanceJoint(const b2DistanceJointDef* def)
 	m_bias = 0.0f;
 }
 
-void b2DistanceJoint::InitVelocityConstraints(const b2TimeStep& step)
+void b2DistanceJoint::InitVelocityConstraints(const b2SolverData& data)
 {
+	const b2TimeStep& step = data.step;
+
 	b2Body* b1 = m_body1;
 	b2Body* b2 = m_body2;
 
+	m_localCenter1 = b1->m_sweep.localCenter;
+	m_localCenter2 = b2->m_sweep.localCenter;
+	m_invMass1 = b1->m_invMass;
+	m_invMass2 = b2->m_invMass;
+	m_invI1 = b1->m_invI;
+	m_invI2 = b2->m_invI;
+
+	b2Vec2 c1 = data.positions[m_index1].x;
+	float32 a1 = data.positions[m_index1].a;
+	b2Vec2 v1 = data.velocities[m_index1].v;
+	float32 w1 = data.velocities[m_index1].w;
+
+	b2Vec2 c2 = data.positions[m_index2].x;
+	float32 a2 = data.positions[m_index2].a;
+	b2Vec2 v2 = data.velocities[m_index2].v;
+	float32 w2 = data.velocities[m_index2].w;
+
 	// Compute the effective mass matrix.
-	b2Vec2 r1 = b2Mul(b1->GetXForm().R, m_localAnchor1 - b1->GetLocalCenter());
-	b2Vec2 r2 = b2Mul(b2->GetXForm().R, m_localAnchor2 - b2->GetLocalCenter());
-	m_u = b2->m_sweep.c + r2 - b1->m_sweep.c - r1;
+	m_r1 = b2Mul(b2Mat22(a1), m_localAnchor1 - m_localCenter1);
+	m_r2 = b2Mul(b2Mat22(a2), m_localAnchor2 - m_localCenter2);
+	m_u = c2 + m_r2 - c1 - m_r1;
 
 	// Handle singularity.
 	float32 length = m_u.Length();
@@ -81,9 +100,9 @@ void b2DistanceJoint::InitVelocityConstraints(const b2TimeStep& step)
 		m_u.Set(0.0f, 0.0f);
 	}
 
-	float32 cr1u = b2Cross(r1, m_u);
-	float32 cr2u = b2Cross(r2, m_u);
-	float32 invMass = b1->m_invMass + b1->m_invI * cr1u * cr1u + b2->m_invMass + b2->m_invI * cr2u * cr2u;
+	float32 cr1u = b2Cross(m_r1, m_u);
+	float32 cr2u = b2Cross(m_r2, m_u);
+	float32 invMass = m_invMass1 + m_invI1 * cr1u * cr1u + m_invMass2 + m_invI2 * cr2u * cr2u;
 	b2Assert(invMass > B2_FLT_EPSILON);
 	m_mass = 1.0f / invMass;
 
@@ -113,43 +132,55 @@ void b2DistanceJoint::InitVelocityConstraints(const b2TimeStep& step)
 		m_impulse *= step.dtRatio;
 
 		b2Vec2 P = m_impulse * m_u;
-		b1->m_linearVelocity -= b1->m_invMass * P;
-		b1->m_angularVelocity -= b1->m_invI * b2Cross(r1, P);
-		b2->m_linearVelocity += b2->m_invMass * P;
-		b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P);
+		v1 -= m_invMass1 * P;
+		w1 -= m_invI1 * b2Cross(m_r1, P);
+		v2 += m_invMass2 * P;
+		w2 += m_invI2 * b2Cross(m_r2, P);
 	}
 	else
 	{
 		m_impulse = 0.0f;
 	}
+
+	data.velocities[m_index1].v = v1;
+	data.velocities[m_index1].w = w1;
+	data.velocities[m_index2].v = v2;
+	data.velocities[m_index2].w = w2;
 }
 
-void b2DistanceJoint::SolveVelocityConstraints(const b2TimeStep& step)
+float32 b2DistanceJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
-	B2_NOT_USED(step);
-
-	b2Body* b1 = m_body1;
-	b2Body* b2 = m_body2;
-
-	b2Vec2 r1 = b2Mul(b1->GetXForm().R, m_localAnchor1 - b1->GetLocalCenter());
-	b2Vec2 r2 = b2Mul(b2->GetXForm().R, m_localAnchor2 - b2->GetLocalCenter());
+	b2Vec2 v1 = data.velocities[m_index1].v;
+	float32 w1 = data.velocities[m_index1].w;
+	b2Vec2 v2 = data.velocities[m_index2].v;
+	float32 w2 = data.velocities[m_index2].w;
 
 	// Cdot = dot(u, v + cross(w, r))
-	b2Vec2 v1 = b1->m_linearVelocity + b2Cross(b1->m_angularVelocity, r1);
-	b2Vec2 v2 = b2->m_linearVelocity + b2Cross(b2->m_angularVelocity, r2);
-	float32 Cdot = b2Dot(m_u, v2 - v1);
+	b2Vec2 vp1 = v1 + b2Cross(w1, m_r1);
+	b2Vec2 vp2 = v2 + b2Cross(w2, m_r2);
+	float32 Cdot = b2Dot(m_u, vp2 - vp1);
 
 	float32 impulse = -m_mass * (Cdot + m_bias + m_gamma * m_impulse);
 	m_impulse += impulse;
 
 	b2Vec2 P = impulse * m_u;
-	b1->m_linearVelocity -= b1->m_invMass * P;
-	b1->m_angularVelocity -= b1->m_invI * b2Cross(r1, P);
-	b2->m_linearVelocity += b2->m_invMass * P;
-	b2->m_angularVelocity += b2->m_invI * b2Cross(r2, P);
+	v1 -= m_invMass1 * P;
+	w1 -= m_invI1 * b2Cross(m_r1, P);
+	v2 += m_invMass2 * P;
+	w2 += m_invI2 * b2Cross(m_r2, P);
+
+	float32 change = b2Max(b2VelocityChange(data.velocities[m_index1], v1, w1),
+						   b2VelocityChange(data.velocities[m_index2], v2, w2));
+
+	data.velocities[m_index1].v = v1;
+	data.velocities[m_index1].w = w1;
+	data.velocities[m_index2].v = v2;
+	data.velocities[m_index2].w = w2;
+
+	return change;
 }
 
-bool b2DistanceJoint::SolvePositionConstraints(float32 baumgarte)
+bool b2DistanceJoint::SolvePositionConstraints(const b2SolverData& data, float32 baumgarte)
 {
 	B2_NOT_USED(baumgarte);
 
@@ -159,13 +190,15 @@ bool b2DistanceJoint::SolvePositionConstraints(float32 baumgarte)
 		return true;
 	}
 
-	b2Body* b1 = m_body1;
-	b2Body* b2 = m_body2;
+	b2Vec2 c1 = data.positions[m_index1].x;
+	float32 a1 = data.positions[m_index1].a;
+	b2Vec2 c2 = data.positions[m_index2].x;
+	float32 a2 = data.positions[m_index2].a;
 
-	b2Vec2 r1 = b2Mul(b1->GetXForm().R, m_localAnchor1 - b1->GetLocalCenter());
-	b2Vec2 r2 = b2Mul(b2->GetXForm().R, m_localAnchor2 - b2->GetLocalCenter());
+	b2Vec2 r1 = b2Mul(b2Mat22(a1), m_localAnchor1 - m_localCenter1);
+	b2Vec2 r2 = b2Mul(b2Mat22(a2), m_localAnchor2 - m_localCenter2);
 
-	b2Vec2 d = b2->m_sweep.c + r2 - b1->m_sweep.c - r1;
+	b2Vec2 d = c2 + r2 - c1 - r1;
 
 	float32 length = d.Normalize();
 	float32 C = length - m_length;
@@ -175,13 +208,15 @@ bool b2DistanceJoint::SolvePositionConstraints(float32 baumgarte)
 	m_u = d;
 	b2Vec2 P = impulse * m_u;
 
-	b1->m_sweep.c -= b1->m_invMass * P;
-	b1->m_sweep.a -= b1->m_invI * b2Cross(r1, P);
-	b2->m_sweep.c += b2->m_invMass * P;
-	b2->m_sweep.a += b2->m_invI * b2Cross(r2, P);
+	c1 -= m_invMass1 * P;
+	a1 -= m_invI1 * b2Cross(r1, P);
+	c2 += m_invMass2 * P;
+	a2 += m_invI2 * b2Cross(r2, P);
 
-	b1->SynchronizeTransform();
-	b2->SynchronizeTransform();
+	data.positions[m_index1].x = c1;
+	data.positions[m_index1].a = a1;
+	data.positions[m_index2].x = c2;
+	data.positions[m_index2].a = a2;
 
 	return b2Abs(C) < b2_linearSlop;
 }
@@ -73,9 +73,9 @@ public:
 
 	b2GearJoint(const b2GearJointDef* data);
 
-	void InitVelocityConstraints(const b2TimeStep& step);
-	void SolveVelocityConstraints(const b2TimeStep& step);
-	bool SolvePositionConstraints(float32 baumgarte);
+	void InitVelocityConstraints(const b2SolverData& data);
+	float32 SolveVelocityConstraints(const b2SolverData& data);
+	bool SolvePositionConstraints(const b2SolverData& data, float32 baumgarte);
 
 	b2Body* m_ground1;
 	b2Body* m_ground2;
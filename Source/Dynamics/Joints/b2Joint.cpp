@@ -153,6 +153,6 @@ b2Joint::b2Joint(const b2JointDef* def)
 	m_body1 = def->body1;
 	m_body2 = def->body2;
 	m_collideConnected = def->collideConnected;
-	m_islandFlag = false;
+	m_islandEpoch = 0;
 	m_userData = def->userData;
 }
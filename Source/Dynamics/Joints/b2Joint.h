@@ -23,7 +23,7 @@
 
 class b2Body;
 class b2Joint;
-struct b2TimeStep;
+struct b2SolverData;
 class b2BlockAllocator;
 
 enum b2JointType
@@ -148,11 +148,15 @@ protected:
 	b2Joint(const b2JointDef* def);
 	virtual ~b2Joint() {}
 
-	virtual void InitVelocityConstraints(const b2TimeStep& step) = 0;
-	virtual void SolveVelocityConstraints(const b2TimeStep& step) = 0;
+	// The constraints are solved on the position and velocity arrays of the island.
+	// The island binds m_index1 and m_index2 before the constraints are initialized.
+	virtual void InitVelocityConstraints(const b2SolverData& data) = 0;
+
+	// This returns the largest velocity change, see b2VelocityChange.
+	virtual float32 SolveVelocityConstraints(const b2SolverData& data) = 0;
 
 	// This returns true if the position errors are within tolerance.
-	virtual bool SolvePositionConstraints(float32 baumgarte) = 0;
+	virtual bool SolvePositionConstraints(const b2SolverData& data, float32 baumgarte) = 0;
 
 	void ComputeXForm(b2XForm* xf, const b2Vec2& center, const b2Vec2& localCenter, float32 angle) const;
 
@@ -164,12 +168,15 @@ protected:
 	b2Body* m_body1;
 	b2Body* m_body2;
 
-	bool m_islandFlag;
+	// The island search that last reached this joint.
+	uint32 m_islandEpoch;
+
 	bool m_collideConnected;
 
 	void* m_userData;
 
 	// Cache here per time step to reduce cache misses.
+	int32 m_index1, m_index2;
 	b2Vec2 m_localCenter1, m_localCenter2;
 	float32 m_invMass1, m_invI1;
 	float32 m_invMass2, m_invI2;
@@ -0,0 +1,293 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "b2JointSolver.h"
+#include "b2DistanceJoint.h"
+#include "b2LineJoint.h"
+#include "b2MouseJoint.h"
+#include "b2RevoluteJoint.h"
+#include "b2PrismaticJoint.h"
+#include "b2PulleyJoint.h"
+#include "b2GearJoint.h"
+#include "b2FixedJoint.h"
+#include "../b2World.h"
+#include "../../Common/b2StackAllocator.h"
+
+// The qualified calls are not virtual.
+
+template <class T>
+inline void b2InitVelocityBatch(b2Joint** joints, int32 count, const b2SolverData& data)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		static_cast<T*>(joints[i])->T::InitVelocityConstraints(data);
+	}
+}
+
+template <class T>
+inline float32 b2SolveVelocityBatch(b2Joint** joints, int32 count, const b2SolverData& data)
+{
+	float32 maxChange = 0.0f;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 change = static_cast<T*>(joints[i])->T::SolveVelocityConstraints(data);
+		maxChange = b2Max(maxChange, change);
+	}
+	return maxChange;
+}
+
+template <class T>
+inline bool b2SolvePositionBatch(b2Joint** joints, int32 count, const b2SolverData& data, float32 baumgarte)
+{
+	bool okay = true;
+	for (int32 i = 0; i < count; ++i)
+	{
+		bool jointOkay = static_cast<T*>(joints[i])->T::SolvePositionConstraints(data, baumgarte);
+		okay = okay && jointOkay;
+	}
+	return okay;
+}
+
+b2JointSolver::b2JointSolver(b2Joint** joints, int32 jointCount, b2StackAllocator* allocator)
+{
+	m_allocator = allocator;
+	m_jointCount = jointCount;
+
+	// Counting sort, this keeps the island order within a type.
+	int32 counts[b2_jointTypeCount];
+	for (int32 i = 0; i < b2_jointTypeCount; ++i)
+	{
+		counts[i] = 0;
+	}
+
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		int32 type = joints[i]->GetType();
+		b2Assert(0 < type && type < b2_jointTypeCount);
+		++counts[type];
+	}
+
+	m_typeStarts[0] = 0;
+	for (int32 i = 0; i < b2_jointTypeCount; ++i)
+	{
+		m_typeStarts[i + 1] = m_typeStarts[i] + counts[i];
+		counts[i] = m_typeStarts[i];
+	}
+
+	m_joints = (b2Joint**)m_allocator->Allocate(jointCount * sizeof(b2Joint*));
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		int32 type = joints[i]->GetType();
+		m_joints[counts[type]++] = joints[i];
+	}
+
+	m_revoluteCount = m_typeStarts[e_revoluteJoint + 1] - m_typeStarts[e_revoluteJoint];
+	m_revoluteConstraints = (b2RevoluteConstraint*)m_allocator->Allocate(m_revoluteCount * sizeof(b2RevoluteConstraint));
+}
+
+b2JointSolver::~b2JointSolver()
+{
+	m_allocator->Free(m_revoluteConstraints);
+	m_allocator->Free(m_joints);
+}
+
+void b2JointSolver::InitVelocityConstraints(const b2SolverData& data)
+{
+	for (int32 type = 0; type < b2_jointTypeCount; ++type)
+	{
+		b2Joint** joints = m_joints + m_typeStarts[type];
+		int32 count = m_typeStarts[type + 1] - m_typeStarts[type];
+		if (count == 0)
+		{
+			continue;
+		}
+
+		switch (type)
+		{
+		case e_revoluteJoint:
+			b2InitVelocityBatch<b2RevoluteJoint>(joints, count, data);
+			break;
+
+		case e_prismaticJoint:
+			b2InitVelocityBatch<b2PrismaticJoint>(joints, count, data);
+			break;
+
+		case e_distanceJoint:
+			b2InitVelocityBatch<b2DistanceJoint>(joints, count, data);
+			break;
+
+		case e_pulleyJoint:
+			b2InitVelocityBatch<b2PulleyJoint>(joints, count, data);
+			break;
+
+		case e_mouseJoint:
+			b2InitVelocityBatch<b2MouseJoint>(joints, count, data);
+			break;
+
+		case e_gearJoint:
+			b2InitVelocityBatch<b2GearJoint>(joints, count, data);
+			break;
+
+		case e_lineJoint:
+			b2InitVelocityBatch<b2LineJoint>(joints, count, data);
+			break;
+
+		case e_fixedJoint:
+			b2InitVelocityBatch<b2FixedJoint>(joints, count, data);
+			break;
+
+		default:
+			b2Assert(false);
+			break;
+		}
+	}
+
+	// Pack the revolute joints.
+	b2Joint** revoluteJoints = m_joints + m_typeStarts[e_revoluteJoint];
+	for (int32 i = 0; i < m_revoluteCount; ++i)
+	{
+		b2RevoluteJoint* joint = static_cast<b2RevoluteJoint*>(revoluteJoints[i]);
+		joint->GetConstraint(m_revoluteConstraints + i, data);
+	}
+}
+
+float32 b2JointSolver::SolveVelocityConstraints(const b2SolverData& data)
+{
+	float32 maxChange = 0.0f;
+	for (int32 type = 0; type < b2_jointTypeCount; ++type)
+	{
+		b2Joint** joints = m_joints + m_typeStarts[type];
+		int32 count = m_typeStarts[type + 1] - m_typeStarts[type];
+		if (count == 0)
+		{
+			continue;
+		}
+
+		float32 change = 0.0f;
+		switch (type)
+		{
+		case e_revoluteJoint:
+			change = b2RevoluteJoint::SolveVelocityBatch(m_revoluteConstraints, m_revoluteCount, data);
+			break;
+
+		case e_prismaticJoint:
+			change = b2SolveVelocityBatch<b2PrismaticJoint>(joints, count, data);
+			break;
+
+		case e_distanceJoint:
+			change = b2SolveVelocityBatch<b2DistanceJoint>(joints, count, data);
+			break;
+
+		case e_pulleyJoint:
+			change = b2SolveVelocityBatch<b2PulleyJoint>(joints, count, data);
+			break;
+
+		case e_mouseJoint:
+			change = b2SolveVelocityBatch<b2MouseJoint>(joints, count, data);
+			break;
+
+		case e_gearJoint:
+			change = b2SolveVelocityBatch<b2GearJoint>(joints, count, data);
+			break;
+
+		case e_lineJoint:
+			change = b2SolveVelocityBatch<b2LineJoint>(joints, count, data);
+			break;
+
+		case e_fixedJoint:
+			change = b2SolveVelocityBatch<b2FixedJoint>(joints, count, data);
+			break;
+
+		default:
+			b2Assert(false);
+			break;
+		}
+
+		maxChange = b2Max(maxChange, change);
+	}
+
+	return maxChange;
+}
+
+void b2JointSolver::FinalizeVelocityConstraints()
+{
+	for (int32 i = 0; i < m_revoluteCount; ++i)
+	{
+		b2RevoluteConstraint* c = m_revoluteConstraints + i;
+		c->joint->StoreImpulses(c);
+	}
+}
+
+bool b2JointSolver::SolvePositionConstraints(const b2SolverData& data, float32 baumgarte)
+{
+	bool okay = true;
+	for (int32 type = 0; type < b2_jointTypeCount; ++type)
+	{
+		b2Joint** joints = m_joints + m_typeStarts[type];
+		int32 count = m_typeStarts[type + 1] - m_typeStarts[type];
+		if (count == 0)
+		{
+			continue;
+		}
+
+		bool typeOkay = true;
+		switch (type)
+		{
+		case e_revoluteJoint:
+			typeOkay = b2RevoluteJoint::SolvePositionBatch(m_revoluteConstraints, m_revoluteCount, data);
+			break;
+
+		case e_prismaticJoint:
+			typeOkay = b2SolvePositionBatch<b2PrismaticJoint>(joints, count, data, baumgarte);
+			break;
+
+		case e_distanceJoint:
+			typeOkay = b2SolvePositionBatch<b2DistanceJoint>(joints, count, data, baumgarte);
+			break;
+
+		case e_pulleyJoint:
+			typeOkay = b2SolvePositionBatch<b2PulleyJoint>(joints, count, data, baumgarte);
+			break;
+
+		case e_mouseJoint:
+			typeOkay = b2SolvePositionBatch<b2MouseJoint>(joints, count, data, baumgarte);
+			break;
+
+		case e_gearJoint:
+			typeOkay = b2SolvePositionBatch<b2GearJoint>(joints, count, data, baumgarte);
+			break;
+
+		case e_lineJoint:
+			typeOkay = b2SolvePositionBatch<b2LineJoint>(joints, count, data, baumgarte);
+			break;
+
+		case e_fixedJoint:
+			typeOkay = b2SolvePositionBatch<b2FixedJoint>(joints, count, data, baumgarte);
+			break;
+
+		default:
+			b2Assert(false);
+			break;
+		}
+
+		okay = okay && typeOkay;
+	}
+
+	return okay;
+}
@@ -0,0 +1,63 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B2_JOINT_SOLVER_H
+#define B2_JOINT_SOLVER_H
+
+#include "b2Joint.h"
+
+class b2StackAllocator;
+struct b2RevoluteConstraint;
+
+/// The number of joint types, including e_unknownJoint.
+const int32 b2_jointTypeCount = e_fixedJoint + 1;
+
+/// Solves the joints of an island grouped by type. The joints of a type are
+/// solved one after the other in a loop without virtual calls. Revolute joints,
+/// the most common type in ragdolls and chains, are packed into a contiguous
+/// array of constraints. Joints of the same type keep their island order.
+class b2JointSolver
+{
+public:
+	b2JointSolver(b2Joint** joints, int32 jointCount, b2StackAllocator* allocator);
+	~b2JointSolver();
+
+	void InitVelocityConstraints(const b2SolverData& data);
+
+	/// This returns the largest velocity change, see b2VelocityChange.
+	float32 SolveVelocityConstraints(const b2SolverData& data);
+
+	/// Copy the accumulated impulses of the packed constraints back to the joints.
+	void FinalizeVelocityConstraints();
+
+	bool SolvePositionConstraints(const b2SolverData& data, float32 baumgarte);
+
+	b2StackAllocator* m_allocator;
+
+	// The joints sorted by type. The joints of type i are
+	// [m_typeStarts[i], m_typeStarts[i + 1]).
+	b2Joint** m_joints;
+	int32 m_jointCount;
+	int32 m_typeStarts[b2_jointTypeCount + 1];
+
+	b2RevoluteConstraint* m_revoluteConstraints;
+	int32 m_revoluteCount;
+};
+
+#endif
@@ -53,10 +53,21 @@ void b2MouseJoint::SetTarget(const b2Vec2& target)
 	m_target = target;
 }
 
-void b2MouseJoint::InitVelocityConstraints(const b2TimeStep& step)
+void b2MouseJoint::InitVelocityConstraints(const b2SolverData& data)
 {
+	const b2TimeStep& step = data.step;
+
 	b2Body* b = m_body2;
 
+	m_localCenter2 = b->m_sweep.localCenter;
+	m_invMass2 = b->m_invMass;
+	m_invI2 = b->m_invI;
+
+	b2Vec2 c = data.positions[m_index2].x;
+	float32 a = data.positions[m_index2].a;
+	b2Vec2 v = data.velocities[m_index2].v;
+	float32 w = data.velocities[m_index2].w;
+
 	float32 mass = b->GetMass();
 
 	// Frequency
@@ -76,21 +87,21 @@ void b2MouseJoint::InitVelocityConstraints(const b2TimeStep& step)
 	m_beta = step.dt * k * m_gamma;
 
 	// Compute the effective mass matrix.
-	b2Vec2 r = b2Mul(b->GetXForm().R, m_localAnchor - b->GetLocalCenter());
+	m_r = b2Mul(b2Mat22(a), m_localAnchor - m_localCenter2);
 
 	// K    = [(1/m1 + 1/m2) * eye(2) - skew(r1) * invI1 * skew(r1) - skew(r2) * invI2 * skew(r2)]
 	//      = [1/m1+1/m2     0    ] + invI1 * [r1.y*r1.y -r1.x*r1.y] + invI2 * [r1.y*r1.y -r1.x*r1.y]
 	//        [    0     1/m1+1/m2]           [-r1.x*r1.y r1.x*r1.x]           [-r1.x*r1.y r1.x*r1.x]
-	float32 invMass = b->m_invMass;
-	float32 invI = b->m_invI;
+	float32 invMass = m_invMass2;
+	float32 invI = m_invI2;
 
 	b2Mat22 K1;
 	K1.col1.x = invMass;	K1.col2.x = 0.0f;
 	K1.col1.y = 0.0f;		K1.col2.y = invMass;
 
 	b2Mat22 K2;
-	K2.col1.x =  invI * r.y * r.y;	K2.col2.x = -invI * r.x * r.y;
-	K2.col1.y = -invI * r.x * r.y;	K2.col2.y =  invI * r.x * r.x;
+	K2.col1.x =  invI * m_r.y * m_r.y;	K2.col2.x = -invI * m_r.x * m_r.y;
+	K2.col1.y = -invI * m_r.x * m_r.y;	K2.col2.y =  invI * m_r.x * m_r.x;
 
 	b2Mat22 K = K1 + K2;
 	K.col1.x += m_gamma;
@@ -98,25 +109,29 @@ void b2MouseJoint::InitVelocityConstraints(const b2TimeStep& step)
 
 	m_mass = K.GetInverse();
 
-	m_C = b->m_sweep.c + r - m_target;
+	m_C = c + m_r - m_target;
 
 	// Cheat with some damping
-	b->m_angularVelocity *= 0.98f;
+	w *= 0.98f;
 
 	// Warm starting.
 	m_impulse *= step.dtRatio;
-	b->m_linearVelocity += invMass * m_impulse;
-	b->m_angularVelocity += invI * b2Cross(r, m_impulse);
+	v += invMass * m_impulse;
+	w += invI * b2Cross(m_r, m_impulse);
+
+	data.velocities[m_index2].v = v;
+	data.velocities[m_index2].w = w;
 }
 
-void b2MouseJoint::SolveVelocityConstraints(const b2TimeStep& step)
+float32 b2MouseJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
-	b2Body* b = m_body2;
+	const b2TimeStep& step = data.step;
 
-	b2Vec2 r = b2Mul(b->GetXForm().R, m_localAnchor - b->GetLocalCenter());
+	b2Vec2 v = data.velocities[m_index2].v;
+	float32 w = data.velocities[m_index2].w;
 
 	// Cdot = v + cross(w, r)
-	b2Vec2 Cdot = b->m_linearVelocity + b2Cross(b->m_angularVelocity, r);
+	b2Vec2 Cdot = v + b2Cross(w, m_r);
 	b2Vec2 impulse = b2Mul(m_mass, -(Cdot + m_beta * m_C + m_gamma * m_impulse));
 
 	b2Vec2 oldImpulse = m_impulse;
@@ -128,8 +143,15 @@ void b2MouseJoint::SolveVelocityConstraints(const b2TimeStep& step)
 	}
 	impulse = m_impulse - oldImpulse;
 
-	b->m_linearVelocity += b->m_invMass * impulse;
-	b->m_angularVelocity += b->m_invI * b2Cross(r, impulse);
+	v += m_invMass2 * impulse;
+	w += m_invI2 * b2Cross(m_r, impulse);
+
+	float32 change = b2VelocityChange(data.velocities[m_index2], v, w);
+
+	data.velocities[m_index2].v = v;
+	data.velocities[m_index2].w = w;
+
+	return change;
 }
 
 b2Vec2 b2MouseJoint::GetAnchor1() const
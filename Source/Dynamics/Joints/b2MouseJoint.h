@@ -77,13 +77,14 @@ public:
 
 	b2MouseJoint(const b2MouseJointDef* def);
 
-	void InitVelocityConstraints(const b2TimeStep& step);
-	void SolveVelocityConstraints(const b2TimeStep& step);
-	bool SolvePositionConstraints(float32 baumgarte) { B2_NOT_USED(baumgarte); return true; }
+	void InitVelocityConstraints(const b2SolverData& data);
+	float32 SolveVelocityConstraints(const b2SolverData& data);
+	bool SolvePositionConstraints(const b2SolverData& data, float32 baumgarte) { B2_NOT_USED(data); B2_NOT_USED(baumgarte); return true; }
 
 	b2Vec2 m_localAnchor;
 	b2Vec2 m_target;
 	b2Vec2 m_impulse;
+	b2Vec2 m_r;
 
 	b2Mat22 m_mass;		// effective mass for point-to-point constraint.
 	b2Vec2 m_C;				// position error
@@ -63,21 +63,40 @@ b2RevoluteJoint::b2RevoluteJoint(const b2RevoluteJointDef* def)
 	m_limitState = e_inactiveLimit;
 }
 
-void b2RevoluteJoint::InitVelocityConstraints(const b2TimeStep& step)
+void b2RevoluteJoint::InitVelocityConstraints(const b2SolverData& data)
 {
+	const b2TimeStep& step = data.step;
+
 	b2Body* b1 = m_body1;
 	b2Body* b2 = m_body2;
 
+	m_localCenter1 = b1->m_sweep.localCenter;
+	m_localCenter2 = b2->m_sweep.localCenter;
+	m_invMass1 = b1->m_invMass;
+	m_invMass2 = b2->m_invMass;
+	m_invI1 = b1->m_invI;
+	m_invI2 = b2->m_invI;
+
+	float32 a1 = data.positions[m_index1].a;
+	b2Vec2 v1 = data.velocities[m_index1].v;
+	float32 w1 = data.velocities[m_index1].w;
+
+	float32 a2 = data.positions[m_index2].a;
+	b2Vec2 v2 = data.velocities[m_index2].v;
+	float32 w2 = data.velocities[m_index2].w;
+
 	if (m_enableMotor || m_enableLimit)
 	{
 		// You cannot create a rotation limit between bodies that
 		// both have fixed rotation.
-		b2Assert(b1->m_invI > 0.0f || b2->m_invI > 0.0f);
+		b2Assert(m_invI1 > 0.0f || m_invI2 > 0.0f);
 	}
 
 	// Compute the effective mass matrix.
-	b2Vec2 r1 = b2Mul(b1->GetXForm().R, m_localAnchor1 - b1->GetLocalCenter());
-	b2Vec2 r2 = b2Mul(b2->GetXForm().R, m_localAnchor2 - b2->GetLocalCenter());
+	m_r1 = b2Mul(b2Mat22(a1), m_localAnchor1 - m_localCenter1);
+	m_r2 = b2Mul(b2Mat22(a2), m_localAnchor2 - m_localCenter2);
+	b2Vec2 r1 = m_r1;
+	b2Vec2 r2 = m_r2;
 
 	// J = [-I -r1_skew I r2_skew]
 	//     [ 0       -1 0       1]
@@ -88,8 +107,8 @@ void b2RevoluteJoint::InitVelocityConstraints(const b2TimeStep& step)
 	//     [  -r1y*i1*r1x-r2y*i2*r2x, m1+r1x^2*i1+m2+r2x^2*i2,           r1x*i1+r2x*i2]
 	//     [          -r1y*i1-r2y*i2,           r1x*i1+r2x*i2,                   i1+i2]
 
-	float32 m1 = b1->m_invMass, m2 = b2->m_invMass;
-	float32 i1 = b1->m_invI, i2 = b2->m_invI;
+	float32 m1 = m_invMass1, m2 = m_invMass2;
+	float32 i1 = m_invI1, i2 = m_invI2;
 
 	m_mass.col1.x = m1 + m2 + r1.y * r1.y * i1 + r2.y * r2.y * i2;
 	m_mass.col2.x = -r1.y * r1.x * i1 - r2.y * r2.x * i2;
@@ -110,7 +129,7 @@ void b2RevoluteJoint::InitVelocityConstraints(const b2TimeStep& step)
 
 	if (m_enableLimit)
 	{
-		float32 jointAngle = b2->m_sweep.a - b1->m_sweep.a - m_referenceAngle;
+		float32 jointAngle = a2 - a1 - m_referenceAngle;
 		if (b2Abs(m_upperAngle - m_lowerAngle) < 2.0f * b2_angularSlop)
 		{
 			m_limitState = e_equalLimits;
@@ -150,89 +169,151 @@ void b2RevoluteJoint::InitVelocityConstraints(const b2TimeStep& step)
 
 		b2Vec2 P(m_impulse.x, m_impulse.y);
 
-		b1->m_linearVelocity -= m1 * P;
-		b1->m_angularVelocity -= i1 * (b2Cross(r1, P) + m_motorImpulse + m_impulse.z);
+		v1 -= m1 * P;
+		w1 -= i1 * (b2Cross(r1, P) + m_motorImpulse + m_impulse.z);
 
-		b2->m_linearVelocity += m2 * P;
-		b2->m_angularVelocity += i2 * (b2Cross(r2, P) + m_motorImpulse + m_impulse.z);
+		v2 += m2 * P;
+		w2 += i2 * (b2Cross(r2, P) + m_motorImpulse + m_impulse.z);
 	}
 	else
 	{
 		m_impulse.SetZero();
 		m_motorImpulse = 0.0f;
 	}
+
+	data.velocities[m_index1].v = v1;
+	data.velocities[m_index1].w = w1;
+	data.velocities[m_index2].v = v2;
+	data.velocities[m_index2].w = w2;
 }
 
-void b2RevoluteJoint::SolveVelocityConstraints(const b2TimeStep& step)
+float32 b2RevoluteJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
-	b2Body* b1 = m_body1;
-	b2Body* b2 = m_body2;
+	b2RevoluteConstraint c;
+	GetConstraint(&c, data);
+	float32 change = SolveVelocityBatch(&c, 1, data);
+	StoreImpulses(&c);
+	return change;
+}
+
+bool b2RevoluteJoint::SolvePositionConstraints(const b2SolverData& data, float32 baumgarte)
+{
+	B2_NOT_USED(baumgarte);
+
+	b2RevoluteConstraint c;
+	GetConstraint(&c, data);
+	return SolvePositionBatch(&c, 1, data);
+}
+
+void b2RevoluteJoint::GetConstraint(b2RevoluteConstraint* c, const b2SolverData& data) const
+{
+	c->joint = const_cast<b2RevoluteJoint*>(this);
+	c->index1 = m_index1;
+	c->index2 = m_index2;
+	c->r1 = m_r1;
+	c->r2 = m_r2;
+	c->localAnchor1 = m_localAnchor1 - m_localCenter1;
+	c->localAnchor2 = m_localAnchor2 - m_localCenter2;
+	c->mass = m_mass;
+
+	b2Mat22 K;
+	K.col1.Set(m_mass.col1.x, m_mass.col1.y);
+	K.col2.Set(m_mass.col2.x, m_mass.col2.y);
+	c->pointMass = K.GetInverse();
+
+	c->impulse = m_impulse;
+	c->motorImpulse = m_motorImpulse;
+	c->motorMass = m_motorMass;
+	c->motorSpeed = m_motorSpeed;
+	c->maxMotorImpulse = data.step.dt * m_maxMotorTorque;
+	c->invMass1 = m_invMass1;
+	c->invI1 = m_invI1;
+	c->invMass2 = m_invMass2;
+	c->invI2 = m_invI2;
+	c->referenceAngle = m_referenceAngle;
+	c->lowerAngle = m_lowerAngle;
+	c->upperAngle = m_upperAngle;
+	c->limitState = m_limitState;
+	c->enableMotor = m_enableMotor;
+	c->enableLimit = m_enableLimit;
+}
+
+void b2RevoluteJoint::StoreImpulses(const b2RevoluteConstraint* c)
+{
+	m_impulse = c->impulse;
+	m_motorImpulse = c->motorImpulse;
+}
+
+static inline float32 b2SolveRevoluteVelocity(b2RevoluteConstraint* c, const b2SolverData& data)
+{
+	b2Velocity* velocity1 = data.velocities + c->index1;
+	b2Velocity* velocity2 = data.velocities + c->index2;
 
-	b2Vec2 v1 = b1->m_linearVelocity;
-	float32 w1 = b1->m_angularVelocity;
-	b2Vec2 v2 = b2->m_linearVelocity;
-	float32 w2 = b2->m_angularVelocity;
+	b2Vec2 v1 = velocity1->v;
+	float32 w1 = velocity1->w;
+	b2Vec2 v2 = velocity2->v;
+	float32 w2 = velocity2->w;
 
-	float32 m1 = b1->m_invMass, m2 = b2->m_invMass;
-	float32 i1 = b1->m_invI, i2 = b2->m_invI;
+	float32 m1 = c->invMass1, m2 = c->invMass2;
+	float32 i1 = c->invI1, i2 = c->invI2;
 
 	// Solve motor constraint.
-	if (m_enableMotor && m_limitState != e_equalLimits)
+	if (c->enableMotor && c->limitState != e_equalLimits)
 	{
-		float32 Cdot = w2 - w1 - m_motorSpeed;
-		float32 impulse = m_motorMass * (-Cdot);
-		float32 oldImpulse = m_motorImpulse;
-		float32 maxImpulse = step.dt * m_maxMotorTorque;
-		m_motorImpulse = b2Clamp(m_motorImpulse + impulse, -maxImpulse, maxImpulse);
-		impulse = m_motorImpulse - oldImpulse;
+		float32 Cdot = w2 - w1 - c->motorSpeed;
+		float32 impulse = c->motorMass * (-Cdot);
+		float32 oldImpulse = c->motorImpulse;
+		float32 maxImpulse = c->maxMotorImpulse;
+		c->motorImpulse = b2Clamp(c->motorImpulse + impulse, -maxImpulse, maxImpulse);
+		impulse = c->motorImpulse - oldImpulse;
 
 		w1 -= i1 * impulse;
 		w2 += i2 * impulse;
 	}
 
 	// Solve limit constraint.
-	if (m_enableLimit && m_limitState != e_inactiveLimit)
+	if (c->enableLimit && c->limitState != e_inactiveLimit)
 	{
-		b2Vec2 r1 = b2Mul(b1->GetXForm().R, m_localAnchor1 - b1->GetLocalCenter());
-		b2Vec2 r2 = b2Mul(b2->GetXForm().R, m_localAnchor2 - b2->GetLocalCenter());
+		b2Vec2 r1 = c->r1;
+		b2Vec2 r2 = c->r2;
 
 		// Solve point-to-point constraint
 		b2Vec2 Cdot1 = v2 + b2Cross(w2, r2) - v1 - b2Cross(w1, r1);
 		float32 Cdot2 = w2 - w1;
 		b2Vec3 Cdot(Cdot1.x, Cdot1.y, Cdot2);
 
-		b2Vec3 impulse = m_mass.Solve33(-Cdot);
+		b2Vec3 impulse = c->mass.Solve33(-Cdot);
 
-		if (m_limitState == e_equalLimits)
+		if (c->limitState == e_equalLimits)
 		{
-			m_impulse += impulse;
+			c->impulse += impulse;
 		}
-		else if (m_limitState == e_atLowerLimit)
+		else if (c->limitState == e_atLowerLimit)
 		{
-			float32 newImpulse = m_impulse.z + impulse.z;
+			float32 newImpulse = c->impulse.z + impulse.z;
 			if (newImpulse < 0.0f)
 			{
-				b2Vec2 reduced = m_mass.Solve22(-Cdot1);
+				b2Vec2 reduced = b2Mul(c->pointMass, -Cdot1);
 				impulse.x = reduced.x;
 				impulse.y = reduced.y;
-				impulse.z = -m_impulse.z;
-				m_impulse.x += reduced.x;
-				m_impulse.y += reduced.y;
-				m_impulse.z = 0.0f;
+				impulse.z = -c->impulse.z;
+				c->impulse.x += reduced.x;
+				c->impulse.y += reduced.y;
+				c->impulse.z = 0.0f;
 			}
 		}
-		else if (m_limitState == e_atUpperLimit)
+		else if (c->limitState == e_atUpperLimit)
 		{
-			float32 newImpulse = m_impulse.z + impulse.z;
+			float32 newImpulse = c->impulse.z + impulse.z;
 			if (newImpulse > 0.0f)
 			{
-				b2Vec2 reduced = m_mass.Solve22(-Cdot1);
+				b2Vec2 reduced = b2Mul(c->pointMass, -Cdot1);
 				impulse.x = reduced.x;
 				impulse.y = reduced.y;
-				impulse.z = -m_impulse.z;
-				m_impulse.x += reduced.x;
-				m_impulse.y += reduced.y;
-				m_impulse.z = 0.0f;
+				impulse.z = -c->impulse.z;
+				c->impulse.x += reduced.x;
+				c->impulse.y += reduced.y;
+				c->impulse.z = 0.0f;
 			}
 		}
 
@@ -246,15 +327,15 @@ void b2RevoluteJoint::SolveVelocityConstraints(const b2TimeStep& step)
 	}
 	else
 	{
-		b2Vec2 r1 = b2Mul(b1->GetXForm().R, m_localAnchor1 - b1->GetLocalCenter());
-		b2Vec2 r2 = b2Mul(b2->GetXForm().R, m_localAnchor2 - b2->GetLocalCenter());
+		b2Vec2 r1 = c->r1;
+		b2Vec2 r2 = c->r2;
 
 		// Solve point-to-point constraint
 		b2Vec2 Cdot = v2 + b2Cross(w2, r2) - v1 - b2Cross(w1, r1);
-		b2Vec2 impulse = m_mass.Solve22(-Cdot);
+		b2Vec2 impulse = b2Mul(c->pointMass, -Cdot);
 
-		m_impulse.x += impulse.x;
-		m_impulse.y += impulse.y;
+		c->impulse.x += impulse.x;
+		c->impulse.y += impulse.y;
 
 		v1 -= m1 * impulse;
 		w1 -= i1 * b2Cross(r1, impulse);
@@ -263,73 +344,77 @@ void b2RevoluteJoint::SolveVelocityConstraints(const b2TimeStep& step)
 		w2 += i2 * b2Cross(r2, impulse);
 	}
 
-	b1->m_linearVelocity = v1;
-	b1->m_angularVelocity = w1;
-	b2->m_linearVelocity = v2;
-	b2->m_angularVelocity = w2;
+	float32 change = b2Max(b2VelocityChange(*velocity1, v1, w1), b2VelocityChange(*velocity2, v2, w2));
+
+	velocity1->v = v1;
+	velocity1->w = w1;
+	velocity2->v = v2;
+	velocity2->w = w2;
+
+	return change;
 }
 
-bool b2RevoluteJoint::SolvePositionConstraints(float32 baumgarte)
+static inline bool b2SolveRevolutePosition(const b2RevoluteConstraint* c, const b2SolverData& data)
 {
 	// TODO_ERIN block solve with limit.
 
-	B2_NOT_USED(baumgarte);
+	b2Position* position1 = data.positions + c->index1;
+	b2Position* position2 = data.positions + c->index2;
 
-	b2Body* b1 = m_body1;
-	b2Body* b2 = m_body2;
+	b2Vec2 c1 = position1->x;
+	float32 a1 = position1->a;
+	b2Vec2 c2 = position2->x;
+	float32 a2 = position2->a;
 
 	float32 angularError = 0.0f;
 	float32 positionError = 0.0f;
 
 	// Solve angular limit constraint.
-	if (m_enableLimit && m_limitState != e_inactiveLimit)
+	if (c->enableLimit && c->limitState != e_inactiveLimit)
 	{
-		float32 angle = b2->m_sweep.a - b1->m_sweep.a - m_referenceAngle;
+		float32 angle = a2 - a1 - c->referenceAngle;
 		float32 limitImpulse = 0.0f;
 
-		if (m_limitState == e_equalLimits)
+		if (c->limitState == e_equalLimits)
 		{
 			// Prevent large angular corrections
-			float32 C = b2Clamp(angle - m_lowerAngle, -b2_maxAngularCorrection, b2_maxAngularCorrection);
-			limitImpulse = -m_motorMass * C;
+			float32 C = b2Clamp(angle - c->lowerAngle, -b2_maxAngularCorrection, b2_maxAngularCorrection);
+			limitImpulse = -c->motorMass * C;
 			angularError = b2Abs(C);
 		}
-		else if (m_limitState == e_atLowerLimit)
+		else if (c->limitState == e_atLowerLimit)
 		{
-			float32 C = angle - m_lowerAngle;
+			float32 C = angle - c->lowerAngle;
 			angularError = -C;
 
 			// Prevent large angular corrections and allow some slop.
 			C = b2Clamp(C + b2_angularSlop, -b2_maxAngularCorrection, 0.0f);
-			limitImpulse = -m_motorMass * C;
+			limitImpulse = -c->motorMass * C;
 		}
-		else if (m_limitState == e_atUpperLimit)
+		else if (c->limitState == e_atUpperLimit)
 		{
-			float32 C = angle - m_upperAngle;
+			float32 C = angle - c->upperAngle;
 			angularError = C;
 
 			// Prevent large angular corrections and allow some slop.
 			C = b2Clamp(C - b2_angularSlop, 0.0f, b2_maxAngularCorrection);
-			limitImpulse = -m_motorMass * C;
+			limitImpulse = -c->motorMass * C;
 		}
 
-		b1->m_sweep.a -= b1->m_invI * limitImpulse;
-		b2->m_sweep.a += b2->m_invI * limitImpulse;
-
-		b1->SynchronizeTransform();
-		b2->SynchronizeTransform();
+		a1 -= c->invI1 * limitImpulse;
+		a2 += c->invI2 * limitImpulse;
 	}
 
 	// Solve point-to-point constraint.
 	{
-		b2Vec2 r1 = b2Mul(b1->GetXForm().R, m_localAnchor1 - b1->GetLocalCenter());
-		b2Vec2 r2 = b2Mul(b2->GetXForm().R, m_localAnchor2 - b2->GetLocalCenter());
+		b2Vec2 r1 = b2Mul(b2Mat22(a1), c->localAnchor1);
+		b2Vec2 r2 = b2Mul(b2Mat22(a2), c->localAnchor2);
 
-		b2Vec2 C = b2->m_sweep.c + r2 - b1->m_sweep.c - r1;
+		b2Vec2 C = c2 + r2 - c1 - r1;
 		positionError = C.Length();
 
-		float32 invMass1 = b1->m_invMass, invMass2 = b2->m_invMass;
-		float32 invI1 = b1->m_invI, invI2 = b2->m_invI;
+		float32 invMass1 = c->invMass1, invMass2 = c->invMass2;
+		float32 invI1 = c->invI1, invI2 = c->invI2;
 
 		// Handle large detachment.
 		const float32 k_allowedStretch = 10.0f * b2_linearSlop;
@@ -342,10 +427,10 @@ bool b2RevoluteJoint::SolvePositionConstraints(float32 baumgarte)
 			float32 m = 1.0f / k;
 			b2Vec2 impulse = m * (-C);
 			const float32 k_beta = 0.5f;
-			b1->m_sweep.c -= k_beta * invMass1 * impulse;
-			b2->m_sweep.c += k_beta * invMass2 * impulse;
+			c1 -= k_beta * invMass1 * impulse;
+			c2 += k_beta * invMass2 * impulse;
 
-			C = b2->m_sweep.c + r2 - b1->m_sweep.c - r1;
+			C = c2 + r2 - c1 - r1;
 		}
 
 		b2Mat22 K1;
@@ -363,19 +448,43 @@ bool b2RevoluteJoint::SolvePositionConstraints(float32 baumgarte)
 		b2Mat22 K = K1 + K2 + K3;
 		b2Vec2 impulse = K.Solve(-C);
 
-		b1->m_sweep.c -= b1->m_invMass * impulse;
-		b1->m_sweep.a -= b1->m_invI * b2Cross(r1, impulse);
+		c1 -= invMass1 * impulse;
+		a1 -= invI1 * b2Cross(r1, impulse);
 
-		b2->m_sweep.c += b2->m_invMass * impulse;
-		b2->m_sweep.a += b2->m_invI * b2Cross(r2, impulse);
-
-		b1->SynchronizeTransform();
-		b2->SynchronizeTransform();
+		c2 += invMass2 * impulse;
+		a2 += invI2 * b2Cross(r2, impulse);
 	}
-	
+
+	position1->x = c1;
+	position1->a = a1;
+	position2->x = c2;
+	position2->a = a2;
+
 	return positionError <= b2_linearSlop && angularError <= b2_angularSlop;
 }
 
+float32 b2RevoluteJoint::SolveVelocityBatch(b2RevoluteConstraint* constraints, int32 count, const b2SolverData& data)
+{
+	float32 maxChange = 0.0f;
+	for (int32 i = 0; i < count; ++i)
+	{
+		float32 change = b2SolveRevoluteVelocity(constraints + i, data);
+		maxChange = b2Max(maxChange, change);
+	}
+	return maxChange;
+}
+
+bool b2RevoluteJoint::SolvePositionBatch(const b2RevoluteConstraint* constraints, int32 count, const b2SolverData& data)
+{
+	bool okay = true;
+	for (int32 i = 0; i < count; ++i)
+	{
+		bool constraintOkay = b2SolveRevolutePosition(constraints + i, data);
+		okay = okay && constraintOkay;
+	}
+	return okay;
+}
+
 b2Vec2 b2RevoluteJoint::GetAnchor1() const
 {
 	return m_body1->GetWorldPoint(m_localAnchor1);
@@ -81,6 +81,33 @@ struct b2RevoluteJointDef : public b2JointDef
 	float32 maxMotorTorque;
 };
 
+class b2RevoluteJoint;
+
+/// The solver state of a revolute joint. The joint solver packs the revolute
+/// joints of an island into an array of these and solves them in a tight loop.
+struct b2RevoluteConstraint
+{
+	b2RevoluteJoint* joint;
+	int32 index1, index2;
+	b2Vec2 r1, r2;
+	b2Vec2 localAnchor1, localAnchor2;	// relative to the centers of mass
+	b2Mat33 mass;
+	b2Mat22 pointMass;		// inverse of the point-to-point block of the mass matrix
+	b2Vec3 impulse;
+	float32 motorImpulse;
+	float32 motorMass;
+	float32 motorSpeed;
+	float32 maxMotorImpulse;
+	float32 invMass1, invI1;
+	float32 invMass2, invI2;
+	float32 referenceAngle;
+	float32 lowerAngle;
+	float32 upperAngle;
+	b2LimitState limitState;
+	bool enableMotor;
+	bool enableLimit;
+};
+
 /// A revolute joint constrains to bodies to share a common point while they
 /// are free to rotate about the point. The relative rotation about the shared
 /// point is the joint angle. You can limit the relative rotation with
@@ -138,13 +165,26 @@ public:
 	//--------------- Internals Below -------------------
 	b2RevoluteJoint(const b2RevoluteJointDef* def);
 
-	void InitVelocityConstraints(const b2TimeStep& step);
-	void SolveVelocityConstraints(const b2TimeStep& step);
+	void InitVelocityConstraints(const b2SolverData& data);
+	float32 SolveVelocityConstraints(const b2SolverData& data);
+
+	bool SolvePositionConstraints(const b2SolverData& data, float32 baumgarte);
+
+	// Copy the solver state into a constraint. Call this after InitVelocityConstraints.
+	void GetConstraint(b2RevoluteConstraint* c, const b2SolverData& data) const;
+
+	// Copy the accumulated impulses of a constraint back to the joint.
+	void StoreImpulses(const b2RevoluteConstraint* c);
 
-	bool SolvePositionConstraints(float32 baumgarte);
+	// Solve an array of constraints. These return the largest velocity change and
+	// true if all position errors are within tolerance.
+	static float32 SolveVelocityBatch(b2RevoluteConstraint* constraints, int32 count, const b2SolverData& data);
+	static bool SolvePositionBatch(const b2RevoluteConstraint* constraints, int32 count, const b2SolverData& data);
 
 	b2Vec2 m_localAnchor1;	// relative
 	b2Vec2 m_localAnchor2;
+	b2Vec2 m_r1;
+	b2Vec2 m_r2;
 	b2Vec3 m_impulse;
 	float32 m_motorImpulse;
 
@@ -42,6 +42,14 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	{
 		m_flags |= e_sleepFlag;
 	}
+	if (bd->isCompound)
+	{
+		m_flags |= e_compoundFlag;
+	}
+	if (bd->isActive == false)
+	{
+		m_flags |= e_inactiveFlag;
+	}
 
 	m_world = world;
 
@@ -49,7 +57,7 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_xf.R.Set(bd->angle);
 
 	m_sweep.localCenter = bd->massData.center;
-	m_sweep.t0 = 1.0f;
+	m_sweep.t0 = 0.0f;
 	m_sweep.a0 = m_sweep.a = bd->angle;
 	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
 
@@ -58,6 +66,11 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_controllerList = NULL;
 	m_prev = NULL;
 	m_next = NULL;
+	m_island = NULL;
+	m_islandPrev = NULL;
+	m_islandNext = NULL;
+	m_awakeIndex = -1;
+	m_islandEpoch = 0;
 
 	m_linearVelocity = bd->linearVelocity;
 	m_angularVelocity = bd->angularVelocity;
@@ -91,7 +104,15 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 		m_invI = 1.0f / m_I;
 	}
 
-	if (m_invMass == 0.0f && m_invI == 0.0f)
+	if (bd->isKinematic)
+	{
+		m_mass = 0.0f;
+		m_invMass = 0.0f;
+		m_I = 0.0f;
+		m_invI = 0.0f;
+		m_type = e_kinematicType;
+	}
+	else if (m_invMass == 0.0f && m_invI == 0.0f)
 	{
 		m_type = e_staticType;
 	}
@@ -104,14 +125,35 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 
 	m_fixtureList = NULL;
 	m_fixtureCount = 0;
+
+	m_treeFixtures = NULL;
+	m_proxyId = b2_nullProxy;
 }
 
 b2Body::~b2Body()
 {
 	// shapes and joints are destroyed in b2World::Destroy
+	b2Assert(m_proxyId == b2_nullProxy);
+
+	if (m_treeFixtures)
+	{
+		b2Free(m_treeFixtures);
+	}
 }
 
 b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
+{
+	b2Fixture* fixture = AddFixture(def);
+
+	if (m_flags & e_compoundFlag)
+	{
+		BuildFixtureTree();
+	}
+
+	return fixture;
+}
+
+b2Fixture* b2Body::AddFixture(const b2FixtureDef* def)
 {
 	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
 	b2BroadPhase* broadPhase = m_world->m_broadPhase;
@@ -123,6 +165,7 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 	fixture->m_next = m_fixtureList;
 	m_fixtureList = fixture;
 	++m_fixtureCount;
+	++m_world->m_topologyStamp;
 
 	fixture->m_body = this;
 
@@ -155,13 +198,23 @@ void b2Body::DestroyFixture(b2Fixture* fixture)
 	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
 	b2BroadPhase* broadPhase = m_world->m_broadPhase;
 
+	--m_fixtureCount;
+	++m_world->m_topologyStamp;
+
+	// The fixture is not in the broad-phase, so its contacts are destroyed
+	// here. Then the tree is rebuilt without it, while the body proxy may
+	// still refer to it.
+	if (m_flags & e_compoundFlag)
+	{
+		m_world->m_contactManager.DestroyCompoundContacts(fixture);
+		BuildFixtureTree();
+	}
+
 	fixture->Destroy(allocator, broadPhase);
 	fixture->m_body = NULL;
 	fixture->m_next = NULL;
 	fixture->~b2Fixture();
 	allocator->Free(fixture, sizeof(b2Fixture));
-
-	--m_fixtureCount;
 }
 
 // TODO_ERIN adjust linear velocity and torque to account for movement of center.
@@ -199,13 +252,12 @@ void b2Body::SetMassData(const b2MassData* massData)
 		m_type = e_dynamicType;
 	}
 
-	// If the body type changed, we need to refilter the broad-phase proxies.
+	// If the body type changed, we need to refilter the broad-phase proxies
+	// and move the body in or out of the islands.
 	if (oldType != m_type)
 	{
-		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
-		{
-			f->RefilterProxy(m_world->m_broadPhase, m_xf);
-		}
+		RefilterProxies();
+		UpdateIsland();
 	}
 }
 
@@ -262,13 +314,12 @@ void b2Body::SetMassFromShapes()
 		m_type = e_dynamicType;
 	}
 
-	// If the body type changed, we need to refilter the broad-phase proxies.
+	// If the body type changed, we need to refilter the broad-phase proxies
+	// and move the body in or out of the islands.
 	if (oldType != m_type)
 	{
-		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
-		{
-			f->RefilterProxy(m_world->m_broadPhase, m_xf);
-		}
+		RefilterProxies();
+		UpdateIsland();
 	}
 }
 
@@ -285,9 +336,126 @@ void b2Body::SetStatic()
 	m_invI = 0.0f;
 	m_type = e_staticType;
 	
-	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	RefilterProxies();
+	UpdateIsland();
+}
+
+void b2Body::SetKinematic()
+{
+	if (m_type == e_kinematicType)
 	{
-		f->RefilterProxy(m_world->m_broadPhase, m_xf);
+		return;
+	}
+
+	m_mass = 0.0f;
+	m_invMass = 0.0f;
+	m_I = 0.0f;
+	m_invI = 0.0f;
+	m_force.SetZero();
+	m_torque = 0.0f;
+	m_type = e_kinematicType;
+
+	RefilterProxies();
+	UpdateIsland();
+}
+
+void b2Body::UpdateIsland()
+{
+	b2IslandManager* islandManager = &m_world->m_islandManager;
+	bool active = IsActive();
+
+	if ((m_type != e_dynamicType || active == false) && m_island != NULL)
+	{
+		islandManager->RemoveBody(this);
+	}
+	else if ((m_type != e_kinematicType || active == false) && m_island == NULL && m_awakeIndex != -1)
+	{
+		islandManager->RemoveKinematicBody(this);
+	}
+
+	if (active == false)
+	{
+		return;
+	}
+
+	if (m_type == e_dynamicType && m_island == NULL)
+	{
+		islandManager->AddBody(this);
+	}
+	else if (m_type == e_kinematicType && m_awakeIndex == -1 && IsSleeping() == false)
+	{
+		islandManager->AddKinematicBody(this);
+	}
+}
+
+void b2Body::WakeUp()
+{
+	m_flags &= ~e_sleepFlag;
+	m_sleepTime = 0.0f;
+
+	// The rest of a sleeping island keeps sleeping.
+	if (m_island && m_island->awake == false)
+	{
+		m_world->m_islandManager.WakeBody(this);
+	}
+	else if (m_type == e_kinematicType && m_awakeIndex == -1 && IsActive())
+	{
+		m_world->m_islandManager.AddKinematicBody(this);
+	}
+}
+
+void b2Body::SetActive(bool flag)
+{
+	b2Assert(m_world->m_lock == false);
+
+	if (flag == IsActive())
+	{
+		return;
+	}
+
+	b2BroadPhase* broadPhase = m_world->m_broadPhase;
+
+	if (flag)
+	{
+		m_flags &= ~e_inactiveFlag;
+
+		// Join the islands first, so that the new contacts are activated.
+		UpdateIsland();
+
+		// The fixtures, the fixture tree and the mass are kept, only the
+		// proxies are created. The broad-phase finds the new pairs.
+		if (m_flags & e_compoundFlag)
+		{
+			CreateProxy();
+		}
+		else
+		{
+			for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+			{
+				f->CreateProxy(broadPhase, m_xf);
+			}
+		}
+	}
+	else
+	{
+		// The bodies resting on this one must fall.
+		m_world->m_islandManager.WakeTouching(this);
+
+		m_flags |= e_inactiveFlag;
+
+		// Destroying the proxies destroys the contacts.
+		if (m_proxyId != b2_nullProxy)
+		{
+			broadPhase->DestroyProxy(m_proxyId);
+			m_proxyId = b2_nullProxy;
+		}
+
+		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+		{
+			f->DestroyProxy(broadPhase);
+		}
+
+		UpdateIsland();
 	}
 }
 
@@ -317,15 +485,28 @@ bool b2Body::SetXForm(const b2Vec2& position, float32 angle)
 	m_sweep.c0 = m_sweep.c = b2Mul(m_xf, m_sweep.localCenter);
 	m_sweep.a0 = m_sweep.a = angle;
 
-	bool freeze = false;
-	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	// The proxies of an inactive body are created at this transform.
+	if (IsActive() == false)
 	{
-		bool inRange = f->Synchronize(m_world->m_broadPhase, m_xf, m_xf);
+		return true;
+	}
 
-		if (inRange == false)
+	bool freeze = false;
+	if (m_flags & e_compoundFlag)
+	{
+		freeze = SynchronizeProxy(m_xf, m_xf) == false;
+	}
+	else
+	{
+		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 		{
-			freeze = true;
-			break;
+			bool inRange = f->Synchronize(m_world->m_broadPhase, m_xf, m_xf, b2Vec2_zero);
+
+			if (inRange == false)
+			{
+				freeze = true;
+				break;
+			}
 		}
 	}
 
@@ -341,6 +522,7 @@ bool b2Body::SetXForm(const b2Vec2& position, float32 angle)
 
 	// Success
 	m_world->m_broadPhase->Commit();
+	m_world->m_contactManager.UpdateCompoundPairs(this);
 	return true;
 }
 
@@ -350,13 +532,28 @@ bool b2Body::SynchronizeFixtures()
 	xf1.R.Set(m_sweep.a0);
 	xf1.position = m_sweep.c0 - b2Mul(xf1.R, m_sweep.localCenter);
 
+	// Extend the AABBs by the motion of the next step so that speculative
+	// contacts exist before the shapes touch.
+	b2Vec2 displacement = b2Vec2_zero;
+	if (m_world->m_speculativeTime > 0.0f && IsBullet() == false)
+	{
+		displacement = m_world->m_speculativeTime * m_linearVelocity;
+	}
+
 	bool inRange = true;
-	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	if (m_flags & e_compoundFlag)
+	{
+		inRange = SynchronizeProxy(xf1, m_xf);
+	}
+	else
 	{
-		inRange = f->Synchronize(m_world->m_broadPhase, xf1, m_xf);
-		if (inRange == false)
+		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 		{
-			break;
+			inRange = f->Synchronize(m_world->m_broadPhase, xf1, m_xf, displacement);
+			if (inRange == false)
+			{
+				break;
+			}
 		}
 	}
 
@@ -373,3 +570,128 @@ bool b2Body::SynchronizeFixtures()
 	// Success
 	return true;
 }
+
+void b2Body::BuildFixtureTree()
+{
+	if (m_treeFixtures)
+	{
+		b2Free(m_treeFixtures);
+		m_treeFixtures = NULL;
+	}
+
+	m_fixtureTree.Clear();
+
+	if (m_fixtureCount > 0)
+	{
+		m_treeFixtures = (b2Fixture**)b2Alloc(m_fixtureCount * sizeof(b2Fixture*));
+		b2AABB* aabbs = (b2AABB*)b2Alloc(m_fixtureCount * sizeof(b2AABB));
+
+		int32 count = 0;
+		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+		{
+			m_treeFixtures[count] = f;
+			f->m_shape->ComputeAABB(aabbs + count, b2XForm_identity);
+			++count;
+		}
+
+		b2Assert(count == m_fixtureCount);
+		m_fixtureTree.Build(aabbs, count);
+		b2Free(aabbs);
+	}
+
+	b2BroadPhase* broadPhase = m_world->m_broadPhase;
+
+	if (m_proxyId == b2_nullProxy)
+	{
+		CreateProxy();
+		return;
+	}
+
+	if (m_fixtureCount == 0)
+	{
+		broadPhase->DestroyProxy(m_proxyId);
+		m_proxyId = b2_nullProxy;
+		return;
+	}
+
+	// The proxy user data must be a fixture that stays alive.
+	broadPhase->GetProxy(m_proxyId)->userData = m_fixtureList;
+
+	if (SynchronizeProxy(m_xf, m_xf))
+	{
+		broadPhase->Commit();
+	}
+}
+
+// The proxy user data is any fixture of the body. The contact manager
+// sees that the body is compound and finds the fixture pairs in the tree.
+void b2Body::CreateProxy()
+{
+	b2Assert(m_proxyId == b2_nullProxy);
+
+	if (m_fixtureCount == 0 || IsActive() == false)
+	{
+		return;
+	}
+
+	b2AABB aabb;
+	b2TransformAABB(&aabb, m_fixtureTree.GetAABB(), m_xf);
+
+	b2BroadPhase* broadPhase = m_world->m_broadPhase;
+	bool inRange = broadPhase->InRange(aabb);
+
+	// You are creating a shape outside the world box.
+	b2Assert(inRange);
+
+	if (inRange)
+	{
+		m_proxyId = broadPhase->CreateProxy(aabb, m_fixtureList);
+	}
+}
+
+bool b2Body::SynchronizeProxy(const b2XForm& xf1, const b2XForm& xf2)
+{
+	if (m_proxyId == b2_nullProxy)
+	{
+		return m_fixtureCount == 0;
+	}
+
+	// Compute an AABB that covers the swept tree (may miss some rotation effect).
+	const b2AABB& localAABB = m_fixtureTree.GetAABB();
+	b2AABB aabb1, aabb2;
+	b2TransformAABB(&aabb1, localAABB, xf1);
+	b2TransformAABB(&aabb2, localAABB, xf2);
+
+	b2AABB aabb;
+	aabb.Combine(aabb1, aabb2);
+
+	b2BroadPhase* broadPhase = m_world->m_broadPhase;
+	if (broadPhase->InRange(aabb))
+	{
+		broadPhase->MoveProxy(m_proxyId, aabb);
+		return true;
+	}
+
+	return false;
+}
+
+void b2Body::RefilterProxies()
+{
+	if ((m_flags & e_compoundFlag) == 0)
+	{
+		for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+		{
+			f->RefilterProxy(m_world->m_broadPhase, m_xf);
+		}
+
+		return;
+	}
+
+	// Recreating the body proxy recreates all pairs of this body.
+	if (m_proxyId != b2_nullProxy)
+	{
+		m_world->m_broadPhase->DestroyProxy(m_proxyId);
+		m_proxyId = b2_nullProxy;
+		CreateProxy();
+	}
+}
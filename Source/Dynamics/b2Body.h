@@ -21,6 +21,7 @@
 
 #include "../Common/b2Math.h"
 #include "../Collision/Shapes/b2Shape.h"
+#include "../Collision/b2StaticTree.h"
 
 #include <memory>
 
@@ -29,6 +30,7 @@ class b2Joint;
 class b2Contact;
 class b2Controller;
 class b2World;
+struct b2PersistentIsland;
 struct b2FixtureDef;
 struct b2JointEdge;
 struct b2ContactEdge;
@@ -55,6 +57,9 @@ struct b2BodyDef
 		isSleeping = false;
 		fixedRotation = false;
 		isBullet = false;
+		isCompound = false;
+		isKinematic = false;
+		isActive = true;
 	}
 
 	/// You can use this to initialized the mass properties of the body.
@@ -103,6 +108,23 @@ struct b2BodyDef
 	/// static bodies.
 	/// @warning You should use this flag sparingly since it increases processing time.
 	bool isBullet;
+
+	/// Is this a compound body? A compound body keeps its fixtures in a tree
+	/// in body space and puts a single proxy into the broad-phase. Fixture
+	/// pairs are only found when the body proxy overlaps another proxy. Use
+	/// this for bodies with many fixtures, such as buildings made of bricks.
+	/// @warning Adding or removing a fixture rebuilds the tree.
+	bool isCompound;
+
+	/// Is this a kinematic body? A kinematic body moves with the velocity you
+	/// set and isn't moved by gravity, forces or contacts. It pushes dynamic
+	/// bodies like a body of infinite mass. Use this for moving platforms and doors.
+	/// The mass data is ignored.
+	bool isKinematic;
+
+	/// Does this body start out active? An inactive body is not simulated and
+	/// has no broad-phase proxies. See b2Body::SetActive.
+	bool isActive;
 };
 
 /// A rigid body. These are created via b2World::CreateBody.
@@ -288,9 +310,19 @@ public:
 	/// Is this body dynamic (movable)?
 	bool IsDynamic() const;
 
+	/// Is this body kinematic (moved by its velocity only)?
+	bool IsKinematic() const;
+
+	/// Make this body kinematic. It keeps its velocity and moves with it, see
+	/// b2BodyDef::isKinematic. Use SetMass and SetMassFromShapes to make bodies dynamic.
+	void SetKinematic();
+
 	/// Is this body frozen?
 	bool IsFrozen() const;
 
+	/// Does this body keep its fixtures in a tree with a single broad-phase proxy?
+	bool IsCompound() const;
+
 	/// Is this body sleeping (not simulating).
 	bool IsSleeping() const;
 
@@ -300,13 +332,26 @@ public:
 	/// You can disable sleeping on this body.
 	void AllowSleeping(bool flag);
 
-	/// Wake up this body so it will begin simulating.
+	/// Wake up this body so it will begin simulating. Bodies joined to it
+	/// wake too. The sleeping bodies it touches wake once it moves.
 	void WakeUp();
 
 	/// Put this body to sleep so it will stop simulating.
-	/// This also sets the velocity to zero.
+	/// This also sets the velocity to zero. The next step takes the island off
+	/// the awake list once all of its bodies sleep.
 	void PutToSleep();
 
+	/// Set the active state of the body. An inactive body is not simulated and
+	/// cannot be collided with, its broad-phase proxies and contacts are destroyed.
+	/// It keeps its fixtures, joints and mass, so activating it only creates the
+	/// proxies again. Joints connected to an inactive body are not simulated.
+	/// Use this to pool bodies instead of destroying and creating them.
+	/// @warning This function is locked during callbacks.
+	void SetActive(bool flag);
+
+	/// Is this body active?
+	bool IsActive() const;
+
 	/// Get the list of all fixtures attached to this body.
 	b2Fixture* GetFixtureList();
 
@@ -343,6 +388,7 @@ private:
 
 	friend class b2World;
 	friend class b2Island;
+	friend class b2IslandManager;
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
 	
@@ -361,11 +407,12 @@ private:
 	enum
 	{
 		e_frozenFlag		= 0x0002,
-		e_islandFlag		= 0x0004,
 		e_sleepFlag			= 0x0008,
 		e_allowSleepFlag	= 0x0010,
 		e_bulletFlag		= 0x0020,
 		e_fixedRotationFlag	= 0x0040,
+		e_compoundFlag		= 0x0080,
+		e_inactiveFlag		= 0x0100,
 	};
 
 	// m_type
@@ -373,6 +420,7 @@ private:
 	{
 		e_staticType,
 		e_dynamicType,
+		e_kinematicType,
 		e_maxTypes,
 	};
 
@@ -381,6 +429,20 @@ private:
 
 	bool SynchronizeFixtures();
 
+	// Allocate a fixture and link it to this body. The proxy is created
+	// by b2Fixture::Create unless the body is compound or inactive.
+	b2Fixture* AddFixture(const b2FixtureDef* def);
+
+	// Compound bodies keep their fixtures in a tree in body space
+	// and move a single broad-phase proxy that bounds the tree.
+	void BuildFixtureTree();
+	void CreateProxy();
+	bool SynchronizeProxy(const b2XForm& xf1, const b2XForm& xf2);
+	void RefilterProxies();
+
+	// Add or remove the body from the islands after a type change.
+	void UpdateIsland();
+
 	void SynchronizeTransform();
 
 	// This is used to prevent connected bodies from colliding.
@@ -394,6 +456,9 @@ private:
 
 	int32 m_islandIndex;
 
+	// The island search that last reached this body.
+	uint32 m_islandEpoch;
+
 	b2XForm m_xf;		// the body origin transform
 	b2Sweep m_sweep;	// the swept motion for CCD
 
@@ -407,9 +472,23 @@ private:
 	b2Body* m_prev;
 	b2Body* m_next;
 
+	// The persistent island of a dynamic body.
+	b2PersistentIsland* m_island;
+	b2Body* m_islandPrev;
+	b2Body* m_islandNext;
+
+	// The index in the awake body array, or -1. This holds the bodies of the
+	// awake islands and the kinematic bodies that don't sleep.
+	int32 m_awakeIndex;
+
 	b2Fixture* m_fixtureList;
 	int32 m_fixtureCount;
 
+	// The fixture tree of a compound body. Tree items index m_treeFixtures.
+	b2StaticTree m_fixtureTree;
+	b2Fixture** m_treeFixtures;
+	uint16 m_proxyId;
+
 	b2JointEdge* m_jointList;
 	b2ContactEdge* m_contactList;
 
@@ -469,6 +548,12 @@ inline const b2Vec2& b2Body::GetLocalCenter() const
 inline void b2Body::SetLinearVelocity(const b2Vec2& v)
 {
 	m_linearVelocity = v;
+
+	// A kinematic body wakes when its velocity is set.
+	if (m_type == e_kinematicType && IsSleeping())
+	{
+		WakeUp();
+	}
 }
 
 inline b2Vec2 b2Body::GetLinearVelocity() const
@@ -479,6 +564,11 @@ inline b2Vec2 b2Body::GetLinearVelocity() const
 inline void b2Body::SetAngularVelocity(float32 w)
 {
 	m_angularVelocity = w;
+
+	if (m_type == e_kinematicType && IsSleeping())
+	{
+		WakeUp();
+	}
 }
 
 inline float32 b2Body::GetAngularVelocity() const
@@ -608,16 +698,31 @@ inline bool b2Body::IsDynamic() const
 	return m_type == e_dynamicType;
 }
 
+inline bool b2Body::IsKinematic() const
+{
+	return m_type == e_kinematicType;
+}
+
 inline bool b2Body::IsFrozen() const
 {
 	return (m_flags & e_frozenFlag) == e_frozenFlag;
 }
 
+inline bool b2Body::IsCompound() const
+{
+	return (m_flags & e_compoundFlag) == e_compoundFlag;
+}
+
 inline bool b2Body::IsSleeping() const
 {
 	return (m_flags & e_sleepFlag) == e_sleepFlag;
 }
 
+inline bool b2Body::IsActive() const
+{
+	return (m_flags & e_inactiveFlag) == 0;
+}
+
 inline bool b2Body::IsAllowSleeping() const
 {
 	return (m_flags & e_allowSleepFlag) == e_allowSleepFlag;
@@ -636,12 +741,6 @@ inline void b2Body::AllowSleeping(bool flag)
 	}
 }
 
-inline void b2Body::WakeUp()
-{
-	m_flags &= ~e_sleepFlag;
-	m_sleepTime = 0.0f;
-}
-
 inline void b2Body::PutToSleep()
 {
 	m_flags |= e_sleepFlag;
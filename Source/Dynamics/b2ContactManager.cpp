@@ -20,6 +20,17 @@
 #include "b2World.h"
 #include "b2Body.h"
 #include "b2Fixture.h"
+#include "../Collision/Shapes/b2Shape.h"
+
+#include <string.h>
+
+b2ContactManager::~b2ContactManager()
+{
+	if (m_activeContacts)
+	{
+		b2Free(m_activeContacts);
+	}
+}
 
 // This is a callback from the broad-phase when two AABB proxies begin
 // to overlap. We create a b2Contact to manage the narrow phase.
@@ -28,10 +39,22 @@ void* b2ContactManager::PairAdded(void* proxyUserDataA, void* proxyUserDataB)
 	b2Fixture* fixtureA = (b2Fixture*)proxyUserDataA;
 	b2Fixture* fixtureB = (b2Fixture*)proxyUserDataB;
 
+	// The proxy of a compound body stands for all of its fixtures.
+	if (fixtureA->GetBody()->IsCompound() || fixtureB->GetBody()->IsCompound())
+	{
+		return AddCompoundPair(fixtureA, fixtureB);
+	}
+
+	return AddContact(fixtureA, fixtureB);
+}
+
+b2Contact* b2ContactManager::AddContact(b2Fixture* fixtureA, b2Fixture* fixtureB)
+{
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
-	if (bodyA->IsStatic() && bodyB->IsStatic())
+	// Only dynamic bodies respond to contacts.
+	if (bodyA->IsDynamic() == false && bodyB->IsDynamic() == false)
 	{
 		return &m_nullContact;
 	}
@@ -100,6 +123,11 @@ void* b2ContactManager::PairAdded(void* proxyUserDataA, void* proxyUserDataB)
 	}
 	bodyB->m_contactList = &c->m_nodeB;
 
+	if (bodyA->m_awakeIndex != -1 || bodyB->m_awakeIndex != -1)
+	{
+		AddActiveContact(c);
+	}
+
 	++m_world->m_contactCount;
 	return c;
 }
@@ -108,20 +136,26 @@ void* b2ContactManager::PairAdded(void* proxyUserDataA, void* proxyUserDataB)
 // to overlap. We retire the b2Contact.
 void b2ContactManager::PairRemoved(void* proxyUserDataA, void* proxyUserDataB, void* pairUserData)
 {
-	B2_NOT_USED(proxyUserDataA);
-	B2_NOT_USED(proxyUserDataB);
-
 	if (pairUserData == NULL)
 	{
 		return;
 	}
 
-	b2Contact* c = (b2Contact*)pairUserData;
-	if (c == &m_nullContact)
+	if (pairUserData == &m_nullContact)
+	{
+		return;
+	}
+
+	b2Fixture* fixtureA = (b2Fixture*)proxyUserDataA;
+	b2Fixture* fixtureB = (b2Fixture*)proxyUserDataB;
+	if (fixtureA->GetBody()->IsCompound() || fixtureB->GetBody()->IsCompound())
 	{
+		DestroyCompoundPair((b2CompoundPair*)pairUserData);
 		return;
 	}
 
+	b2Contact* c = (b2Contact*)pairUserData;
+
 	// An attached body is being destroyed, we must destroy this contact
 	// immediately to avoid orphaned shape pointers.
 	Destroy(c);
@@ -134,11 +168,16 @@ void b2ContactManager::Destroy(b2Contact* c)
 	b2Body* bodyA = fixtureA->GetBody();
 	b2Body* bodyB = fixtureB->GetBody();
 
-	if (c->m_manifold.m_pointCount > 0)
+	if (c->GetPointCount() > 0)
 	{
 		m_world->m_contactListener->EndContact(c);
 	}
 
+	if (b2IslandManager::IsConstraint(c))
+	{
+		m_world->m_islandManager.Unlink(bodyA, bodyB);
+	}
+
 	// Remove from the world.
 	if (c->m_prev)
 	{
@@ -187,10 +226,24 @@ void b2ContactManager::Destroy(b2Contact* c)
 		bodyB->m_contactList = c->m_nodeB.next;
 	}
 
-	if (m_nextContact == c)
+	if (c->m_activeIndex != -1)
+	{
+		RemoveActiveContact(c);
+	}
+
+	// Remove from the TOI queue.
+	if (c->m_flags & b2Contact::e_toiFlag)
+	{
+		m_world->m_toiQueue.Remove(c);
+	}
+
+	// The fixtures of a contact that is destroyed later may be gone by then.
+	if (c->GetPointCount() > 0)
 	{
-		m_nextContact = c->GetNext();
+		bodyA->WakeUp();
+		bodyB->WakeUp();
 	}
+
 	// Call the factory.
 	if( c->m_flags & b2Contact::e_lockedFlag)
 	{
@@ -211,29 +264,407 @@ void b2ContactManager::Destroy(b2Contact* c)
 	--m_world->m_contactCount;
 }
 
+// Compute the AABB of a shape over the last step.
+static void b2ComputeSweptAABB(b2AABB* aabb, const b2Shape* shape, const b2XForm& xf1, const b2XForm& xf2)
+{
+	b2AABB aabb1, aabb2;
+	shape->ComputeAABB(&aabb1, xf1);
+	shape->ComputeAABB(&aabb2, xf2);
+	aabb->Combine(aabb1, aabb2);
+}
+
+// Report the fixtures of a compound body that overlap a fixture of the other
+// side. The tree is queried in body space where the AABB of the other fixture
+// is loose, so the candidates are checked in world space like in the broad-phase.
+struct b2CompoundQueryCallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2Fixture* candidate = fixtures[index];
+
+		b2AABB candidateAABB;
+		b2ComputeSweptAABB(&candidateAABB, candidate->GetShape(), xf1, xf2);
+		if (b2TestOverlap(candidateAABB, aabb))
+		{
+			manager->AddFixturePair(pair, candidate, fixture);
+		}
+	}
+
+	b2ContactManager* manager;
+	b2CompoundPair* pair;
+	b2Fixture* const* fixtures;
+	b2XForm xf1, xf2;	///< the transforms of the compound body
+	b2Fixture* fixture;
+	b2AABB aabb;		///< the world AABB of the fixture
+};
+
+// Report the fixtures of compound body A that may overlap compound body B
+// and query the tree of B for each of them.
+struct b2CompoundTreeCallback
+{
+	void QueryCallback(int32 index)
+	{
+		b2Fixture* fixture = fixturesA[index];
+		const b2Shape* shape = fixture->GetShape();
+
+		callback.fixture = fixture;
+		b2ComputeSweptAABB(&callback.aabb, shape, xfA1, xfA2);
+
+		b2AABB localAABB;
+		b2ComputeSweptAABB(&localAABB, shape, localXF1, localXF2);
+		treeB->Query(&callback, localAABB);
+	}
+
+	b2CompoundQueryCallback callback;
+	const b2StaticTree* treeB;
+	b2Fixture* const* fixturesA;
+	b2XForm xfA1, xfA2;			///< the transforms of A
+	b2XForm localXF1, localXF2;	///< the transforms of A in the frame of B
+};
+
+// Get the transform of body B in the frame of body A.
+static b2XForm b2GetRelativeXForm(const b2XForm& xfA, const b2XForm& xfB)
+{
+	return b2XForm(b2MulT(xfA, xfB.position), b2MulT(xfA.R, xfB.R));
+}
+
+void* b2ContactManager::AddCompoundPair(b2Fixture* fixtureA, b2Fixture* fixtureB)
+{
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
+	// Only dynamic bodies respond to contacts.
+	if (bodyA->IsDynamic() == false && bodyB->IsDynamic() == false)
+	{
+		return &m_nullContact;
+	}
+
+	if (bodyB->IsConnected(bodyA))
+	{
+		return &m_nullContact;
+	}
+
+	void* mem = m_world->m_blockAllocator.Allocate(sizeof(b2CompoundPair));
+	b2CompoundPair* pair = (b2CompoundPair*)mem;
+	pair->bodyA = bodyA;
+	pair->bodyB = bodyB;
+	pair->fixtureA = bodyA->IsCompound() ? NULL : fixtureA;
+	pair->fixtureB = bodyB->IsCompound() ? NULL : fixtureB;
+	pair->fixturePairs = NULL;
+	pair->stamp = 0;
+
+	pair->prev = NULL;
+	pair->next = m_compoundPairList;
+	if (m_compoundPairList)
+	{
+		m_compoundPairList->prev = pair;
+	}
+	m_compoundPairList = pair;
+
+	// Create the contacts right away, like for other pairs, so that they
+	// take part in the TOI phase of this step.
+	UpdateCompoundPair(pair);
+
+	return pair;
+}
+
+void b2ContactManager::DestroyCompoundPair(b2CompoundPair* pair)
+{
+	b2FixturePair* fp = pair->fixturePairs;
+	while (fp)
+	{
+		b2FixturePair* fp0 = fp;
+		fp = fp->next;
+
+		DestroyFixturePair(fp0);
+	}
+
+	if (pair->prev)
+	{
+		pair->prev->next = pair->next;
+	}
+
+	if (pair->next)
+	{
+		pair->next->prev = pair->prev;
+	}
+
+	if (pair == m_compoundPairList)
+	{
+		m_compoundPairList = pair->next;
+	}
+
+	m_world->m_blockAllocator.Free(pair, sizeof(b2CompoundPair));
+}
+
+void b2ContactManager::DestroyFixturePair(b2FixturePair* fixturePair)
+{
+	if (fixturePair->contact != &m_nullContact)
+	{
+		Destroy(fixturePair->contact);
+	}
+
+	m_world->m_blockAllocator.Free(fixturePair, sizeof(b2FixturePair));
+}
+
+void b2ContactManager::AddFixturePair(b2CompoundPair* pair, b2Fixture* fixtureA, b2Fixture* fixtureB)
+{
+	for (b2FixturePair* fp = pair->fixturePairs; fp; fp = fp->next)
+	{
+		if ((fp->fixtureA == fixtureA && fp->fixtureB == fixtureB) ||
+			(fp->fixtureA == fixtureB && fp->fixtureB == fixtureA))
+		{
+			fp->stamp = pair->stamp;
+			return;
+		}
+	}
+
+	void* mem = m_world->m_blockAllocator.Allocate(sizeof(b2FixturePair));
+	b2FixturePair* fp = (b2FixturePair*)mem;
+	fp->fixtureA = fixtureA;
+	fp->fixtureB = fixtureB;
+	fp->contact = AddContact(fixtureA, fixtureB);
+	fp->stamp = pair->stamp;
+	fp->next = pair->fixturePairs;
+	pair->fixturePairs = fp;
+}
+
+// Query the fixture trees with the AABBs swept over the last step, so that
+// fast bodies get their contacts for TOI. Fixture pairs that were not found
+// again are retired.
+void b2ContactManager::UpdateCompoundPair(b2CompoundPair* pair)
+{
+	b2Body* bodyA = pair->bodyA;
+	b2Body* bodyB = pair->bodyB;
+
+	// Let A be a compound body.
+	bool flip = pair->fixtureA != NULL;
+	if (flip)
+	{
+		b2Swap(bodyA, bodyB);
+	}
+
+	b2XForm xfA1, xfB1;
+	xfA1.R.Set(bodyA->m_sweep.a0);
+	xfA1.position = bodyA->m_sweep.c0 - b2Mul(xfA1.R, bodyA->m_sweep.localCenter);
+	xfB1.R.Set(bodyB->m_sweep.a0);
+	xfB1.position = bodyB->m_sweep.c0 - b2Mul(xfB1.R, bodyB->m_sweep.localCenter);
+
+	++pair->stamp;
+
+	b2CompoundQueryCallback callback;
+	callback.manager = this;
+	callback.pair = pair;
+
+	if (bodyB->IsCompound() == false)
+	{
+		b2Fixture* fixture = flip ? pair->fixtureA : pair->fixtureB;
+		const b2Shape* shape = fixture->GetShape();
+
+		callback.fixtures = bodyA->m_treeFixtures;
+		callback.xf1 = xfA1;
+		callback.xf2 = bodyA->m_xf;
+		callback.fixture = fixture;
+		b2ComputeSweptAABB(&callback.aabb, shape, xfB1, bodyB->m_xf);
+
+		b2AABB localAABB;
+		b2ComputeSweptAABB(&localAABB, shape, b2GetRelativeXForm(xfA1, xfB1), b2GetRelativeXForm(bodyA->m_xf, bodyB->m_xf));
+		bodyA->m_fixtureTree.Query(&callback, localAABB);
+	}
+	else if (bodyA->m_proxyId != b2_nullProxy && bodyB->m_proxyId != b2_nullProxy)
+	{
+		// Find the fixtures of A that may overlap the tree of B, then the
+		// fixtures of B that overlap each of them.
+		const b2AABB& treeAABB = bodyB->m_fixtureTree.GetAABB();
+		b2AABB aabb1, aabb2, aabb;
+		b2TransformAABB(&aabb1, treeAABB, b2GetRelativeXForm(xfA1, xfB1));
+		b2TransformAABB(&aabb2, treeAABB, b2GetRelativeXForm(bodyA->m_xf, bodyB->m_xf));
+		aabb.Combine(aabb1, aabb2);
+
+		callback.fixtures = bodyB->m_treeFixtures;
+		callback.xf1 = xfB1;
+		callback.xf2 = bodyB->m_xf;
+
+		b2CompoundTreeCallback treeCallback;
+		treeCallback.callback = callback;
+		treeCallback.treeB = &bodyB->m_fixtureTree;
+		treeCallback.fixturesA = bodyA->m_treeFixtures;
+		treeCallback.xfA1 = xfA1;
+		treeCallback.xfA2 = bodyA->m_xf;
+		treeCallback.localXF1 = b2GetRelativeXForm(xfB1, xfA1);
+		treeCallback.localXF2 = b2GetRelativeXForm(bodyB->m_xf, bodyA->m_xf);
+
+		bodyA->m_fixtureTree.Query(&treeCallback, aabb);
+	}
+
+	// Retire the fixture pairs that were not found.
+	b2FixturePair** node = &pair->fixturePairs;
+	while (*node)
+	{
+		b2FixturePair* fp = *node;
+		if (fp->stamp == pair->stamp)
+		{
+			node = &fp->next;
+			continue;
+		}
+
+		*node = fp->next;
+		DestroyFixturePair(fp);
+	}
+}
+
+void b2ContactManager::UpdateCompoundPairs()
+{
+	for (b2CompoundPair* pair = m_compoundPairList; pair; pair = pair->next)
+	{
+		b2Body* bodyA = pair->bodyA;
+		b2Body* bodyB = pair->bodyB;
+
+		// Fixture pairs don't change while neither body moves.
+		bool activeA = bodyA->IsStatic() == false && bodyA->IsSleeping() == false;
+		bool activeB = bodyB->IsStatic() == false && bodyB->IsSleeping() == false;
+		if (activeA == false && activeB == false)
+		{
+			continue;
+		}
+
+		UpdateCompoundPair(pair);
+	}
+}
+
+void b2ContactManager::UpdateCompoundPairs(b2Body* body)
+{
+	for (b2CompoundPair* pair = m_compoundPairList; pair; pair = pair->next)
+	{
+		if (pair->bodyA == body || pair->bodyB == body)
+		{
+			UpdateCompoundPair(pair);
+		}
+	}
+}
+
+void b2ContactManager::DestroyCompoundContacts(b2Fixture* fixture)
+{
+	b2Body* body = fixture->GetBody();
+
+	for (b2CompoundPair* pair = m_compoundPairList; pair; pair = pair->next)
+	{
+		if (pair->bodyA != body && pair->bodyB != body)
+		{
+			continue;
+		}
+
+		b2FixturePair** node = &pair->fixturePairs;
+		while (*node)
+		{
+			b2FixturePair* fp = *node;
+			if (fp->fixtureA != fixture && fp->fixtureB != fixture)
+			{
+				node = &fp->next;
+				continue;
+			}
+
+			*node = fp->next;
+			DestroyFixturePair(fp);
+		}
+	}
+}
+
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
 void b2ContactManager::Collide()
 {
-	// Update awake contacts.
-	// Note the use of a accessible iterator, m_nextContact, this can be updated elsewhere
-	// should that contact get deleted inside the call to m_nextContact
-	m_nextContact = m_world->m_contactList;
-	while(m_nextContact)
-	{
-		b2Contact* c  = m_nextContact;
-		m_nextContact = c->GetNext();
-		b2Body* bodyA = c->GetFixtureA()->GetBody();
-		b2Body* bodyB = c->GetFixtureB()->GetBody();
-		if (bodyA->IsSleeping() && bodyB->IsSleeping())
+	// Walk backwards, so that a contact destroyed by a callback is replaced by
+	// one that was already updated. Contacts activated by a callback come
+	// after the current one and are updated in the next step.
+	int32 i = m_activeContactCount;
+	while (i > 0)
+	{
+		--i;
+		if (i >= m_activeContactCount)
 		{
 			continue;
 		}
 
-		Update(c);
+		Update(m_activeContacts[i]);
 	}
-    m_nextContact = NULL;
+}
+
+void b2ContactManager::AddActiveContact(b2Contact* contact)
+{
+	b2Assert(contact->m_activeIndex == -1);
+
+	if (m_activeContactCount == m_activeContactCapacity)
+	{
+		// Grow the array.
+		int32 capacity = b2Max(64, 2 * m_activeContactCapacity);
+		b2Contact** contacts = (b2Contact**)b2Alloc(capacity * sizeof(b2Contact*));
+		if (m_activeContacts)
+		{
+			memcpy(contacts, m_activeContacts, m_activeContactCount * sizeof(b2Contact*));
+			b2Free(m_activeContacts);
+		}
+		m_activeContacts = contacts;
+		m_activeContactCapacity = capacity;
+	}
+
+	contact->m_activeIndex = m_activeContactCount;
+	m_activeContacts[m_activeContactCount++] = contact;
+}
+
+void b2ContactManager::RemoveActiveContact(b2Contact* contact)
+{
+	int32 index = contact->m_activeIndex;
+	b2Assert(0 <= index && index < m_activeContactCount && m_activeContacts[index] == contact);
+
+	// Move the last contact into the hole.
+	b2Contact* last = m_activeContacts[--m_activeContactCount];
+	m_activeContacts[index] = last;
+	last->m_activeIndex = index;
+	contact->m_activeIndex = -1;
+}
+
+bool b2ContactManager::IsSpeculative(b2Contact* contact) const
+{
+	if (m_world->m_speculativeTime == 0.0f)
+	{
+		return false;
+	}
+
+	uint32 mask = b2Contact::e_speculativeFlag | b2Contact::e_nonSolidFlag;
+	if ((contact->m_flags & mask) != b2Contact::e_speculativeFlag)
+	{
+		return false;
+	}
+
+	// Bullets keep TOI. The fixture pairs of compound bodies are found with
+	// the swept AABB only, so they keep TOI as well.
+	b2Body* bodyA = contact->m_fixtureA->GetBody();
+	b2Body* bodyB = contact->m_fixtureB->GetBody();
+	if (bodyA->IsBullet() || bodyB->IsBullet() || bodyA->IsCompound() || bodyB->IsCompound())
+	{
+		return false;
+	}
+
+	return true;
+}
+
+// Link or unlink the islands of the bodies when the contact became or stopped
+// being a constraint. Returns whether the contact is a constraint now.
+static bool b2SyncIslands(b2IslandManager* islandManager, b2Contact* contact, bool wasConstraint)
+{
+	bool isConstraint = b2IslandManager::IsConstraint(contact);
+	if (isConstraint && wasConstraint == false)
+	{
+		islandManager->Link(contact->GetFixtureA()->GetBody(), contact->GetFixtureB()->GetBody());
+	}
+	else if (wasConstraint && isConstraint == false)
+	{
+		islandManager->Unlink(contact->GetFixtureA()->GetBody(), contact->GetFixtureB()->GetBody());
+	}
+
+	return isConstraint;
 }
 
 bool b2ContactManager::Update(b2Contact* contact)
@@ -247,11 +678,48 @@ bool b2ContactManager::Update(b2Contact* contact)
 	b2ShapeType shapeBType = contact->m_fixtureB->GetType();
     
     b2Manifold oldManifold = contact->m_manifold;
+	int32 oldCount = contact->GetPointCount();
+
+	// Composite contacts double buffer their manifolds, so the manifolds of
+	// the previous update stay valid after Evaluate.
+	const b2Manifold* oldManifolds = &oldManifold;
+	int32 oldManifoldCount = 1;
+	if (contact->m_manifolds != &contact->m_manifold)
+	{
+		oldManifolds = contact->m_manifolds;
+		oldManifoldCount = contact->m_manifoldCount;
+	}
     
 	uint32 oldLock = contact->m_flags & b2Contact::e_lockedFlag ;
+	bool wasConstraint = b2IslandManager::IsConstraint(contact);
 
 	contact->m_flags |= b2Contact::e_lockedFlag;
 
+	bool speculative = IsSpeculative(contact);
+	if (speculative)
+	{
+		// Bound the approach of the closest points over the next step.
+		b2Vec2 v = bodyB->m_linearVelocity - bodyA->m_linearVelocity;
+		float32 speed = v.Length();
+		if (bodyA->m_angularVelocity != 0.0f)
+		{
+			float32 radius = contact->m_fixtureA->ComputeSweepRadius(bodyA->m_sweep.localCenter);
+			speed += b2Abs(bodyA->m_angularVelocity) * radius;
+		}
+		if (bodyB->m_angularVelocity != 0.0f)
+		{
+			float32 radius = contact->m_fixtureB->ComputeSweepRadius(bodyB->m_sweep.localCenter);
+			speed += b2Abs(bodyB->m_angularVelocity) * radius;
+		}
+
+		float32 distance = m_world->m_speculativeTime * speed;
+		contact->m_speculativeDistance = b2Min(distance, 2.0f * b2_maxTranslation);
+	}
+	else
+	{
+		contact->m_speculativeDistance = 0.0f;
+	}
+
 	contact->Evaluate();
 	
 	contact->m_flags &= ~b2Contact::e_invalidFlag;
@@ -262,11 +730,7 @@ bool b2ContactManager::Update(b2Contact* contact)
         return true;
 	}
 
-	if(!oldLock)
-		contact->m_flags &= ~b2Contact::e_lockedFlag;
-    
-	int32 oldCount = oldManifold.m_pointCount;
-	int32 newCount = contact->m_manifold.m_pointCount;
+	int32 newCount = contact->GetPointCount();
     
 	if (newCount == 0 && oldCount > 0)
 	{
@@ -274,8 +738,13 @@ bool b2ContactManager::Update(b2Contact* contact)
 		bodyB->WakeUp();
 	}
 
-	// Slow contacts don't generate TOI events.
-	if (bodyA->IsStatic() || bodyA->IsBullet() || bodyB->IsStatic() || bodyB->IsBullet())
+	// Slow contacts don't generate TOI events. Speculative contacts are
+	// stopped by the solver instead.
+	if (bodyA->IsBullet() || bodyB->IsBullet())
+	{
+		contact->m_flags &= ~b2Contact::e_slowFlag;
+	}
+	else if (speculative == false && (bodyA->IsStatic() || bodyB->IsStatic()))
 	{
 		contact->m_flags &= ~b2Contact::e_slowFlag;
 	}
@@ -285,49 +754,52 @@ bool b2ContactManager::Update(b2Contact* contact)
 	}
     
 	// Match old contact ids to new contact ids and copy the
-	// stored impulses to warm start the solver.
-	for (int32 i = 0; i < contact->m_manifold.m_pointCount; ++i)
-	{
-		b2ManifoldPoint* mp2 = contact->m_manifold.m_points + i;
-		mp2->m_normalImpulse = 0.0f;
-		mp2->m_tangentImpulse = 0.0f;
-		b2ContactID id2 = mp2->m_id;
-
-		for (int32 j = 0; j < oldManifold.m_pointCount; ++j)
-		{
-			b2ManifoldPoint* mp1 = oldManifold.m_points + j;
-
-			if (mp1->m_id.key == id2.key)
-			{
-				mp2->m_normalImpulse = mp1->m_normalImpulse;
-				mp2->m_tangentImpulse = mp1->m_tangentImpulse;
-				break;
-			}
-		}
-	}
-
+	// stored impulses to warm start the solver. Contacts with a
+	// chain warm start their segment manifolds during Evaluate.
+	b2Contact::WarmStart(&contact->m_manifold, &oldManifold);
+
+	// The contact stays locked during the callbacks. A listener that destroys
+	// one of the bodies only marks the contact for destruction. The islands
+	// are in sync with the contact before each callback, so that destroying
+	// the contact unlinks them correctly.
 	if (oldCount == 0 && newCount > 0)
 	{
 		contact->m_flags |= b2Contact::e_touchFlag;
+		wasConstraint = b2SyncIslands(&m_world->m_islandManager, contact, wasConstraint);
 		listener->BeginContact(contact);
 	}
 
-	if (oldCount > 0 && newCount == 0)
+	if (oldCount > 0 && newCount == 0 && (contact->m_flags & b2Contact::e_destroyFlag) == 0)
 	{
 		contact->m_flags &= ~b2Contact::e_touchFlag;
+		wasConstraint = b2SyncIslands(&m_world->m_islandManager, contact, wasConstraint);
 		listener->EndContact(contact);
 	}
 
-	if ((contact->m_flags & b2Contact::e_nonSolidFlag) == 0)
+	if ((contact->m_flags & (b2Contact::e_nonSolidFlag | b2Contact::e_destroyFlag)) == 0)
 	{
-		listener->PreSolve(contact, &oldManifold);
+		listener->PreSolveManifolds(contact, oldManifolds, oldManifoldCount);
 
 		// The user may have disabled contact.
-		if (contact->m_manifold.m_pointCount == 0)
+		if (contact->GetPointCount() == 0)
 		{
 			contact->m_flags &= ~b2Contact::e_touchFlag;
 		}
 	}
+
+	if (contact->m_flags & b2Contact::e_destroyFlag)
+	{
+		b2Contact::Destroy(contact, shapeAType, shapeBType, &m_world->m_blockAllocator);
+		return true;
+	}
+
+	if (!oldLock)
+	{
+		contact->m_flags &= ~b2Contact::e_lockedFlag;
+	}
+
+	// The listener may have disabled the contact.
+	b2SyncIslands(&m_world->m_islandManager, contact, wasConstraint);
 	
 	return false;
 }
@@ -24,8 +24,39 @@
 
 class b2World;
 class b2Contact;
+class b2Body;
+class b2Fixture;
 struct b2TimeStep;
 
+// A pair of fixtures found under a compound pair, with the contact that
+// was created for it. The contact is the null contact if the fixtures
+// were filtered.
+struct b2FixturePair
+{
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2Contact* contact;
+	int32 stamp;
+	b2FixturePair* next;
+};
+
+// The pair user data of a broad-phase pair that involves a compound body.
+// A compound body has a single proxy, so the fixture pairs are found by
+// querying the fixture trees whenever the bodies move. Each side is a
+// compound body or a fixture with its own proxy (the fixture is NULL for
+// compound sides).
+struct b2CompoundPair
+{
+	b2Body* bodyA;
+	b2Body* bodyB;
+	b2Fixture* fixtureA;
+	b2Fixture* fixtureB;
+	b2FixturePair* fixturePairs;
+	int32 stamp;
+	b2CompoundPair* prev;
+	b2CompoundPair* next;
+};
+
 // Delegate of b2World.
 class b2ContactManager : public b2PairCallback
 {
@@ -33,9 +64,14 @@ public:
 	b2ContactManager() : 
 		m_world(NULL), 
 		m_destroyImmediate(false),
-		m_nextContact(NULL)
+		m_compoundPairList(NULL),
+		m_activeContacts(NULL),
+		m_activeContactCount(0),
+		m_activeContactCapacity(0)
 		{}
 
+	~b2ContactManager();
+
 	// Implements PairCallback
 	void* PairAdded(void* proxyUserDataA, void* proxyUserDataB);
 
@@ -44,7 +80,31 @@ public:
 
 	void Destroy(b2Contact* c);
 
+	// Create the contact for two fixtures, unless they are filtered.
+	b2Contact* AddContact(b2Fixture* fixtureA, b2Fixture* fixtureB);
+
+	// Find the fixture pairs of compound pairs with a moving body. This is
+	// called after the broad-phase commits the proxy movements of a step.
+	void UpdateCompoundPairs();
+
+	// Find the fixture pairs of the compound pairs of a body that was moved
+	// by the user.
+	void UpdateCompoundPairs(b2Body* body);
+
+	// Destroy the contacts of a fixture of a compound body. They are created
+	// again by the next update if the fixture still exists.
+	void DestroyCompoundContacts(b2Fixture* fixture);
+
+	// Keep a fixture pair of a compound pair for this update, creating its contact if needed.
+	void AddFixturePair(b2CompoundPair* pair, b2Fixture* fixtureA, b2Fixture* fixtureB);
+
+	// Update the active contacts.
 	void Collide();
+
+	// Contacts are active while one of their bodies is awake. Only active
+	// contacts are updated and checked for TOI events.
+	void AddActiveContact(b2Contact* contact);
+	void RemoveActiveContact(b2Contact* contact);
             
 	/// Updates the contact, which includes re-evaluating it and calling user call backs.
 	/// Thus the world can be arbitrarily changed.
@@ -55,13 +115,25 @@ private:
 	friend class b2World;
 	b2World* m_world;
 
+	void* AddCompoundPair(b2Fixture* fixtureA, b2Fixture* fixtureB);
+	void DestroyCompoundPair(b2CompoundPair* pair);
+	void DestroyFixturePair(b2FixturePair* fixturePair);
+	void UpdateCompoundPair(b2CompoundPair* pair);
+
+	// Does the contact get a speculative margin in this step?
+	bool IsSpeculative(b2Contact* contact) const;
+
 	// This lets us provide broadphase proxy pair user data for
 	// contacts that shouldn't exist.
 	b2NullContact m_nullContact;
-    
-    b2Contact* m_nextContact;
 
 	bool m_destroyImmediate;
+
+	b2CompoundPair* m_compoundPairList;
+
+	b2Contact** m_activeContacts;
+	int32 m_activeContactCount;
+	int32 m_activeContactCapacity;
 };
 
 #endif
@@ -20,6 +20,11 @@
 #include "../Collision/Shapes/b2CircleShape.h"
 #include "../Collision/Shapes/b2PolygonShape.h"
 #include "../Collision/Shapes/b2EdgeShape.h"
+#include "../Collision/Shapes/b2ChainShape.h"
+#include "../Collision/Shapes/b2HeightfieldShape.h"
+#include "../Collision/Shapes/b2MeshShape.h"
+#include "../Collision/Shapes/b2CapsuleShape.h"
+#include "../Collision/Shapes/b2GridShape.h"
 #include "../Collision/b2Collision.h"
 #include "../Collision/b2BroadPhase.h"
 #include "../Common/b2BlockAllocator.h"
@@ -118,11 +123,91 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2BroadPhase* broadPhase, b2
 		}
 		break;
 
+	case b2_chainShape:
+		{
+			void* mem = allocator->Allocate(sizeof(b2ChainShape));
+			b2ChainShape* chain = new (mem) b2ChainShape;
+			b2ChainDef* chainDef = (b2ChainDef*)def;
+			chain->Set(chainDef->vertices, chainDef->vertexCount, chainDef->isLoop);
+			if (chainDef->isLoop == false)
+			{
+				if (chainDef->hasPrevVertex)
+				{
+					chain->SetPrevVertex(chainDef->prevVertex);
+				}
+
+				if (chainDef->hasNextVertex)
+				{
+					chain->SetNextVertex(chainDef->nextVertex);
+				}
+			}
+			m_shape = chain;
+		}
+		break;
+
+	case b2_heightfieldShape:
+		{
+			void* mem = allocator->Allocate(sizeof(b2HeightfieldShape));
+			b2HeightfieldShape* heightfield = new (mem) b2HeightfieldShape;
+			b2HeightfieldDef* heightfieldDef = (b2HeightfieldDef*)def;
+			if (heightfieldDef->heights)
+			{
+				heightfield->Set(heightfieldDef->heights, heightfieldDef->sampleCount, heightfieldDef->spacing);
+			}
+			else
+			{
+				heightfield->Set(heightfieldDef->quantizedHeights, heightfieldDef->sampleCount,
+					heightfieldDef->spacing, heightfieldDef->heightScale);
+			}
+			m_shape = heightfield;
+		}
+		break;
+
+	case b2_meshShape:
+		{
+			void* mem = allocator->Allocate(sizeof(b2MeshShape));
+			b2MeshShape* mesh = new (mem) b2MeshShape;
+			b2MeshDef* meshDef = (b2MeshDef*)def;
+			mesh->Set(meshDef->vertices, meshDef->vertexCount,
+				meshDef->triangles, meshDef->triangleCount,
+				meshDef->segments, meshDef->segmentCount);
+			m_shape = mesh;
+		}
+		break;
+
+	case b2_capsuleShape:
+		{
+			void* mem = allocator->Allocate(sizeof(b2CapsuleShape));
+			b2CapsuleShape* capsule = new (mem) b2CapsuleShape;
+			b2CapsuleDef* capsuleDef = (b2CapsuleDef*)def;
+			capsule->Set(capsuleDef->localPoint1, capsuleDef->localPoint2, capsuleDef->radius);
+			m_shape = capsule;
+		}
+		break;
+
+	case b2_gridShape:
+		{
+			void* mem = allocator->Allocate(sizeof(b2GridShape));
+			b2GridShape* grid = new (mem) b2GridShape;
+			b2GridDef* gridDef = (b2GridDef*)def;
+			grid->Set(gridDef->cells, gridDef->columnCount, gridDef->rowCount, gridDef->cellSize);
+			m_shape = grid;
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
 	}
 
+	// Fixtures of a compound body are kept in the body's fixture tree. An
+	// inactive body creates the proxies when it is activated.
+	if (body->IsCompound() || body->IsActive() == false)
+	{
+		m_proxyId = b2_nullProxy;
+		return;
+	}
+
 	// Create proxy in the broad-phase.
 	b2AABB aabb;
 	m_shape->ComputeAABB(&aabb, xf);
@@ -145,11 +230,7 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2BroadPhase* broadPhase, b2
 void b2Fixture::Destroy(b2BlockAllocator* allocator, b2BroadPhase* broadPhase)
 {
 	// Remove proxy from the broad-phase.
-	if (m_proxyId != b2_nullProxy)
-	{
-		broadPhase->DestroyProxy(m_proxyId);
-		m_proxyId = b2_nullProxy;
-	}
+	DestroyProxy(broadPhase);
 
 	// Free the child shape.
 	switch (m_type)
@@ -178,6 +259,46 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator, b2BroadPhase* broadPhase)
 		}
 		break;
 
+	case b2_chainShape:
+		{
+			b2ChainShape* s = (b2ChainShape*)m_shape;
+			s->~b2ChainShape();
+			allocator->Free(s, sizeof(b2ChainShape));
+		}
+		break;
+
+	case b2_heightfieldShape:
+		{
+			b2HeightfieldShape* s = (b2HeightfieldShape*)m_shape;
+			s->~b2HeightfieldShape();
+			allocator->Free(s, sizeof(b2HeightfieldShape));
+		}
+		break;
+
+	case b2_meshShape:
+		{
+			b2MeshShape* s = (b2MeshShape*)m_shape;
+			s->~b2MeshShape();
+			allocator->Free(s, sizeof(b2MeshShape));
+		}
+		break;
+
+	case b2_capsuleShape:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			s->~b2CapsuleShape();
+			allocator->Free(s, sizeof(b2CapsuleShape));
+		}
+		break;
+
+	case b2_gridShape:
+		{
+			b2GridShape* s = (b2GridShape*)m_shape;
+			s->~b2GridShape();
+			allocator->Free(s, sizeof(b2GridShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -186,7 +307,8 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator, b2BroadPhase* broadPhase)
 	m_shape = NULL;
 }
 
-bool b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2XForm& transform1, const b2XForm& transform2)
+bool b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2XForm& transform1, const b2XForm& transform2,
+							const b2Vec2& displacement)
 {
 	if (m_proxyId == b2_nullProxy)
 	{	
@@ -201,6 +323,9 @@ bool b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2XForm& transform1,
 	b2AABB aabb;
 	aabb.Combine(aabb1, aabb2);
 
+	aabb.lowerBound += b2Min(displacement, b2Vec2_zero);
+	aabb.upperBound += b2Max(displacement, b2Vec2_zero);
+
 	if (broadPhase->InRange(aabb))
 	{
 		broadPhase->MoveProxy(m_proxyId, aabb);
@@ -219,19 +344,28 @@ void b2Fixture::RefilterProxy(b2BroadPhase* broadPhase, const b2XForm& transform
 		return;
 	}
 
-	broadPhase->DestroyProxy(m_proxyId);
+	DestroyProxy(broadPhase);
+	CreateProxy(broadPhase, transform);
+}
+
+void b2Fixture::CreateProxy(b2BroadPhase* broadPhase, const b2XForm& transform)
+{
+	b2Assert(m_proxyId == b2_nullProxy);
 
 	b2AABB aabb;
 	m_shape->ComputeAABB(&aabb, transform);
 
-	bool inRange = broadPhase->InRange(aabb);
-
-	if (inRange)
+	if (broadPhase->InRange(aabb))
 	{
 		m_proxyId = broadPhase->CreateProxy(aabb, this);
 	}
-	else
+}
+
+void b2Fixture::DestroyProxy(b2BroadPhase* broadPhase)
+{
+	if (m_proxyId != b2_nullProxy)
 	{
+		broadPhase->DestroyProxy(m_proxyId);
 		m_proxyId = b2_nullProxy;
 	}
 }
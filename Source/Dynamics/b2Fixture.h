@@ -145,6 +145,138 @@ struct b2EdgeDef : public b2FixtureDef
 	b2Vec2 vertex2;
 };
 
+/// This structure is used to build a chain shape. A chain is a single fixture
+/// with one broad-phase proxy, no matter how many segments it has. The vertices
+/// are copied, so the array only needs to live until the fixture is created.
+struct b2ChainDef : public b2FixtureDef
+{
+	b2ChainDef()
+	{
+		type = b2_chainShape;
+		vertices = NULL;
+		vertexCount = 0;
+		isLoop = false;
+		hasPrevVertex = false;
+		hasNextVertex = false;
+	}
+
+	/// The vertices in local coordinates. Adjacent vertices must not be coincident.
+	const b2Vec2* vertices;
+
+	/// The number of vertices.
+	int32 vertexCount;
+
+	/// Whether to create an extra segment between the last and first vertices.
+	bool isLoop;
+
+	/// Optional ghost vertices before the first and after the last vertex. These
+	/// give smooth collision where an open chain connects to other geometry.
+	b2Vec2 prevVertex;
+	b2Vec2 nextVertex;
+	bool hasPrevVertex;
+	bool hasNextVertex;
+};
+
+/// This structure is used to build heightfield shapes. Provide either float
+/// samples or 16 bit samples, the 16 bit samples use half the memory.
+struct b2HeightfieldDef : public b2FixtureDef
+{
+	b2HeightfieldDef()
+	{
+		type = b2_heightfieldShape;
+		heights = NULL;
+		quantizedHeights = NULL;
+		heightScale = 1.0f;
+		sampleCount = 0;
+		spacing = 1.0f;
+	}
+
+	/// The float height samples.
+	const float32* heights;
+
+	/// The 16 bit height samples, each height is heightScale * sample.
+	const uint16* quantizedHeights;
+	float32 heightScale;
+
+	/// The number of samples.
+	int32 sampleCount;
+
+	/// The distance between samples along the local x-axis.
+	float32 spacing;
+};
+
+/// This structure is used to build a static mesh of triangles and segments.
+/// The arrays are copied, so they only need to live until the fixture is created.
+struct b2MeshDef : public b2FixtureDef
+{
+	b2MeshDef()
+	{
+		type = b2_meshShape;
+		vertices = NULL;
+		vertexCount = 0;
+		triangles = NULL;
+		triangleCount = 0;
+		segments = NULL;
+		segmentCount = 0;
+	}
+
+	/// The shared vertices in local coordinates.
+	const b2Vec2* vertices;
+	int32 vertexCount;
+
+	/// Three vertex indices per triangle, in either winding.
+	const int32* triangles;
+	int32 triangleCount;
+
+	/// Two vertex indices per segment.
+	const int32* segments;
+	int32 segmentCount;
+};
+
+/// This structure is used to build a fixture with a capsule shape.
+struct b2CapsuleDef : public b2FixtureDef
+{
+	b2CapsuleDef()
+	{
+		type = b2_capsuleShape;
+		localPoint1.Set(0.0f, -0.5f);
+		localPoint2.Set(0.0f, 0.5f);
+		radius = 0.5f;
+	}
+
+	/// The centers of the end caps in local coordinates. They must not be coincident.
+	b2Vec2 localPoint1;
+	b2Vec2 localPoint2;
+
+	/// The radius of the capsule.
+	float32 radius;
+};
+
+/// This structure is used to build a grid of square cells. The cell types are
+/// copied, so they only need to live until the fixture is created.
+struct b2GridDef : public b2FixtureDef
+{
+	b2GridDef()
+	{
+		type = b2_gridShape;
+		cells = NULL;
+		columnCount = 0;
+		rowCount = 0;
+		cellSize = 1.0f;
+	}
+
+	/// The cell types row by row, starting with the bottom row. Non-zero cells
+	/// are solid. NULL leaves all cells empty.
+	const uint8* cells;
+
+	/// The number of columns and rows.
+	int32 columnCount;
+	int32 rowCount;
+
+	/// The side length of a cell.
+	float32 cellSize;
+};
+
 
 /// A fixture is used to attach a shape to a body for collision detection. A fixture
 /// inherits its transform from its parent. Fixtures hold additional non-geometric data
@@ -255,9 +387,14 @@ protected:
 	void Create(b2BlockAllocator* allocator, b2BroadPhase* broadPhase, b2Body* body, const b2XForm& xf, const b2FixtureDef* def);
 	void Destroy(b2BlockAllocator* allocator, b2BroadPhase* broadPhase);
 
-	bool Synchronize(b2BroadPhase* broadPhase, const b2XForm& xf1, const b2XForm& xf2);
+	// The displacement extends the AABB ahead of the motion for speculative contacts.
+	bool Synchronize(b2BroadPhase* broadPhase, const b2XForm& xf1, const b2XForm& xf2, const b2Vec2& displacement);
 	void RefilterProxy(b2BroadPhase* broadPhase, const b2XForm& xf);
 
+	// Create or destroy the proxy of a fixture that isn't in a compound body.
+	void CreateProxy(b2BroadPhase* broadPhase, const b2XForm& xf);
+	void DestroyProxy(b2BroadPhase* broadPhase);
+
 	b2ShapeType m_type;
 	b2Fixture* m_next;
 	b2Body* m_body;
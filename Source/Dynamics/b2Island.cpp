@@ -23,6 +23,7 @@
 #include "Contacts/b2Contact.h"
 #include "Contacts/b2ContactSolver.h"
 #include "Joints/b2Joint.h"
+#include "Joints/b2JointSolver.h"
 #include "../Common/b2StackAllocator.h"
 
 /*
@@ -143,6 +144,14 @@ This might be faster than computing sin+cos.
 However, we can compute sin+cos of the same angle fast.
 */
 
+// Static and kinematic bodies and the sleeping bodies at the border of an
+// island are not moved by it. These may be shared by islands solved at the
+// same time. Kinematic bodies were already moved by the world.
+static inline bool b2IsFixed(const b2Body* b)
+{
+	return b->IsDynamic() == false || b->IsSleeping();
+}
+
 b2Island::b2Island(
 	int32 bodyCapacity,
 	int32 contactCapacity,
@@ -166,6 +175,43 @@ b2Island::b2Island(
 
 	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
 	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+
+	m_reports = NULL;
+	m_reportCount = 0;
+	m_velocityIterationCount = 0;
+	m_ownsLists = true;
+	m_taskScheduler = NULL;
+}
+
+b2Island::b2Island(
+	b2Body** bodies, int32 bodyCount,
+	b2Contact** contacts, int32 contactCount,
+	b2Joint** joints, int32 jointCount,
+	b2PostSolveReport* reports,
+	b2StackAllocator* allocator)
+{
+	m_bodyCapacity = bodyCount;
+	m_contactCapacity = contactCount;
+	m_jointCapacity = jointCount;
+	m_bodyCount = bodyCount;
+	m_contactCount = contactCount;
+	m_jointCount = jointCount;
+
+	m_allocator = allocator;
+	m_listener = NULL;
+
+	m_bodies = bodies;
+	m_contacts = contacts;
+	m_joints = joints;
+
+	m_velocities = (b2Velocity*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Velocity));
+	m_positions = (b2Position*)m_allocator->Allocate(m_bodyCapacity * sizeof(b2Position));
+
+	m_reports = reports;
+	m_reportCount = 0;
+	m_velocityIterationCount = 0;
+	m_ownsLists = false;
+	m_taskScheduler = NULL;
 }
 
 b2Island::~b2Island()
@@ -173,310 +219,478 @@ b2Island::~b2Island()
 	// Warning: the order should reverse the constructor order.
 	m_allocator->Free(m_positions);
 	m_allocator->Free(m_velocities);
-	m_allocator->Free(m_joints);
-	m_allocator->Free(m_contacts);
-	m_allocator->Free(m_bodies);
+
+	if (m_ownsLists)
+	{
+		m_allocator->Free(m_joints);
+		m_allocator->Free(m_contacts);
+		m_allocator->Free(m_bodies);
+	}
+}
+
+void b2Island::BindIndices(b2Contact** contacts, int32 contactCount, b2Joint** joints, int32 jointCount)
+{
+	for (int32 i = 0; i < contactCount; ++i)
+	{
+		b2Contact* c = contacts[i];
+		c->m_indexA = c->GetFixtureA()->GetBody()->m_islandIndex;
+		c->m_indexB = c->GetFixtureB()->GetBody()->m_islandIndex;
+	}
+
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		b2Joint* j = joints[i];
+		j->m_index1 = j->m_body1->m_islandIndex;
+		j->m_index2 = j->m_body2->m_islandIndex;
+	}
 }
 
 void b2Island::Solve(const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
-	// Integrate velocities and apply damping.
+	if (step.subStepCount > 0)
+	{
+		SolveSoft(step, gravity);
+
+		if (allowSleep)
+		{
+			UpdateSleep(step.dt);
+		}
+		return;
+	}
+
+	// Copy the body state into the solver arrays. Integrate velocities and apply damping.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
 
-		if (b->IsStatic())
-			continue;
-
-		// Integrate velocities.
-		b->m_linearVelocity += step.dt * (gravity + b->m_invMass * b->m_force);
-		b->m_angularVelocity += step.dt * b->m_invI * b->m_torque;
+		b2Vec2 v = b->m_linearVelocity;
+		float32 w = b->m_angularVelocity;
 
-		// Reset forces.
-		b->m_force.Set(0.0f, 0.0f);
-		b->m_torque = 0.0f;
+		if (b2IsFixed(b) == false)
+		{
+			// Store positions for continuous collision.
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+
+			// Integrate velocities.
+			v += step.dt * (gravity + b->m_invMass * b->m_force);
+			w += step.dt * b->m_invI * b->m_torque;
+
+			// Reset forces.
+			b->m_force.Set(0.0f, 0.0f);
+			b->m_torque = 0.0f;
+
+			// Apply damping.
+			// ODE: dv/dt + c * v = 0
+			// Solution: v(t) = v0 * exp(-c * t)
+			// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
+			// v2 = exp(-c * dt) * v1
+			// Taylor expansion:
+			// v2 = (1.0f - c * dt) * v1
+			v *= b2Clamp(1.0f - step.dt * b->m_linearDamping, 0.0f, 1.0f);
+			w *= b2Clamp(1.0f - step.dt * b->m_angularDamping, 0.0f, 1.0f);
+		}
 
-		// Apply damping.
-		// ODE: dv/dt + c * v = 0
-		// Solution: v(t) = v0 * exp(-c * t)
-		// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
-		// v2 = exp(-c * dt) * v1
-		// Taylor expansion:
-		// v2 = (1.0f - c * dt) * v1
-		b->m_linearVelocity *= b2Clamp(1.0f - step.dt * b->m_linearDamping, 0.0f, 1.0f);
-		b->m_angularVelocity *= b2Clamp(1.0f - step.dt * b->m_angularDamping, 0.0f, 1.0f);
+		m_positions[i].x = b->m_sweep.c;
+		m_positions[i].a = b->m_sweep.a;
+		m_velocities[i].v = v;
+		m_velocities[i].w = w;
 	}
 
-	b2ContactSolver contactSolver(step, m_contacts, m_contactCount, m_allocator);
+	b2SolverData solverData;
+	solverData.step = step;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+	solverData.taskScheduler = m_taskScheduler;
+
+	// The contact solver may allocate more while solving, so it is freed first.
+	b2JointSolver jointSolver(m_joints, m_jointCount, m_allocator);
+	b2ContactSolver contactSolver(solverData, m_contacts, m_contactCount, m_allocator);
 
 	// Initialize velocity constraints.
 	contactSolver.InitVelocityConstraints(step);
-
-	for (int32 i = 0; i < m_jointCount; ++i)
-	{
-		m_joints[i]->InitVelocityConstraints(step);
-	}
+	jointSolver.InitVelocityConstraints(solverData);
 
 	// Solve velocity constraints.
+	m_velocityIterationCount = 0;
 	for (int32 i = 0; i < step.velocityIterations; ++i)
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
+		float32 maxChange = jointSolver.SolveVelocityConstraints(solverData);
+
+		float32 change = contactSolver.SolveVelocityConstraints();
+		maxChange = b2Max(maxChange, change);
+
+		++m_velocityIterationCount;
+		if (m_velocityIterationCount >= step.minVelocityIterations && maxChange < step.velocityTolerance)
 		{
-			m_joints[j]->SolveVelocityConstraints(step);
+			// Exit early if the velocities have converged.
+			break;
 		}
-
-		contactSolver.SolveVelocityConstraints();
 	}
 
 	// Post-solve (store impulses for warm starting).
 	contactSolver.FinalizeVelocityConstraints();
+	jointSolver.FinalizeVelocityConstraints();
 
 	// Integrate positions.
+	IntegratePositions(step);
+
+	// Iterate over constraints.
+	for (int32 i = 0; i < step.positionIterations; ++i)
+	{
+		bool contactsOkay = contactSolver.SolvePositionConstraints(b2_contactBaumgarte);
+		bool jointsOkay = jointSolver.SolvePositionConstraints(solverData, b2_contactBaumgarte);
+
+		if (contactsOkay && jointsOkay)
+		{
+			// Exit early if the position errors are small.
+			break;
+		}
+	}
+
+	// Copy the state back to the bodies.
+	WriteBack();
+
+	Report(contactSolver.m_constraints, contactSolver.m_constraintCount);
+
+	if (allowSleep)
+	{
+		UpdateSleep(step.dt);
+	}
+}
+
+void b2Island::SolveSoft(const b2TimeStep& step, const b2Vec2& gravity)
+{
+	int32 subStepCount = step.subStepCount;
+	float32 h = step.dt / float32(subStepCount);
+	float32 inv_h = step.inv_dt * float32(subStepCount);
+
+	// Copy the body state into the solver arrays. Velocities are integrated per sub-step.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Body* b = m_bodies[i];
 
-		if (b->IsStatic())
-			continue;
-
-		// Check for large velocities.
-		b2Vec2 translation = step.dt * b->m_linearVelocity;
-		if (b2Dot(translation, translation) > b2_maxTranslationSquared)
+		if (b2IsFixed(b) == false)
 		{
-			translation.Normalize();
-			b->m_linearVelocity = (b2_maxTranslation * step.inv_dt) * translation;
+			// Store positions for continuous collision.
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
 		}
 
-		float32 rotation = step.dt * b->m_angularVelocity;
-		if (rotation * rotation > b2_maxRotationSquared)
+		m_positions[i].x = b->m_sweep.c;
+		m_positions[i].a = b->m_sweep.a;
+		m_velocities[i].v = b->m_linearVelocity;
+		m_velocities[i].w = b->m_angularVelocity;
+	}
+
+	b2SolverData solverData;
+	solverData.step = step;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+	solverData.taskScheduler = NULL;
+
+	b2JointSolver jointSolver(m_joints, m_jointCount, m_allocator);
+
+	b2ContactSolver contactSolver(solverData, m_contacts, m_contactCount, m_allocator);
+	contactSolver.PrepareSoftConstraints(step, h);
+
+	b2TimeStep subStep = step;
+	subStep.dt = h;
+	subStep.inv_dt = inv_h;
+
+	for (int32 k = 0; k < subStepCount; ++k)
+	{
+		// Integrate velocities and apply damping.
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
-			if (rotation < 0.0)
-			{
-				b->m_angularVelocity = -step.inv_dt * b2_maxRotation;
-			}
-			else
+			b2Body* b = m_bodies[i];
+			if (b2IsFixed(b))
 			{
-				b->m_angularVelocity = step.inv_dt * b2_maxRotation;
+				continue;
 			}
+
+			b2Vec2 v = m_velocities[i].v;
+			float32 w = m_velocities[i].w;
+			v += h * (gravity + b->m_invMass * b->m_force);
+			w += h * b->m_invI * b->m_torque;
+			v *= b2Clamp(1.0f - h * b->m_linearDamping, 0.0f, 1.0f);
+			w *= b2Clamp(1.0f - h * b->m_angularDamping, 0.0f, 1.0f);
+			m_velocities[i].v = v;
+			m_velocities[i].w = w;
 		}
 
-		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
+		// The joints warm start from the previous sub-step.
+		subStep.dtRatio = k == 0 ? step.dtRatio : float32(1.0f);
+		solverData.step = subStep;
 
-		// Integrate
-		b->m_sweep.c += step.dt * b->m_linearVelocity;
-		b->m_sweep.a += step.dt * b->m_angularVelocity;
+		jointSolver.InitVelocityConstraints(solverData);
 
-		// Compute new transform
-		b->SynchronizeTransform();
+		contactSolver.WarmStartSoftConstraints();
 
-		// Note: shapes are synchronized later.
+		// Solve with the soft bias.
+		jointSolver.SolveVelocityConstraints(solverData);
+		jointSolver.FinalizeVelocityConstraints();
+
+		contactSolver.SolveSoftConstraints(inv_h, true);
+
+		IntegratePositions(subStep);
+
+		jointSolver.SolvePositionConstraints(solverData, b2_contactBaumgarte);
+
+		// Relax, this removes the velocity added by the bias.
+		contactSolver.SolveSoftConstraints(inv_h, false);
 	}
 
-	// Iterate over constraints.
-	for (int32 i = 0; i < step.positionIterations; ++i)
-	{
-		bool contactsOkay = contactSolver.SolvePositionConstraints(b2_contactBaumgarte);
+	contactSolver.ApplyRestitution();
 
-		bool jointsOkay = true;
-		for (int32 i = 0; i < m_jointCount; ++i)
-		{
-			bool jointOkay = m_joints[i]->SolvePositionConstraints(b2_contactBaumgarte);
-			jointsOkay = jointsOkay && jointOkay;
-		}
+	// One velocity iteration per sub-step.
+	m_velocityIterationCount = subStepCount;
 
-		if (contactsOkay && jointsOkay)
+	// Store impulses for warm starting.
+	contactSolver.FinalizeVelocityConstraints();
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b2IsFixed(b))
 		{
-			// Exit early if the position errors are small.
-			break;
+			continue;
 		}
+
+		b->m_force.Set(0.0f, 0.0f);
+		b->m_torque = 0.0f;
 	}
 
-	Report(contactSolver.m_constraints);
+	// Copy the state back to the bodies.
+	WriteBack();
 
-	if (allowSleep)
-	{
-		float32 minSleepTime = B2_FLT_MAX;
+	Report(contactSolver.m_constraints, contactSolver.m_constraintCount);
+}
+
+void b2Island::UpdateSleep(float32 dt)
+{
+	float32 minSleepTime = B2_FLT_MAX;
 
 #ifndef TARGET_FLOAT32_IS_FIXED
-		const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+	const float32 linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
+	const float32 angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
 #endif
 
-		for (int32 i = 0; i < m_bodyCount; ++i)
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b->m_invMass == 0.0f || b->IsSleeping())
 		{
-			b2Body* b = m_bodies[i];
-			if (b->m_invMass == 0.0f)
-			{
-				continue;
-			}
+			continue;
+		}
 
-			if ((b->m_flags & b2Body::e_allowSleepFlag) == 0)
-			{
-				b->m_sleepTime = 0.0f;
-				minSleepTime = 0.0f;
-			}
+		if ((b->m_flags & b2Body::e_allowSleepFlag) == 0)
+		{
+			b->m_sleepTime = 0.0f;
+			minSleepTime = 0.0f;
+		}
 
-			if ((b->m_flags & b2Body::e_allowSleepFlag) == 0 ||
+		if ((b->m_flags & b2Body::e_allowSleepFlag) == 0 ||
 #ifdef TARGET_FLOAT32_IS_FIXED
-				b2Abs(b->m_angularVelocity) > b2_angularSleepTolerance ||
-				b2Abs(b->m_linearVelocity.x) > b2_linearSleepTolerance ||
-				b2Abs(b->m_linearVelocity.y) > b2_linearSleepTolerance)
+			b2Abs(b->m_angularVelocity) > b2_angularSleepTolerance ||
+			b2Abs(b->m_linearVelocity.x) > b2_linearSleepTolerance ||
+			b2Abs(b->m_linearVelocity.y) > b2_linearSleepTolerance)
 #else
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
+			b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
+			b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
 #endif
-			{
-				b->m_sleepTime = 0.0f;
-				minSleepTime = 0.0f;
-			}
-			else
-			{
-				b->m_sleepTime += step.dt;
-				minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
-			}
+		{
+			b->m_sleepTime = 0.0f;
+			minSleepTime = 0.0f;
+		}
+		else
+		{
+			b->m_sleepTime += dt;
+			minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
 		}
+	}
 
-		if (minSleepTime >= b2_timeToSleep)
+	if (minSleepTime >= b2_timeToSleep)
+	{
+		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
+			b2Body* b = m_bodies[i];
+			if (b2IsFixed(b))
 			{
-				b2Body* b = m_bodies[i];
-				b->m_flags |= b2Body::e_sleepFlag;
-				b->m_linearVelocity = b2Vec2_zero;
-				b->m_angularVelocity = 0.0f;
+				continue;
 			}
+
+			b->m_flags |= b2Body::e_sleepFlag;
+			b->m_linearVelocity = b2Vec2_zero;
+			b->m_angularVelocity = 0.0f;
 		}
 	}
 }
 
 void b2Island::SolveTOI(b2TimeStep& subStep)
 {
-	b2ContactSolver contactSolver(subStep, m_contacts, m_contactCount, m_allocator);
+	// Copy the body state into the solver arrays.
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+
+		if (b2IsFixed(b) == false)
+		{
+			// Store positions for continuous collision.
+			b->m_sweep.c0 = b->m_sweep.c;
+			b->m_sweep.a0 = b->m_sweep.a;
+		}
+
+		m_positions[i].x = b->m_sweep.c;
+		m_positions[i].a = b->m_sweep.a;
+		m_velocities[i].v = b->m_linearVelocity;
+		m_velocities[i].w = b->m_angularVelocity;
+	}
+
+	b2SolverData solverData;
+	solverData.step = subStep;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+	solverData.taskScheduler = NULL;
+
+	b2ContactSolver contactSolver(solverData, m_contacts, m_contactCount, m_allocator);
 
 	// No warm starting is needed for TOI events because warm
 	// starting impulses were applied in the discrete solver.
 
 	// Warm starting for joints is off for now, but we need to
 	// call this function to compute Jacobians.
-	for (int32 i = 0; i < m_jointCount; ++i)
-	{
-		m_joints[i]->InitVelocityConstraints(subStep);
-	}
+	b2JointSolver jointSolver(m_joints, m_jointCount, m_allocator);
+	jointSolver.InitVelocityConstraints(solverData);
 
 	// Solve velocity constraints.
+	m_velocityIterationCount = 0;
 	for (int32 i = 0; i < subStep.velocityIterations; ++i)
 	{
-		contactSolver.SolveVelocityConstraints();
-		for (int32 j = 0; j < m_jointCount; ++j)
+		float32 maxChange = contactSolver.SolveVelocityConstraints();
+		float32 change = jointSolver.SolveVelocityConstraints(solverData);
+		maxChange = b2Max(maxChange, change);
+
+		++m_velocityIterationCount;
+		if (m_velocityIterationCount >= subStep.minVelocityIterations && maxChange < subStep.velocityTolerance)
 		{
-			m_joints[j]->SolveVelocityConstraints(subStep);
+			break;
 		}
 	}
 
 	// Don't store the TOI contact forces for warm starting
-	// because they can be quite large.
+	// because they can be quite large. The joints do keep theirs.
+	jointSolver.FinalizeVelocityConstraints();
 
 	// Integrate positions.
-	for (int32 i = 0; i < m_bodyCount; ++i)
+	IntegratePositions(subStep);
+
+	// Solve position constraints.
+	const float32 k_toiBaumgarte = 0.75f;
+	for (int32 i = 0; i < subStep.positionIterations; ++i)
 	{
-		b2Body* b = m_bodies[i];
+		bool contactsOkay = contactSolver.SolvePositionConstraints(k_toiBaumgarte);
+		bool jointsOkay = jointSolver.SolvePositionConstraints(solverData, k_toiBaumgarte);
+		
+		if (contactsOkay && jointsOkay)
+		{
+			break;
+		}
+	}
 
-		if (b->IsStatic())
+	// Copy the state back to the bodies.
+	WriteBack();
+
+	Report(contactSolver.m_constraints, contactSolver.m_constraintCount);
+}
+
+void b2Island::IntegratePositions(const b2TimeStep& step)
+{
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		if (b2IsFixed(m_bodies[i]))
 			continue;
 
+		b2Vec2 v = m_velocities[i].v;
+		float32 w = m_velocities[i].w;
+
 		// Check for large velocities.
-		b2Vec2 translation = subStep.dt * b->m_linearVelocity;
+		b2Vec2 translation = step.dt * v;
 		if (b2Dot(translation, translation) > b2_maxTranslationSquared)
 		{
 			translation.Normalize();
-			b->m_linearVelocity = (b2_maxTranslation * subStep.inv_dt) * translation;
+			v = (b2_maxTranslation * step.inv_dt) * translation;
 		}
 
-		float32 rotation = subStep.dt * b->m_angularVelocity;
+		float32 rotation = step.dt * w;
 		if (rotation * rotation > b2_maxRotationSquared)
 		{
 			if (rotation < 0.0)
 			{
-				b->m_angularVelocity = -subStep.inv_dt * b2_maxRotation;
+				w = -step.inv_dt * b2_maxRotation;
 			}
 			else
 			{
-				b->m_angularVelocity = subStep.inv_dt * b2_maxRotation;
+				w = step.inv_dt * b2_maxRotation;
 			}
 		}
 
-		// Store positions for continuous collision.
-		b->m_sweep.c0 = b->m_sweep.c;
-		b->m_sweep.a0 = b->m_sweep.a;
-
 		// Integrate
-		b->m_sweep.c += subStep.dt * b->m_linearVelocity;
-		b->m_sweep.a += subStep.dt * b->m_angularVelocity;
-
-		// Compute new transform
-		b->SynchronizeTransform();
-
-		// Note: shapes are synchronized later.
+		m_positions[i].x += step.dt * v;
+		m_positions[i].a += step.dt * w;
+		m_velocities[i].v = v;
+		m_velocities[i].w = w;
 	}
+}
 
-#if 0
+void b2Island::WriteBack()
+{
+	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		for (int32 i = 0; i < m_contactCount; ++i)
-		{
-			m_contacts[i]->Update(NULL);
-		}
-		b2ContactSolver contactSolver2(subStep, m_contacts, m_contactCount, m_allocator);
+		b2Body* b = m_bodies[i];
 
-		// Solve position constraints.
-		const float32 k_toiBaumgarte = 0.75f;
-		for (int32 i = 0; i < subStep.positionIterations; ++i)
-		{
-			bool contactsOkay = contactSolver2.SolvePositionConstraints(k_toiBaumgarte);
+		if (b2IsFixed(b))
+			continue;
 
-			if (contactsOkay)
-			{
-				break;
-			}
-		}
+		b->m_sweep.c = m_positions[i].x;
+		b->m_sweep.a = m_positions[i].a;
+		b->m_linearVelocity = m_velocities[i].v;
+		b->m_angularVelocity = m_velocities[i].w;
+
+		// Note: shapes are synchronized later.
+		b->SynchronizeTransform();
 	}
-#else
+}
 
-	// Solve position constraints.
-	const float32 k_toiBaumgarte = 0.75f;
-	for (int32 i = 0; i < subStep.positionIterations; ++i)
+// Contacts with a chain are reported once per touching segment.
+void b2Island::Report(const b2ContactConstraint* constraints, int32 constraintCount)
+{
+	if (m_reports)
 	{
-		bool contactsOkay = contactSolver.SolvePositionConstraints(k_toiBaumgarte);
-		bool jointsOkay = true;
-		for (int32 j = 0; j < m_jointCount; ++j)
+		// The world delivers these later, in a deterministic order.
+		for (int32 i = 0; i < constraintCount; ++i)
 		{
-			bool jointOkay = m_joints[j]->SolvePositionConstraints(k_toiBaumgarte);
-			jointsOkay = jointsOkay && jointOkay;
-		}
-		
-		if (contactsOkay && jointsOkay)
-		{
-			break;
+			const b2ContactConstraint* cc = constraints + i;
+			b2PostSolveReport* report = m_reports + m_reportCount++;
+			report->contact = cc->contact;
+			for (int32 j = 0; j < cc->pointCount; ++j)
+			{
+				report->impulse.normalImpulses[j] = cc->points[j].normalImpulse;
+				report->impulse.tangentImpulses[j] = cc->points[j].tangentImpulse;
+			}
 		}
+		return;
 	}
-#endif
-
-	Report(contactSolver.m_constraints);
-}
 
-void b2Island::Report(const b2ContactConstraint* constraints)
-{
 	if (m_listener == NULL)
 	{
 		return;
 	}
 
-	for (int32 i = 0; i < m_contactCount; ++i)
+	for (int32 i = 0; i < constraintCount; ++i)
 	{
-		b2Contact* c = m_contacts[i];
-
 		const b2ContactConstraint* cc = constraints + i;
+		b2Contact* c = cc->contact;
 		
 		b2ContactImpulse impulse;
 		for (int32 j = 0; j < cc->pointCount; ++j)
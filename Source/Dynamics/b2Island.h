@@ -21,24 +21,31 @@
 
 #include "../Common/b2Math.h"
 #include "b2Body.h"
+#include "b2World.h"
 
 class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactConstraint;
-struct b2TimeStep;
 
-struct b2Position
+/// A post-solve report that is delivered after all islands are solved.
+struct b2PostSolveReport
 {
-	b2Vec2 x;
-	float32 a;
+	b2Contact* contact;
+	b2ContactImpulse impulse;
 };
 
-struct b2Velocity
+/// The lists of an awake island that were gathered by b2World::Solve. The
+/// islands of a time step are stored back to back in shared lists.
+struct b2IslandRange
 {
-	b2Vec2 v;
-	float32 w;
+	b2PersistentIsland* island;
+	int32 bodyStart, bodyCount;
+	int32 contactStart, contactCount;
+	int32 jointStart, jointCount;
+	int32 reportStart, reportCount;
+	int32 velocityIterationCount;
 };
 
 class b2Island
@@ -46,8 +53,20 @@ class b2Island
 public:
 	b2Island(int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity,
 			b2StackAllocator* allocator, b2ContactListener* listener);
+
+	// Solve lists that were built elsewhere. The constraint indices must be
+	// bound and the post-solve reports are stored in the given buffer.
+	b2Island(b2Body** bodies, int32 bodyCount, b2Contact** contacts, int32 contactCount,
+			b2Joint** joints, int32 jointCount, b2PostSolveReport* reports,
+			b2StackAllocator* allocator);
+
 	~b2Island();
 
+	// Store the island indices of the bodies in the contacts and joints. A static
+	// body can be part of several islands, so this is done as soon as an island
+	// is complete.
+	static void BindIndices(b2Contact** contacts, int32 contactCount, b2Joint** joints, int32 jointCount);
+
 	void Clear()
 	{
 		m_bodyCount = 0;
@@ -57,8 +76,20 @@ public:
 
 	void Solve(const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
+	// Solve with soft contacts and several sub-steps, see b2World::SetSubStepCount.
+	void SolveSoft(const b2TimeStep& step, const b2Vec2& gravity);
+
+	// Put the island to sleep once all bodies have rested long enough.
+	void UpdateSleep(float32 dt);
+
 	void SolveTOI(b2TimeStep& subStep);
 
+	// Integrate the positions in the solver arrays.
+	void IntegratePositions(const b2TimeStep& step);
+
+	// Copy the solver arrays to the bodies.
+	void WriteBack();
+
 	void Add(b2Body* body)
 	{
 		b2Assert(m_bodyCount < m_bodyCapacity);
@@ -78,7 +109,7 @@ public:
 		m_joints[m_jointCount++] = joint;
 	}
 
-	void Report(const b2ContactConstraint* constraints);
+	void Report(const b2ContactConstraint* constraints, int32 constraintCount);
 
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
@@ -90,6 +121,16 @@ public:
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
 
+	// Buffered post-solve reports, or NULL to call the listener directly.
+	b2PostSolveReport* m_reports;
+	int32 m_reportCount;
+
+	// The lists are owned unless they were built elsewhere.
+	bool m_ownsLists;
+
+	// Spreads the contacts of a large island over threads, or NULL.
+	b2TaskScheduler* m_taskScheduler;
+
 	int32 m_bodyCount;
 	int32 m_jointCount;
 	int32 m_contactCount;
@@ -99,6 +140,9 @@ public:
 	int32 m_jointCapacity;
 
 	int32 m_positionIterationCount;
+
+	// The velocity iterations used by the last solve.
+	int32 m_velocityIterationCount;
 };
 
 #endif
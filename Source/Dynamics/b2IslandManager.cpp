@@ -0,0 +1,653 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "b2IslandManager.h"
+#include "b2World.h"
+#include "b2Body.h"
+#include "Contacts/b2Contact.h"
+#include "Joints/b2Joint.h"
+#include "../Common/b2StackAllocator.h"
+
+#include <string.h>
+
+b2IslandManager::b2IslandManager()
+{
+	m_world = NULL;
+	m_awakeList = NULL;
+	m_sleepingList = NULL;
+	m_islandCount = 0;
+	m_awakeCount = 0;
+	m_awakeBodies = NULL;
+	m_awakeBodyCount = 0;
+	m_awakeBodyCapacity = 0;
+}
+
+b2IslandManager::~b2IslandManager()
+{
+	if (m_awakeBodies)
+	{
+		b2Free(m_awakeBodies);
+	}
+}
+
+b2PersistentIsland* b2IslandManager::CreateIsland(bool awake)
+{
+	void* mem = m_world->m_blockAllocator.Allocate(sizeof(b2PersistentIsland));
+	b2PersistentIsland* island = (b2PersistentIsland*)mem;
+	island->bodyList = NULL;
+	island->bodyCount = 0;
+	island->constraintRemoveCount = 0;
+	island->awake = awake;
+	island->prev = NULL;
+	island->next = NULL;
+	++m_islandCount;
+	return island;
+}
+
+void b2IslandManager::DestroyIsland(b2PersistentIsland* island)
+{
+	RemoveIsland(island);
+	m_world->m_blockAllocator.Free(island, sizeof(b2PersistentIsland));
+	--m_islandCount;
+}
+
+void b2IslandManager::InsertIsland(b2PersistentIsland* island, b2PersistentIsland* after)
+{
+	if (after)
+	{
+		b2Assert(after->awake == island->awake);
+		island->prev = after;
+		island->next = after->next;
+		if (after->next)
+		{
+			after->next->prev = island;
+		}
+		after->next = island;
+	}
+	else
+	{
+		b2PersistentIsland** list = island->awake ? &m_awakeList : &m_sleepingList;
+		island->prev = NULL;
+		island->next = *list;
+		if (*list)
+		{
+			(*list)->prev = island;
+		}
+		*list = island;
+	}
+
+	if (island->awake)
+	{
+		++m_awakeCount;
+	}
+}
+
+void b2IslandManager::RemoveIsland(b2PersistentIsland* island)
+{
+	if (island->prev)
+	{
+		island->prev->next = island->next;
+	}
+
+	if (island->next)
+	{
+		island->next->prev = island->prev;
+	}
+
+	if (island == m_awakeList)
+	{
+		m_awakeList = island->next;
+	}
+	else if (island == m_sleepingList)
+	{
+		m_sleepingList = island->next;
+	}
+
+	if (island->awake)
+	{
+		--m_awakeCount;
+	}
+
+	island->prev = NULL;
+	island->next = NULL;
+}
+
+void b2IslandManager::AddAwakeBody(b2Body* body)
+{
+	b2Assert(body->m_awakeIndex == -1);
+
+	if (m_awakeBodyCount == m_awakeBodyCapacity)
+	{
+		// Grow the array.
+		int32 capacity = b2Max(64, 2 * m_awakeBodyCapacity);
+		b2Body** bodies = (b2Body**)b2Alloc(capacity * sizeof(b2Body*));
+		if (m_awakeBodies)
+		{
+			memcpy(bodies, m_awakeBodies, m_awakeBodyCount * sizeof(b2Body*));
+			b2Free(m_awakeBodies);
+		}
+		m_awakeBodies = bodies;
+		m_awakeBodyCapacity = capacity;
+	}
+
+	body->m_awakeIndex = m_awakeBodyCount;
+	m_awakeBodies[m_awakeBodyCount++] = body;
+
+	for (b2ContactEdge* cn = body->m_contactList; cn; cn = cn->next)
+	{
+		if (cn->contact->m_activeIndex == -1)
+		{
+			m_world->m_contactManager.AddActiveContact(cn->contact);
+		}
+	}
+}
+
+void b2IslandManager::RemoveAwakeBody(b2Body* body)
+{
+	int32 index = body->m_awakeIndex;
+	b2Assert(0 <= index && index < m_awakeBodyCount && m_awakeBodies[index] == body);
+
+	// Move the last body into the hole.
+	b2Body* last = m_awakeBodies[--m_awakeBodyCount];
+	m_awakeBodies[index] = last;
+	last->m_awakeIndex = index;
+	body->m_awakeIndex = -1;
+
+	for (b2ContactEdge* cn = body->m_contactList; cn; cn = cn->next)
+	{
+		if (cn->contact->m_activeIndex != -1 && cn->other->m_awakeIndex == -1)
+		{
+			m_world->m_contactManager.RemoveActiveContact(cn->contact);
+		}
+	}
+}
+
+void b2IslandManager::AddToIsland(b2PersistentIsland* island, b2Body* body)
+{
+	body->m_island = island;
+	body->m_islandPrev = NULL;
+	body->m_islandNext = island->bodyList;
+	if (island->bodyList)
+	{
+		island->bodyList->m_islandPrev = body;
+	}
+	island->bodyList = body;
+	++island->bodyCount;
+}
+
+void b2IslandManager::RemoveFromIsland(b2Body* body)
+{
+	b2PersistentIsland* island = body->m_island;
+
+	if (body->m_islandPrev)
+	{
+		body->m_islandPrev->m_islandNext = body->m_islandNext;
+	}
+
+	if (body->m_islandNext)
+	{
+		body->m_islandNext->m_islandPrev = body->m_islandPrev;
+	}
+
+	if (body == island->bodyList)
+	{
+		island->bodyList = body->m_islandNext;
+	}
+
+	body->m_island = NULL;
+	body->m_islandPrev = NULL;
+	body->m_islandNext = NULL;
+	--island->bodyCount;
+}
+
+void b2IslandManager::AddBody(b2Body* body)
+{
+	b2Assert(body->m_island == NULL);
+	b2Assert(body->IsDynamic());
+
+	b2PersistentIsland* island = CreateIsland(body->IsSleeping() == false);
+	InsertIsland(island, NULL);
+	AddToIsland(island, body);
+
+	if (island->awake)
+	{
+		AddAwakeBody(body);
+	}
+
+	// A body that was static may already be constrained.
+	for (b2JointEdge* jn = body->m_jointList; jn; jn = jn->next)
+	{
+		Link(body, jn->other);
+	}
+
+	for (b2ContactEdge* cn = body->m_contactList; cn; cn = cn->next)
+	{
+		if (IsConstraint(cn->contact))
+		{
+			Link(body, cn->other);
+		}
+	}
+}
+
+void b2IslandManager::RemoveBody(b2Body* body)
+{
+	b2PersistentIsland* island = body->m_island;
+	b2Assert(island != NULL);
+
+	RemoveFromIsland(body);
+
+	if (island->awake)
+	{
+		RemoveAwakeBody(body);
+	}
+
+	if (island->bodyCount == 0)
+	{
+		DestroyIsland(island);
+		return;
+	}
+
+	// The body may have connected the others.
+	++island->constraintRemoveCount;
+}
+
+void b2IslandManager::AddKinematicBody(b2Body* body)
+{
+	b2Assert(body->IsKinematic() && body->IsSleeping() == false);
+	AddAwakeBody(body);
+}
+
+void b2IslandManager::RemoveKinematicBody(b2Body* body)
+{
+	b2Assert(body->m_island == NULL);
+	RemoveAwakeBody(body);
+}
+
+void b2IslandManager::Link(b2Body* bodyA, b2Body* bodyB)
+{
+	b2PersistentIsland* islandA = bodyA->m_island;
+	b2PersistentIsland* islandB = bodyB->m_island;
+
+	if (islandA == NULL || islandB == NULL || islandA == islandB)
+	{
+		return;
+	}
+
+	// An awake body wakes the sleeping body it connects to and the bodies
+	// this one touches, so that a hit isn't stopped by the sleeping border.
+	// This links the woken bodies with the awake islands they touch.
+	if (islandA->awake != islandB->awake)
+	{
+		b2Body* body = islandA->awake ? bodyB : bodyA;
+		WakeBody(body);
+		WakeTouching(body);
+		return;
+	}
+
+	// Move the bodies of the smaller island.
+	b2PersistentIsland* big = islandA;
+	b2PersistentIsland* small = islandB;
+	if (islandA->bodyCount < islandB->bodyCount)
+	{
+		big = islandB;
+		small = islandA;
+	}
+
+	b2Body* tail = NULL;
+	for (b2Body* b = small->bodyList; b; b = b->m_islandNext)
+	{
+		b->m_island = big;
+		tail = b;
+	}
+
+	tail->m_islandNext = big->bodyList;
+	if (big->bodyList)
+	{
+		big->bodyList->m_islandPrev = tail;
+	}
+	big->bodyList = small->bodyList;
+	big->bodyCount += small->bodyCount;
+	big->constraintRemoveCount += small->constraintRemoveCount;
+
+	small->bodyList = NULL;
+	small->bodyCount = 0;
+	DestroyIsland(small);
+}
+
+void b2IslandManager::Unlink(b2Body* bodyA, b2Body* bodyB)
+{
+	b2PersistentIsland* island = bodyA->m_island;
+	if (island == NULL || bodyB->m_island == NULL)
+	{
+		return;
+	}
+
+	// A sleeping body at the border of an awake island isn't part of it.
+	if (island != bodyB->m_island)
+	{
+		b2Assert(island->awake != bodyB->m_island->awake || island->awake == false);
+		return;
+	}
+
+	++island->constraintRemoveCount;
+}
+
+void b2IslandManager::WakeBody(b2Body* body)
+{
+	b2PersistentIsland* island = body->m_island;
+	if (island == NULL || island->awake)
+	{
+		return;
+	}
+
+	b2PersistentIsland* awakeIsland = CreateIsland(true);
+	InsertIsland(awakeIsland, NULL);
+
+	// Joined bodies share an island, so the joints are followed through the
+	// sleeping island. The array doubles as the search queue.
+	b2StackAllocator* allocator = &m_world->m_stackAllocator;
+	b2Body** bodies = (b2Body**)allocator->Allocate(island->bodyCount * sizeof(b2Body*));
+	int32 bodyCount = 0;
+
+	uint32 epoch = ++m_world->m_islandEpoch;
+	bodies[bodyCount++] = body;
+	body->m_islandEpoch = epoch;
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+
+		RemoveFromIsland(b);
+		AddToIsland(awakeIsland, b);
+		b->m_flags &= ~b2Body::e_sleepFlag;
+		b->m_sleepTime = 0.0f;
+		AddAwakeBody(b);
+
+		for (b2JointEdge* jn = b->m_jointList; jn; jn = jn->next)
+		{
+			b2Body* other = jn->other;
+			if (other->m_island != island || other->m_islandEpoch == epoch)
+			{
+				continue;
+			}
+
+			other->m_islandEpoch = epoch;
+			bodies[bodyCount++] = other;
+		}
+	}
+
+	if (island->bodyCount == 0)
+	{
+		DestroyIsland(island);
+	}
+
+	// Join the awake islands that the woken bodies are connected to. This may
+	// merge the new island into a larger one.
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = bodies[i];
+
+		for (b2JointEdge* jn = b->m_jointList; jn; jn = jn->next)
+		{
+			b2Body* other = jn->other;
+			if (other->m_island && other->m_island->awake)
+			{
+				Link(b, other);
+			}
+		}
+
+		for (b2ContactEdge* cn = b->m_contactList; cn; cn = cn->next)
+		{
+			b2Body* other = cn->other;
+			if (other->m_island && other->m_island->awake && IsConstraint(cn->contact))
+			{
+				Link(b, other);
+			}
+		}
+	}
+
+	allocator->Free(bodies);
+}
+
+void b2IslandManager::WakeTouching(b2Body* body)
+{
+	for (b2ContactEdge* cn = body->m_contactList; cn; cn = cn->next)
+	{
+		b2Body* other = cn->other;
+		if (other->m_island && other->m_island->awake == false && IsConstraint(cn->contact))
+		{
+			other->WakeUp();
+		}
+	}
+
+	// Joined bodies share an island, unless this one is kinematic.
+	for (b2JointEdge* jn = body->m_jointList; jn; jn = jn->next)
+	{
+		b2Body* other = jn->other;
+		if (other->m_island && other->m_island->awake == false)
+		{
+			other->WakeUp();
+		}
+	}
+}
+
+void b2IslandManager::PutIslandToSleep(b2PersistentIsland* island)
+{
+	if (island->awake == false)
+	{
+		return;
+	}
+
+	for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+	{
+		b2Assert(b->IsSleeping());
+		RemoveAwakeBody(b);
+	}
+
+	RemoveIsland(island);
+	island->awake = false;
+	InsertIsland(island, NULL);
+}
+
+void b2IslandManager::Split(b2PersistentIsland* island, b2StackAllocator* allocator)
+{
+	int32 bodyCount = island->bodyCount;
+	b2Body** bodies = (b2Body**)allocator->Allocate(bodyCount * sizeof(b2Body*));
+	b2Body** stack = (b2Body**)allocator->Allocate(bodyCount * sizeof(b2Body*));
+
+	int32 count = 0;
+	for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+	{
+		bodies[count++] = b;
+	}
+	b2Assert(count == bodyCount);
+
+	island->bodyList = NULL;
+	island->bodyCount = 0;
+	island->constraintRemoveCount = 0;
+
+	// Bodies reached by this split carry its epoch.
+	uint32 epoch = ++m_world->m_islandEpoch;
+
+	// The first part keeps the island.
+	b2PersistentIsland* current = island;
+	b2PersistentIsland* last = island;
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* seed = bodies[i];
+		if (seed->m_islandEpoch == epoch)
+		{
+			continue;
+		}
+
+		if (current == NULL)
+		{
+			current = CreateIsland(island->awake);
+			InsertIsland(current, last);
+			last = current;
+		}
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_islandEpoch = epoch;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			b2Body* b = stack[--stackCount];
+
+			b->m_island = current;
+			b->m_islandPrev = NULL;
+			b->m_islandNext = current->bodyList;
+			if (current->bodyList)
+			{
+				current->bodyList->m_islandPrev = b;
+			}
+			current->bodyList = b;
+			++current->bodyCount;
+
+			for (b2ContactEdge* cn = b->m_contactList; cn; cn = cn->next)
+			{
+				// Sleeping bodies at the border belong to other islands.
+				b2Body* other = cn->other;
+				if (other->IsDynamic() == false || other->m_island->awake != island->awake || other->m_islandEpoch == epoch)
+				{
+					continue;
+				}
+
+				if (IsConstraint(cn->contact) == false)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < bodyCount);
+				stack[stackCount++] = other;
+				other->m_islandEpoch = epoch;
+			}
+
+			// Static, kinematic and inactive bodies have no island.
+			for (b2JointEdge* jn = b->m_jointList; jn; jn = jn->next)
+			{
+				b2Body* other = jn->other;
+				if (other->m_island == NULL || other->m_islandEpoch == epoch)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < bodyCount);
+				stack[stackCount++] = other;
+				other->m_islandEpoch = epoch;
+			}
+		}
+
+		current = NULL;
+	}
+
+	allocator->Free(stack);
+	allocator->Free(bodies);
+}
+
+bool b2IslandManager::IsConstraint(const b2Contact* contact)
+{
+	uint32 flags = contact->m_flags;
+	if (flags & (b2Contact::e_nonSolidFlag | b2Contact::e_invalidFlag | b2Contact::e_destroyFlag))
+	{
+		return false;
+	}
+
+	return (flags & b2Contact::e_touchFlag) != 0;
+}
+
+void b2IslandManager::Validate() const
+{
+	int32 islandCount = 0;
+	int32 awakeCount = 0;
+	int32 awakeBodyCount = 0;
+	for (int32 k = 0; k < 2; ++k)
+	{
+		const b2PersistentIsland* list = k == 0 ? m_awakeList : m_sleepingList;
+		for (const b2PersistentIsland* island = list; island; island = island->next)
+		{
+			b2Assert(island->awake == (k == 0));
+			b2Assert(island->bodyCount > 0);
+
+			int32 bodyCount = 0;
+			for (b2Body* b = island->bodyList; b; b = b->m_islandNext)
+			{
+				b2Assert(b->m_island == island);
+				b2Assert(b->IsDynamic());
+				b2Assert(island->awake || b->IsSleeping());
+				b2Assert((b->m_awakeIndex != -1) == island->awake);
+				++bodyCount;
+			}
+			b2Assert(bodyCount == island->bodyCount);
+
+			++islandCount;
+			if (island->awake)
+			{
+				++awakeCount;
+				awakeBodyCount += bodyCount;
+			}
+		}
+	}
+
+	b2Assert(islandCount == m_islandCount);
+	b2Assert(awakeCount == m_awakeCount);
+
+	for (b2Body* b = m_world->m_bodyList; b; b = b->m_next)
+	{
+		b2Assert((b->m_island == NULL) == (b->IsDynamic() == false || b->IsActive() == false));
+
+		if (b->IsActive() == false)
+		{
+			b2Assert(b->m_awakeIndex == -1 && b->m_contactList == NULL);
+		}
+
+		if (b->IsKinematic() && b->m_awakeIndex != -1)
+		{
+			++awakeBodyCount;
+		}
+
+		for (b2JointEdge* jn = b->m_jointList; jn; jn = jn->next)
+		{
+			b2Assert(jn->other->m_island == NULL || b->m_island == NULL || jn->other->m_island == b->m_island);
+		}
+
+		// Touching sleeping bodies may be in other islands.
+
+		for (b2ContactEdge* cn = b->m_contactList; cn; cn = cn->next)
+		{
+			bool active = b->m_awakeIndex != -1 || cn->other->m_awakeIndex != -1;
+			b2Assert((cn->contact->m_activeIndex != -1) == active);
+
+			if (b->IsDynamic() == false || cn->other->IsDynamic() == false || IsConstraint(cn->contact) == false)
+			{
+				continue;
+			}
+
+			if (b->m_island->awake && cn->other->m_island->awake)
+			{
+				b2Assert(cn->other->m_island == b->m_island);
+			}
+		}
+	}
+
+	b2Assert(awakeBodyCount == m_awakeBodyCount);
+}
@@ -0,0 +1,128 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef B2_ISLAND_MANAGER_H
+#define B2_ISLAND_MANAGER_H
+
+#include "../Common/b2Settings.h"
+
+class b2World;
+class b2Body;
+class b2Contact;
+class b2StackAllocator;
+
+/// A set of bodies that is kept from step to step. Islands are merged when a
+/// constraint connects two of them and split lazily after constraints were
+/// removed, so an island may hold several parts of the constraint graph until
+/// it is split. Static and inactive bodies don't belong to an island. The bodies of an
+/// island fall asleep together. A woken body only takes the bodies joined to
+/// it out of its sleeping island, the sleeping bodies it touches are held in
+/// place by the solver until a moving body wakes them. Kinematic bodies don't
+/// belong to an island either, they are held in place like static bodies.
+struct b2PersistentIsland
+{
+	b2Body* bodyList;
+	int32 bodyCount;
+
+	// The number of constraints that were removed since the last split.
+	int32 constraintRemoveCount;
+
+	bool awake;
+
+	b2PersistentIsland* prev;
+	b2PersistentIsland* next;
+};
+
+// Delegate of b2World.
+class b2IslandManager
+{
+public:
+	b2IslandManager();
+	~b2IslandManager();
+
+	// Give a body that became dynamic its own island and link its constraints.
+	void AddBody(b2Body* body);
+
+	// Remove a body that is destroyed, deactivated or is no longer dynamic.
+	void RemoveBody(b2Body* body);
+
+	// A kinematic body that doesn't sleep is kept with the awake bodies, so
+	// that its contacts are updated. Remove it when it falls asleep, is
+	// destroyed, deactivated or is no longer kinematic.
+	void AddKinematicBody(b2Body* body);
+	void RemoveKinematicBody(b2Body* body);
+
+	// A constraint connects two bodies, this merges their islands. A sleeping
+	// body connected to an awake body is woken.
+	void Link(b2Body* bodyA, b2Body* bodyB);
+
+	// A constraint between two bodies was removed. The island is split
+	// before it is solved again.
+	void Unlink(b2Body* bodyA, b2Body* bodyB);
+
+	// Wake a sleeping body and the bodies joined to it. These form a new awake
+	// island, the rest of the sleeping island keeps sleeping.
+	void WakeBody(b2Body* body);
+
+	// Wake the sleeping bodies that a moving body touches or is joined to.
+	void WakeTouching(b2Body* body);
+
+	// Move an island whose bodies all sleep to the sleeping list.
+	void PutIslandToSleep(b2PersistentIsland* island);
+
+	// Split an island into the connected parts of the constraint graph. The
+	// new islands are inserted after the island in its list.
+	void Split(b2PersistentIsland* island, b2StackAllocator* allocator);
+
+	// Does this contact connect the bodies of an island?
+	static bool IsConstraint(const b2Contact* contact);
+
+	// Check that joined bodies and touching awake bodies share an island.
+	void Validate() const;
+
+	b2World* m_world;
+
+	b2PersistentIsland* m_awakeList;
+	b2PersistentIsland* m_sleepingList;
+	int32 m_islandCount;
+	int32 m_awakeCount;
+
+	// The bodies of the awake islands and the awake kinematic bodies.
+	b2Body** m_awakeBodies;
+	int32 m_awakeBodyCount;
+	int32 m_awakeBodyCapacity;
+
+private:
+	// Add a body to the awake bodies and activate its contacts.
+	void AddAwakeBody(b2Body* body);
+
+	// Remove a body from the awake bodies and deactivate the contacts
+	// that have no other awake body.
+	void RemoveAwakeBody(b2Body* body);
+
+	void AddToIsland(b2PersistentIsland* island, b2Body* body);
+	void RemoveFromIsland(b2Body* body);
+
+	b2PersistentIsland* CreateIsland(bool awake);
+	void DestroyIsland(b2PersistentIsland* island);
+	void InsertIsland(b2PersistentIsland* island, b2PersistentIsland* after);
+	void RemoveIsland(b2PersistentIsland* island);
+};
+
+#endif
@@ -0,0 +1,163 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "b2TOIQueue.h"
+#include "Contacts/b2Contact.h"
+
+#include <string.h>
+
+b2TOIQueue::b2TOIQueue()
+{
+	m_contacts = NULL;
+	m_count = 0;
+	m_capacity = 0;
+}
+
+b2TOIQueue::~b2TOIQueue()
+{
+	if (m_contacts)
+	{
+		b2Free(m_contacts);
+	}
+}
+
+void b2TOIQueue::Push(b2Contact* contact)
+{
+	b2Assert((contact->m_flags & b2Contact::e_toiFlag) == 0);
+
+	if (m_count == m_capacity)
+	{
+		// Grow the heap.
+		int32 capacity = b2Max(16, 2 * m_capacity);
+		b2Contact** contacts = (b2Contact**)b2Alloc(capacity * sizeof(b2Contact*));
+		if (m_contacts)
+		{
+			memcpy(contacts, m_contacts, m_count * sizeof(b2Contact*));
+			b2Free(m_contacts);
+		}
+
+		m_contacts = contacts;
+		m_capacity = capacity;
+	}
+
+	contact->m_flags |= b2Contact::e_toiFlag;
+	Place(contact, m_count);
+	++m_count;
+	MoveUp(m_count - 1);
+}
+
+b2Contact* b2TOIQueue::Pop()
+{
+	b2Assert(m_count > 0);
+
+	b2Contact* contact = m_contacts[0];
+	Remove(contact);
+	return contact;
+}
+
+void b2TOIQueue::Remove(b2Contact* contact)
+{
+	b2Assert(contact->m_flags & b2Contact::e_toiFlag);
+
+	int32 index = contact->m_toiIndex;
+	b2Assert(0 <= index && index < m_count && m_contacts[index] == contact);
+
+	contact->m_flags &= ~b2Contact::e_toiFlag;
+	contact->m_toiIndex = -1;
+
+	--m_count;
+	if (index == m_count)
+	{
+		return;
+	}
+
+	// Fill the hole with the last contact and restore the heap order.
+	b2Contact* last = m_contacts[m_count];
+	Place(last, index);
+	if (index > 0 && last->m_toi < m_contacts[(index - 1) >> 1]->m_toi)
+	{
+		MoveUp(index);
+	}
+	else
+	{
+		MoveDown(index);
+	}
+}
+
+void b2TOIQueue::Clear()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_contacts[i]->m_flags &= ~b2Contact::e_toiFlag;
+		m_contacts[i]->m_toiIndex = -1;
+	}
+
+	m_count = 0;
+}
+
+void b2TOIQueue::Place(b2Contact* contact, int32 index)
+{
+	m_contacts[index] = contact;
+	contact->m_toiIndex = index;
+}
+
+void b2TOIQueue::MoveUp(int32 index)
+{
+	b2Contact* contact = m_contacts[index];
+	while (index > 0)
+	{
+		int32 parent = (index - 1) >> 1;
+		if (m_contacts[parent]->m_toi <= contact->m_toi)
+		{
+			break;
+		}
+
+		Place(m_contacts[parent], index);
+		index = parent;
+	}
+
+	Place(contact, index);
+}
+
+void b2TOIQueue::MoveDown(int32 index)
+{
+	b2Contact* contact = m_contacts[index];
+	for (;;)
+	{
+		int32 child = 2 * index + 1;
+		if (child >= m_count)
+		{
+			break;
+		}
+
+		if (child + 1 < m_count && m_contacts[child + 1]->m_toi < m_contacts[child]->m_toi)
+		{
+			++child;
+		}
+
+		if (contact->m_toi <= m_contacts[child]->m_toi)
+		{
+			break;
+		}
+
+		Place(m_contacts[child], index);
+		index = child;
+	}
+
+	Place(contact, index);
+}
@@ -0,0 +1,66 @@
+/*
+* Copyright (c) 2006-2009 Erin Catto http://www.gphysics.com
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_TOI_QUEUE_H
+#define B2_TOI_QUEUE_H
+
+#include "../Common/b2Settings.h"
+
+class b2Contact;
+
+/// A binary min-heap of contacts keyed by their cached time of impact. SolveTOI
+/// uses this to find the next TOI event without scanning all contacts. Queued
+/// contacts carry the e_toiFlag and their heap index, so a contact can be
+/// removed when its TOI is invalidated or when it is destroyed.
+class b2TOIQueue
+{
+public:
+	b2TOIQueue();
+	~b2TOIQueue();
+
+	/// Add a contact with a valid m_toi.
+	void Push(b2Contact* contact);
+
+	/// Remove and return the contact with the smallest TOI.
+	b2Contact* Pop();
+
+	/// Remove a queued contact.
+	void Remove(b2Contact* contact);
+
+	/// Remove all contacts, keeping the storage.
+	void Clear();
+
+	/// Get the number of queued contacts.
+	int32 GetCount() const;
+
+private:
+	void Place(b2Contact* contact, int32 index);
+	void MoveUp(int32 index);
+	void MoveDown(int32 index);
+
+	b2Contact** m_contacts;
+	int32 m_count;
+	int32 m_capacity;
+};
+
+inline int32 b2TOIQueue::GetCount() const
+{
+	return m_count;
+}
+
+#endif
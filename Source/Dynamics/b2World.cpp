@@ -25,10 +25,18 @@
 #include "Contacts/b2ContactSolver.h"
 #include "Controllers/b2Controller.h"
 #include "../Collision/b2Collision.h"
+#include "../Common/b2Timer.h"
 #include "../Collision/Shapes/b2CircleShape.h"
 #include "../Collision/Shapes/b2PolygonShape.h"
 #include "../Collision/Shapes/b2EdgeShape.h"
+#include "../Collision/Shapes/b2ChainShape.h"
+#include "../Collision/Shapes/b2HeightfieldShape.h"
+#include "../Collision/Shapes/b2MeshShape.h"
+#include "../Collision/Shapes/b2CapsuleShape.h"
+#include "../Collision/Shapes/b2GridShape.h"
 #include <new>
+#include <algorithm>
+#include <cstring>
 
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
@@ -39,6 +47,9 @@ b2World::b2World(const b2AABB& worldAABB, const b2Vec2& gravity, bool doSleep)
 	m_boundaryListener = NULL;
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
+	m_taskScheduler = NULL;
+	m_threadAllocators = NULL;
+	m_threadAllocatorCount = 0;
 	m_debugDraw = NULL;
 
 	m_bodyList = NULL;
@@ -52,7 +63,22 @@ b2World::b2World(const b2AABB& worldAABB, const b2Vec2& gravity, bool doSleep)
 	m_controllerCount = 0;
 
 	m_warmStarting = true;
+	m_wideContactSolver = false;
+	m_subStepCount = 0;
 	m_continuousPhysics = true;
+	m_speculativeContacts = false;
+
+	m_maxTOIEvents = 0;
+	m_maxTOITime = 0.0f;
+	m_speculativeTime = 0.0f;
+
+	m_velocityTolerance = b2_velocityTolerance;
+	m_minVelocityIterations = b2_minVelocityIterations;
+
+	m_toiStats.SetZero();
+	m_solverStats.SetZero();
+	m_islandIterations = NULL;
+	m_islandIterationCapacity = 0;
 
 	m_allowSleep = doSleep;
 	m_gravity = gravity;
@@ -61,7 +87,11 @@ b2World::b2World(const b2AABB& worldAABB, const b2Vec2& gravity, bool doSleep)
 
 	m_inv_dt0 = 0.0f;
 
+	m_islandEpoch = 0;
+	m_topologyStamp = 0;
+
 	m_contactManager.m_world = this;
+	m_islandManager.m_world = this;
 	void* mem = b2Alloc(sizeof(b2BroadPhase));
 	m_broadPhase = new (mem) b2BroadPhase(worldAABB, &m_contactManager);
 
@@ -74,6 +104,13 @@ b2World::~b2World()
 	DestroyBody(m_groundBody);
 	m_broadPhase->~b2BroadPhase();
 	b2Free(m_broadPhase);
+
+	SetTaskScheduler(NULL);
+
+	if (m_islandIterations)
+	{
+		b2Free(m_islandIterations);
+	}
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -96,6 +133,37 @@ void b2World::SetContactListener(b2ContactListener* listener)
 	m_contactListener = listener;
 }
 
+void b2World::SetTaskScheduler(b2TaskScheduler* scheduler)
+{
+	b2Assert(m_lock == false);
+
+	for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+	{
+		m_threadAllocators[i].~b2StackAllocator();
+	}
+
+	if (m_threadAllocators)
+	{
+		b2Free(m_threadAllocators);
+		m_threadAllocators = NULL;
+		m_threadAllocatorCount = 0;
+	}
+
+	m_taskScheduler = scheduler;
+
+	// Thread 0 uses the stack allocator of the world. Every other thread
+	// gets its own for solving islands.
+	if (scheduler && scheduler->GetThreadCount() > 1)
+	{
+		m_threadAllocatorCount = scheduler->GetThreadCount() - 1;
+		m_threadAllocators = (b2StackAllocator*)b2Alloc(m_threadAllocatorCount * sizeof(b2StackAllocator));
+		for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+		{
+			new (m_threadAllocators + i) b2StackAllocator();
+		}
+	}
+}
+
 void b2World::SetDebugDraw(b2DebugDraw* debugDraw)
 {
 	m_debugDraw = debugDraw;
@@ -115,10 +183,144 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	}
 	m_bodyList = b;
 	++m_bodyCount;
+	++m_topologyStamp;
+
+	// An inactive body joins the islands when it is activated.
+	if (b->IsActive() == false)
+	{
+		return b;
+	}
+
+	if (b->IsDynamic())
+	{
+		m_islandManager.AddBody(b);
+	}
+	else if (b->IsKinematic() && b->IsSleeping() == false)
+	{
+		m_islandManager.AddKinematicBody(b);
+	}
 
 	return b;
 }
 
+void b2World::CreateBodies(const b2BodyDef* bodyDefs, int32 bodyCount,
+						   const b2FixtureDef* const* fixtureDefs, const int32* fixtureCounts, b2Body** bodies)
+{
+	b2Assert(m_lock == false);
+
+	b2Body** created = (b2Body**)m_stackAllocator.Allocate(bodyCount * sizeof(b2Body*));
+
+	int32 fixtureIndex = 0;
+	int32 proxyCount = 0;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		// The body stays inactive until the proxies are inserted, so the fixtures
+		// and the mass are set up without touching the broad-phase or the islands.
+		b2BodyDef def = bodyDefs[i];
+		def.isActive = false;
+		b2Body* b = CreateBody(&def);
+		created[i] = b;
+
+		for (int32 j = 0; j < fixtureCounts[i]; ++j)
+		{
+			b->AddFixture(fixtureDefs[fixtureIndex++]);
+		}
+
+		if (b->IsCompound())
+		{
+			b->BuildFixtureTree();
+		}
+
+		const b2MassData& massData = bodyDefs[i].massData;
+		if (massData.mass == 0.0f && massData.I == 0.0f && b->IsKinematic() == false)
+		{
+			b->SetMassFromShapes();
+		}
+
+		if (bodyDefs[i].isActive)
+		{
+			b->m_flags &= ~b2Body::e_inactiveFlag;
+			b->UpdateIsland();
+			proxyCount += b->IsCompound() ? b2Min(b->m_fixtureCount, 1) : b->m_fixtureCount;
+		}
+	}
+
+	b2AABB* aabbs = (b2AABB*)m_stackAllocator.Allocate(proxyCount * sizeof(b2AABB));
+	void** userData = (void**)m_stackAllocator.Allocate(proxyCount * sizeof(void*));
+	uint16* proxyIds = (uint16*)m_stackAllocator.Allocate(proxyCount * sizeof(uint16));
+
+	// A compound body has a single proxy that refers to any of its fixtures.
+	// Like CreateFixture, a shape outside the world box gets no proxy and
+	// its body is frozen on the next step.
+	int32 proxyIndex = 0;
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Body* b = created[i];
+		if (bodies)
+		{
+			bodies[i] = b;
+		}
+
+		if (b->IsActive() == false || b->m_fixtureCount == 0)
+		{
+			continue;
+		}
+
+		if (b->IsCompound())
+		{
+			b2TransformAABB(aabbs + proxyIndex, b->m_fixtureTree.GetAABB(), b->m_xf);
+			bool inRange = m_broadPhase->InRange(aabbs[proxyIndex]);
+
+			// You are creating a shape outside the world box.
+			b2Assert(inRange);
+
+			if (inRange)
+			{
+				userData[proxyIndex++] = b->m_fixtureList;
+			}
+			continue;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->m_shape->ComputeAABB(aabbs + proxyIndex, b->m_xf);
+			bool inRange = m_broadPhase->InRange(aabbs[proxyIndex]);
+
+			// You are creating a shape outside the world box.
+			b2Assert(inRange);
+
+			if (inRange)
+			{
+				userData[proxyIndex++] = f;
+			}
+		}
+	}
+
+	b2Assert(proxyIndex <= proxyCount);
+	proxyCount = proxyIndex;
+
+	// This finds the pairs of the new proxies and creates their contacts.
+	m_broadPhase->CreateProxies(aabbs, userData, proxyCount, proxyIds);
+
+	for (int32 i = 0; i < proxyCount; ++i)
+	{
+		b2Fixture* f = (b2Fixture*)userData[i];
+		if (f->m_body->IsCompound())
+		{
+			f->m_body->m_proxyId = proxyIds[i];
+		}
+		else
+		{
+			f->m_proxyId = proxyIds[i];
+		}
+	}
+
+	m_stackAllocator.Free(proxyIds);
+	m_stackAllocator.Free(userData);
+	m_stackAllocator.Free(aabbs);
+	m_stackAllocator.Free(created);
+}
+
 void b2World::DestroyBody(b2Body* b)
 {
 	b2Assert(m_bodyCount > 0);
@@ -148,6 +350,13 @@ void b2World::DestroyBody(b2Body* b)
 		ce0->controller->RemoveBody(b);
 	}
 
+	// A compound body has a single proxy that refers to its fixtures.
+	if (b->m_proxyId != b2_nullProxy)
+	{
+		m_broadPhase->DestroyProxy(b->m_proxyId);
+		b->m_proxyId = b2_nullProxy;
+	}
+
 	// Delete the attached fixtures. This destroys broad-phase
 	// proxies and pairs, leading to the destruction of contacts.
 	b2Fixture* f = b->m_fixtureList;
@@ -166,6 +375,15 @@ void b2World::DestroyBody(b2Body* b)
 		m_blockAllocator.Free(f0, sizeof(b2Fixture));
 	}
 
+	if (b->m_island)
+	{
+		m_islandManager.RemoveBody(b);
+	}
+	else if (b->m_awakeIndex != -1)
+	{
+		m_islandManager.RemoveKinematicBody(b);
+	}
+
 	// Remove world body list.
 	if (b->m_prev)
 	{
@@ -183,6 +401,7 @@ void b2World::DestroyBody(b2Body* b)
 	}
 
 	--m_bodyCount;
+	++m_topologyStamp;
 	b->~b2Body();
 	m_blockAllocator.Free(b, sizeof(b2Body));
 }
@@ -200,6 +419,7 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 	}
 	m_jointList = j;
 	++m_jointCount;
+	++m_topologyStamp;
 
 	// Connect to the bodies' doubly linked lists.
 	j->m_node1.joint = j;
@@ -216,15 +436,14 @@ b2Joint* b2World::CreateJoint(const b2JointDef* def)
 	if (j->m_body2->m_jointList) j->m_body2->m_jointList->prev = &j->m_node2;
 	j->m_body2->m_jointList = &j->m_node2;
 
+	m_islandManager.Link(j->m_body1, j->m_body2);
+
 	// If the joint prevents collisions, then reset collision filtering.
 	if (def->collideConnected == false)
 	{
 		// Reset the proxies on the body with the minimum number of fixtures.
 		b2Body* b = def->body1->m_fixtureCount < def->body2->m_fixtureCount ? def->body1 : def->body2;
-		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
-		{
-			f->RefilterProxy(m_broadPhase, b->GetXForm());
-		}
+		b->RefilterProxies();
 	}
 
 	return j;
@@ -258,6 +477,8 @@ void b2World::DestroyJoint(b2Joint* j)
 	body1->WakeUp();
 	body2->WakeUp();
 
+	m_islandManager.Unlink(body1, body2);
+
 	// Remove from body 1.
 	if (j->m_node1.prev)
 	{
@@ -300,16 +521,14 @@ void b2World::DestroyJoint(b2Joint* j)
 
 	b2Assert(m_jointCount > 0);
 	--m_jointCount;
+	++m_topologyStamp;
 
 	// If the joint prevents collisions, then reset collision filtering.
 	if (collideConnected == false)
 	{
 		// Reset the proxies on the body with the minimum number of fixtures.
 		b2Body* b = body1->m_fixtureCount < body2->m_fixtureCount ? body1 : body2;
-		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
-		{
-			f->RefilterProxy(m_broadPhase, b->GetXForm());
-		}
+		b->RefilterProxies();
 	}
 }
 
@@ -327,6 +546,7 @@ b2Controller* b2World::CreateController( const b2ControllerDef* def)
 	
 	m_controllerList = controller;
 	++m_controllerCount;
+	++m_topologyStamp;
 
 	controller->m_world = this;
 
@@ -353,159 +573,766 @@ void b2World::DestroyController(b2Controller* controller)
 	}
 
 	--m_controllerCount;
+	++m_topologyStamp;
 
 	b2Controller::Destroy(controller, &m_blockAllocator);
 }
 
-void b2World::Refilter(b2Fixture* fixture)
+void b2World::Clear()
 {
-	fixture->RefilterProxy(m_broadPhase, fixture->GetBody()->GetXForm());
+	b2Assert(m_lock == false);
+
+	m_toiQueue.Clear();
+
+	// The objects live in the block allocator, which is reset below. Only
+	// the heap memory that they own is freed.
+	for (b2Contact* c = m_contactList; c; )
+	{
+		b2Contact* c0 = c;
+		c = c->m_next;
+		c0->~b2Contact();
+	}
+
+	for (b2Joint* j = m_jointList; j; )
+	{
+		b2Joint* j0 = j;
+		j = j->m_next;
+		j0->~b2Joint();
+	}
+
+	for (b2Controller* c = m_controllerList; c; )
+	{
+		b2Controller* c0 = c;
+		c = c->m_next;
+		c0->m_bodyList = NULL;
+		c0->~b2Controller();
+	}
+
+	for (b2Body* b = m_bodyList; b; )
+	{
+		b2Body* b0 = b;
+		b = b->m_next;
+
+		for (b2Fixture* f = b0->m_fixtureList; f; )
+		{
+			b2Fixture* f0 = f;
+			f = f->m_next;
+			f0->m_shape->~b2Shape();
+			f0->m_shape = NULL;
+			f0->m_proxyId = b2_nullProxy;
+			f0->~b2Fixture();
+		}
+
+		b0->m_proxyId = b2_nullProxy;
+		b0->~b2Body();
+	}
+
+	m_contactManager.m_compoundPairList = NULL;
+	m_contactManager.m_activeContactCount = 0;
+
+	m_islandManager.m_awakeList = NULL;
+	m_islandManager.m_sleepingList = NULL;
+	m_islandManager.m_islandCount = 0;
+	m_islandManager.m_awakeCount = 0;
+	m_islandManager.m_awakeBodyCount = 0;
+
+	b2AABB worldAABB = m_broadPhase->m_worldAABB;
+	m_broadPhase->~b2BroadPhase();
+	new (m_broadPhase) b2BroadPhase(worldAABB, &m_contactManager);
+
+	m_blockAllocator.Reset();
+
+	m_bodyList = NULL;
+	m_contactList = NULL;
+	m_jointList = NULL;
+	m_controllerList = NULL;
+
+	m_bodyCount = 0;
+	m_contactCount = 0;
+	m_jointCount = 0;
+	m_controllerCount = 0;
+
+	m_inv_dt0 = 0.0f;
+	m_toiStats.SetZero();
+	m_solverStats.SetZero();
+
+	b2BodyDef bd;
+	m_groundBody = CreateBody(&bd);
 }
 
-// Find islands, integrate and solve constraints, solve position constraints
-void b2World::Solve(const b2TimeStep& step)
+// The fields of a saved world state. They are followed by the blocks of the
+// block allocator, the broad-phase, the active contacts, the awake bodies and
+// the heap state of the contacts.
+struct b2WorldStateHeader
 {
-	// Step all controllers
-	for(b2Controller* controller = m_controllerList; controller; controller = controller->m_next)
+	int32 allocatorSize;
+	int32 broadPhaseSize;
+
+	b2Body* bodyList;
+	b2Joint* jointList;
+	b2Controller* controllerList;
+	b2Contact* contactList;
+
+	int32 bodyCount;
+	int32 contactCount;
+	int32 jointCount;
+	int32 controllerCount;
+
+	uint32 topologyStamp;
+	uint32 islandEpoch;
+	float32 inv_dt0;
+
+	b2CompoundPair* compoundPairList;
+	int32 activeContactCount;
+
+	b2PersistentIsland* awakeList;
+	b2PersistentIsland* sleepingList;
+	int32 islandCount;
+	int32 awakeIslandCount;
+	int32 awakeBodyCount;
+};
+
+int32 b2World::GetStateSize() const
+{
+	int32 size = sizeof(b2WorldStateHeader);
+	size += m_blockAllocator.GetStateSize();
+	size += m_broadPhase->GetStateSize();
+	size += m_contactManager.m_activeContactCount * sizeof(b2Contact*);
+	size += m_islandManager.m_awakeBodyCount * sizeof(b2Body*);
+
+	for (b2Contact* c = m_contactList; c; c = c->m_next)
 	{
-		controller->Step(step);
+		size += c->GetStateSize();
 	}
 
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount, m_contactCount, m_jointCount, &m_stackAllocator, m_contactListener);
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			size += f->m_shape->GetStateSize();
+		}
+	}
+
+	return size;
+}
 
-	// Clear all the island flags.
+void b2World::SaveState(void* buffer) const
+{
+	b2Assert(m_lock == false);
+	b2Assert(m_toiQueue.GetCount() == 0);
+
+	b2WorldStateHeader header;
+	header.allocatorSize = m_blockAllocator.GetStateSize();
+	header.broadPhaseSize = m_broadPhase->GetStateSize();
+	header.bodyList = m_bodyList;
+	header.jointList = m_jointList;
+	header.controllerList = m_controllerList;
+	header.contactList = m_contactList;
+	header.bodyCount = m_bodyCount;
+	header.contactCount = m_contactCount;
+	header.jointCount = m_jointCount;
+	header.controllerCount = m_controllerCount;
+	header.topologyStamp = m_topologyStamp;
+	header.islandEpoch = m_islandEpoch;
+	header.inv_dt0 = m_inv_dt0;
+	header.compoundPairList = m_contactManager.m_compoundPairList;
+	header.activeContactCount = m_contactManager.m_activeContactCount;
+	header.awakeList = m_islandManager.m_awakeList;
+	header.sleepingList = m_islandManager.m_sleepingList;
+	header.islandCount = m_islandManager.m_islandCount;
+	header.awakeIslandCount = m_islandManager.m_awakeCount;
+	header.awakeBodyCount = m_islandManager.m_awakeBodyCount;
+
+	int8* p = (int8*)buffer;
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+
+	// All bodies, fixtures, joints, controllers, contacts and islands live in
+	// the block allocator, so saving its blocks saves them with their links.
+	m_blockAllocator.SaveState(p);
+	p += header.allocatorSize;
+
+	m_broadPhase->SaveState(p);
+	p += header.broadPhaseSize;
+
+	int32 activeSize = header.activeContactCount * sizeof(b2Contact*);
+	if (activeSize > 0)
+	{
+		memcpy(p, m_contactManager.m_activeContacts, activeSize);
+	}
+	p += activeSize;
+
+	int32 awakeSize = header.awakeBodyCount * sizeof(b2Body*);
+	if (awakeSize > 0)
+	{
+		memcpy(p, m_islandManager.m_awakeBodies, awakeSize);
+	}
+	p += awakeSize;
+
+	for (b2Contact* c = m_contactList; c; c = c->m_next)
+	{
+		c->SaveState(p);
+		p += c->GetStateSize();
+	}
+
+	// Shapes may keep data on the heap that changes, like the cells of a grid.
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->m_shape->SaveState(p);
+			p += f->m_shape->GetStateSize();
+		}
+	}
+}
+
+void b2World::RestoreState(const void* buffer)
+{
+	b2Assert(m_lock == false);
+
+	b2WorldStateHeader header;
+	const int8* p = (const int8*)buffer;
+	memcpy(&header, p, sizeof(header));
+	p += sizeof(header);
+
+	b2Assert(header.bodyList == m_bodyList && header.bodyCount == m_bodyCount);
+	b2Assert(header.jointList == m_jointList && header.jointCount == m_jointCount);
+	b2Assert(header.controllerList == m_controllerList && header.controllerCount == m_controllerCount);
+	b2Assert(header.topologyStamp == m_topologyStamp);
+
+	m_toiQueue.Clear();
+
+	// The restored contacts allocate their heap memory again.
+	for (b2Contact* c = m_contactList; c; )
+	{
+		b2Contact* c0 = c;
+		c = c->m_next;
+		c0->~b2Contact();
 	}
+
+	m_blockAllocator.RestoreState(p);
+	p += header.allocatorSize;
+
+	m_broadPhase->RestoreState(p);
+	p += header.broadPhaseSize;
+
+	m_contactList = header.contactList;
+	m_contactCount = header.contactCount;
+	m_islandEpoch = header.islandEpoch;
+	m_inv_dt0 = header.inv_dt0;
+
+	b2ContactManager& cm = m_contactManager;
+	cm.m_compoundPairList = header.compoundPairList;
+	if (cm.m_activeContactCapacity < header.activeContactCount)
+	{
+		if (cm.m_activeContacts)
+		{
+			b2Free(cm.m_activeContacts);
+		}
+		cm.m_activeContactCapacity = header.activeContactCount;
+		cm.m_activeContacts = (b2Contact**)b2Alloc(cm.m_activeContactCapacity * sizeof(b2Contact*));
+	}
+	cm.m_activeContactCount = header.activeContactCount;
+	int32 activeSize = header.activeContactCount * sizeof(b2Contact*);
+	if (activeSize > 0)
+	{
+		memcpy(cm.m_activeContacts, p, activeSize);
+	}
+	p += activeSize;
+
+	b2IslandManager& im = m_islandManager;
+	im.m_awakeList = header.awakeList;
+	im.m_sleepingList = header.sleepingList;
+	im.m_islandCount = header.islandCount;
+	im.m_awakeCount = header.awakeIslandCount;
+	if (im.m_awakeBodyCapacity < header.awakeBodyCount)
+	{
+		if (im.m_awakeBodies)
+		{
+			b2Free(im.m_awakeBodies);
+		}
+		im.m_awakeBodyCapacity = header.awakeBodyCount;
+		im.m_awakeBodies = (b2Body**)b2Alloc(im.m_awakeBodyCapacity * sizeof(b2Body*));
+	}
+	im.m_awakeBodyCount = header.awakeBodyCount;
+	int32 awakeSize = header.awakeBodyCount * sizeof(b2Body*);
+	if (awakeSize > 0)
+	{
+		memcpy(im.m_awakeBodies, p, awakeSize);
+	}
+	p += awakeSize;
+
 	for (b2Contact* c = m_contactList; c; c = c->m_next)
 	{
-		c->m_flags &= ~b2Contact::e_islandFlag;
+		c->RestoreState(p);
+		p += c->GetStateSize();
 	}
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
-		j->m_islandFlag = false;
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			f->m_shape->RestoreState(p);
+			p += f->m_shape->GetStateSize();
+		}
 	}
+}
 
-	// Build and simulate all awake islands.
-	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
-	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+void b2World::Refilter(b2Fixture* fixture)
+{
+	if (fixture->GetBody()->IsCompound())
+	{
+		// The contacts are created again with the new filter.
+		m_contactManager.DestroyCompoundContacts(fixture);
+		m_contactManager.UpdateCompoundPairs(fixture->GetBody());
+		return;
+	}
+
+	fixture->RefilterProxy(m_broadPhase, fixture->GetBody()->GetXForm());
+}
+
+// Solves the islands found by b2World::Solve on the threads of the task scheduler.
+class b2IslandTask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		// The islands of a thread are solved one after the other, so each thread
+		// needs only one stack allocator.
+		b2Assert(threadIndex <= world->m_threadAllocatorCount);
+		b2StackAllocator* allocator = &world->m_stackAllocator;
+		if (threadIndex > 0)
+		{
+			allocator = world->m_threadAllocators + threadIndex - 1;
+		}
+
+		for (int32 i = begin; i < end; ++i)
+		{
+			SolveIsland(islands + order[i], allocator, NULL);
+		}
+	}
+
+	// The task scheduler spreads the contacts of the island over the threads. It
+	// must not be used inside a task.
+	void SolveIsland(b2IslandRange* range, b2StackAllocator* allocator, b2TaskScheduler* scheduler)
 	{
-		if (seed->m_flags & (b2Body::e_islandFlag | b2Body::e_sleepFlag | b2Body::e_frozenFlag))
+		b2PostSolveReport* islandReports = reports ? reports + range->reportStart : NULL;
+
+		b2Island island(bodies + range->bodyStart, range->bodyCount,
+						contacts + range->contactStart, range->contactCount,
+						joints + range->jointStart, range->jointCount,
+						islandReports, allocator);
+		island.m_taskScheduler = scheduler;
+
+		island.Solve(*step, world->m_gravity, world->m_allowSleep);
+
+		range->reportCount = island.m_reportCount;
+		range->velocityIterationCount = island.m_velocityIterationCount;
+	}
+
+	b2World* world;
+	const b2TimeStep* step;
+	b2IslandRange* islands;
+	const int32* order;
+	b2Body** bodies;
+	b2Contact** contacts;
+	b2Joint** joints;
+	b2PostSolveReport* reports;
+};
+
+// Sorts islands by size, largest first.
+struct b2IslandSizeOrder
+{
+	bool operator()(int32 a, int32 b) const
+	{
+		const b2IslandRange* islandA = islands + a;
+		const b2IslandRange* islandB = islands + b;
+		int32 sizeA = islandA->bodyCount + islandA->contactCount + islandA->jointCount;
+		int32 sizeB = islandB->bodyCount + islandB->contactCount + islandB->jointCount;
+		if (sizeA != sizeB)
+		{
+			return sizeA > sizeB;
+		}
+
+		return a < b;
+	}
+
+	const b2IslandRange* islands;
+};
+
+// Kinematic bodies are moved before the islands are solved. The islands hold
+// them in place at the end of the step, so they push the dynamic bodies there.
+void b2World::MoveKinematicBodies(const b2TimeStep& step)
+{
+	// Walk backwards, so that a body that falls asleep is replaced by one that
+	// was already moved.
+	b2Body** awakeBodies = m_islandManager.m_awakeBodies;
+	for (int32 i = m_islandManager.m_awakeBodyCount - 1; i >= 0; --i)
+	{
+		b2Body* b = awakeBodies[i];
+		if (b->IsKinematic() == false || b->IsFrozen())
 		{
 			continue;
 		}
 
-		if (seed->IsStatic())
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = b->m_sweep.a;
+
+		if (b->m_linearVelocity.x == 0.0f && b->m_linearVelocity.y == 0.0f && b->m_angularVelocity == 0.0f)
 		{
+			// A kinematic body never sleeps while it moves.
+			if (b->m_flags & b2Body::e_allowSleepFlag)
+			{
+				b->m_sleepTime += step.dt;
+			}
+
+			if (b->m_sleepTime >= b2_timeToSleep || b->IsSleeping())
+			{
+				b->m_flags |= b2Body::e_sleepFlag;
+				m_islandManager.RemoveKinematicBody(b);
+			}
+
 			continue;
 		}
 
-		// Reset island and stack.
-		island.Clear();
-		int32 stackCount = 0;
-		stack[stackCount++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+		b->m_sleepTime = 0.0f;
+
+		b->m_sweep.c += step.dt * b->m_linearVelocity;
+		b->m_sweep.a += step.dt * b->m_angularVelocity;
+		b->SynchronizeTransform();
 
-		// Perform a depth first search (DFS) on the constraint graph.
-		while (stackCount > 0)
+		bool inRange = b->SynchronizeFixtures();
+		if (inRange == false && m_boundaryListener != NULL)
 		{
-			// Grab the next body off the stack and add it to the island.
-			b2Body* b = stack[--stackCount];
-			island.Add(b);
+			m_boundaryListener->Violation(b);
+		}
 
-			// Make sure the body is awake.
-			b->m_flags &= ~b2Body::e_sleepFlag;
+		// The bodies that it pushes or drags wake up.
+		m_islandManager.WakeTouching(b);
+	}
+}
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
-			if (b->IsStatic())
+// Find islands, integrate and solve constraints, solve position constraints
+void b2World::Solve(const b2TimeStep& step)
+{
+	// Step all controllers
+	for(b2Controller* controller = m_controllerList; controller; controller = controller->m_next)
+	{
+		controller->Step(step);
+	}
+
+	MoveKinematicBodies(step);
+
+	// Split the awake islands that lost constraints since they were solved.
+	// The new islands follow the split island in the awake list.
+	for (b2PersistentIsland* p = m_islandManager.m_awakeList; p; p = p->next)
+	{
+		if (p->constraintRemoveCount > 0)
+		{
+			m_islandManager.Split(p, &m_stackAllocator);
+		}
+	}
+
+	// Gather the awake islands before solving any of them. The lists of the
+	// islands are stored back to back. A static or kinematic body or a sleeping
+	// body at the border of an island may be in several islands.
+	int32 bodyCapacity = m_bodyCount + m_contactCount + m_jointCount;
+	b2Body** bodies = (b2Body**)m_stackAllocator.Allocate(bodyCapacity * sizeof(b2Body*));
+	b2Contact** contacts = (b2Contact**)m_stackAllocator.Allocate(m_contactCount * sizeof(b2Contact*));
+	b2Joint** joints = (b2Joint**)m_stackAllocator.Allocate(m_jointCount * sizeof(b2Joint*));
+	b2IslandRange* islands = (b2IslandRange*)m_stackAllocator.Allocate(m_islandManager.m_awakeCount * sizeof(b2IslandRange));
+	int32 bodyCount = 0;
+	int32 contactCount = 0;
+	int32 jointCount = 0;
+	int32 islandCount = 0;
+	int32 reportCount = 0;
+
+	b2PersistentIsland* next = NULL;
+	for (b2PersistentIsland* p = m_islandManager.m_awakeList; p; p = next)
+	{
+		next = p->next;
+
+		// An island needs a body that is neither sleeping nor frozen.
+		bool seeded = false;
+		bool sleeping = true;
+		for (b2Body* b = p->bodyList; b; b = b->m_islandNext)
+		{
+			if ((b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag)) == 0)
 			{
-				continue;
+				seeded = true;
+				break;
 			}
 
-			// Search all contacts connected to this body.
+			if ((b->m_flags & b2Body::e_sleepFlag) == 0)
+			{
+				sleeping = false;
+			}
+		}
+
+		if (seeded == false)
+		{
+			// The user put every body of the island to sleep. Take the island
+			// off the awake list, so its bodies and contacts cost nothing.
+			if (sleeping)
+			{
+				m_islandManager.PutIslandToSleep(p);
+			}
+
+			continue;
+		}
+
+		// Start a new island. Border bodies reached by it carry its epoch.
+		uint32 epoch = ++m_islandEpoch;
+		b2IslandRange* island = islands + islandCount++;
+		island->island = p;
+		island->bodyStart = bodyCount;
+		island->contactStart = contactCount;
+		island->jointStart = jointCount;
+		island->reportStart = reportCount;
+		island->reportCount = 0;
+
+		for (b2Body* b = p->bodyList; b; b = b->m_islandNext)
+		{
+			b2Assert(bodyCount < bodyCapacity);
+			b->m_islandIndex = bodyCount - island->bodyStart;
+			bodies[bodyCount++] = b;
+
+			// Make sure the body is awake.
+			b->m_flags &= ~b2Body::e_sleepFlag;
+
+			// A constraint between two bodies of the island is added by one
+			// of them. Static, kinematic and sleeping bodies are at the border
+			// of the island, these are added once per island and held in place.
 			for (b2ContactEdge* cn = b->m_contactList; cn; cn = cn->next)
 			{
-				// Has this contact already been added to an island?
-				// Is this contact non-solid (involves a sensor).
-				if (cn->contact->m_flags & (b2Contact::e_islandFlag | b2Contact::e_nonSolidFlag | b2Contact::e_invalidFlag | b2Contact::e_destroyFlag))
+				b2Contact* c = cn->contact;
+				if (b2IslandManager::IsConstraint(c) == false)
 				{
 					continue;
 				}
 
-				// Is this contact touching?
-				if ((cn->contact->m_flags & b2Contact::e_touchFlag) == 0)
+				b2Body* other = cn->other;
+				bool border = other->m_island != p;
+				if (border == false && c->GetFixtureA()->GetBody() != b)
 				{
 					continue;
 				}
 
-				island.Add(cn->contact);
-				cn->contact->m_flags |= b2Contact::e_islandFlag;
+				b2Assert(contactCount < m_contactCount);
+				contacts[contactCount++] = c;
 
-				b2Body* other = cn->other;
+				// Contacts with a chain are reported once per manifold.
+				reportCount += c->m_manifoldCount;
 
-				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (border && other->m_islandEpoch != epoch)
 				{
-					continue;
+					b2Assert(bodyCount < bodyCapacity);
+					other->m_islandIndex = bodyCount - island->bodyStart;
+					bodies[bodyCount++] = other;
+					other->m_islandEpoch = epoch;
 				}
-
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
 			}
 
-			// Search all joints connect to this body.
+			// Joints to inactive bodies are not simulated.
 			for (b2JointEdge* jn = b->m_jointList; jn; jn = jn->next)
 			{
-				if (jn->joint->m_islandFlag == true)
+				b2Joint* j = jn->joint;
+				b2Body* other = jn->other;
+				if (other->IsActive() == false || (other->IsDynamic() && j->m_body1 != b))
 				{
 					continue;
 				}
 
-				island.Add(jn->joint);
-				jn->joint->m_islandFlag = true;
+				b2Assert(jointCount < m_jointCount);
+				joints[jointCount++] = j;
 
-				b2Body* other = jn->other;
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (other->IsDynamic() == false && other->m_islandEpoch != epoch)
 				{
-					continue;
+					b2Assert(bodyCount < bodyCapacity);
+					other->m_islandIndex = bodyCount - island->bodyStart;
+					bodies[bodyCount++] = other;
+					other->m_islandEpoch = epoch;
 				}
+			}
+		}
+
+		island->bodyCount = bodyCount - island->bodyStart;
+		island->contactCount = contactCount - island->contactStart;
+		island->jointCount = jointCount - island->jointStart;
+
+		// The island indices of static bodies change with the next island.
+		b2Island::BindIndices(contacts + island->contactStart, island->contactCount,
+							  joints + island->jointStart, island->jointCount);
+	}
 
-				b2Assert(stackCount < stackSize);
-				stack[stackCount++] = other;
-				other->m_flags |= b2Body::e_islandFlag;
+	// The islands don't share any dynamic bodies, contacts or joints, so they can be
+	// solved on the threads of the task scheduler. The listener isn't thread safe, so
+	// the post-solve reports are buffered.
+	b2PostSolveReport* reports = (b2PostSolveReport*)m_stackAllocator.Allocate(reportCount * sizeof(b2PostSolveReport));
+	int32* order = (int32*)m_stackAllocator.Allocate(islandCount * sizeof(int32));
+
+	b2IslandTask task;
+	task.world = this;
+	task.step = &step;
+	task.islands = islands;
+	task.order = order;
+	task.bodies = bodies;
+	task.contacts = contacts;
+	task.joints = joints;
+	task.reports = m_contactListener ? reports : NULL;
+
+	if (m_taskScheduler && m_taskScheduler->GetThreadCount() > 1)
+	{
+		// A large island would keep one thread busy while the others idle. These
+		// are solved one at a time with their contacts spread over the threads.
+		// The soft step has no colors, so it solves all islands in parallel.
+		int32 smallCount = 0;
+		for (int32 i = 0; i < islandCount; ++i)
+		{
+			if (islands[i].contactCount >= b2_largeIslandContactCount && step.subStepCount == 0)
+			{
+				task.SolveIsland(islands + i, &m_stackAllocator, m_taskScheduler);
+			}
+			else
+			{
+				order[smallCount++] = i;
 			}
 		}
 
-		island.Solve(step, m_gravity, m_allowSleep);
+		// Start the largest islands first, so that they don't finish last.
+		b2IslandSizeOrder sizeOrder;
+		sizeOrder.islands = islands;
+		std::sort(order, order + smallCount, sizeOrder);
 
-		// Post solve cleanup.
-		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		if (smallCount > 0)
 		{
-			// Allow static bodies to participate in other islands.
-			b2Body* b = island.m_bodies[i];
-			if (b->IsStatic())
+			m_taskScheduler->Run(&task, smallCount);
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < islandCount; ++i)
+		{
+			order[i] = i;
+		}
+
+		task.Execute(0, islandCount, 0);
+	}
+
+	if (islandCount > m_islandIterationCapacity)
+	{
+		if (m_islandIterations)
+		{
+			b2Free(m_islandIterations);
+		}
+
+		m_islandIterationCapacity = b2Max(islandCount, 2 * m_islandIterationCapacity);
+		m_islandIterations = (int32*)b2Alloc(m_islandIterationCapacity * sizeof(int32));
+	}
+
+	m_solverStats.islandCount = islandCount;
+
+	// Post solve cleanup, in the order the islands were gathered. This doesn't
+	// depend on the threads, so the callbacks are deterministic.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange* island = islands + i;
+
+		m_islandIterations[i] = island->velocityIterationCount;
+		m_solverStats.velocityIterationCount += island->velocityIterationCount;
+		m_solverStats.maxVelocityIterationCount = b2Max(m_solverStats.maxVelocityIterationCount, island->velocityIterationCount);
+
+		// A static body sleeps when the last island it is in falls asleep. The seed
+		// is dynamic and tells if the island fell asleep.
+		bool sleeping = bodies[island->bodyStart]->IsSleeping();
+		for (int32 j = 0; j < island->bodyCount; ++j)
+		{
+			b2Body* b = bodies[island->bodyStart + j];
+			if (b->IsStatic() == false)
+			{
+				continue;
+			}
+
+			if (sleeping)
+			{
+				b->m_flags |= b2Body::e_sleepFlag;
+			}
+			else
+			{
+				b->m_flags &= ~b2Body::e_sleepFlag;
+			}
+		}
+
+		if (sleeping)
+		{
+			m_islandManager.PutIslandToSleep(island->island);
+		}
+	}
+
+	// The sleeping bodies at the border of an island wake when a body that still
+	// moves touches them or when the solver pushed them. The rest of a sleeping
+	// pile keeps sleeping. This merges islands, so it comes after the islands
+	// went to sleep.
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		const b2IslandRange* island = islands + i;
+		for (int32 j = 0; j < island->contactCount; ++j)
+		{
+			b2Contact* c = contacts[island->contactStart + j];
+			if ((c->m_flags & b2Contact::e_wakeFlag) == 0)
+			{
+				continue;
+			}
+
+			c->m_flags &= ~b2Contact::e_wakeFlag;
+			b2Body* bodyA = c->GetFixtureA()->GetBody();
+			b2Body* bodyB = c->GetFixtureB()->GetBody();
+			b2Body* border = bodyA->IsSleeping() ? bodyA : bodyB;
+			if (border->IsSleeping() && border->IsStatic() == false)
+			{
+				border->WakeUp();
+			}
+		}
+
+		for (int32 j = 0; j < island->bodyCount; ++j)
+		{
+			b2Body* b = bodies[island->bodyStart + j];
+			if (b->IsDynamic() == false || b->IsSleeping() || b->m_sleepTime > 0.0f)
 			{
-				b->m_flags &= ~b2Body::e_islandFlag;
+				continue;
 			}
+
+			m_islandManager.WakeTouching(b);
 		}
 	}
 
-	m_stackAllocator.Free(stack);
+	// The callbacks may wake and merge islands, so they come after the islands
+	// went to sleep.
+	if (task.reports)
+	{
+		for (int32 i = 0; i < islandCount; ++i)
+		{
+			const b2IslandRange* island = islands + i;
+			for (int32 j = 0; j < island->reportCount; ++j)
+			{
+				b2PostSolveReport* report = reports + island->reportStart + j;
+				m_contactListener->PostSolve(report->contact, &report->impulse);
+			}
+		}
+	}
 
-	// Synchronize fixtures, check for out of range bodies.
-	for (b2Body* b = m_bodyList; b; b = b->GetNext())
+	// Synchronize fixtures, check for out of range bodies. Only the bodies
+	// of the solved islands can have moved. Kinematic bodies were synchronized
+	// when they moved.
+	for (int32 i = 0; i < bodyCount; ++i)
 	{
+		b2Body* b = bodies[i];
 		if (b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag))
 		{
 			continue;
 		}
 
-		if (b->IsStatic())
+		if (b->IsDynamic() == false)
 		{
 			continue;
 		}
@@ -518,21 +1345,133 @@ void b2World::Solve(const b2TimeStep& step)
 		// Did the body's fixtures leave the world?
 		if (inRange == false && m_boundaryListener != NULL)
 		{
-			m_boundaryListener->Violation(b);
+			m_boundaryListener->Violation(b);
+		}
+	}
+
+	m_stackAllocator.Free(order);
+	m_stackAllocator.Free(reports);
+	m_stackAllocator.Free(islands);
+	m_stackAllocator.Free(joints);
+	m_stackAllocator.Free(contacts);
+	m_stackAllocator.Free(bodies);
+
+	// Commit fixture proxy movements to the broad-phase so that new contacts are created.
+	// Also, some contacts can be destroyed.
+	m_broadPhase->Commit();
+
+	// Compound bodies find their new contacts in the fixture trees.
+	m_contactManager.UpdateCompoundPairs();
+}
+
+// Computes the initial TOIs of SolveTOI on the threads of the task scheduler.
+class b2TOITask : public b2Task
+{
+public:
+	void Execute(int32 begin, int32 end, int32 threadIndex)
+	{
+		world->ComputeInitialTOIs(contacts + begin, tois + begin, end - begin, counters + threadIndex);
+	}
+
+	b2World* world;
+	b2Contact** contacts;
+	float32* tois;
+	b2TOICounters* counters;
+};
+
+void b2World::ComputeInitialTOIs(b2Contact** contacts, float32* tois, int32 count, b2TOICounters* counters)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Contact* c = contacts[i];
+		b2Body* b1 = c->GetFixtureA()->GetBody();
+		b2Body* b2 = c->GetFixtureB()->GetBody();
+		b2Assert(b1->m_sweep.t0 == 0.0f && b2->m_sweep.t0 == 0.0f);
+
+		tois[i] = c->ComputeTOI(b1->m_sweep, b2->m_sweep, counters);
+		b2Assert(0.0f <= tois[i] && tois[i] <= 1.0f);
+	}
+}
+
+// Compute the TOI of a contact from the current time of its bodies. Contacts with
+// a TOI inside the step go into the TOI queue. This replaces the cached TOI.
+void b2World::QueueTOI(b2Contact* c, b2TOICounters* counters)
+{
+	if (c->m_flags & b2Contact::e_toiFlag)
+	{
+		// Invalidate the cached TOI.
+		m_toiQueue.Remove(c);
+	}
+
+	if (c->m_flags & (b2Contact::e_slowFlag | b2Contact::e_nonSolidFlag | b2Contact::e_invalidFlag | b2Contact::e_destroyFlag))
+	{
+		return;
+	}
+
+	// TODO_ERIN keep a counter on the contact, only respond to M TOIs per contact.
+
+	b2Body* b1 = c->GetFixtureA()->GetBody();
+	b2Body* b2 = c->GetFixtureB()->GetBody();
+
+	if ((b1->IsDynamic() == false || b1->IsSleeping()) && (b2->IsDynamic() == false || b2->IsSleeping()))
+	{
+		return;
+	}
+
+	// Put the sweeps onto the same time interval. Static, kinematic and
+	// sleeping bodies keep t0 = 0, their sweeps are only aligned for this query.
+	b2Sweep sweep1 = b1->m_sweep;
+	b2Sweep sweep2 = b2->m_sweep;
+	float32 t0 = sweep1.t0;
+	
+	if (sweep1.t0 < sweep2.t0)
+	{
+		t0 = sweep2.t0;
+		sweep1.Advance(t0);
+		if (b1->IsDynamic() && b1->IsSleeping() == false)
+		{
+			b1->m_sweep = sweep1;
+		}
+	}
+	else if (sweep2.t0 < sweep1.t0)
+	{
+		t0 = sweep1.t0;
+		sweep2.Advance(t0);
+		if (b2->IsDynamic() && b2->IsSleeping() == false)
+		{
+			b2->m_sweep = sweep2;
 		}
 	}
 
-	// Commit fixture proxy movements to the broad-phase so that new contacts are created.
-	// Also, some contacts can be destroyed.
-	m_broadPhase->Commit();
+	b2Assert(t0 < 1.0f);
+
+	// Compute the time of impact.
+	float32 toi = c->ComputeTOI(sweep1, sweep2, counters);
+
+	b2Assert(0.0f <= toi && toi <= 1.0f);
+
+	// If the TOI is in range ...
+	if (0.0f < toi && toi < 1.0f)
+	{
+		// Interpolate on the actual range.
+		toi = b2Min((1.0f - toi) * t0 + toi, 1.0f);
+	}
+
+	c->m_toi = toi;
+
+	// Only queue events that happen in this step.
+	if (B2_FLT_EPSILON < toi && toi <= 1.0f - 100.0f * B2_FLT_EPSILON)
+	{
+		m_toiQueue.Push(c);
+	}
 }
 
-// Find TOI contacts and solve them.
+// Find TOI events and solve them. Only fast contacts (with a bullet or a static
+// body) are candidates. Their TOIs are kept in a min-heap, so each event costs a
+// pop plus recomputing the contacts of the bodies that the event moved.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
-	// Reserve an island and a queue for TOI island solution.
-	b2Island island(m_bodyCount, b2_maxTOIContactsPerIsland, b2_maxTOIJointsPerIsland, &m_stackAllocator, m_contactListener);
-	
+	// Reserve a queue for TOI island solution.
 	//Simple one pass queue
 	//Relies on the fact that we're only making one pass
 	//through and each body can only be pushed/popped once.
@@ -544,121 +1483,119 @@ void b2World::SolveTOI(const b2TimeStep& step)
 	int32 queueCapacity = m_bodyCount;
 	b2Body** queue = (b2Body**)m_stackAllocator.Allocate(queueCapacity* sizeof(b2Body*));
 
-	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	// All sweeps start at t0 = 0. Only awake dynamic bodies are advanced and
+	// these are reset at the end, so the other bodies are never touched.
+
+	// Find the candidates of the initial TOI events.
+	b2Contact** activeContacts = m_contactManager.m_activeContacts;
+	int32 activeContactCount = m_contactManager.m_activeContactCount;
+	b2Contact** candidates = (b2Contact**)m_stackAllocator.Allocate(activeContactCount * sizeof(b2Contact*));
+	int32 candidateCount = 0;
+	for (int32 i = 0; i < activeContactCount; ++i)
 	{
-		b->m_flags &= ~b2Body::e_islandFlag;
-		b->m_sweep.t0 = 0.0f;
+		b2Contact* c = activeContacts[i];
+		if (c->m_flags & (b2Contact::e_slowFlag | b2Contact::e_nonSolidFlag | b2Contact::e_invalidFlag | b2Contact::e_destroyFlag))
+		{
+			continue;
+		}
+
+		b2Body* b1 = c->GetFixtureA()->GetBody();
+		b2Body* b2 = c->GetFixtureB()->GetBody();
+		if ((b1->IsDynamic() == false || b1->IsSleeping()) && (b2->IsDynamic() == false || b2->IsSleeping()))
+		{
+			continue;
+		}
+
+		candidates[candidateCount++] = c;
 	}
 
-	for (b2Contact* c = m_contactList; c; c = c->m_next)
+	// All bodies are at the start of the step, so the initial TOIs are
+	// independent and may be computed on worker threads.
+	float32* tois = (float32*)m_stackAllocator.Allocate(candidateCount * sizeof(float32));
+	int32 threadCount = m_taskScheduler ? m_taskScheduler->GetThreadCount() : 1;
+	b2TOICounters* threadCounters = (b2TOICounters*)m_stackAllocator.Allocate(threadCount * sizeof(b2TOICounters));
+	for (int32 i = 0; i < threadCount; ++i)
 	{
-		// Invalidate TOI
-		c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
+		threadCounters[i].SetZero();
 	}
 
-	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	b2TOITask task;
+	task.world = this;
+	task.contacts = candidates;
+	task.tois = tois;
+	task.counters = threadCounters;
+
+	if (m_taskScheduler && candidateCount > 1)
+	{
+		m_taskScheduler->Run(&task, candidateCount);
+	}
+	else
 	{
-            j->m_islandFlag = false;
+		task.Execute(0, candidateCount, 0);
 	}
 
-	// Find TOI events and solve them.
-	for (;;)
+	b2TOICounters counters;
+	counters.SetZero();
+	for (int32 i = 0; i < threadCount; ++i)
 	{
-		// Find the first TOI.
-		b2Contact* minContact = NULL;
-		float32 minTOI = 1.0f;
+		counters.Add(threadCounters[i]);
+	}
 
-		for (b2Contact* c = m_contactList; c; c = c->m_next)
+	// Queue the initial TOI events.
+	b2Assert(m_toiQueue.GetCount() == 0);
+	for (int32 i = 0; i < candidateCount; ++i)
+	{
+		b2Contact* c = candidates[i];
+		c->m_toi = tois[i];
+		if (B2_FLT_EPSILON < c->m_toi && c->m_toi <= 1.0f - 100.0f * B2_FLT_EPSILON)
 		{
-			if (c->m_flags & (b2Contact::e_slowFlag | b2Contact::e_nonSolidFlag | b2Contact::e_invalidFlag | b2Contact::e_destroyFlag))
-			{
-				continue;
-			}
-
-			// TODO_ERIN keep a counter on the contact, only respond to M TOIs per contact.
-
-			float32 toi = 1.0f;
-			if (c->m_flags & b2Contact::e_toiFlag)
-			{
-				// This contact has a valid cached TOI.
-				toi = c->m_toi;
-			}
-			else
-			{
-				// Compute the TOI for this contact.
-				b2Fixture* s1 = c->GetFixtureA();
-				b2Fixture* s2 = c->GetFixtureB();
-				b2Body* b1 = s1->GetBody();
-				b2Body* b2 = s2->GetBody();
-
-				if ((b1->IsStatic() || b1->IsSleeping()) && (b2->IsStatic() || b2->IsSleeping()))
-				{
-					continue;
-				}
-
-				// Put the sweeps onto the same time interval.
-				float32 t0 = b1->m_sweep.t0;
-				
-				if (b1->m_sweep.t0 < b2->m_sweep.t0)
-				{
-					t0 = b2->m_sweep.t0;
-					b1->m_sweep.Advance(t0);
-				}
-				else if (b2->m_sweep.t0 < b1->m_sweep.t0)
-				{
-					t0 = b1->m_sweep.t0;
-					b2->m_sweep.Advance(t0);
-				}
-
-				b2Assert(t0 < 1.0f);
-
-				// Compute the time of impact.
-				toi = c->ComputeTOI(b1->m_sweep, b2->m_sweep);
-				//b2TimeOfImpact(c->m_fixtureA->GetShape(), b1->m_sweep, c->m_fixtureB->GetShape(), b2->m_sweep);
-
-				b2Assert(0.0f <= toi && toi <= 1.0f);
-
-				// If the TOI is in range ...
-				if (0.0f < toi && toi < 1.0f)
-				{
-					// Interpolate on the actual range.
-					toi = b2Min((1.0f - toi) * t0 + toi, 1.0f);
-				}
-
+			m_toiQueue.Push(c);
+		}
+	}
 
-				c->m_toi = toi;
-				c->m_flags |= b2Contact::e_toiFlag;
-			}
+	m_toiStats.candidateCount = m_toiQueue.GetCount();
 
-			if (B2_FLT_EPSILON < toi && toi < minTOI)
-			{
-				// This is the minimum TOI found so far.
-				minContact = c;
-				minTOI = toi;
-			}
-		}
+	m_stackAllocator.Free(threadCounters);
+	m_stackAllocator.Free(tois);
+	m_stackAllocator.Free(candidates);
 
-		if (minContact == NULL || 1.0f - 100.0f * B2_FLT_EPSILON < minTOI)
+	// Solve the TOI events in order.
+	b2Timer timer;
+	while (m_toiQueue.GetCount() > 0)
+	{
+		// Stop when the budget of this step is spent. The bodies of the remaining
+		// events keep their end of step positions, so these may tunnel.
+		if ((m_maxTOIEvents > 0 && m_toiStats.eventCount >= m_maxTOIEvents) ||
+			(m_maxTOITime > 0.0f && timer.GetMilliseconds() >= m_maxTOITime))
 		{
-			// No more TOI events. Done!
+			m_toiStats.droppedCount = m_toiQueue.GetCount();
+			m_toiQueue.Clear();
 			break;
 		}
 
+		// Find the first TOI.
+		b2Contact* minContact = m_toiQueue.Pop();
+		float32 minTOI = minContact->m_toi;
+
 		// Advance the bodies to the TOI.
 		b2Fixture* s1 = minContact->GetFixtureA();
 		b2Fixture* s2 = minContact->GetFixtureB();
 		b2Body* b1 = s1->GetBody();
 		b2Body* b2 = s2->GetBody();
-		b1->Advance(minTOI);
-		b2->Advance(minTOI);
+		if (b1->IsDynamic() && b1->IsSleeping() == false)
+		{
+			b1->Advance(minTOI);
+		}
+		if (b2->IsDynamic() && b2->IsSleeping() == false)
+		{
+			b2->Advance(minTOI);
+		}
 
 		// The TOI contact likely has some new contact points.
 		bool destroyed = m_contactManager.Update(minContact);
 		if (destroyed)
 			continue;
         
-		minContact->m_flags &= ~b2Contact::e_toiFlag;
-        
 		// Check if some flags have changed in the user callback
 		// Any of these mean we should now ignore the collision
 		if (minContact->m_flags & (b2Contact::e_slowFlag | b2Contact::e_nonSolidFlag | b2Contact::e_invalidFlag | b2Contact::e_destroyFlag))
@@ -670,43 +1607,50 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		{
 			// This shouldn't happen. Numerical error?
 			//b2Assert(false);
+			QueueTOI(minContact, &counters);
 			continue;
 		}
 
-		// Build the TOI island. We need a dynamic seed.
+		// Build the TOI island. We need an awake dynamic seed.
 		b2Body* seed = b1;
-		if (seed->IsStatic())
+		if (seed->IsDynamic() == false || seed->IsSleeping())
 		{
 			seed = b2;
 		}
-		if (seed->IsStatic())
+		if (seed->IsDynamic() == false || seed->IsSleeping())
 		{
+			QueueTOI(minContact, &counters);
 			continue;
 		}
 
-		// Reset island and queue.
-		island.Clear();
-		
+		// The update may have woken the seed.
+		seed->Advance(minTOI);
+
+		// Bodies, contacts and joints reached by this search carry its epoch.
+		uint32 epoch = ++m_islandEpoch;
+
+		// The search only counts the contacts and joints, so that the island is
+		// reserved with the size of this event. The queue keeps the bodies.
+		int32 contactCount = 0;
+		int32 jointCount = 0;
+
+		// Reset the queue.
 		int32 queueStart = 0; // starting index for queue
 		int32 queueSize = 0;  // elements in queue
 		queue[queueStart + queueSize++] = seed;
-		seed->m_flags |= b2Body::e_islandFlag;
+		seed->m_islandEpoch = epoch;
 
 		// Perform a breadth first search (BFS) on the contact/joint graph.
 		while (queueSize > 0)
 		{
-			// Grab the next body off the stack and add it to the island.
+			// Grab the next body off the stack.
 			b2Body* b = queue[queueStart++];
 			--queueSize;
-			
-			island.Add(b);
-
-			// Make sure the body is awake.
-			b->m_flags &= ~b2Body::e_sleepFlag;
 
-			// To keep islands as small as possible, we don't
-			// propagate islands across static bodies.
-			if (b->IsStatic())
+			// To keep islands as small as possible, we don't propagate islands
+			// across static and kinematic bodies. Sleeping bodies are held in
+			// place, like in the discrete solver.
+			if (b->IsDynamic() == false || b->IsSleeping())
 			{
 				continue;
 			}
@@ -714,14 +1658,8 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			// Search all contacts connected to this body.
 			for (b2ContactEdge* cEdge = b->m_contactList; cEdge; cEdge = cEdge->next)
 			{
-				// Does the TOI island still have space for contacts?
-				if (island.m_contactCount == island.m_contactCapacity)
-				{
-					continue;
-				}
-
 				// Has this contact already been added to an island? Skip slow or non-solid contacts.
-				if (cEdge->contact->m_flags & (b2Contact::e_islandFlag | b2Contact::e_slowFlag | b2Contact::e_nonSolidFlag))
+				if (cEdge->contact->m_islandEpoch == epoch || (cEdge->contact->m_flags & (b2Contact::e_slowFlag | b2Contact::e_nonSolidFlag)))
 				{
 					continue;
 				}
@@ -732,90 +1670,121 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					continue;
 				}
 
-				island.Add(cEdge->contact);
-				cEdge->contact->m_flags |= b2Contact::e_islandFlag;
+				++contactCount;
+				cEdge->contact->m_islandEpoch = epoch;
 
 				// Update other body.
 				b2Body* other = cEdge->other;
 
 				// Was the other body already added to this island?
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (other->m_islandEpoch == epoch)
 				{
 					continue;
 				}
 
 				// March forward, this can do no harm since this is the min TOI.
-				if (other->IsStatic() == false)
+				if (other->IsDynamic() && other->IsSleeping() == false)
 				{
 					other->Advance(minTOI);
-					other->WakeUp();
 				}
 
 				b2Assert(queueStart + queueSize < queueCapacity);
 				queue[queueStart + queueSize] = other;
 				++queueSize;
-				other->m_flags |= b2Body::e_islandFlag;
+				other->m_islandEpoch = epoch;
 			}
 			
 			for (b2JointEdge* jEdge = b->m_jointList; jEdge; jEdge = jEdge->next)
 			{
-				if (island.m_jointCount == island.m_jointCapacity)
-				{
-					continue;
-				}
-				
-				if (jEdge->joint->m_islandFlag == true)
+				if (jEdge->joint->m_islandEpoch == epoch || jEdge->other->IsActive() == false)
 				{
 					continue;
 				}
 				
-				island.Add(jEdge->joint);
-				
-				jEdge->joint->m_islandFlag = true;
+				++jointCount;
+				jEdge->joint->m_islandEpoch = epoch;
 				
 				b2Body* other = jEdge->other;
 				
-				if (other->m_flags & b2Body::e_islandFlag)
+				if (other->m_islandEpoch == epoch)
 				{
 					continue;
 				}
 				
-				if (!other->IsStatic())
+				if (other->IsDynamic() && other->IsSleeping() == false)
 				{
 					other->Advance(minTOI);
-					other->WakeUp();
 				}
 				
 				b2Assert(queueStart + queueSize < queueCapacity);
 				queue[queueStart + queueSize] = other;
 				++queueSize;
-				other->m_flags |= b2Body::e_islandFlag;
+				other->m_islandEpoch = epoch;
+			}
+		}
+
+		// The queue holds the bodies in search order. The contacts and joints are
+		// added in the order the search reached them, each one is marked with a
+		// new epoch when it is added. The bodies keep the epoch of the search.
+		int32 bodyCount = queueStart;
+		b2Island island(bodyCount, contactCount, jointCount, &m_stackAllocator, m_contactListener);
+
+		uint32 addEpoch = ++m_islandEpoch;
+		for (int32 i = 0; i < bodyCount; ++i)
+		{
+			b2Body* b = queue[i];
+			island.Add(b);
+
+			if (b->IsDynamic() == false || b->IsSleeping())
+			{
+				continue;
+			}
+
+			for (b2ContactEdge* cEdge = b->m_contactList; cEdge; cEdge = cEdge->next)
+			{
+				if (cEdge->contact->m_islandEpoch == epoch)
+				{
+					island.Add(cEdge->contact);
+					cEdge->contact->m_islandEpoch = addEpoch;
+				}
+			}
+
+			for (b2JointEdge* jEdge = b->m_jointList; jEdge; jEdge = jEdge->next)
+			{
+				if (jEdge->joint->m_islandEpoch == epoch)
+				{
+					island.Add(jEdge->joint);
+					jEdge->joint->m_islandEpoch = addEpoch;
+				}
 			}
 		}
 
+		b2Assert(island.m_contactCount == contactCount && island.m_jointCount == jointCount);
+
 		b2TimeStep subStep;
 		subStep.warmStarting = false;
+		subStep.wideContactSolver = false;
+		subStep.subStepCount = 0;
 		subStep.dt = (1.0f - minTOI) * step.dt;
 		subStep.inv_dt = 1.0f / subStep.dt;
 		subStep.dtRatio = 0.0f;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.positionIterations = step.positionIterations;
+		subStep.velocityTolerance = step.velocityTolerance;
+		subStep.minVelocityIterations = step.minVelocityIterations;
+
+		b2Island::BindIndices(island.m_contacts, island.m_contactCount, island.m_joints, island.m_jointCount);
 
 		island.SolveTOI(subStep);
+		++m_toiStats.eventCount;
 
-		// Post solve cleanup.
+		// Post solve cleanup. The next search has a new epoch, so the bodies,
+		// contacts and joints of this island may join future TOI islands.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
 		{
-			// Allow bodies to participate in future TOI islands.
 			b2Body* b = island.m_bodies[i];
-			b->m_flags &= ~b2Body::e_islandFlag;
-
-			if (b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag))
-			{
-				continue;
-			}
 
-			if (b->IsStatic())
+			if ((b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag)) || b->IsDynamic() == false)
 			{
 				continue;
 			}
@@ -830,35 +1799,55 @@ void b2World::SolveTOI(const b2TimeStep& step)
 			{
 				m_boundaryListener->Violation(b);
 			}
+		}
 
-			// Invalidate all contact TOIs associated with this body. Some of these
-			// may not be in the island because they were not touching.
-			for (b2ContactEdge* cn = b->m_contactList; cn; cn = cn->next)
+		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
+		// Also, some contacts can be destroyed.
+		m_broadPhase->Commit();
+
+		// Recompute the TOIs of all contacts of the moved bodies, including the new
+		// ones. Some of these may not be in the island because they were not touching.
+		// A contact between two moved bodies is handled by the second body.
+		for (int32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			b2Body* b = island.m_bodies[i];
+			if ((b->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag)) || b->IsDynamic() == false)
 			{
-				cn->contact->m_flags &= ~b2Contact::e_toiFlag;
+				continue;
 			}
-		}
 
-		for (int32 i = 0; i < island.m_contactCount; ++i)
-		{
-			// Allow contacts to participate in future TOI islands.
-			b2Contact* c = island.m_contacts[i];
-			c->m_flags &= ~(b2Contact::e_toiFlag | b2Contact::e_islandFlag);
-		}
+			for (b2ContactEdge* cn = b->m_contactList; cn; cn = cn->next)
+			{
+				// Is the other body a moved body that comes later in the island?
+				b2Body* other = cn->other;
+				if (other->m_islandEpoch == epoch && other->m_islandIndex > i &&
+					(other->m_flags & (b2Body::e_sleepFlag | b2Body::e_frozenFlag)) == 0 && other->IsDynamic())
+				{
+					continue;
+				}
 
-		for (int32 i = 0; i < island.m_jointCount; ++i)
-		{
-			// Allow joints to participate in future TOI islands.
-			b2Joint* j = island.m_joints[i];
-			j->m_islandFlag = false;
+				QueueTOI(cn->contact, &counters);
+			}
 		}
-		
-		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
-		// Also, some contacts can be destroyed.
-		m_broadPhase->Commit();
 	}
 
 	m_stackAllocator.Free(queue);
+
+	// Start the sweeps of the next step.
+	b2Body** awakeBodies = m_islandManager.m_awakeBodies;
+	for (int32 i = 0; i < m_islandManager.m_awakeBodyCount; ++i)
+	{
+		awakeBodies[i]->m_sweep.t0 = 0.0f;
+	}
+
+	m_toiStats.callCount = counters.callCount;
+	m_toiStats.iterationCount = counters.iterationCount;
+	m_toiStats.rootIterationCount = counters.rootIterationCount;
+
+	// Keep the global maxima for the tests.
+	extern int32 b2_maxToiIters, b2_maxToiRootIters;
+	b2_maxToiIters = b2Max(b2_maxToiIters, counters.maxIterations);
+	b2_maxToiRootIters = b2Max(b2_maxToiRootIters, counters.maxRootIterations);
 }
 
 void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIterations)
@@ -869,6 +1858,8 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dt = dt;
 	step.velocityIterations	= velocityIterations;
 	step.positionIterations = positionIterations;
+	step.velocityTolerance = m_velocityTolerance;
+	step.minVelocityIterations = m_minVelocityIterations;
 	if (dt > 0.0f)
 	{
 		step.inv_dt = 1.0f / dt;
@@ -881,6 +1872,18 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.wideContactSolver = m_wideContactSolver;
+	step.subStepCount = m_subStepCount;
+
+	m_toiStats.SetZero();
+	m_solverStats.SetZero();
+
+	// Speculative contacts look ahead by one step.
+	m_speculativeTime = 0.0f;
+	if (m_speculativeContacts)
+	{
+		m_speculativeTime = dt;
+	}
 	
 	// Update contacts.
 	m_contactManager.Collide();
@@ -908,19 +1911,115 @@ void b2World::Step(float32 dt, int32 velocityIterations, int32 positionIteration
 	m_lock = false;
 }
 
+// Collects the fixtures of a compound body that overlap the query AABB.
+struct b2WorldQueryCallback
+{
+	void QueryCallback(int32 index)
+	{
+		if (count == maxCount)
+		{
+			return;
+		}
+
+		b2Fixture* fixture = treeFixtures[index];
+
+		b2AABB fixtureAABB;
+		fixture->GetShape()->ComputeAABB(&fixtureAABB, xf);
+		if (b2TestOverlap(fixtureAABB, aabb))
+		{
+			fixtures[count++] = fixture;
+		}
+	}
+
+	b2AABB aabb;
+	b2XForm xf;
+	b2Fixture* const* treeFixtures;
+	b2Fixture** fixtures;
+	int32 count;
+	int32 maxCount;
+};
+
+// Ray casts the fixtures of a compound body and keeps the closest hit.
+struct b2WorldRayCastCallback
+{
+	void RayCastCallback(b2RayCastOutput* output, const b2RayCastInput& input, int32 index)
+	{
+		b2Fixture* fixture = treeFixtures[index];
+
+		if (filter && filter->RayCollide(userData, fixture) == false)
+		{
+			return;
+		}
+
+		float32 lambda;
+		b2Vec2 normal;
+		b2SegmentCollide collide = fixture->TestSegment(&lambda, &normal, *segment, input.maxFraction);
+
+		if (collide == b2_missCollide || (solidShapes == false && collide != b2_hitCollide))
+		{
+			return;
+		}
+
+		if (collide == b2_startsInsideCollide)
+		{
+			lambda = 0.0f;
+		}
+
+		output->hit = true;
+		output->fraction = lambda;
+		output->normal = normal;
+
+		closestFixture = fixture;
+		closestLambda = lambda;
+	}
+
+	b2ContactFilter* filter;
+	void* userData;
+	const b2Segment* segment;
+	bool solidShapes;
+	b2Fixture* const* treeFixtures;
+	b2Fixture* closestFixture;
+	float32 closestLambda;
+};
+
 int32 b2World::Query(const b2AABB& aabb, b2Fixture** fixtures, int32 maxCount)
 {
 	void** results = (void**)m_stackAllocator.Allocate(maxCount * sizeof(void*));
 
 	int32 count = m_broadPhase->Query(aabb, results, maxCount);
 
-	for (int32 i = 0; i < count; ++i)
+	b2WorldQueryCallback callback;
+	callback.aabb = aabb;
+	callback.fixtures = fixtures;
+	callback.count = 0;
+	callback.maxCount = maxCount;
+
+	for (int32 i = 0; i < count && callback.count < maxCount; ++i)
 	{
-		fixtures[i] = (b2Fixture*)results[i];
+		b2Fixture* fixture = (b2Fixture*)results[i];
+		b2Body* body = fixture->GetBody();
+
+		if (body->IsCompound() == false)
+		{
+			fixtures[callback.count++] = fixture;
+			continue;
+		}
+
+		// Query the fixture tree in body space.
+		const b2XForm& xf = body->GetXForm();
+		b2Vec2 center = b2MulT(xf, aabb.GetCenter());
+		b2Vec2 extents = b2MulT(b2Abs(xf.R), aabb.GetExtents());
+		b2AABB localAABB;
+		localAABB.lowerBound = center - extents;
+		localAABB.upperBound = center + extents;
+
+		callback.treeFixtures = body->m_treeFixtures;
+		callback.xf = xf;
+		body->m_fixtureTree.Query(&callback, localAABB);
 	}
 
 	m_stackAllocator.Free(results);
-	return count;
+	return callback.count;
 }
 
 int32 b2World::Raycast(const b2Segment& segment, b2Fixture** fixtures, int32 maxCount, bool solidShapes, void* userData)
@@ -936,6 +2035,15 @@ int32 b2World::Raycast(const b2Segment& segment, b2Fixture** fixtures, int32 max
 	for (int32 i = 0; i < count; ++i)
 	{
 		fixtures[i] = (b2Fixture*)results[i];
+
+		// A compound body reports its closest fixture.
+		b2Body* body = fixtures[i]->GetBody();
+		if (body->IsCompound())
+		{
+			float32 lambda;
+			fixtures[i] = RaycastCompound(body, &lambda);
+			b2Assert(fixtures[i] != NULL);
+		}
 	}
 
 	m_stackAllocator.Free(results);
@@ -961,6 +2069,20 @@ b2Fixture* b2World::RaycastOne(const b2Segment& segment, float32* lambda, b2Vec2
 	return fixture;
 }
 
+// Draws the merged faces of a grid.
+struct b2GridDrawCallback
+{
+	void QueryCallback(const b2EdgeShape* edge, int32 key)
+	{
+		B2_NOT_USED(key);
+		debugDraw->DrawSegment(b2Mul(xf, edge->m_v1), b2Mul(xf, edge->m_v2), color);
+	}
+
+	b2DebugDraw* debugDraw;
+	b2XForm xf;
+	b2Color color;
+};
+
 void b2World::DrawShape(b2Fixture* fixture, const b2XForm& xf, const b2Color& color)
 {
 	b2Color coreColor(0.9f, 0.6f, 0.6f);
@@ -1002,6 +2124,95 @@ void b2World::DrawShape(b2Fixture* fixture, const b2XForm& xf, const b2Color& co
 			m_debugDraw->DrawSegment(b2Mul(xf, edge->GetVertex1()), b2Mul(xf, edge->GetVertex2()), color);
 		}
 		break;
+
+	case b2_chainShape:
+		{
+			b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
+			int32 count = chain->m_count;
+			const b2Vec2* vertices = chain->m_vertices;
+
+			b2Vec2 v1 = b2Mul(xf, vertices[0]);
+			for (int32 i = 1; i < count; ++i)
+			{
+				b2Vec2 v2 = b2Mul(xf, vertices[i]);
+				m_debugDraw->DrawSegment(v1, v2, color);
+				v1 = v2;
+			}
+		}
+		break;
+
+	case b2_heightfieldShape:
+		{
+			b2HeightfieldShape* heightfield = (b2HeightfieldShape*)fixture->GetShape();
+			int32 count = heightfield->m_count;
+			float32 spacing = heightfield->m_spacing;
+
+			b2Vec2 v1 = b2Mul(xf, b2Vec2(0.0f, heightfield->GetHeight(0)));
+			for (int32 i = 1; i < count; ++i)
+			{
+				b2Vec2 v2 = b2Mul(xf, b2Vec2(spacing * float32(i), heightfield->GetHeight(i)));
+				m_debugDraw->DrawSegment(v1, v2, color);
+				v1 = v2;
+			}
+		}
+		break;
+
+	case b2_meshShape:
+		{
+			b2MeshShape* mesh = (b2MeshShape*)fixture->GetShape();
+			const b2Vec2* meshVertices = mesh->m_vertices;
+
+			for (int32 i = 0; i < mesh->m_triangleCount; ++i)
+			{
+				const int32* triangle = mesh->m_triangles + 3 * i;
+				b2Vec2 vertices[3];
+				vertices[0] = b2Mul(xf, meshVertices[triangle[0]]);
+				vertices[1] = b2Mul(xf, meshVertices[triangle[1]]);
+				vertices[2] = b2Mul(xf, meshVertices[triangle[2]]);
+				m_debugDraw->DrawSolidPolygon(vertices, 3, color);
+			}
+
+			for (int32 i = 0; i < mesh->m_segmentCount; ++i)
+			{
+				const int32* segment = mesh->m_segments + 2 * i;
+				m_debugDraw->DrawSegment(b2Mul(xf, meshVertices[segment[0]]), b2Mul(xf, meshVertices[segment[1]]), color);
+			}
+		}
+		break;
+
+	case b2_capsuleShape:
+		{
+			b2CapsuleShape* capsule = (b2CapsuleShape*)fixture->GetShape();
+			b2Vec2 p1 = b2Mul(xf, capsule->m_p1);
+			b2Vec2 p2 = b2Mul(xf, capsule->m_p2);
+			float32 radius = capsule->m_radius;
+
+			b2Vec2 axis = p2 - p1;
+			axis.Normalize();
+			b2Vec2 n = radius * b2Cross(axis, 1.0f);
+
+			m_debugDraw->DrawSolidCircle(p1, radius, -axis, color);
+			m_debugDraw->DrawSolidCircle(p2, radius, axis, color);
+			m_debugDraw->DrawSegment(p1 + n, p2 + n, color);
+			m_debugDraw->DrawSegment(p1 - n, p2 - n, color);
+		}
+		break;
+
+	case b2_gridShape:
+		{
+			b2GridShape* grid = (b2GridShape*)fixture->GetShape();
+
+			b2GridDrawCallback callback;
+			callback.debugDraw = m_debugDraw;
+			callback.xf = xf;
+			callback.color = color;
+
+			b2AABB aabb;
+			aabb.lowerBound.SetZero();
+			aabb.upperBound.Set(grid->m_cellSize * float32(grid->m_columnCount), grid->m_cellSize * float32(grid->m_rowCount));
+			grid->QueryFaces(&callback, aabb);
+		}
+		break;
 	}
 }
 
@@ -1068,10 +2279,18 @@ void b2World::DrawDebugData()
 			const b2XForm& xf = b->GetXForm();
 			for (b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
 			{
-				if (b->IsStatic())
+				if (b->IsActive() == false)
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.3f));
+				}
+				else if (b->IsStatic())
 				{
 					DrawShape(f, xf, b2Color(0.5f, 0.9f, 0.5f));
 				}
+				else if (b->IsKinematic())
+				{
+					DrawShape(f, xf, b2Color(0.5f, 0.9f, 0.9f));
+				}
 				else if (b->IsSleeping())
 				{
 					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.9f));
@@ -1193,6 +2412,7 @@ void b2World::DrawDebugData()
 void b2World::Validate()
 {
 	m_broadPhase->Validate();
+	m_islandManager.Validate();
 }
 
 int32 b2World::GetProxyCount() const
@@ -1216,6 +2436,17 @@ float32 b2World::RaycastSortKey(void* data)
 	b2Body* body = fixture->GetBody();
 	b2World* world = body->GetWorld();
 
+	if (body->IsCompound())
+	{
+		float32 lambda;
+		if (RaycastCompound(body, &lambda) == NULL)
+		{
+			return -1;
+		}
+
+		return lambda;
+	}
+
 	if (world->m_contactFilter && !world->m_contactFilter->RayCollide(world->m_raycastUserData,fixture))
 	{
 		return -1;
@@ -1236,3 +2467,33 @@ float32 b2World::RaycastSortKey(void* data)
 
 	return lambda;
 }
+
+b2Fixture* b2World::RaycastCompound(b2Body* body, float32* lambda)
+{
+	b2World* world = body->GetWorld();
+	const b2Segment& segment = *world->m_raycastSegment;
+
+	b2RayCastInput input;
+	input.p1 = body->GetLocalPoint(segment.p1);
+	input.p2 = body->GetLocalPoint(segment.p2);
+	input.maxFraction = 1.0f;
+
+	if (b2DistanceSquared(input.p1, input.p2) == 0.0f)
+	{
+		return NULL;
+	}
+
+	b2WorldRayCastCallback callback;
+	callback.filter = world->m_contactFilter;
+	callback.userData = world->m_raycastUserData;
+	callback.segment = &segment;
+	callback.solidShapes = world->m_raycastSolidShape;
+	callback.treeFixtures = body->m_treeFixtures;
+	callback.closestFixture = NULL;
+	callback.closestLambda = 1.0f;
+
+	body->m_fixtureTree.RayCast(&callback, input);
+
+	*lambda = callback.closestLambda;
+	return callback.closestFixture;
+}
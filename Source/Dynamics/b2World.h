@@ -23,10 +23,14 @@
 #include "../Common/b2BlockAllocator.h"
 #include "../Common/b2StackAllocator.h"
 #include "b2ContactManager.h"
+#include "b2IslandManager.h"
+#include "b2TOIQueue.h"
+#include "../Collision/b2TimeOfImpact.h"
 #include "b2WorldCallbacks.h"
 
 struct b2AABB;
 struct b2BodyDef;
+struct b2FixtureDef;
 struct b2JointDef;
 class b2Body;
 class b2Fixture;
@@ -43,9 +47,87 @@ struct b2TimeStep
 	float32 dtRatio;	// dt * inv_dt0
 	int32 velocityIterations;
 	int32 positionIterations;
+	float32 velocityTolerance;		// the velocity iterations may stop below this velocity change
+	int32 minVelocityIterations;
 	bool warmStarting;
+	bool wideContactSolver;
+	int32 subStepCount;	// soft step sub-steps, 0 for the iterative solver
 };
 
+/// The position of a body center of mass in the solver.
+struct b2Position
+{
+	b2Vec2 x;
+	float32 a;
+};
+
+/// The velocity of a body in the solver.
+struct b2Velocity
+{
+	b2Vec2 v;
+	float32 w;
+};
+
+/// The largest change of a body velocity component. The velocity iterations
+/// stop early once the constraints of an island change the velocities less
+/// than the velocity tolerance.
+inline float32 b2VelocityChange(const b2Velocity& velocity, const b2Vec2& v, float32 w)
+{
+	b2Vec2 dv = v - velocity.v;
+	return b2Max(b2Max(b2Abs(dv.x), b2Abs(dv.y)), b2Abs(w - velocity.w));
+}
+
+/// The island copies the state of its bodies into compact arrays, indexed
+/// by b2Body::m_islandIndex, and the constraints are solved on these.
+struct b2SolverData
+{
+	b2TimeStep step;
+	b2Position* positions;
+	b2Velocity* velocities;
+
+	/// Spreads the contacts of a large island over threads, or NULL.
+	b2TaskScheduler* taskScheduler;
+};
+
+/// Statistics of the continuous collision in the last time step.
+struct b2TOIStats
+{
+	/// Set all counts to zero.
+	void SetZero()
+	{
+		candidateCount = 0;
+		eventCount = 0;
+		callCount = 0;
+		iterationCount = 0;
+		rootIterationCount = 0;
+		droppedCount = 0;
+	}
+
+	int32 candidateCount;		///< contacts queued for TOI at the start of the step
+	int32 eventCount;			///< TOI events that were solved
+	int32 callCount;			///< TOI computations
+	int32 iterationCount;		///< conservative advancement iterations of all TOI computations
+	int32 rootIterationCount;	///< root finder iterations of all TOI computations
+	int32 droppedCount;			///< TOI events left over when the budget ran out
+};
+
+/// Statistics of the constraint solver in the last time step. The islands of
+/// continuous collision are not counted.
+struct b2SolverStats
+{
+	/// Set all counts to zero.
+	void SetZero()
+	{
+		islandCount = 0;
+		velocityIterationCount = 0;
+		maxVelocityIterationCount = 0;
+	}
+
+	int32 islandCount;					///< islands that were solved
+	int32 velocityIterationCount;		///< velocity iterations of all islands
+	int32 maxVelocityIterationCount;	///< velocity iterations of the island that needed the most
+};
+
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
 /// management facilities.
@@ -74,6 +156,13 @@ public:
 	/// Register a contact event listener
 	void SetContactListener(b2ContactListener* listener);
 
+	/// Register a task scheduler to run parts of the step on worker threads.
+	/// Currently these are the islands, the contacts of large islands and the
+	/// initial TOI computations of SolveTOI. Large islands always use the colors
+	/// of the wide contact solver.
+	/// The thread count of the scheduler must not change while it is registered.
+	void SetTaskScheduler(b2TaskScheduler* scheduler);
+
 	/// Register a routine for debug drawing. The debug draw functions are called
 	/// inside the b2World::Step method, so make sure your renderer is ready to
 	/// consume draw commands when you call Step().
@@ -84,6 +173,20 @@ public:
 	/// @warning This function is locked during callbacks.
 	b2Body* CreateBody(const b2BodyDef* def);
 
+	/// Create bodies together with their fixtures, such as when loading a level.
+	/// This is faster than creating them one by one: the fixture tree of a compound
+	/// body is built once and all proxies are inserted into the broad-phase at once.
+	/// The mass of a body is computed from its fixtures like b2Body::SetMassFromShapes,
+	/// unless the body definition has mass data or is kinematic.
+	/// @param bodyDefs the body definitions.
+	/// @param bodyCount the number of bodies.
+	/// @param fixtureDefs the fixture definitions of all bodies, body by body.
+	/// @param fixtureCounts the number of fixtures of each body.
+	/// @param bodies receives the new bodies, may be NULL.
+	/// @warning This function is locked during callbacks.
+	void CreateBodies(const b2BodyDef* bodyDefs, int32 bodyCount,
+					  const b2FixtureDef* const* fixtureDefs, const int32* fixtureCounts, b2Body** bodies);
+
 	/// Destroy a rigid body given a definition. No reference to the definition
 	/// is retained. This function is locked during callbacks.
 	/// @warning This automatically deletes all associated shapes and joints.
@@ -105,6 +208,34 @@ public:
 	/// Removes a controller from the world.
 	void DestroyController(b2Controller* controller);
 
+	/// Destroy all bodies, joints, contacts and controllers at once so the world
+	/// can be reused. This is much faster than destroying them one by one: the
+	/// destruction listener is not called and the memory is kept for the next
+	/// objects instead of being returned. A new ground body is created, the
+	/// settings and listeners of the world are kept.
+	/// @warning This function is locked during callbacks.
+	void Clear();
+
+	/// Get the size of the buffer that SaveState needs for the current state.
+	int32 GetStateSize() const;
+
+	/// Save the simulation state for rollback. This covers the bodies, fixtures, joints
+	/// and controllers, the contacts with their manifolds and impulses, the islands and
+	/// the broad-phase. Only the used memory is saved. The state refers to the objects of this world, so it can only
+	/// be restored into this world.
+	/// @param buffer receives the state, it must hold GetStateSize() bytes.
+	/// @warning This function is locked during callbacks.
+	void SaveState(void* buffer) const;
+
+	/// Restore a state saved by SaveState. A step after the restore gives the same
+	/// results as the step after the save. No bodies, fixtures, joints or controllers
+	/// may be created or destroyed in between, this is checked by an assert. Every
+	/// other change to them is undone, including the cells of grid shapes.
+	/// Contacts are restored without calling the contact listener and pointers to
+	/// contacts are no longer valid.
+	/// @warning This function is locked during callbacks.
+	void RestoreState(const void* buffer);
+
 	/// The world provides a single static ground body with no collision shapes.
 	/// You can use this to simplify the creation of joints and static shapes.
 	b2Body* GetGroundBody();
@@ -178,9 +309,49 @@ public:
 	/// Enable/disable warm starting. For testing.
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 
+	/// Enable/disable the wide contact solver. It solves groups of contacts
+	/// that don't share a body at once with SSE2 or AVX. The results differ
+	/// slightly from the regular solver because contacts are solved in a
+	/// different order.
+	void SetWideContactSolver(bool flag) { m_wideContactSolver = flag; }
+
+	/// Set the number of sub-steps of the soft step. The soft step splits each
+	/// step into sub-steps with soft contacts and does a single velocity iteration
+	/// and a relaxation iteration per sub-step. This replaces the velocity and
+	/// position iterations of b2World::Step. Zero uses the iterative solver.
+	/// The soft step doesn't use the wide solver and the impulses given to
+	/// b2ContactListener::PostSolve are those of the last sub-step.
+	void SetSubStepCount(int32 count) { b2Assert(count >= 0); m_subStepCount = count; }
+
+	/// Get the number of sub-steps of the soft step.
+	int32 GetSubStepCount() const { return m_subStepCount; }
+
+	/// Let the velocity iterations of an island stop early. An island stops once an
+	/// iteration changes no body velocity by more than the tolerance, but not before
+	/// the minimum number of iterations. The velocity iterations given to b2World::Step
+	/// are the maximum. Settled islands need few iterations.
+	/// @param tolerance the velocity change in m/s and rad/s, zero to always run all iterations.
+	/// @param minIterations the minimum number of velocity iterations.
+	void SetVelocityTolerance(float32 tolerance, int32 minIterations);
+
 	/// Enable/disable continuous physics. For testing.
 	void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 
+	/// Enable/disable speculative contacts. Contacts between shapes that are about
+	/// to touch within the next step are solved together with the touching
+	/// contacts, so fast bodies are stopped by the regular solver and TOI is only
+	/// needed for bullets. Speculative points count as touching, so BeginContact
+	/// is reported slightly before the shapes actually touch. Only circle and
+	/// polygon pairs and non-compound bodies are handled this way.
+	void SetSpeculativeContacts(bool flag) { m_speculativeContacts = flag; }
+
+	/// Limit the continuous collision work of a step. Once the budget is spent
+	/// the remaining TOI events of the step are dropped, trading tunneling for a
+	/// predictable step time. The defaults have no limits.
+	/// @param maxEvents the maximum number of TOI events per step, zero for no limit.
+	/// @param maxTime the maximum time of the TOI solver per step in milliseconds, zero for no limit.
+	void SetTOIBudget(int32 maxEvents, float32 maxTime);
+
 	/// Perform validation of internal data structures.
 	void Validate();
 
@@ -202,6 +373,26 @@ public:
 	/// Get the number of controllers.
 	int32 GetControllerCount() const;
 
+	/// Get the number of islands. Islands persist over steps, only the awake
+	/// islands are solved.
+	int32 GetIslandCount() const;
+
+	/// Get the number of awake islands.
+	int32 GetAwakeIslandCount() const;
+
+	/// Get the number of awake bodies. Static bodies are not counted.
+	int32 GetAwakeBodyCount() const;
+
+	/// Get the continuous collision statistics of the last step.
+	const b2TOIStats& GetTOIStats() const;
+
+	/// Get the constraint solver statistics of the last step.
+	const b2SolverStats& GetSolverStats() const;
+
+	/// Get the velocity iterations that each island used in the last step, in the
+	/// order the islands were found. There are b2SolverStats::islandCount entries.
+	const int32* GetIslandVelocityIterations() const;
+
 	/// Change the global gravity vector.
 	void SetGravity(const b2Vec2& gravity);
 	
@@ -212,17 +403,30 @@ private:
 
 	friend class b2Body;
 	friend class b2ContactManager;
+	friend class b2IslandManager;
 	friend class b2Controller;
+	friend class b2TOITask;
+	friend class b2IslandTask;
+
+	// Move the kinematic bodies by their velocity and put the resting ones to sleep.
+	void MoveKinematicBodies(const b2TimeStep& step);
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
+	// Compute the TOI of a contact and queue it if there is an event in this step.
+	void QueueTOI(b2Contact* contact, b2TOICounters* counters);
+
+	// Compute the TOIs of contacts whose bodies are all at the start of the step.
+	void ComputeInitialTOIs(b2Contact** contacts, float32* tois, int32 count, b2TOICounters* counters);
+
 	void DrawJoint(b2Joint* joint);
 	void DrawShape(b2Fixture* shape, const b2XForm& xf, const b2Color& color);
 	void DrawDebugData();
 
 	//Is it safe to pass private static function pointers?
 	static float32 RaycastSortKey(void* shape);
+	static b2Fixture* RaycastCompound(b2Body* body, float32* lambda);
 
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
@@ -231,6 +435,14 @@ private:
 
 	b2BroadPhase* m_broadPhase;
 	b2ContactManager m_contactManager;
+	b2IslandManager m_islandManager;
+
+	// Incremented by every island search, see b2Body::m_islandEpoch.
+	uint32 m_islandEpoch;
+
+	// Incremented when bodies, fixtures, joints or controllers are created or
+	// destroyed. A saved state can only be restored while it is unchanged.
+	uint32 m_topologyStamp;
 
 	b2Body* m_bodyList;
 	b2Joint* m_jointList;
@@ -244,6 +456,10 @@ private:
 	// Do not access
 	b2Contact* m_contactList;
 
+	// The TOI events of the contacts, only used in SolveTOI.
+	b2TOIQueue m_toiQueue;
+	b2TOIStats m_toiStats;
+
 	int32 m_bodyCount;
 	int32 m_contactCount;
 	int32 m_jointCount;
@@ -258,6 +474,12 @@ private:
 	b2BoundaryListener* m_boundaryListener;
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
+	b2TaskScheduler* m_taskScheduler;
+
+	// Stack allocators of the threads 1 and up. Thread 0 uses m_stackAllocator.
+	b2StackAllocator* m_threadAllocators;
+	int32 m_threadAllocatorCount;
+
 	b2DebugDraw* m_debugDraw;
 
 	// This is used to compute the time step ratio to
@@ -267,8 +489,29 @@ private:
 	// This is for debugging the solver.
 	bool m_warmStarting;
 
+	bool m_wideContactSolver;
+
+	int32 m_subStepCount;
+
 	// This is for debugging the solver.
 	bool m_continuousPhysics;
+
+	bool m_speculativeContacts;
+
+	// The look ahead time of speculative contacts, zero when they are off.
+	float32 m_speculativeTime;
+
+	// The TOI budget per step, zero means no limit.
+	int32 m_maxTOIEvents;
+	float32 m_maxTOITime;
+
+	float32 m_velocityTolerance;
+	int32 m_minVelocityIterations;
+
+	// The velocity iterations of the islands in the last step.
+	b2SolverStats m_solverStats;
+	int32* m_islandIterations;
+	int32 m_islandIterationCapacity;
 };
 
 inline b2Body* b2World::GetGroundBody()
@@ -316,6 +559,50 @@ inline int32 b2World::GetControllerCount() const
 	return m_controllerCount;
 }
 
+inline int32 b2World::GetIslandCount() const
+{
+	return m_islandManager.m_islandCount;
+}
+
+inline int32 b2World::GetAwakeIslandCount() const
+{
+	return m_islandManager.m_awakeCount;
+}
+
+inline int32 b2World::GetAwakeBodyCount() const
+{
+	return m_islandManager.m_awakeBodyCount;
+}
+
+inline const b2TOIStats& b2World::GetTOIStats() const
+{
+	return m_toiStats;
+}
+
+inline const b2SolverStats& b2World::GetSolverStats() const
+{
+	return m_solverStats;
+}
+
+inline const int32* b2World::GetIslandVelocityIterations() const
+{
+	return m_islandIterations;
+}
+
+inline void b2World::SetVelocityTolerance(float32 tolerance, int32 minIterations)
+{
+	b2Assert(tolerance >= 0.0f && minIterations >= 1);
+	m_velocityTolerance = tolerance;
+	m_minVelocityIterations = minIterations;
+}
+
+inline void b2World::SetTOIBudget(int32 maxEvents, float32 maxTime)
+{
+	b2Assert(maxEvents >= 0 && maxTime >= 0.0f);
+	m_maxTOIEvents = maxEvents;
+	m_maxTOITime = maxTime;
+}
+
 inline void b2World::SetGravity(const b2Vec2& gravity)
 {
 	m_gravity = gravity;
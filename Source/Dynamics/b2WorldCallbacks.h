@@ -109,6 +109,8 @@ public:
 	/// contact before it goes to the solver. If you are careful, you can modify the
 	/// contact manifold (e.g. disable contact).
 	/// A copy of the old manifold is provided so that you can detect changes.
+	/// Contacts with a chain get the first old segment manifold, override
+	/// PreSolveManifolds to see all of them.
 	/// Note: this is called only for awake bodies.
 	/// Note: this is called even when the number of contact points is zero.
 	/// Note: this is not called for sensors.
@@ -121,12 +123,24 @@ public:
 		B2_NOT_USED(oldManifold);
 	}
 
+	/// This is called where PreSolve is, with all manifolds of the previous update.
+	/// Contacts with a chain have one old manifold per segment that was touching,
+	/// in the order of the previous update, so a segment may not keep its index.
+	/// Other contacts have a single old manifold. The default calls PreSolve with
+	/// the first old manifold.
+	virtual void PreSolveManifolds(b2Contact* contact, const b2Manifold* oldManifolds, int32 oldManifoldCount)
+	{
+		B2_NOT_USED(oldManifoldCount);
+		PreSolve(contact, oldManifolds);
+	}
+
 	/// This lets you inspect a contact after the solver is finished. This is useful
 	/// for inspecting impulses.
 	/// Note: the contact manifold does not include time of impact impulses, which can be
 	/// arbitrarily large if the sub-step is small. Hence the impulse is provided explicitly
 	/// in a separate data structure.
 	/// Note: this is only called for contacts that are touching, solid, and awake.
+	/// Contacts with a chain are reported once for each touching segment manifold.
 	virtual void PostSolve(const b2Contact* contact, const b2ContactImpulse* impulse)
 	{
 		B2_NOT_USED(contact);
@@ -134,6 +148,35 @@ public:
 	}
 };
 
+/// A parallel loop over work items. The items are independent, so ranges of
+/// them may be executed on different threads at the same time.
+class b2Task
+{
+public:
+	virtual ~b2Task() {}
+
+	/// Execute the items in [begin, end).
+	/// @param threadIndex identifies the executing thread, in [0, thread count).
+	/// Ranges that run at the same time must have different thread indices.
+	virtual void Execute(int32 begin, int32 end, int32 threadIndex) = 0;
+};
+
+/// Implement this class to run parts of the time step on worker threads.
+/// Box2D doesn't create threads by itself. Without a scheduler everything
+/// runs on the calling thread.
+class b2TaskScheduler
+{
+public:
+	virtual ~b2TaskScheduler() {}
+
+	/// Get the number of threads that execute tasks, including the calling thread.
+	virtual int32 GetThreadCount() const = 0;
+
+	/// Execute all items of the task, split into ranges, and return
+	/// when all ranges are done.
+	virtual void Run(b2Task* task, int32 itemCount) = 0;
+};
+
 /// Color for debug drawing. Each value has the range [0,1].
 struct b2Color
 {